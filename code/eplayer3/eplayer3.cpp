@@ -168,6 +168,9 @@ void WinMainCRTStartup()
                 eShowError(eIntToStr(averageFps));
 #endif
                 demo.getSynth().stop();
+#ifndef NO_ADDSYNTH
+                tfPadSynthCache::get().shutdown();
+#endif
             }
 #ifdef eEDITOR         
             eOpStacking::shutdown();
@@ -0,0 +1,837 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+// Command line tool which loads a demo script and
+// runs its complete precalculation, measuring the
+// time spent in each operator. It's built with
+// the null graphics API (eNULL_GFX), so no device
+// or window is required. Like the player it has
+// to be built for the production, because the
+// operator IDs are production dependent. Either
+// the production's script or an exported script
+// file of the same production is processed.
+// On Windows it's built with its project, on
+// Linux with the compile script, which generates
+// the production's operator creator. There no
+// compiled shader headers are needed and the text
+// operators, which need GDI, render no text.
+// With -sweep one operator is executed for a
+// list of values of one of its parameters, after
+// fixing other parameters with -set. Settings of
+// the swept operator are applied after the
+// precalculation, so that operators depending on
+// it aren't processed with them. The
+// number of worker threads is set with -threads.
+// With -voicebench the synthesizer's voice
+// rendering is measured instead, with
+// -dispatchbench the calling of the operators'
+// execute functions, with -psysbench the frame
+// time of a full particle system and with
+// -meshbench the Subdivide and Multiply mesh
+// operators.
+
+#include <stdio.h>
+
+#include "../eshared/eshared.hpp"
+#include "../eplayer3/production.hpp"
+
+struct eOpTiming
+{
+    eIOperator *    op;
+    eF64            ms;
+};
+
+typedef eArray<eOpTiming> eOpTimingArray;
+
+struct eParamSetting
+{
+    eID             opId;
+    eU32            paramIndex;
+    eF32            value;
+};
+
+typedef eArray<eParamSetting> eParamSettingArray;
+
+static eF64 getTimeMs()
+{
+    return (eF64)eTimer::getTickCount()*1000.0/(eF64)eTimer::getFrequency();
+}
+
+static eBool sortByTime(const eOpTiming &a, const eOpTiming &b)
+{
+    return (a.ms < b.ms);
+}
+
+static eBool progressCallback(eIRenderer *renderer, eU32 processed, eU32 total, ePtr param)
+{
+    eASSERT(processed <= total);
+
+    printf("\rprocessing operators: %u/%u", processed, total);
+    return eTRUE;
+}
+
+// Sets all components of an operator's numeric
+// parameter to the given value. Returns false if
+// the parameter doesn't exist or isn't numeric.
+static eBool setParameter(eIOperator *op, eU32 index, eF32 value)
+{
+    if (index >= op->getParameterCount())
+    {
+        return eFALSE;
+    }
+
+    eParameter &param = op->getParameter(index);
+    eParameter::Value &val = param.getValue();
+    eU32 fltCount = 0;
+    eU32 intCount = 0;
+
+    switch (param.getType())
+    {
+        case eParameter::TYPE_FLOAT:
+            fltCount = 1;
+            break;
+
+        case eParameter::TYPE_FXY:
+            fltCount = 2;
+            break;
+
+        case eParameter::TYPE_FXYZ:
+            fltCount = 3;
+            break;
+
+        case eParameter::TYPE_FXYZW:
+            fltCount = 4;
+            break;
+
+        case eParameter::TYPE_INT:
+        case eParameter::TYPE_ENUM:
+        case eParameter::TYPE_FLAGS:
+        case eParameter::TYPE_BOOL:
+            intCount = 1;
+            break;
+
+        case eParameter::TYPE_IXY:
+            intCount = 2;
+            break;
+
+        case eParameter::TYPE_IXYZ:
+            intCount = 3;
+            break;
+
+        case eParameter::TYPE_IXYXY:
+            intCount = 4;
+            break;
+
+        default:
+            return eFALSE;
+    }
+
+    for (eU32 i=0; i<fltCount; i++)
+    {
+        ((eF32 *)&val.fxyzw)[i] = value;
+    }
+
+    for (eU32 i=0; i<intCount; i++)
+    {
+        ((eInt *)&val.ixyxy)[i] = eFtoL(value);
+    }
+
+    op->setChanged();
+    return eTRUE;
+}
+
+// Executes the given operator the given number
+// of times and returns the fastest time. Only
+// the operator itself is executed again, its
+// inputs are already processed.
+static eF64 timeOperator(eIRenderer *renderer, eIOperator *op, eU32 runs)
+{
+    eF64 minTime = 0.0;
+
+    for (eU32 i=0; i<runs; i++)
+    {
+        op->setChanged();
+
+        const eF64 startTime = getTimeMs();
+        op->process(renderer, 0.0f);
+        const eF64 time = getTimeMs()-startTime;
+
+        minTime = (i == 0 ? time : eMin(minTime, time));
+    }
+
+    return minTime;
+}
+
+// Executes an operator for each of the given
+// comma separated values of one of its parameters.
+static eBool sweepParameter(eIRenderer *renderer, eID opId, eU32 paramIndex, const eChar *values, eU32 runs)
+{
+    eIOperator *op = eDemoData::findOperator(opId);
+
+    if (!op)
+    {
+        printf("operator %u doesn't exist!\n", opId);
+        return eFALSE;
+    }
+
+    printf("sweep of parameter %u of operator %u (type-id %u), fastest of %u runs\n", paramIndex, opId, op->m_metaOpID, runs);
+    printf("       value        time\n");
+
+    const eChar *str = values;
+
+    while (*str)
+    {
+        eF32 value;
+        eInt length = 0;
+
+        if (sscanf(str, "%f%n", &value, &length) != 1)
+        {
+            printf("invalid value list \"%s\"!\n", values);
+            return eFALSE;
+        }
+
+        if (!setParameter(op, paramIndex, value))
+        {
+            printf("parameter %u of operator %u isn't numeric!\n", paramIndex, opId);
+            return eFALSE;
+        }
+
+        printf("%12.4f %8.2f ms\n", value, timeOperator(renderer, op, runs));
+
+        str += length;
+
+        if (*str == ',')
+        {
+            str++;
+        }
+    }
+
+    return eTRUE;
+}
+
+// Applies either the settings of the swept
+// operator or all others.
+static eBool applySettings(const eParamSettingArray &settings, eBool sweptOp, eID sweepOpId)
+{
+    for (eU32 i=0; i<settings.size(); i++)
+    {
+        const eParamSetting &ps = settings[i];
+
+        if ((sweepOpId != 0 && ps.opId == sweepOpId) != sweptOp)
+        {
+            continue;
+        }
+
+        eIOperator *op = eDemoData::findOperator(ps.opId);
+
+        if (!op || !setParameter(op, ps.paramIndex, ps.value))
+        {
+            printf("couldn't set parameter %u of operator %u!\n", ps.paramIndex, ps.opId);
+            return eFALSE;
+        }
+    }
+
+    return eTRUE;
+}
+
+static void printUsage()
+{
+    printf("usage: eprecalc3 [demo script] [number of operators to list] [options]\n");
+    printf("       eprecalc3 -voicebench\n");
+    printf("       eprecalc3 -dispatchbench\n");
+    printf("       eprecalc3 -psysbench\n");
+    printf("       eprecalc3 -meshbench\n\n");
+    printf("options:\n");
+    printf("  -sweep <op-id> <param index> <v0,v1,...>  time an operator for each value of a parameter\n");
+    printf("  -set <op-id> <param index> <value>        set a parameter before processing, of the swept\n"
+           "                                            operator after processing (repeatable)\n");
+    printf("  -runs <n>                                 report the fastest of n runs (default 1)\n");
+    printf("  -threads <n>                              use n worker threads (0 runs serially)\n");
+}
+
+static eBool loadScript(const eChar *fileName, eByteArray &buffer)
+{
+    FILE *f = fopen(fileName, "rb");
+
+    if (!f)
+    {
+        return eFALSE;
+    }
+
+    fseek(f, 0, SEEK_END);
+    buffer.resize(ftell(f));
+    fseek(f, 0, SEEK_SET);
+
+    const eBool ok = (buffer.size() > 0 && fread(&buffer[0], 1, buffer.size(), f) == buffer.size());
+    fclose(f);
+    return ok;
+}
+
+// Compares the voice interleaved filter engine
+// with filtering one voice after another.
+static void benchmarkVoices()
+{
+    const eU32 BLOCK_COUNT = 2000;
+
+    printf("voices   serial blocks/ms   lanes blocks/ms   speedup\n");
+
+    for (eU32 voices=1; voices<=TF_MAXVOICES; voices*=2)
+    {
+        const eF32 serial = tfInstrument::benchmark(eFALSE, voices, BLOCK_COUNT);
+        const eF32 lanes = tfInstrument::benchmark(eTRUE, voices, BLOCK_COUNT);
+
+        printf("%6u %18.2f %17.2f %8.2fx\n", voices, serial, lanes, lanes/serial);
+    }
+
+    tfPadSynthCache::get().shutdown();
+}
+
+// Measures the frame time of a particle system
+// which is filled up to its maximum particle count:
+// the simulation of one frame and the filling of
+// the vertex buffers for rendering it.
+static void benchmarkParticles()
+{
+    const eU32 FRAME_COUNT = 600;
+    const eF32 FRAME_TIME = 1.0f/60.0f;
+
+    eEngine engine;
+    engine.openWindow(eFALSE, eSize(800, 600), eNULL);
+
+    eParticleSystem psys;
+    psys.init(engine.getGraphicsApi());
+    psys.m_lifeTime = 5.0f;
+    psys.m_randomization = 0.5f;
+    psys.m_emissionFreq = 2.0f*(eF32)PSYS_MAX_PARTICLES/psys.m_lifeTime;
+    psys.m_gravityConst->set(0.0f, -1.0f, 0.0f);
+
+    eF32 time = 2.0f*psys.m_lifeTime;
+    psys.update(time);
+
+    eF64 updateTime = 0.0;
+    eF64 fillTime = 0.0;
+    eU32 particles = 0;
+
+    for (eU32 i=0; i<FRAME_COUNT; i++)
+    {
+        time += FRAME_TIME;
+
+        const eF64 startTime = getTimeMs();
+        psys.update(time);
+        const eF64 updatedTime = getTimeMs();
+        psys.m_geometry->render();
+
+        updateTime += updatedTime-startTime;
+        fillTime += getTimeMs()-updatedTime;
+        particles += psys.m_count;
+    }
+
+    printf("max. particles:  %u\n", PSYS_MAX_PARTICLES);
+    printf("avg. particles:  %u\n", particles/FRAME_COUNT);
+    printf("update:          %8.3f ms/frame\n", updateTime/(eF64)FRAME_COUNT);
+    printf("fill buffers:    %8.3f ms/frame\n", fillTime/(eF64)FRAME_COUNT);
+    printf("frame:           %8.3f ms/frame\n", (updateTime+fillTime)/(eF64)FRAME_COUNT);
+}
+
+// Builds a closed torus of quads, so that all
+// vertices of the benchmark mesh are interior.
+static void buildTorus(eEditMesh &mesh, eU32 rings, eU32 sides)
+{
+    mesh.clear();
+    mesh.reserveSpace(rings*sides, rings*sides);
+
+    for (eU32 i=0; i<rings; i++)
+    {
+        const eF32 u = (eF32)i/(eF32)rings;
+        const eF32 cu = eCos(u*eTWOPI);
+        const eF32 su = eSin(u*eTWOPI);
+
+        for (eU32 j=0; j<sides; j++)
+        {
+            const eF32 v = (eF32)j/(eF32)sides;
+            const eF32 r = 1.0f+0.3f*eCos(v*eTWOPI);
+
+            mesh.addVertex(eVector3(r*cu, 0.3f*eSin(v*eTWOPI), r*su), eVector2(u, v));
+        }
+    }
+
+    for (eU32 i=0; i<rings; i++)
+    {
+        const eU32 i1 = (i+1)%rings;
+
+        for (eU32 j=0; j<sides; j++)
+        {
+            const eU32 j1 = (j+1)%sides;
+            mesh.addQuad(i*sides+j, i*sides+j1, i1*sides+j1, i1*sides+j);
+        }
+    }
+
+    mesh.updateNormals();
+}
+
+// Measures the work of the Subdivide and the
+// Multiply mesh operators on a large mesh. The
+// operators' execute functions are replayed on
+// the engine level, because the production may
+// not contain them. Subdivide is measured when
+// its topology is rebuilt and when only the
+// vertices are recalculated.
+static void benchmarkMesh()
+{
+    const eU32 RUNS = 5;
+    const eU32 RINGS = 128;
+    const eU32 SIDES = 64;
+    const eU32 LEVELS = 2;
+    const eU32 MULTIPLY_COUNT = 4;
+
+    eF64 buildTime = 0.0;
+    eF64 refineTime = 0.0;
+    eF64 evalTime = 0.0;
+    eF64 multiplyTime = 0.0;
+
+    eEditMesh torus;
+    eEditMesh subdivided;
+    eEditMesh multiplied;
+
+    for (eU32 i=0; i<RUNS; i++)
+    {
+        eF64 startTime = getTimeMs();
+        buildTorus(torus, RINGS, SIDES);
+        const eF64 build = getTimeMs()-startTime;
+
+        // Subdivide with a changed input topology
+        // and then with an unchanged one.
+        eSubdivider subdiv;
+        subdivided.clear();
+
+        startTime = getTimeMs();
+        subdiv.refine(torus, LEVELS, subdivided);
+        subdiv.evaluate(torus, 1.0f, subdivided);
+        subdivided.updateBoundingBox();
+        subdivided.updateNormals();
+        const eF64 refine = getTimeMs()-startTime;
+
+        startTime = getTimeMs();
+        subdiv.refine(torus, LEVELS, subdivided);
+        subdiv.evaluate(torus, 0.5f, subdivided);
+        subdivided.updateBoundingBox();
+        subdivided.updateNormals();
+        const eF64 eval = getTimeMs()-startTime;
+
+        // Multiply the subdivided mesh like the
+        // Multiply operator does.
+        multiplied.clear();
+        startTime = getTimeMs();
+
+        eEditMesh em = subdivided;
+        eMatrix4x4 mtxPos;
+        mtxPos.transformation(eVector3(0.0f, 0.1f, 0.0f)*eTWOPI, eVector3(3.0f, 0.0f, 0.0f), eVector3(1.0f));
+        multiplied.merge(em);
+
+        for (eU32 j=0; j<MULTIPLY_COUNT; j++)
+        {
+            eMatrix4x4 mtxNrm = mtxPos;
+            mtxNrm.invert();
+            mtxNrm.transpose();
+
+            eVector3Array &positions = em.getPositions();
+            eVector3Array &normals = em.getNormals();
+
+            for (eU32 k=0; k<positions.size(); k++)
+            {
+                positions[k] *= mtxPos;
+                normals[k] *= mtxNrm;
+            }
+
+            multiplied.merge(em);
+        }
+
+        for (eU32 j=0; j<multiplied.getFaceCount(); j++)
+        {
+            multiplied.getFace(j)->updateNormal();
+        }
+
+        const eF64 multiply = getTimeMs()-startTime;
+
+        buildTime = (i == 0 ? build : eMin(buildTime, build));
+        refineTime = (i == 0 ? refine : eMin(refineTime, refine));
+        evalTime = (i == 0 ? eval : eMin(evalTime, eval));
+        multiplyTime = (i == 0 ? multiply : eMin(multiplyTime, multiply));
+    }
+
+    printf("input:           %u faces\n", torus.getFaceCount());
+    printf("subdivided:      %u faces (%u levels)\n", subdivided.getFaceCount(), LEVELS);
+    printf("multiplied:      %u faces (count %u)\n\n", multiplied.getFaceCount(), MULTIPLY_COUNT);
+    printf("fastest of %u runs\n", RUNS);
+    printf("build input:     %10.2f ms\n", buildTime);
+    printf("subdivide:       %10.2f ms\n", refineTime);
+    printf("subdivide again: %10.2f ms\n", evalTime);
+    printf("multiply:        %10.2f ms\n", multiplyTime);
+}
+
+// Stands in for an operator in the dispatch
+// benchmark. Its execute function takes the
+// typical argument mix of an operator.
+class eDispatchBenchOp
+{
+public:
+    eDispatchBenchOp() : m_sum(0.0f)
+    {
+    }
+
+    void execute(eGraphicsApiDx9 *gfx, eInt mode, eF32 amount, const eFXYZ &pos, eF32 scale, eBool flag, const eChar *name)
+    {
+        m_sum += (eF32)mode+amount*scale+pos.x+pos.y+pos.z+(eF32)flag+(eF32)name[0];
+    }
+
+public:
+    eF32 m_sum;
+};
+
+static const eParameter::Type DISPATCH_BENCH_TYPES[] =
+{
+    eParameter::TYPE_ENUM,
+    eParameter::TYPE_FLOAT,
+    eParameter::TYPE_FXYZ,
+    eParameter::TYPE_FLOAT,
+    eParameter::TYPE_BOOL,
+    eParameter::TYPE_STRING,
+};
+
+static const eU32 DISPATCH_BENCH_ARGS = sizeof(DISPATCH_BENCH_TYPES)/sizeof(DISPATCH_BENCH_TYPES[0]);
+
+// Collects the arguments and calls the execute
+// function like eIOperator::_callExecute() does.
+static void callTypedDispatch(eDispatchBenchOp *op, eIOperator::ExecFunc func, const eParameter::Value *vals)
+{
+    eIOperator::ExecArg args[DISPATCH_BENCH_ARGS];
+
+    for (eU32 i=0; i<DISPATCH_BENCH_ARGS; i++)
+    {
+        switch (DISPATCH_BENCH_TYPES[i])
+        {
+            case eParameter::TYPE_FXYZ:
+                args[i].ptr = (ePtr)&vals[i].fxyz;
+                break;
+
+            case eParameter::TYPE_STRING:
+                args[i].ptr = (ePtr)vals[i].string;
+                break;
+
+            case eParameter::TYPE_FLOAT:
+                args[i].flt = vals[i].flt;
+                break;
+
+            default:
+                args[i].integer = vals[i].integer;
+                break;
+        }
+    }
+
+    func((eIOperator *)op, eNULL, args);
+}
+
+#if defined(_MSC_VER) && defined(_M_IX86)
+// Calls the execute function like operators were
+// called before the typed dispatch functions: the
+// arguments are pushed in reverse order with inline
+// assembly and the function is called via its raw
+// address using the this-call convention.
+static void callAsmThunk(eDispatchBenchOp *op, ePtr func, const eParameter::Value *vals)
+{
+    eGraphicsApiDx9 *gfx = eNULL;
+
+    for (eInt i=(eInt)DISPATCH_BENCH_ARGS-1; i>=0; i--)
+    {
+        switch (DISPATCH_BENCH_TYPES[i])
+        {
+            case eParameter::TYPE_FXYZ:
+            {
+                const eFXYZ &v = vals[i].fxyz;
+                __asm push dword ptr [v]
+                break;
+            }
+
+            case eParameter::TYPE_STRING:
+            {
+                const eChar *string = vals[i].string;
+                __asm push dword ptr [string]
+                break;
+            }
+
+            case eParameter::TYPE_FLOAT:
+            {
+                const float flt = vals[i].flt;
+
+                __asm
+                {
+                    fld     dword ptr [flt]
+                    sub     esp, 4
+                    fstp    dword ptr [esp]
+                }
+
+                break;
+            }
+
+            default:
+            {
+                const int integer = vals[i].integer;
+                __asm push dword ptr [integer]
+                break;
+            }
+        }
+    }
+
+    __asm
+    {
+        push    dword ptr [gfx]
+        mov     ecx, dword ptr [op]
+        call    dword ptr [func]
+    }
+}
+#endif
+
+// Measures the time needed to collect the
+// arguments of an operator and to call its
+// execute function, with the typed dispatch
+// functions and (on 32-bit x86) with the
+// inline assembly thunk they replaced.
+static void benchmarkDispatch()
+{
+    const eU32 CALL_COUNT = 10000000;
+
+    eParameter::Value vals[DISPATCH_BENCH_ARGS];
+    vals[0].integer = 2;
+    vals[1].flt = 0.5f;
+    vals[2].fxyz.x = 1.0f;
+    vals[2].fxyz.y = 2.0f;
+    vals[2].fxyz.z = 3.0f;
+    vals[3].flt = 2.0f;
+    vals[4].boolean = eTRUE;
+    eStrCopy(vals[5].string, "dispatch");
+
+    eDispatchBenchOp op;
+    const eIOperator::ExecFunc typedFunc = eOP_EXEC_FUNC(eDispatchBenchOp);
+
+    eF64 startTime = getTimeMs();
+
+    for (eU32 i=0; i<CALL_COUNT; i++)
+    {
+        callTypedDispatch(&op, typedFunc, vals);
+    }
+
+    const eF64 typedTime = getTimeMs()-startTime;
+
+    printf("calls: %u, arguments per call: %u\n", CALL_COUNT, DISPATCH_BENCH_ARGS);
+    printf("typed dispatch: %10.2f ms %8.2f ns/call\n", typedTime, typedTime*1000000.0/(eF64)CALL_COUNT);
+
+#if defined(_MSC_VER) && defined(_M_IX86)
+    void (eDispatchBenchOp::*execFunc)(eGraphicsApiDx9 *, eInt, eF32, const eFXYZ &, eF32, eBool, const eChar *) = &eDispatchBenchOp::execute;
+    const ePtr thunkFunc = *(ePtr *)&execFunc;
+
+    startTime = getTimeMs();
+
+    for (eU32 i=0; i<CALL_COUNT; i++)
+    {
+        callAsmThunk(&op, thunkFunc, vals);
+    }
+
+    const eF64 thunkTime = getTimeMs()-startTime;
+    printf("asm thunk:      %10.2f ms %8.2f ns/call\n", thunkTime, thunkTime*1000000.0/(eF64)CALL_COUNT);
+#endif
+
+    // Print the sum, so that the calls can't be
+    // optimized away.
+    printf("(checksum %.1f)\n", op.m_sum);
+}
+
+eInt main(eInt argc, eChar **argv)
+{
+    if (argc > 1 && eStrCompare(argv[1], "-voicebench") == 0)
+    {
+        benchmarkVoices();
+        return 0;
+    }
+
+    if (argc > 1 && eStrCompare(argv[1], "-dispatchbench") == 0)
+    {
+        benchmarkDispatch();
+        return 0;
+    }
+
+    if (argc > 1 && eStrCompare(argv[1], "-psysbench") == 0)
+    {
+        benchmarkParticles();
+        return 0;
+    }
+
+    if (argc > 1 && eStrCompare(argv[1], "-meshbench") == 0)
+    {
+        benchmarkMesh();
+        return 0;
+    }
+
+    const eChar *scriptName = eNULL;
+    eU32 listCount = 20;
+    eU32 runs = 1;
+    eID sweepOpId = 0;
+    eU32 sweepParam = 0;
+    const eChar *sweepValues = eNULL;
+    eParamSettingArray settings;
+    eU32 positionals = 0;
+
+    for (eInt i=1; i<argc; i++)
+    {
+        if (eStrCompare(argv[i], "-sweep") == 0 && i+3 < argc)
+        {
+            sweepOpId = eStrToInt(argv[++i]);
+            sweepParam = eStrToInt(argv[++i]);
+            sweepValues = argv[++i];
+        }
+        else if (eStrCompare(argv[i], "-set") == 0 && i+3 < argc)
+        {
+            eParamSetting &ps = settings.push();
+            ps.opId = eStrToInt(argv[++i]);
+            ps.paramIndex = eStrToInt(argv[++i]);
+
+            if (sscanf(argv[++i], "%f", &ps.value) != 1)
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (eStrCompare(argv[i], "-runs") == 0 && i+1 < argc)
+        {
+            runs = eMax(1, eStrToInt(argv[++i]));
+        }
+        else if (eStrCompare(argv[i], "-threads") == 0 && i+1 < argc)
+        {
+            eThreadPool::setGlobalThreadCount(eMax(0, eStrToInt(argv[++i])));
+        }
+        else if (argv[i][0] != '-' && positionals == 0)
+        {
+            scriptName = argv[i];
+            positionals++;
+        }
+        else if (argv[i][0] != '-' && positionals == 1)
+        {
+            listCount = eStrToInt(argv[i]);
+            positionals++;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    eByteArray scriptData;
+    scriptData.resize(sizeof(data));
+    eMemCopy(&scriptData[0], data, sizeof(data));
+
+    if (scriptName && !loadScript(scriptName, scriptData))
+    {
+        printf("couldn't load demo script \"%s\"!\n", scriptName);
+        printUsage();
+        return 1;
+    }
+
+    eMemTrackerStart();
+    eInitGlobalsStatics();
+
+    eEngine engine;
+    engine.openWindow(eFALSE, eSize(800, 600), eNULL);
+
+    eIRenderer *renderer = engine.getRenderer();
+    eASSERT(renderer != eNULL);
+
+    eOpStacking::initialize();
+
+    // Load demo and process the whole stack at once,
+    // like the player does it on start-up.
+    eF64 startTime = getTimeMs();
+    eDemoScript script(&scriptData[0], scriptData.size());
+    eDemoData::load(script);
+    const eF64 loadTime = getTimeMs()-startTime;
+
+    if (!applySettings(settings, eFALSE, sweepOpId))
+    {
+        return 1;
+    }
+
+    eIDemoOp *demoOp = eDemoData::getMainDemoOperator();
+    eASSERT(demoOp != eNULL);
+    demoOp->setProcessAll(eTRUE);
+
+    startTime = getTimeMs();
+    demoOp->process(renderer, 0.0f, progressCallback);
+    const eF64 precalcTime = getTimeMs()-startTime;
+
+    if (sweepValues)
+    {
+        printf("\n\n");
+
+        if (!applySettings(settings, eTRUE, sweepOpId))
+        {
+            return 1;
+        }
+
+        const eBool ok = sweepParameter(renderer, sweepOpId, sweepParam, sweepValues, runs);
+        tfPadSynthCache::get().shutdown();
+        return (ok ? 0 : 1);
+    }
+
+    // Process all operators once more one after the
+    // other, so that the time of each operator can
+    // be measured without parallel interference.
+    eIOperatorPtrArray ops;
+    demoOp->getOpsInStack(ops);
+
+    for (eU32 i=0; i<ops.size(); i++)
+    {
+        ops[i]->setChanged();
+    }
+
+    eOpTimingArray timings;
+    eF64 serialTime = 0.0;
+
+    for (eU32 i=0; i<ops.size(); i++)
+    {
+        eOpTiming t;
+        t.op = ops[i];
+        t.ms = timeOperator(renderer, ops[i], runs);
+
+        serialTime += t.ms;
+        timings.append(t);
+    }
+
+    timings.sort(sortByTime);
+
+    printf("\n\n");
+    printf("loading script:    %10.2f ms\n", loadTime);
+    printf("precalc:           %10.2f ms (%u operators)\n", precalcTime, ops.size());
+    printf("precalc (serial):  %10.2f ms\n\n", serialTime);
+    printf("  op-id    type-id        time      share\n");
+
+    for (eU32 i=0; i<eMin(listCount, timings.size()); i++)
+    {
+        const eOpTiming &t = timings[i];
+
+        printf("%8u %10u %10.2f ms %8.2f %%\n", t.op->getId(), t.op->m_metaOpID, t.ms,
+               (serialTime > 0.0 ? t.ms/serialTime*100.0 : 0.0));
+    }
+
+    tfPadSynthCache::get().shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,391 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "../system/system.hpp"
+#include "../math/math.hpp"
+#include "engine.hpp"
+
+eTriangleBvh::eTriangleBvh() :
+    m_mesh(eNULL),
+    m_generation(0)
+{
+}
+
+// Rebuilds the hierarchy if the mesh changed since
+// the last call. Returns if it was rebuilt.
+eBool eTriangleBvh::update(const eEditMesh &mesh)
+{
+    if (m_mesh == &mesh && m_generation == mesh.getGeneration())
+    {
+        return eFALSE;
+    }
+
+    ePROFILER_ZONE("Build triangle BVH");
+
+    m_mesh = &mesh;
+    m_generation = mesh.getGeneration();
+    m_nodes.clear();
+
+    // Split faces into triangle fans. Degenerated
+    // triangles are skipped, because they can't be
+    // handled by the distance calculation.
+    eArray<Triangle> tris;
+    tris.reserve(mesh.getFaceCount());
+
+    for (eU32 i=0; i<mesh.getFaceCount(); i++)
+    {
+        const eEditMesh::HalfEdge *he0 = mesh.getFace(i)->he;
+        eASSERT(he0 != eNULL);
+
+        for (const eEditMesh::HalfEdge *he=he0->next; he->next!=he0; he=he->next)
+        {
+            Triangle tri;
+
+            tri.base = he0->origin->getPosition();
+            tri.e0 = he->origin->getPosition()-tri.base;
+            tri.e1 = he->next->origin->getPosition()-tri.base;
+            tri.e0DotE0 = tri.e0*tri.e0;
+            tri.e0DotE1 = tri.e0*tri.e1;
+            tri.e1DotE1 = tri.e1*tri.e1;
+            tri.face = i;
+
+            const eF32 det = tri.e0DotE0*tri.e1DotE1-tri.e0DotE1*tri.e0DotE1;
+
+            if (det > 1e-10f*tri.e0DotE0*tri.e1DotE1)
+            {
+                tris.append(tri);
+            }
+        }
+    }
+
+    m_buildTris.resize(tris.size());
+    m_buildIndices.resize(tris.size());
+
+    for (eU32 i=0; i<tris.size(); i++)
+    {
+        const Triangle &tri = tris[i];
+        const eVector3 v1 = tri.base+tri.e0;
+        const eVector3 v2 = tri.base+tri.e1;
+        BuildTriangle &bt = m_buildTris[i];
+
+        bt.min = tri.base;
+        bt.min.minimum(v1);
+        bt.min.minimum(v2);
+        bt.max = tri.base;
+        bt.max.maximum(v1);
+        bt.max.maximum(v2);
+        bt.center = (bt.min+bt.max)*0.5f;
+        m_buildIndices[i] = i;
+    }
+
+    if (tris.size() > 0)
+    {
+        m_nodes.reserve(2*tris.size());
+        m_nodes.resize(1);
+        _build(0, 0, tris.size(), 0);
+    }
+
+    // Store triangles in order of the leaves.
+    m_tris.resize(tris.size());
+
+    for (eU32 i=0; i<tris.size(); i++)
+    {
+        m_tris[i] = tris[m_buildIndices[i]];
+    }
+
+    m_buildTris.free();
+    m_buildIndices.free();
+    return eTRUE;
+}
+
+void eTriangleBvh::clear()
+{
+    m_mesh = eNULL;
+    m_tris.clear();
+    m_nodes.clear();
+}
+
+// Finds the closest point on the triangles to the
+// given position. Children are visited in order of
+// their distance and skipped, if they're farther
+// away than the closest point found so far. If a
+// triangle close to the position is known (e.g. of
+// the last query for a close position), it's given
+// as hint so that most nodes can be skipped.
+eBool eTriangleBvh::findClosest(const eVector3 &pos, Hit &hit, eU32 hint) const
+{
+    hit.sqrDist = eF32_MAX;
+
+    if (isEmpty())
+    {
+        return eFALSE;
+    }
+
+    if (hint < m_tris.size())
+    {
+        _testTriangle(hint, pos, hit);
+    }
+
+    eU32 stack[MAX_DEPTH*2];
+    eF32 stackDists[MAX_DEPTH*2];
+    eU32 stackSize = 1;
+
+    stack[0] = 0;
+    stackDists[0] = 0.0f;
+
+    while (stackSize > 0)
+    {
+        stackSize--;
+
+        if (stackDists[stackSize] >= hit.sqrDist)
+        {
+            continue;
+        }
+
+        const Node &node = m_nodes[stack[stackSize]];
+
+        if (node.count > 0)
+        {
+            for (eU32 i=0; i<node.count; i++)
+            {
+                _testTriangle(node.first+i, pos, hit);
+            }
+        }
+        else
+        {
+            const eF32 dist0 = _sqrDistToNode(m_nodes[node.first], pos);
+            const eF32 dist1 = _sqrDistToNode(m_nodes[node.first+1], pos);
+            const eU32 closer = (dist0 <= dist1 ? 0 : 1);
+            const eF32 closerDist = (closer == 0 ? dist0 : dist1);
+            const eF32 fartherDist = (closer == 0 ? dist1 : dist0);
+
+            // The farther child is pushed first, so
+            // that the closer one is visited first.
+            if (fartherDist < hit.sqrDist)
+            {
+                stack[stackSize] = node.first+1-closer;
+                stackDists[stackSize++] = fartherDist;
+            }
+
+            if (closerDist < hit.sqrDist)
+            {
+                stack[stackSize] = node.first+closer;
+                stackDists[stackSize++] = closerDist;
+            }
+        }
+    }
+
+    return eTRUE;
+}
+
+// Processes independent queries in parallel. The
+// result of each query is used as hint for the
+// next one, so coherent positions are faster.
+void eTriangleBvh::findClosest(const eVector3 *positions, eU32 count, Hit *hits) const
+{
+    ePROFILER_ZONE("Query triangle BVH");
+
+    QueryJob job;
+    job.bvh = this;
+    job.positions = positions;
+    job.count = count;
+    job.hits = hits;
+
+    eThreadPool::get().parallelFor(_queryJob, &job, (count+QUERIES_PER_JOB-1)/QUERIES_PER_JOB);
+}
+
+eBool eTriangleBvh::isEmpty() const
+{
+    return (m_nodes.size() == 0);
+}
+
+eU32 eTriangleBvh::getTriangleCount() const
+{
+    return m_tris.size();
+}
+
+// Splits the triangles of a node at the bin border
+// along the longest axis of the triangle centers,
+// which minimizes the surface area heuristic.
+void eTriangleBvh::_build(eU32 nodeIndex, eU32 first, eU32 count, eU32 depth)
+{
+    eVector3 min(eF32_MAX, eF32_MAX, eF32_MAX), max(eF32_MIN, eF32_MIN, eF32_MIN);
+    eVector3 centerMin = min, centerMax = max;
+
+    for (eU32 i=0; i<count; i++)
+    {
+        const BuildTriangle &bt = m_buildTris[m_buildIndices[first+i]];
+
+        min.minimum(bt.min);
+        max.maximum(bt.max);
+        centerMin.minimum(bt.center);
+        centerMax.maximum(bt.center);
+    }
+
+    m_nodes[nodeIndex].min = min;
+    m_nodes[nodeIndex].max = max;
+    m_nodes[nodeIndex].first = first;
+    m_nodes[nodeIndex].count = count;
+
+    const eVector3 extent = centerMax-centerMin;
+    const eU32 axis = (extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2));
+
+    if (count <= MAX_LEAF_SIZE || depth+1 >= MAX_DEPTH || extent[axis] <= 0.0f)
+    {
+        return;
+    }
+
+    // Sort triangles into bins.
+    eVector3 binMin[BIN_COUNT], binMax[BIN_COUNT];
+    eU32 binCounts[BIN_COUNT];
+
+    for (eU32 i=0; i<BIN_COUNT; i++)
+    {
+        binMin[i].set(eF32_MAX, eF32_MAX, eF32_MAX);
+        binMax[i].set(eF32_MIN, eF32_MIN, eF32_MIN);
+        binCounts[i] = 0;
+    }
+
+    const eF32 binScale = (eF32)BIN_COUNT/extent[axis];
+
+    for (eU32 i=0; i<count; i++)
+    {
+        const BuildTriangle &bt = m_buildTris[m_buildIndices[first+i]];
+        const eU32 bin = eMin((eU32)((bt.center[axis]-centerMin[axis])*binScale), BIN_COUNT-1);
+
+        binMin[bin].minimum(bt.min);
+        binMax[bin].maximum(bt.max);
+        binCounts[bin]++;
+    }
+
+    // Sweep from right to left to get the costs of
+    // the right sides, then from left to right.
+    eF32 rightCosts[BIN_COUNT];
+    eVector3 sideMin = binMin[BIN_COUNT-1], sideMax = binMax[BIN_COUNT-1];
+    eU32 sideCount = binCounts[BIN_COUNT-1];
+
+    for (eInt i=BIN_COUNT-2; i>=0; i--)
+    {
+        rightCosts[i] = (sideCount > 0 ? (eF32)sideCount*_getArea(sideMin, sideMax) : 0.0f);
+        sideMin.minimum(binMin[i]);
+        sideMax.maximum(binMax[i]);
+        sideCount += binCounts[i];
+    }
+
+    eU32 bestSplit = 0;
+    eF32 bestCost = eF32_MAX;
+
+    sideMin.set(eF32_MAX, eF32_MAX, eF32_MAX);
+    sideMax.set(eF32_MIN, eF32_MIN, eF32_MIN);
+    sideCount = 0;
+
+    for (eU32 i=0; i<BIN_COUNT-1; i++)
+    {
+        sideMin.minimum(binMin[i]);
+        sideMax.maximum(binMax[i]);
+        sideCount += binCounts[i];
+
+        const eF32 cost = (sideCount > 0 ? (eF32)sideCount*_getArea(sideMin, sideMax) : 0.0f)+rightCosts[i];
+
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestSplit = i;
+        }
+    }
+
+    // Partition triangles into left and right side.
+    eU32 left = first;
+    eU32 right = first+count;
+
+    while (left < right)
+    {
+        const BuildTriangle &bt = m_buildTris[m_buildIndices[left]];
+        const eU32 bin = eMin((eU32)((bt.center[axis]-centerMin[axis])*binScale), BIN_COUNT-1);
+
+        if (bin <= bestSplit)
+        {
+            left++;
+        }
+        else
+        {
+            eSwap(m_buildIndices[left], m_buildIndices[--right]);
+        }
+    }
+
+    const eU32 leftCount = left-first;
+
+    if (leftCount == 0 || leftCount == count)
+    {
+        return;
+    }
+
+    const eU32 childIndex = m_nodes.size();
+    m_nodes.resize(childIndex+2);
+    m_nodes[nodeIndex].first = childIndex;
+    m_nodes[nodeIndex].count = 0;
+
+    _build(childIndex, first, leftCount, depth+1);
+    _build(childIndex+1, first+leftCount, count-leftCount, depth+1);
+}
+
+void eTriangleBvh::_testTriangle(eU32 index, const eVector3 &pos, Hit &hit) const
+{
+    const Triangle &tri = m_tris[index];
+    eVector3 p = pos;
+    const eVector3 res = p.distanceToTriangleOptimized(tri.base, tri.e0, tri.e1, tri.e0DotE0, tri.e0DotE1, tri.e1DotE1);
+
+    if (res.x < hit.sqrDist)
+    {
+        hit.sqrDist = res.x;
+        hit.position = tri.base+tri.e0*res.y+tri.e1*res.z;
+        hit.triangle = index;
+        hit.face = tri.face;
+    }
+}
+
+eF32 eTriangleBvh::_sqrDistToNode(const Node &node, const eVector3 &pos)
+{
+    eF32 sqrDist = 0.0f;
+
+    for (eU32 i=0; i<3; i++)
+    {
+        const eF32 d = eMax(eMax(node.min[i]-pos[i], pos[i]-node.max[i]), 0.0f);
+        sqrDist += d*d;
+    }
+
+    return sqrDist;
+}
+
+// Returns half of the surface area of the box.
+eF32 eTriangleBvh::_getArea(const eVector3 &min, const eVector3 &max)
+{
+    const eVector3 size = max-min;
+    return size.x*size.y+size.y*size.z+size.z*size.x;
+}
+
+void eTriangleBvh::_queryJob(ePtr arg, eU32 index)
+{
+    const QueryJob &job = *(const QueryJob *)arg;
+    const eU32 first = index*QUERIES_PER_JOB;
+    const eU32 last = eMin(first+QUERIES_PER_JOB, job.count);
+    eU32 hint = NO_HINT;
+
+    for (eU32 i=first; i<last; i++)
+    {
+        if (job.bvh->findClosest(job.positions[i], job.hits[i], hint))
+        {
+            hint = job.hits[i].triangle;
+        }
+    }
+}
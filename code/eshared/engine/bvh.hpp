@@ -0,0 +1,111 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef BVH_HPP
+#define BVH_HPP
+
+// Bounding volume hierarchy over the triangles of
+// an edit mesh (polygons are split into fans) for
+// closest point queries. It's built using binned
+// surface area heuristic and only rebuilt, when
+// the mesh (its generation) changes.
+class eTriangleBvh
+{
+public:
+    struct Hit
+    {
+        eVector3            position;
+        eF32                sqrDist;
+        eU32                triangle;   // Can be used as hint for next query.
+        eU32                face;       // Face of the edit mesh.
+    };
+
+public:
+    eTriangleBvh();
+
+    eBool                   update(const eEditMesh &mesh);
+    void                    clear();
+
+    eBool                   findClosest(const eVector3 &pos, Hit &hit, eU32 hint=NO_HINT) const;
+    void                    findClosest(const eVector3 *positions, eU32 count, Hit *hits) const;
+
+    eBool                   isEmpty() const;
+    eU32                    getTriangleCount() const;
+
+public:
+    static const eU32       NO_HINT = 0xffffffff;
+
+private:
+    // Triangle given by base, base+e0 and base+e1,
+    // with the dot products of the edges needed by
+    // eVector3::distanceToTriangleOptimized().
+    struct Triangle
+    {
+        eVector3            base;
+        eVector3            e0;
+        eVector3            e1;
+        eF32                e0DotE0;
+        eF32                e0DotE1;
+        eF32                e1DotE1;
+        eU32                face;
+    };
+
+    // Inner nodes have no triangles, their children
+    // are stored at first and first+1.
+    struct Node
+    {
+        eVector3            min;
+        eVector3            max;
+        eU32                first;
+        eU32                count;
+    };
+
+    struct BuildTriangle
+    {
+        eVector3            min;
+        eVector3            max;
+        eVector3            center;
+    };
+
+    struct QueryJob
+    {
+        const eTriangleBvh *bvh;
+        const eVector3 *    positions;
+        eU32                count;
+        Hit *               hits;
+    };
+
+private:
+    void                    _build(eU32 nodeIndex, eU32 first, eU32 count, eU32 depth);
+    void                    _testTriangle(eU32 index, const eVector3 &pos, Hit &hit) const;
+
+    static eF32             _sqrDistToNode(const Node &node, const eVector3 &pos);
+    static eF32             _getArea(const eVector3 &min, const eVector3 &max);
+    static void             _queryJob(ePtr arg, eU32 index);
+
+private:
+    static const eU32       BIN_COUNT = 16;
+    static const eU32       MAX_LEAF_SIZE = 4;
+    static const eU32       MAX_DEPTH = 64;
+    static const eU32       QUERIES_PER_JOB = 256;
+
+private:
+    const eEditMesh *       m_mesh;
+    eU32                    m_generation;
+    eArray<Triangle>        m_tris;
+    eArray<Node>            m_nodes;
+    eArray<BuildTriangle>   m_buildTris;    // Only used while building.
+    eArray<eU32>            m_buildIndices;
+};
+
+#endif // BVH_HPP
@@ -11,6 +11,8 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifndef eNULL_GFX
+
 #include <d3d9.h>
 
 #include "../../eshared.hpp"
@@ -254,4 +256,6 @@ eU32 eVertexBufferDx9::getByteSize() const
 eBool eVertexBufferDx9::isDynamic() const
 {
     return m_dynamic;
-}
\ No newline at end of file
+}
+
+#endif // eNULL_GFX
\ No newline at end of file
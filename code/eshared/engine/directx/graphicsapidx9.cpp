@@ -11,12 +11,18 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifndef eNULL_GFX
 #define D3D_DEBUG_INFO
 #include <d3d9.h>
 #include <d3dx9.h>
+#endif
 
 #include "../../eshared.hpp"
 
+// Everything device dependent is replaced by the
+// null implementation if eNULL_GFX is defined.
+#ifndef eNULL_GFX
+
 #include "texturesdx9.hpp"
 #include "buffersdx9.hpp"
 #include "shadersdx9.hpp"
@@ -1301,6 +1307,8 @@ void eGraphicsApiDx9::_releaseQueries()
     }
 }
 
+#endif // eNULL_GFX
+
 
 
 
@@ -1457,7 +1465,8 @@ void eGraphicsApiDx9::setPsConst(eU32 offset, const eMatrix4x4 &m)
 
 void eGraphicsApiDx9::setPsConst(eU32 offset, const eColor &v)
 {
-    setPsConst(offset, 1, v);
+    const eFloatColor fc = v.toFloatColor();
+    setPsConst(offset, 1, &fc.r);
 }
 
 void eGraphicsApiDx9::setPsConst(eU32 offset, const eVector4 &v)
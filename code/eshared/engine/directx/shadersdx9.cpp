@@ -11,6 +11,8 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifndef eNULL_GFX
+
 #include <d3d9.h>
 #include <d3dx9.h>
 
@@ -223,4 +225,6 @@ eBool eVertexShaderDx9::unload()
 {
     // Nothing todo for shaders.
     return eTRUE;
-}
\ No newline at end of file
+}
+
+#endif // eNULL_GFX
\ No newline at end of file
@@ -11,6 +11,8 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifndef eNULL_GFX
+
 #include <d3d9.h>
 #include <d3dx9.h>
 
@@ -559,4 +561,6 @@ eBool eTextureCubeDx9::unlock()
 
     m_locked = eFALSE;
     return eTRUE;
-}
\ No newline at end of file
+}
+
+#endif // eNULL_GFX
\ No newline at end of file
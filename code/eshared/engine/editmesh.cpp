@@ -11,51 +11,17 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <gl/glu.h>
+#else
+#include <GL/glu.h>
+#endif
 
 #include "../system/system.hpp"
 #include "../math/math.hpp"
 #include "engine.hpp"
-/*
-#define ALLOCATE_OPT(type, target, preallocList)			type* target = new type
-#define DEALLOCATE_OPT(target)								eSAFE_DELETE(target)
-/**/
-
-// optimized allocation
-#define ALLOCATE_OPT(type, target, preallocList)			\
-	type* target = eNULL;									\
-	if(preallocList.size() < preallocList.capacity()) {		\
-		preallocList.resize(preallocList.size() + 1);		\
-		target = &preallocList[preallocList.size() - 1];	\
-		target->isPreallocated = true;						\
-	} else {												\
-		target = new type;									\
-		target->isPreallocated = false;						\
-	}														
-
-// optimized allocation, assumes that target is type**
-#define ALLOCATE_OPT_MULTIPLE(type, target, preallocList, count)		\
-	if(preallocList.size() + count <= preallocList.capacity()) {		\
-		preallocList.resize(preallocList.size() + count);				\
-		for(int _i = 0; _i < count; _i++) {								\
-			target[_i] = &preallocList[preallocList.size() - count + _i];\
-			target[_i]->isPreallocated = true;							\
-		}																\
-	} else {															\
-		for(int _i = 0; _i < count; _i++) {								\
-			target[_i] = new type;										\
-			target[_i]->isPreallocated = false;							\
-		}																\
-	}														
-
-#define DEALLOCATE_OPT(target)			\
-{										\
-	if((target != eNULL) && (!(target)->isPreallocated))		\
-	    eSAFE_DELETE(target);			\
-}
-/**/
 // Implementation of triangulator.
 
 eTriangulator::eTriangulator() : m_totalVtxCount(0)
@@ -194,28 +160,6 @@ eBool eEditMesh::Vertex::isFree() const
     return eFALSE;
 }
 
-void				
-eEditMesh::Vertex::lerp(const Vertex& v0, const Vertex& v1, eF32 t) {
-	this->position = v0.position.lerp(t, v1.position);
-	this->normal = v0.normal.lerp(t, v1.normal);
-	this->texCoord = v0.texCoord.lerp(v1.texCoord, t);
-}
-
-void				
-eEditMesh::Vertex::add(const eEditMesh::Vertex& other) {
-	this->position += other.position;
-	this->normal += other.normal;
-	this->texCoord += other.texCoord;
-}
-
-void				
-eEditMesh::Vertex::mul(eF32 val) {
-	this->position *= val;
-	this->normal *= val;
-	this->texCoord *= val;
-}
-
-
 eBool eEditMesh::Vertex::isBoundary() const
 {
     if (he == eNULL)
@@ -248,9 +192,9 @@ void eEditMesh::Face::updateNormal()
 {
     eASSERT(he != eNULL);
 
-    const eVector3 &pos0 = he->prev->origin->position;
-    const eVector3 &pos1 = he->origin->position;
-    const eVector3 &pos2 = he->next->origin->position;
+    const eVector3 &pos0 = he->prev->origin->getPosition();
+    const eVector3 &pos1 = he->origin->getPosition();
+    const eVector3 &pos2 = he->next->origin->getPosition();
 
     normal = (pos2-pos1)^(pos0-pos1);
     normal.normalize();
@@ -282,12 +226,12 @@ eBool eEditMesh::Face::isBoundary() const
 // Returns area of polygon using Gaussian trapezoid formula.
 eF32 eEditMesh::Face::getArea() const
 {
-	const eVector3& pos0 = he->origin->position;
+	const eVector3& pos0 = he->origin->getPosition();
 	const eEditMesh::HalfEdge* he1 = he->next;
 	const eEditMesh::HalfEdge* he2 = he1->next;
 	eF32 area = 0.0f;
 	do {
-		area += 0.5f * ((he1->origin->position - pos0)^(he2->origin->position - pos0)).length();
+		area += 0.5f * ((he1->origin->getPosition() - pos0)^(he2->origin->getPosition() - pos0)).length();
 		he1 = he2;
 		he2 = he2->next;
 	} while(he2 != he);
@@ -297,47 +241,60 @@ eF32 eEditMesh::Face::getArea() const
 void
 eEditMesh::Face::getRandomSurfacePoint(eVector3 &resultPos, eVector3 &resultNormal) const {
 	// assuming dumb equally sized triangulation, pick a random triangle
-	int triNr = eRandom(0, this->getEdgeCount() - 2);
+	const eU32 triNr = eRandom(0, this->getEdgeCount() - 2);
+	const eF32 w0 = eRandomF();
+	const eF32 w1 = eRandomF();
+	getSurfacePoint(triNr, w0, w1, resultPos, resultNormal);
+}
+
+// Same as above, but uses the given random seed
+// instead of the global one (thread safe).
+void
+eEditMesh::Face::getRandomSurfacePoint(eVector3 &resultPos, eVector3 &resultNormal, eU32 &seed) const {
+	const eU32 triNr = eRandom(0, this->getEdgeCount() - 2, seed);
+	const eF32 w0 = eRandomF(seed);
+	const eF32 w1 = eRandomF(seed);
+	getSurfacePoint(triNr, w0, w1, resultPos, resultNormal);
+}
+
+// Returns the point with the barycentric coordinates
+// w0 and w1 on the given triangle of the triangle fan
+// spanned by the face.
+void
+eEditMesh::Face::getSurfacePoint(eU32 triNr, eF32 w0, eF32 w1, eVector3 &resultPos, eVector3 &resultNormal) const {
 	const eEditMesh::Vertex& v0 = *this->he->origin;
 	const eEditMesh::Vertex& v1 = *this->getVertex(triNr + 1);
 	const eEditMesh::Vertex& v2 = *this->getVertex(triNr + 2);
 
-	eF32 w0 = eRandomF();
-    eF32 w1 = eRandomF();
     if (w0+w1 > 1.0f) {
         w0 = 1.0f - w0;
         w1 = 1.0f - w1;
     }
     eF32 w2 = 1.0f - w0 - w1;
 
-	resultPos = (v0.position * w0) + (v1.position * w1) + (v2.position * w2);
-    resultNormal = ((v0.normal * w0) + (v1.normal * w1) + (v2.normal * w2));
+	resultPos = (v0.getPosition() * w0) + (v1.getPosition() * w1) + (v2.getPosition() * w2);
+    resultNormal = ((v0.getNormal() * w0) + (v1.getNormal() * w1) + (v2.getNormal() * w2));
 }
 
 
-eEditMesh::Vertex eEditMesh::Face::getCenter() const
+eVector3 eEditMesh::Face::getCenter() const
 {
     HalfEdge *curHe = he;
     eASSERT(curHe != eNULL);
 
     eU32 edgeCount = 0;
-    Vertex center;
-	center.position = eVector3(0);
-	center.normal = eVector3(0);
-	center.texCoord = eVector2(0);
+    eVector3 center;
 
     do
     {
-		center.add(*curHe->origin);
+		center += curHe->origin->getPosition();
         edgeCount++;
         curHe = curHe->next;
     }
     while (curHe != he);
 
     eASSERT(edgeCount >= 3);
-	center.mul(1.0f / (eF32)edgeCount);
-
-    return center;
+    return center/(eF32)edgeCount;
 }
 
 eU32 eEditMesh::Face::getEdgeCount() const
@@ -388,15 +345,19 @@ eEditMesh::Vertex * eEditMesh::HalfEdge::destination() const
 
 // Implementation of edit mesh.
 
+volatile eInt eEditMesh::m_generationCounter = 0;
+
 eEditMesh::eEditMesh(eU32 vertexCount, eU32 faceCount) :
     m_triangulated(eTRUE)
 {
+    setChanged();
     reserveSpace(vertexCount, faceCount);
 }
 
 eEditMesh::eEditMesh(const eEditMesh &em) :
     m_triangulated(eTRUE)
 {
+    setChanged();
     merge(em);
 }
 
@@ -412,8 +373,17 @@ eEditMesh::~eEditMesh()
 void eEditMesh::reserveSpace(eU32 vertexCount, eU32 faceCount)
 {
     m_vertices.reserve(vertexCount);
+    m_positions.reserve(vertexCount);
+    m_normals.reserve(vertexCount);
+    m_texCoords.reserve(vertexCount);
+    m_colors.reserve(vertexCount);
     m_edges.reserve(4*faceCount);
     m_faces.reserve(faceCount);
+
+    m_vertexPool.reserve(vertexCount);
+    m_edgePool.reserve(4*faceCount);
+    m_halfEdgePool.reserve(8*faceCount);
+    m_facePool.reserve(faceCount);
 }
 
 void eEditMesh::merge(eEditMesh &em)
@@ -422,19 +392,10 @@ void eEditMesh::merge(eEditMesh &em)
 
     reserveSpace(m_vertices.size()+em.getVertexCount(), m_faces.size()+em.getFaceCount());
 
-    // Add vertices of new mesh.
-    for (eU32 i=0; i<em.getVertexCount(); i++)
-    {
-        Vertex *vtx = em.getVertex(i);
-        eASSERT(vtx != eNULL);
-
-        Vertex *newVtx = addVertex(vtx->position, vtx->texCoord, vtx->normal);
-        eASSERT(vtx != eNULL);
-        newVtx->selected = vtx->selected;
-        newVtx->color = vtx->color;
-        newVtx->tag = vtx->tag;
-		vtx->_volatile_attribute0 = newVtx;
-    }
+    // Add vertices of new mesh. The new vertices
+    // of this mesh start at the first index.
+    const eU32 firstVtx = m_vertices.size();
+    _mergeVertices(em);
 
     // Add faces of new mesh.
     VertexPtrArray vtxLoop;
@@ -451,9 +412,9 @@ void eEditMesh::merge(eEditMesh &em)
 
         Face *newFace = eNULL;
 		if(em.isTriangulated()) {
-			Vertex* v3[] = { (eEditMesh::Vertex*)he->origin->_volatile_attribute0,
-				             (eEditMesh::Vertex*)he->next->origin->_volatile_attribute0,
-						     (eEditMesh::Vertex*)he->next->next->origin->_volatile_attribute0};
+			Vertex* v3[] = { m_vertices[firstVtx+he->origin->index],
+				             m_vertices[firstVtx+he->next->origin->index],
+						     m_vertices[firstVtx+he->next->next->origin->index]};
 			eVector2	tex3[] = {he->texCoord, he->next->texCoord, he->next->next->texCoord};
 			newFace = addTriangleFast(&v3[0], &tex3[0]);
 		} else {
@@ -462,7 +423,7 @@ void eEditMesh::merge(eEditMesh &em)
 
 			do
 			{
-				vtxLoop.append((eEditMesh::Vertex*)he->origin->_volatile_attribute0);
+				vtxLoop.append(m_vertices[firstVtx+he->origin->index]);
 				texCoords.append(he->texCoord);
 
 				he = he->next;
@@ -499,20 +460,8 @@ void eEditMesh::merge(const eEditMesh &em)
     reserveSpace(m_vertices.size()+em.getVertexCount(), m_faces.size()+em.getFaceCount());
 
     // Add vertices of new mesh.
-
-    for (eU32 i=0; i<em.getVertexCount(); i++)
-    {
-        const Vertex *vtx = em.getVertex(i);
-        eASSERT(vtx != eNULL);
-
-        Vertex *newVtx = addVertex(vtx->position, vtx->texCoord, vtx->normal);
-        eASSERT(vtx != eNULL);
-        newVtx->selected = vtx->selected;
-        newVtx->color = vtx->color;
-        newVtx->tag = vtx->tag;
-		// we need to break const here
-        ((Vertex*)vtx)->_volatile_attribute0 = newVtx;
-    }
+    const eU32 firstVtx = m_vertices.size();
+    _mergeVertices(em);
 
     // Add faces of new mesh.
     VertexPtrArray vtxLoop;
@@ -531,7 +480,7 @@ void eEditMesh::merge(const eEditMesh &em)
 
         do
         {
-            vtxLoop.append((Vertex*)he->origin->_volatile_attribute0);
+            vtxLoop.append(m_vertices[firstVtx+he->origin->index]);
             texCoords.append(he->texCoord);
 
             he = he->next;
@@ -560,44 +509,76 @@ void eEditMesh::merge(const eEditMesh &em)
     }
 }
 
-void eEditMesh::clear()
+// Appends the vertices of the given mesh. Their
+// attributes are copied stream by stream.
+void eEditMesh::_mergeVertices(const eEditMesh &em)
 {
-    for (eU32 i=0; i<m_faces.size(); i++)
-        DEALLOCATE_OPT(m_faces[i]);
+    const eU32 firstVtx = m_vertices.size();
+    const eU32 count = em.getVertexCount();
 
-    for (eU32 i=0; i<m_edges.size(); i++)
+    _appendStream(m_positions, em.m_positions);
+    _appendStream(m_normals, em.m_normals);
+    _appendStream(m_texCoords, em.m_texCoords);
+    _appendStream(m_colors, em.m_colors);
+
+    for (eU32 i=0; i<count; i++)
     {
-        Edge *edge = m_edges[i];
-        eASSERT(edge != eNULL);
+        const Vertex *vtx = em.getVertex(i);
+        eASSERT(vtx != eNULL);
 
-        DEALLOCATE_OPT(edge->he0);
-        DEALLOCATE_OPT(edge->he1);
-        DEALLOCATE_OPT(edge);
+        Vertex *newVtx = _allocVertex();
+        newVtx->selected = vtx->selected;
+        newVtx->tag = vtx->tag;
+        m_bbox.updateExtent(m_positions[firstVtx+i]);
     }
+}
 
-    for (eU32 i=0; i<m_vertices.size(); i++)
-	    DEALLOCATE_OPT(m_vertices[i]);
+template<class T> void eEditMesh::_appendStream(eArray<T> &stream, const eArray<T> &src)
+{
+    const eU32 first = stream.size();
+
+    if (first+src.size() > stream.capacity())
+    {
+        stream.reserve(eMax(stream.capacity()*2, first+src.size()));
+    }
+
+    stream.resize(first+src.size());
+
+    if (src.size() > 0)
+    {
+        eMemCopy(&stream[first], &src[0], src.size()*sizeof(T));
+    }
+}
+
+void eEditMesh::clear()
+{
+    m_vertexPool.reset();
+    m_halfEdgePool.reset();
+    m_edgePool.reset();
+    m_facePool.reset();
 
     m_bbox.clear();
 
     m_faces.clear();
     m_edges.clear();
     m_vertices.clear();
+    m_positions.clear();
+    m_normals.clear();
+    m_texCoords.clear();
+    m_colors.clear();
 
     m_triangulated = eTRUE;
+    setChanged();
 }
 
-void                    
-eEditMesh::clearAndPreallocate(eU32 numVertices, eU32 numFaces, eU32 numEdges) {
-	this->clear();
-	this->m_preallocatedVertices.reserve(numVertices);
-	this->m_preallocatedVertices.resize(0);
-	this->m_preallocatedFaces.reserve(numFaces);
-	this->m_preallocatedFaces.resize(0);
-	this->m_preallocatedEdges.reserve(numEdges);
-	this->m_preallocatedEdges.resize(0);
-	this->m_preallocatedHalfEdges.reserve(numEdges * 2);
-	this->m_preallocatedHalfEdges.resize(0);
+void eEditMesh::clearAndPreallocate(eU32 numVertices, eU32 numFaces, eU32 numEdges)
+{
+    clear();
+
+    m_vertexPool.reserve(numVertices);
+    m_facePool.reserve(numFaces);
+    m_edgePool.reserve(numEdges);
+    m_halfEdgePool.reserve(numEdges*2);
 }
 
 // Be careful with faces with more than four vertices.
@@ -684,6 +665,7 @@ eBool eEditMesh::triangulate()
                 f->tag = face->tag;
 
                 m_faces[i] = f;
+                f->index = i;
                 m_faces.removeAt(m_faces.size()-1);
 
                 // Add second triangle.
@@ -694,7 +676,7 @@ eBool eEditMesh::triangulate()
                 f->tag = face->tag;
 
                 // Free memory of old quad face.
-                DEALLOCATE_OPT(face);
+                m_facePool.release(face);
                 break;
             }
 
@@ -714,17 +696,13 @@ eBool eEditMesh::triangulate()
     return eTRUE;
 }
 
-void eEditMesh::optimizeIndices()
-{
-}
-
 void eEditMesh::updateBoundingBox()
 {
     m_bbox.clear();
 
-    for (eU32 i=0; i<m_vertices.size(); i++)
+    for (eU32 i=0; i<m_positions.size(); i++)
     {
-        m_bbox.updateExtent(m_vertices[i]->position);
+        m_bbox.updateExtent(m_positions[i]);
     }
 }
 
@@ -740,28 +718,28 @@ void eEditMesh::updateOutlineNormals()
             eEditMesh::HalfEdge* he = startHE;
             do {
                 if(he->isBoundary()) {
-                    eVector3 conorm = (he->twin->face->normal^(he->destination()->position - he->origin->position)).normalized();
+                    eVector3 conorm = (he->twin->face->normal^(he->destination()->getPosition() - he->origin->getPosition())).normalized();
                     sum += conorm;
                     cnt++;
                 }
                 if(he->twin->isBoundary()) {
-                    eVector3 conorm = ((he->destination()->position - he->origin->position)^he->face->normal).normalized();
+                    eVector3 conorm = ((he->destination()->getPosition() - he->origin->getPosition())^he->face->normal).normalized();
                     sum += conorm;
                     cnt++;
                 }
                 he = he->twin->next;
             } while(he != startHE);
             if(cnt != 0) {
-                m_vertices[i]->normal = sum * (1.0f / (eF32)cnt);
+                m_normals[i] = sum * (1.0f / (eF32)cnt);
             }
         }
 }
 
 void eEditMesh::updateNormals()
 {
-    for (eU32 i=0; i<m_vertices.size(); i++)
+    for (eU32 i=0; i<m_normals.size(); i++)
     {
-        m_vertices[i]->normal.null();
+        m_normals[i].null();
     }
 
     for (eU32 i=0; i<m_faces.size(); i++)
@@ -775,15 +753,15 @@ void eEditMesh::updateNormals()
 
         do
         {
-            he->origin->normal += face->normal;
+            m_normals[he->origin->index] += face->normal;
             he = he->next;
         }
         while (he != face->he);
     }
 
-    for (eU32 i=0; i<m_vertices.size(); i++)
+    for (eU32 i=0; i<m_normals.size(); i++)
     {
-        m_vertices[i]->normal.normalize();
+        m_normals[i].normalize();
     }
 }
 
@@ -797,11 +775,6 @@ void eEditMesh::setMaterial(const eMaterial *mat)
     }
 }
 
-eEditMesh::Vertex * eEditMesh::addVertex(const Vertex& vertex)
-{
-	return addVertex(vertex.position, vertex.texCoord, vertex.normal);
-}
-
 eEditMesh::Vertex * eEditMesh::addVertex(const eVector3 &pos)
 {
 	return addVertex(pos, eVector2());
@@ -814,20 +787,32 @@ eEditMesh::Vertex * eEditMesh::addVertex(const eVector3 &pos, const eVector2 &te
 
 eEditMesh::Vertex * eEditMesh::addVertex(const eVector3 &pos, const eVector2 &texCoord, const eVector3 &normal)
 {
-	ALLOCATE_OPT(Vertex, vtx, this->m_preallocatedVertices);
+	Vertex *vtx = _allocVertex();
+
+    m_positions.append(pos);
+    m_normals.append(normal);
+    m_texCoords.append(texCoord);
+    m_colors.append(eColor::WHITE);
+    m_bbox.updateExtent(pos);
+
+    return vtx;
+}
+
+// Allocates a vertex and appends it to the vertex
+// list. Its attributes have to be appended to the
+// streams by the caller.
+eEditMesh::Vertex * eEditMesh::_allocVertex()
+{
+	Vertex *vtx = m_vertexPool.alloc();
     eASSERT(vtx != eNULL);
 
-	vtx->position = pos;
-    vtx->texCoord = texCoord;
-    vtx->normal = normal;
     vtx->he = eNULL;
+    vtx->mesh = this;
     vtx->selected = eFALSE;
-    vtx->color = eColor::WHITE;
     vtx->tag = 0;
+    vtx->index = m_vertices.size();
 
-    m_bbox.updateExtent(pos);
     m_vertices.append(vtx);
-
     return vtx;
 }
 
@@ -835,12 +820,14 @@ void
 eEditMesh::setSize(eU32 vertexCount, eU32 faceCount) {
 	this->reserveSpace(vertexCount, faceCount);
 	this->m_faces.resize(faceCount);
-	this->m_vertices.resize(vertexCount);
+	this->m_vertices.clear();
 	// initialize vertices
-	for(eU32 i = 0; i < vertexCount; i++) {
-		ALLOCATE_OPT(Vertex, vtx, this->m_preallocatedVertices);
-		m_vertices[i] = vtx;
-	}
+	for(eU32 i = 0; i < vertexCount; i++)
+		_allocVertex();
+	m_positions.resize(vertexCount);
+	m_normals.resize(vertexCount);
+	m_texCoords.resize(vertexCount);
+	m_colors.resize(vertexCount);
 }
 
 eEditMesh::HalfEdge * eEditMesh::_findHalfEdge(const Vertex *fromVtx, const Vertex *toVtx)
@@ -863,34 +850,29 @@ eEditMesh::HalfEdge * eEditMesh::_findHalfEdge(const Vertex *fromVtx, const Vert
 
 eEditMesh::Face * eEditMesh::addTriangleFast(Vertex** vertices, const eVector2 *texCoords)
 {
-	ALLOCATE_OPT(Face, newFace, this->m_preallocatedFaces);
+	Face *newFace = m_facePool.alloc();
 	eASSERT(newFace != eNULL);
 
 	Edge *nedges[3];
 	HalfEdge *nhalfEdges[6];
 
-	ALLOCATE_OPT_MULTIPLE(Edge, nedges, this->m_preallocatedEdges, 3);
-	ALLOCATE_OPT_MULTIPLE(HalfEdge, nhalfEdges, this->m_preallocatedHalfEdges, 6);
+	for (eU32 i=0; i<3; i++)
+	{
+		nedges[i] = _allocEdge();
+		nhalfEdges[i] = nedges[i]->he0;
+		nhalfEdges[i+3] = nedges[i]->he1;
+	}
 
 	// Create half-edges that are not yet existing.
 	for (eU32 i=0; i<3; i++)
     {
 		const eU32 nextIdx = (i + 1) % 3;
 
-		Edge *edge = nedges[i];
-		m_edges.append(edge);
-
 		HalfEdge* newHe = nhalfEdges[i];
 		HalfEdge* newHe2 = nhalfEdges[i + 3];
 
-		// Initialize edge and half-edges.
-		edge->he0 = newHe;
-		edge->he1 = newHe2;
-		edge->selected = eFALSE;
-		edge->tag = 0;
-
 		newHe->origin = vertices[i];
-		newHe->edge = edge;
+		newHe->edge = nedges[i];
 		newHe->face = newFace;
         newHe->texCoord = texCoords[i];
 		newHe->next = nhalfEdges[nextIdx];
@@ -902,7 +884,7 @@ eEditMesh::Face * eEditMesh::addTriangleFast(Vertex** vertices, const eVector2 *
 
 		newHe2->twin = newHe;
 		newHe2->face = eNULL;
-		newHe2->edge = edge;
+		newHe2->edge = nedges[i];
 		newHe2->origin = vertices[nextIdx];
 
     }
@@ -910,6 +892,7 @@ eEditMesh::Face * eEditMesh::addTriangleFast(Vertex** vertices, const eVector2 *
     newFace->selected = eFALSE;
     newFace->material = eMaterial::getDefault();
     newFace->tag = 0;
+    newFace->index = m_faces.size();
 
     m_faces.append(newFace);
     return newFace;
@@ -933,6 +916,9 @@ eEditMesh::Face * eEditMesh::addFace(Vertex **vertices, const eVector2 *texCoord
     }
 
     // Find the existing half-edges. Check that they are free.
+    HalfEdgePtrArray &hes = m_faceHalfEdges;
+    hes.resize(vertexCount);
+
     for (eU32 i=0; i<vertexCount; i++)
     {
         HalfEdge *he = _findHalfEdge(vertices[i], vertices[(i+1)%vertexCount]);
@@ -942,7 +928,7 @@ eEditMesh::Face * eEditMesh::addFace(Vertex **vertices, const eVector2 *texCoord
             eASSERT(he->isFree() == eTRUE);
         }
 
-		vertices[i]->_volatile_attribute0 = he;
+        hes[i] = he;
     }
 
     // Create half-edges that are not yet existing.
@@ -950,7 +936,7 @@ eEditMesh::Face * eEditMesh::addFace(Vertex **vertices, const eVector2 *texCoord
     {
         const eU32 nextIndex = (i+1)%vertexCount;
 
-		if (vertices[i]->_volatile_attribute0 == eNULL)
+        if (hes[i] == eNULL)
         {
             Edge *newEdge = _addEdge(vertices[i], vertices[nextIndex]);
             eASSERT(newEdge != eNULL);
@@ -964,21 +950,21 @@ eEditMesh::Face * eEditMesh::addFace(Vertex **vertices, const eVector2 *texCoord
                 eASSERT(newHe->origin == vertices[i]);
             }
 
-            vertices[i]->_volatile_attribute0 = newHe;
+            hes[i] = newHe;
         }
 
         // Copy texture coordinates.
-		HalfEdge* curHe = ((HalfEdge*)vertices[i]->_volatile_attribute0);
+        HalfEdge *curHe = hes[i];
         eASSERT(curHe->origin == vertices[i]);
-        curHe->texCoord = (texCoords ? texCoords[i] : curHe->origin->texCoord);
+        curHe->texCoord = (texCoords ? texCoords[i] : curHe->origin->getTexCoord());
     }
 
     // Check that the half-edges are free and form a chain.
     for (eU32 i=0; i<vertexCount; i++)
     {
         const eU32 ip1 = (i+1)%vertexCount;
-		const HalfEdge* curHe = ((HalfEdge*)vertices[i]->_volatile_attribute0);
-		const HalfEdge* ip1He = ((HalfEdge*)vertices[ip1]->_volatile_attribute0);
+        const HalfEdge *curHe = hes[i];
+        const HalfEdge *ip1He = hes[ip1];
         eASSERT(curHe->destination() == ip1He->origin);
         eASSERT(curHe->isFree() == eTRUE);
     }
@@ -989,21 +975,21 @@ eEditMesh::Face * eEditMesh::addFace(Vertex **vertices, const eVector2 *texCoord
         const eU32 ip1 = (i+1)%vertexCount;
 
         // Would face introduce a non-manifold condition?
-        const eBool nonManifold = !_makeAdjacent(((HalfEdge*)vertices[i]->_volatile_attribute0), 
-			                                     ((HalfEdge*)vertices[ip1]->_volatile_attribute0));
+        const eBool nonManifold = !_makeAdjacent(hes[i], hes[ip1]);
         eASSERT(nonManifold == eFALSE);
     }
 
-	ALLOCATE_OPT(Face, newFace, this->m_preallocatedFaces);
+    Face *newFace = m_facePool.alloc();
     eASSERT(newFace != eNULL);
     newFace->selected = eFALSE;
     newFace->material = eMaterial::getDefault();
     newFace->tag = 0;
-    newFace->he = ((HalfEdge*)vertices[0]->_volatile_attribute0);
+    newFace->he = hes[0];
+    newFace->index = m_faces.size();
 
     // Link half-edges to the polygon.
     for (eU32 i=0; i<vertexCount; i++)
-        ((HalfEdge*)vertices[i]->_volatile_attribute0)->face = newFace;
+        hes[i]->face = newFace;
 
     m_faces.append(newFace);
     return newFace;
@@ -1069,15 +1055,10 @@ eEditMesh::Face * eEditMesh::addQuad(eU32 i0, eU32 i1, eU32 i2, eU32 i3)
 
 eBool eEditMesh::removeVertex(const Vertex *vtx)
 {
-    for (eU32 i=0; i<m_vertices.size(); i++)
-    {
-        if (m_vertices[i] == vtx)
-        {
-            return removeVertex(i);
-        }
-    }
+    eASSERT(vtx != eNULL);
+    eASSERT(m_vertices[vtx->index] == vtx);
 
-    return eFALSE;
+    return removeVertex(vtx->index);
 }
 
 eBool eEditMesh::removeVertex(eU32 index)
@@ -1093,23 +1074,23 @@ eBool eEditMesh::removeVertex(eU32 index)
         return eFALSE;
     }
 
-	DEALLOCATE_OPT(vtx);
+    m_vertexPool.release(vtx);
     m_vertices.removeAt(index);
+    m_positions.removeAt(index);
+    m_normals.removeAt(index);
+    m_texCoords.removeAt(index);
+    m_colors.removeAt(index);
+    _updateIndices(m_vertices, index);
 
     return eTRUE;
 }
 
 eBool eEditMesh::removeEdge(const Edge *edge)
 {
-    for (eU32 i=0; i<m_edges.size(); i++)
-    {
-        if (m_edges[i] == edge)
-        {
-            return removeEdge(i);
-        }
-    }
+    eASSERT(edge != eNULL);
+    eASSERT(m_edges[edge->index] == edge);
 
-    return eFALSE;
+    return removeEdge(edge->index);
 }
 
 eBool eEditMesh::removeEdge(eU32 index)
@@ -1164,25 +1145,22 @@ eBool eEditMesh::removeEdge(eU32 index)
         removeVertex(fromVtx);
     }
 
-    // Free the memory.
-    DEALLOCATE_OPT(edge->he0);
-    DEALLOCATE_OPT(edge->he1);
-    DEALLOCATE_OPT(edge);
+    // Free the memory. The index of the edge may
+    // have changed when removing the vertices.
+    index = edge->index;
+    _freeEdge(edge);
     m_edges.removeAt(index);
+    _updateIndices(m_edges, index);
 
     return eTRUE;
 }
 
 void eEditMesh::removeFace(const Face *face, eBool remFreeGeo)
 {
-    for (eU32 i=0; i<m_faces.size(); i++)
-    {
-        if (m_faces[i] == face)
-        {
-            removeFace(i, remFreeGeo);
-            break;
-        }
-    }
+    eASSERT(face != eNULL);
+    eASSERT(m_faces[face->index] == face);
+
+    removeFace(face->index, remFreeGeo);
 }
 
 // Removes the face with the given index from the
@@ -1219,8 +1197,8 @@ void eEditMesh::removeFace(eU32 index, eBool remFreeGeo)
     }
 
     // Free memory of face.
-    DEALLOCATE_OPT(face);
-    m_faces.removeAt(index);
+    m_facePool.release(face);
+    _removeFaceAt(index);
 
     // Remove "free" edges of face if requested.
     if (remFreeGeo)
@@ -1232,6 +1210,17 @@ void eEditMesh::removeFace(eU32 index, eBool remFreeGeo)
     }
 }
 
+// Gives the mesh a new, globally unique generation.
+// Clearing the mesh does this implicitly, so meshes
+// of operators get a new generation on execution.
+// Has to be called after modifying a mesh in place,
+// so that data derived from it (e.g. by surface
+// samplers) is rebuilt.
+void eEditMesh::setChanged()
+{
+    m_generation = (eU32)eAtomicInc(m_generationCounter);
+}
+
 eBool eEditMesh::checkConsistency() const
 {
     for (eU32 i=0; i<m_vertices.size(); i++)
@@ -1283,6 +1272,11 @@ eU32 eEditMesh::getFaceCount() const
     return m_faces.size();
 }
 
+eU32 eEditMesh::getGeneration() const
+{
+    return m_generation;
+}
+
 const eAABB & eEditMesh::getBoundingBox() const
 {
     return m_bbox;
@@ -1339,6 +1333,36 @@ eEditMesh::Face * eEditMesh::getFace(eU32 index)
     return m_faces[index];
 }
 
+const eVector3Array & eEditMesh::getPositions() const
+{
+    return m_positions;
+}
+
+eVector3Array & eEditMesh::getPositions()
+{
+    return m_positions;
+}
+
+const eVector3Array & eEditMesh::getNormals() const
+{
+    return m_normals;
+}
+
+eVector3Array & eEditMesh::getNormals()
+{
+    return m_normals;
+}
+
+const eVector2Array & eEditMesh::getTexCoords() const
+{
+    return m_texCoords;
+}
+
+eVector2Array & eEditMesh::getTexCoords()
+{
+    return m_texCoords;
+}
+
 eEditMesh & eEditMesh::operator = (eEditMesh &em) {
     if (&em != this) {
 		this->clearAndPreallocate(em.getVertexCount(), em.getFaceCount(), em.getEdgeCount());
@@ -1477,21 +1501,12 @@ eEditMesh::Edge * eEditMesh::_addEdge(Vertex *fromVtx, Vertex *toVtx)
         }
     }
 
-    // Allocate edge and half-edges.
-	ALLOCATE_OPT(Edge, edge, this->m_preallocatedEdges);
+    // Allocate and initialize edge and half-edges.
+    Edge *edge = _allocEdge();
     eASSERT(edge != eNULL);
-    m_edges.append(edge);
-
-	ALLOCATE_OPT(HalfEdge, fromToHe, this->m_preallocatedHalfEdges);
-    eASSERT(fromToHe != eNULL);
-	ALLOCATE_OPT(HalfEdge, toFromHe, this->m_preallocatedHalfEdges);
-    eASSERT(toFromHe != eNULL);
 
-    // Initialize edge and half-edges.
-    edge->he0 = fromToHe;
-    edge->he1 = toFromHe;
-    edge->selected = eFALSE;
-    edge->tag = 0;
+    HalfEdge *fromToHe = edge->he0;
+    HalfEdge *toFromHe = edge->he1;
 
     fromToHe->next = toFromHe;
     fromToHe->prev = toFromHe;
@@ -1563,7 +1578,7 @@ eBool eEditMesh::_triangulateFace(Face *face)
 
     do
     {
-        contourPos.append(he->origin->position);
+        contourPos.append(he->origin->getPosition());
         contourVerts.append(he->origin);
         contourUvs.append(he->texCoord);
 
@@ -1598,7 +1613,7 @@ eBool eEditMesh::_triangulateFace(Face *face)
             }
             while (he != face->he);
 
-            m_faces.removeAt(i);
+            _removeFaceAt(i);
             break;
         }
     }
@@ -1642,16 +1657,82 @@ eBool eEditMesh::_triangulateFace(Face *face)
         newFace->tag = face->tag;
     }
 
-    DEALLOCATE_OPT(face);
+    m_facePool.release(face);
     return eTRUE;
 }
 
+// Allocates a new edge together with its two
+// half-edges and appends it to the edge list.
+eEditMesh::Edge * eEditMesh::_allocEdge()
+{
+    Edge *edge = m_edgePool.alloc();
+    eASSERT(edge != eNULL);
+
+    edge->he0 = m_halfEdgePool.alloc();
+    edge->he1 = m_halfEdgePool.alloc();
+    edge->selected = eFALSE;
+    edge->tag = 0;
+    edge->index = m_edges.size();
+    edge->he0->index = 2*edge->index;
+    edge->he1->index = 2*edge->index+1;
+
+    m_edges.append(edge);
+    return edge;
+}
+
+void eEditMesh::_freeEdge(Edge *edge)
+{
+    eASSERT(edge != eNULL);
+
+    m_halfEdgePool.release(edge->he0);
+    m_halfEdgePool.release(edge->he1);
+    m_edgePool.release(edge);
+}
+
+void eEditMesh::_removeFaceAt(eU32 index)
+{
+    m_faces.removeAt(index);
+    _updateIndices(m_faces, index);
+}
+
+// Updates the indices of all elements, starting
+// at the given index (after removing an element).
+// Removal keeps the element order, which operators
+// iterating by index rely on, so it stays linear in
+// the number of following elements; only finding
+// the element to remove is constant time.
+void eEditMesh::_updateIndices(VertexPtrArray &vertices, eU32 first)
+{
+    for (eU32 i=first; i<vertices.size(); i++)
+    {
+        vertices[i]->index = i;
+    }
+}
+
+void eEditMesh::_updateIndices(EdgePtrArray &edges, eU32 first)
+{
+    for (eU32 i=first; i<edges.size(); i++)
+    {
+        edges[i]->index = i;
+        edges[i]->he0->index = 2*i;
+        edges[i]->he1->index = 2*i+1;
+    }
+}
+
+void eEditMesh::_updateIndices(FacePtrArray &faces, eU32 first)
+{
+    for (eU32 i=first; i<faces.size(); i++)
+    {
+        faces[i]->index = i;
+    }
+}
+
 void					
 eEditMesh::centerMesh() {
     const eVector3 &center = this->getBoundingBox().getCenter();
 
-    for (eU32 i=0; i<this->getVertexCount(); i++)
-        this->getVertex(i)->position -= center;
+    for (eU32 i=0; i<m_positions.size(); i++)
+        m_positions[i] -= center;
 
     this->getBoundingBox().translate(-center);
 }
@@ -1685,7 +1766,7 @@ eEditMesh::mapUVs(eU32 method, const eVector3	up, const eVector3	projectAxis, co
         for(eU32 e = 0; e < face->getEdgeCount(); e++) {
             vRecord rec;
             rec.lat = 1.0;
-			rec.pos = invMat * (face->getVertex(e)->position - center);
+			rec.pos = invMat * (face->getVertex(e)->getPosition() - center);
 			rec.normal = rec.pos.normalized();
 			if((rec.normal.x != 0.0f) || (rec.normal.y != 0.0f)) {
 				rec.lat = eATan2(rec.normal.y, rec.normal.x) + ePI;
@@ -1758,7 +1839,7 @@ eEditMesh::mapUVs(eU32 method, const eVector3	up, const eVector3	projectAxis, co
 			tu *= 0.5f * uvscale.x / ePI;
 			tv *= 0.5f * uvscale.y / ePI;
 			edge->texCoord = eVector2(tu, tv);
-			edge->origin->texCoord = edge->texCoord;
+			edge->origin->getTexCoord() = edge->texCoord;
 		}
 
 		// fix mapping errors
@@ -1791,12 +1872,10 @@ eEditMesh::transform(const eMatrix4x4 &mtx) {
     mtxNrm.invert();
     mtxNrm.transpose();
 
-	for (eU32 i=0; i<this->getVertexCount(); i++)
+	for (eU32 i=0; i<m_positions.size(); i++)
     {
-        eEditMesh::Vertex *vtx = this->getVertex(i);
-        eASSERT(vtx != eNULL);
-        vtx->position *= mtx;
-        vtx->normal *= mtxNrm;
+        m_positions[i] *= mtx;
+        m_normals[i] *= mtxNrm;
 	}
 
     // Update face normals.
@@ -43,6 +43,14 @@ private:
 };
 
 // Half-edge based mesh editing data-structure.
+// Every element knows its index in the mesh's
+// element lists. Temporary per-element data of
+// mesh algorithms is kept in arrays indexed by
+// it (e.g. eArray<Vertex *> of size face count).
+// The vertex attributes are stored in streams
+// (one array per attribute) indexed by it, so
+// that loops over all vertices read contiguous
+// memory and copying meshes copies whole arrays.
 class eEditMesh
 {
 public:
@@ -56,23 +64,22 @@ public:
         eBool               isFree() const;
         eBool               isBoundary() const;
 
-		void				lerp(const Vertex& v0, const Vertex& v1, eF32 t);
-		void				add(const Vertex& other);
-		void				mul(eF32 val);
+        const eVector3 &    getPosition() const;
+        eVector3 &          getPosition();
+        const eVector3 &    getNormal() const;
+        eVector3 &          getNormal();
+        const eVector2 &    getTexCoord() const;
+        eVector2 &          getTexCoord();
+        const eColor &      getColor() const;
+        eColor &            getColor();
 
     public:
         HalfEdge *          he;
+        eEditMesh *         mesh;
 
-        eVector3            position;
-        eVector3            normal;
-        eVector2            texCoord;
         eBool               selected;
-        eColor              color;
         eID                 tag;
-
-		void*				_volatile_attribute0; // for emesh-internal operations
-		void*				_volatile_attribute1; // for      -external operations
-		eBool				isPreallocated;
+        eU32                index;
     };
 
     class Edge
@@ -85,9 +92,7 @@ public:
         HalfEdge *          he1;
         eBool               selected;
         eID                 tag;
-
-		void*				_volatile_attribute0;
-		eBool				isPreallocated;
+        eU32                index;
     };
 
     class Face
@@ -97,11 +102,13 @@ public:
 
         eBool               isBoundary() const;
         eF32                getArea() const;
-		Vertex				getCenter() const;
+		eVector3			getCenter() const;
         eU32                getEdgeCount() const;
         HalfEdge *          getHalfEdge(eU32 index) const;
 		const Vertex *		getVertex(eU32 index) const;
 		void				getRandomSurfacePoint(eVector3 &resultPos, eVector3 &resultNormal) const;
+		void				getRandomSurfacePoint(eVector3 &resultPos, eVector3 &resultNormal, eU32 &seed) const;
+		void				getSurfacePoint(eU32 triNr, eF32 w0, eF32 w1, eVector3 &resultPos, eVector3 &resultNormal) const;
     public:
         HalfEdge *          he;
 
@@ -109,9 +116,7 @@ public:
         eVector3            normal;
         eBool               selected;
         eID                 tag;
-
-		void*				_volatile_attribute0;
-		eBool				isPreallocated;
+        eU32                index;
     };
 
     class HalfEdge
@@ -131,8 +136,76 @@ public:
         Face *              face;
 
         eVector2            texCoord;
-		void*				_volatile_attribute0;
-		eBool				isPreallocated;
+        eU32                index;  // 2*edge->index for he0, +1 for he1.
+    };
+
+private:
+    // Allocates mesh elements block-wise, so that
+    // building meshes doesn't hit the heap for each
+    // element. Addresses of allocated elements never
+    // change. Blocks are kept when the pool is reset,
+    // so they're reused when the mesh is rebuilt.
+    template<class T> class ElementPool
+    {
+    public:
+        ElementPool() : m_used(0)
+        {
+        }
+
+        ~ElementPool()
+        {
+            for (eU32 i=0; i<m_blocks.size(); i++)
+            {
+                eSAFE_DELETE_ARRAY(m_blocks[i]);
+            }
+        }
+
+        T * alloc()
+        {
+            if (!m_freeList.isEmpty())
+            {
+                return m_freeList.pop();
+            }
+
+            const eU32 block = m_used/BLOCK_SIZE;
+
+            if (block == m_blocks.size())
+            {
+                m_blocks.append(new T[BLOCK_SIZE]);
+            }
+
+            return &m_blocks[block][m_used++%BLOCK_SIZE];
+        }
+
+        void release(T *elem)
+        {
+            m_freeList.append(elem);
+        }
+
+        void reserve(eU32 count)
+        {
+            while (m_blocks.size()*BLOCK_SIZE < count)
+            {
+                m_blocks.append(new T[BLOCK_SIZE]);
+            }
+        }
+
+        void reset()
+        {
+            m_used = 0;
+            m_freeList.clear();
+        }
+
+    private:
+        ElementPool(const ElementPool &pool);
+        ElementPool & operator = (const ElementPool &pool);
+
+    private:
+        static const eU32   BLOCK_SIZE = 1024;
+
+        eArray<T *>         m_blocks;
+        eArray<T *>         m_freeList;
+        eU32                m_used;
     };
 
 public:
@@ -162,7 +235,6 @@ public:
     void                    clear();
     void                    clearAndPreallocate(eU32 numVertices, eU32 numFaces, eU32 numEdges);
     eBool                   triangulate();
-    void                    optimizeIndices();
     void                    updateBoundingBox();
     void                    updateBoundingBox(const eVector3& pos);
     void                    updateNormals();
@@ -174,7 +246,6 @@ public:
     Vertex *                addVertex(const eVector3 &pos, const eVector2 &texCoord, const eVector3 &normal);
     Vertex *                addVertex(const eVector3 &pos, const eVector2 &texCoord);
     Vertex *                addVertex(const eVector3 &pos);
-    Vertex *                addVertex(const Vertex& vertex);
     Face *                  addTriangleFast(Vertex **vertices, const eVector2 *texCoords);
     Face *                  addFace(Vertex **vertices, const eVector2 *texCoords, eU32 vertexCount);
     Face *                  addFace(const eU32 *indices, const eVector2 *texCoords, eU32 indexCount);
@@ -190,6 +261,8 @@ public:
     void                    removeFace(const Face *face, eBool remFreeGeo=eTRUE);
     void                    removeFace(eU32 index, eBool remFreeGeo=eTRUE);
 
+    void                    setChanged();
+
     eBool                   checkConsistency() const;
     eBool                   isTriangulated() const;
     eBool                   isEmpty() const;
@@ -197,6 +270,7 @@ public:
     eU32                    getVertexCount() const;
     eU32                    getEdgeCount() const;
     eU32                    getFaceCount() const;
+    eU32                    getGeneration() const;
     const eAABB &           getBoundingBox() const;
     eAABB &                 getBoundingBox();
 	void					setBoundingBox(const eAABB & bbox);
@@ -206,6 +280,12 @@ public:
     Edge *                  getEdge(eU32 index);
     const Face *            getFace(eU32 index) const;
     Face *                  getFace(eU32 index);
+    const eVector3Array &   getPositions() const;
+    eVector3Array &         getPositions();
+    const eVector3Array &   getNormals() const;
+    eVector3Array &         getNormals();
+    const eVector2Array &   getTexCoords() const;
+    eVector2Array &         getTexCoords();
 
     eEditMesh &             operator = (eEditMesh &em);
 
@@ -215,21 +295,80 @@ private:
     HalfEdge *              _findHalfEdge(const Vertex *fromVtx, const Vertex *toVtx);
     eBool                   _makeAdjacent(HalfEdge *inHe, HalfEdge *outHe);
     Edge *                  _addEdge(Vertex *fromVtx, Vertex *toVtx);
+    Vertex *                _allocVertex();
+    void                    _mergeVertices(const eEditMesh &em);
+    Edge *                  _allocEdge();
+    void                    _freeEdge(Edge *edge);
     eBool                   _triangulateFace(Face *face);
+    void                    _removeFaceAt(eU32 index);
+
+    static void             _updateIndices(VertexPtrArray &vertices, eU32 first);
+    static void             _updateIndices(EdgePtrArray &edges, eU32 first);
+    static void             _updateIndices(FacePtrArray &faces, eU32 first);
+
+    template<class T> static void _appendStream(eArray<T> &stream, const eArray<T> &src);
 
 private:
 public:
 	VertexPtrArray          m_vertices;
 private:
+    eVector3Array           m_positions;
+    eVector3Array           m_normals;
+    eVector2Array           m_texCoords;
+    eArray<eColor>          m_colors;
     EdgePtrArray            m_edges;
     FacePtrArray            m_faces;
     eAABB                   m_bbox;
     eBool                   m_triangulated;
 
-	eArray<Vertex>			m_preallocatedVertices;
-	eArray<HalfEdge>		m_preallocatedHalfEdges;
-	eArray<Edge>			m_preallocatedEdges;
-	eArray<Face>			m_preallocatedFaces;
+    ElementPool<Vertex>     m_vertexPool;
+    ElementPool<HalfEdge>   m_halfEdgePool;
+    ElementPool<Edge>       m_edgePool;
+    ElementPool<Face>       m_facePool;
+    HalfEdgePtrArray        m_faceHalfEdges; // Temporary used by addFace().
+    eU32                    m_generation;
+
+    static volatile eInt    m_generationCounter;
 };
 
+eFORCEINLINE const eVector3 & eEditMesh::Vertex::getPosition() const
+{
+    return mesh->m_positions[index];
+}
+
+eFORCEINLINE eVector3 & eEditMesh::Vertex::getPosition()
+{
+    return mesh->m_positions[index];
+}
+
+eFORCEINLINE const eVector3 & eEditMesh::Vertex::getNormal() const
+{
+    return mesh->m_normals[index];
+}
+
+eFORCEINLINE eVector3 & eEditMesh::Vertex::getNormal()
+{
+    return mesh->m_normals[index];
+}
+
+eFORCEINLINE const eVector2 & eEditMesh::Vertex::getTexCoord() const
+{
+    return mesh->m_texCoords[index];
+}
+
+eFORCEINLINE eVector2 & eEditMesh::Vertex::getTexCoord()
+{
+    return mesh->m_texCoords[index];
+}
+
+eFORCEINLINE const eColor & eEditMesh::Vertex::getColor() const
+{
+    return mesh->m_colors[index];
+}
+
+eFORCEINLINE eColor & eEditMesh::Vertex::getColor()
+{
+    return mesh->m_colors[index];
+}
+
 #endif // EDIT_MESH_HPP
\ No newline at end of file
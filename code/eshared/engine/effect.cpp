@@ -504,8 +504,8 @@ eIEffect::Target * eAdjustEffect::_run(TargetPtrArray &srcs)
 
     // Pre-multiply color by brightness to save
     // computation time in shader.
-    const eF32 *fcol = (const eF32 *)m_adjCol;
-    eVector4 vcol(fcol[0], fcol[1], fcol[2], fcol[3]);
+    const eFloatColor fcol = m_adjCol.toFloatColor();
+    eVector4 vcol(fcol.r, fcol.g, fcol.b, fcol.a);
     vcol *= m_brightness;
 
     m_gfx->setPsConst(0, eVector2(m_contrast));
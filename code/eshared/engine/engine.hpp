@@ -24,6 +24,9 @@
 #include "vertex.hpp"
 #include "geometry.hpp"
 #include "editmesh.hpp"
+#include "subdivider.hpp"
+#include "surfsampler.hpp"
+#include "bvh.hpp"
 #include "path.hpp"
 #include "camera.hpp"
 #include "renderjob.hpp"
@@ -60,9 +60,12 @@ private:
     void                    _unlockStaticBuffers();
 
 private:
+    // Dynamic buffers have to hold at least one
+    // full particle system (four vertices and six
+    // indices per particle).
     static const eU32       INSTANCE_VB_ELEMENTS = 100000;
-    static const eU32       DYNAMIC_VB_ELEMENTS  = 100000;
-    static const eU32       DYNAMIC_IB_ELEMENTS  = 1000000;
+    static const eU32       DYNAMIC_VB_ELEMENTS  = 600000;
+    static const eU32       DYNAMIC_IB_ELEMENTS  = 1500000;
 
 private:
     static eU32             m_instVbPos;
@@ -102,7 +102,7 @@ eU32 eMaterial::getSortKey() const
 
     key |= (m_renderPass<<24);
     key |= ((eU32)m_useBlending<<16);
-    key |= (eU16)((eU32)m_textures[0]^(eU32)m_textures[1]);
+    key |= (eU16)((size_t)m_textures[0]^(size_t)m_textures[1]);
 
     return key;
 }
@@ -75,12 +75,18 @@ eBool eMesh::Instance::getCastsShadows() const
 eMesh::eMesh(Type type, eU32 primitiveCount, eU32 vertexCount) :
     m_type(type)
 {
+#ifdef eEDITOR
+    eMemSet(m_vcacheStats, 0, sizeof(m_vcacheStats));
+#endif
     reserveSpace(primitiveCount, vertexCount);
 }
 
 eMesh::eMesh(Type type, eEditMesh &em) :
     m_type(type)
 {
+#ifdef eEDITOR
+    eMemSet(m_vcacheStats, 0, sizeof(m_vcacheStats));
+#endif
     fromEditMesh(em);
 }
 
@@ -127,6 +133,7 @@ void eMesh::finishLoading(Type type)
     ePROFILER_ZONE("Mesh finish loading");
 
 	m_type = type;
+    _resetVertexCacheStats();
 
     if(m_vertices.size() == 0) {
         m_drawSections.clear();
@@ -165,9 +172,17 @@ void eMesh::finishLoading(Type type)
             }
         }
 
-        // Create geometry object.
         eASSERT(ds.indices.size() == ds.primitives.size()*primSizes[ds.type]);
 
+        // Dynamic meshes are rebuilt too often
+        // to be worth optimizing.
+        if (ds.type == DrawSection::TYPE_TRIANGLES && m_type == TYPE_STATIC)
+        {
+            _optimizeDrawSection(ds);
+        }
+
+        // Create geometry object.
+
         const ePrimitiveType primTypes[3] =
         {
             ePRIMTYPE_TRIANGLELIST,
@@ -207,6 +222,7 @@ void eMesh::fromEditMesh(eEditMesh &em)
 
 void eMesh::clear()
 {
+    _resetVertexCacheStats();
     m_bbox.clear();
 
     m_vertices.clear();
@@ -228,32 +244,100 @@ void eMesh::clear()
     m_drawSections.clear();
 }
 
-// NOTE: Assumes that this mesh has enough capacity
 void eMesh::merge(const eMesh &other, const eMatrix4x4& mtx, const eMatrix4x4& mtxRotOnly) {
-    eU32 vtxCntBefore = m_vertices.size();
-    for(eU32 i = 0; i < other.getVertexCount(); i++) {
-        m_vertices.append(other.getVertex(i));
-        eVertex& v = m_vertices.lastElement();
-        v.position = eVector3(v.position) * mtx;
-        v.normal = eVector3(v.normal) * mtxRotOnly;
-        m_bbox.updateExtentFast(v.position);
-    }
-
-    for(eU32 d = 0; d < other.getDrawSectionCount(); d++) {
-        const DrawSection& ods = other.getDrawSection(d);
-        DrawSection &ds = _findDrawSection(ods.material, ods.type);
-        ds.primitives.reserve(ods.primitives.size());
-
-        for(eU32 i = 0; i < ods.primitives.size(); i++) {
-            const Primitive& oprim = other.getPrimitive(ods.primitives[i]);
-            m_primitives.append(oprim);
-            Primitive& prim = m_primitives.lastElement();
-            prim.material = ods.material;
-            for(eU32 k = 0; k < 3; k++)
-                prim.indices[k] = oprim.indices[k] + vtxCntBefore;
-
-            ds.primitives.append(m_primitives.size()-1);
+    eSceneData::MeshInstance inst;
+    inst.matrix = mtx;
+    inst.normalMatrix = mtxRotOnly;
+    inst.mesh = &other;
+
+    mergeInstances(&inst, 1);
+}
+
+// Appends all instances with their transformations
+// applied. All ranges are laid out up front, so the
+// instances can be transformed in parallel into
+// exactly sized vertex and primitive arrays.
+void eMesh::mergeInstances(const eSceneData::MeshInstance *instances, eU32 count)
+{
+    ePROFILER_ZONE("Merge mesh instances");
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    eASSERT(instances != eNULL);
+
+    eArray<MergeRange> ranges(count);
+    eArray<MergeSection> sections;
+    eArray<eU32> sectionSizes;
+    eU32 vertexCount = m_vertices.size();
+    eU32 primCount = m_primitives.size();
+
+    for (eU32 i=0; i<m_drawSections.size(); i++)
+    {
+        sectionSizes.append(m_drawSections[i].primitives.size());
+    }
+
+    for (eU32 i=0; i<count; i++)
+    {
+        const eMesh &mesh = *instances[i].mesh;
+        MergeRange &range = ranges[i];
+
+        range.firstVertex = vertexCount;
+        range.firstSection = sections.size();
+        vertexCount += mesh.m_vertices.size();
+
+        for (eU32 j=0; j<mesh.m_drawSections.size(); j++)
+        {
+            const DrawSection &srcDs = mesh.m_drawSections[j];
+
+            if (srcDs.primitives.size() == 0)
+            {
+                continue;
+            }
+
+            MergeSection ms;
+            ms.srcSection = j;
+            ms.dstSection = _findDrawSectionIdx(srcDs.material, srcDs.type);
+            ms.firstPrim = primCount;
+
+            if (ms.dstSection == sectionSizes.size())
+            {
+                sectionSizes.append(0);
+            }
+
+            ms.firstEntry = sectionSizes[ms.dstSection];
+            sectionSizes[ms.dstSection] += srcDs.primitives.size();
+            primCount += srcDs.primitives.size();
+            sections.append(ms);
         }
+
+        range.sectionCount = sections.size()-range.firstSection;
+    }
+
+    m_vertices.resize(vertexCount);
+    m_primitives.resize(primCount);
+
+    for (eU32 i=0; i<m_drawSections.size(); i++)
+    {
+        m_drawSections[i].primitives.resize(sectionSizes[i]);
+    }
+
+    eArray<eAABB> bboxes(count);
+
+    MergeJob job;
+    job.mesh = this;
+    job.instances = instances;
+    job.ranges = &ranges[0];
+    job.sections = (sections.size() > 0 ? &sections[0] : eNULL);
+    job.bboxes = &bboxes[0];
+
+    eThreadPool::get().parallelFor(_mergeJob, &job, count);
+
+    for (eU32 i=0; i<count; i++)
+    {
+        m_bbox.mergeFast(bboxes[i]);
     }
 }
 
@@ -485,12 +569,16 @@ void eMesh::_fromTriangleEditMesh(eEditMesh &em)
     reserveSpace(em.getFaceCount(), em.getFaceCount()*3); 
 	m_bbox = em.getBoundingBox();
 
-	for(eU32 i = 0; i < em.getVertexCount(); i++)
-    {
-		em.getVertex(i)->_volatile_attribute1 = (ePtr)-1;
-    }
+    // Vertices on UV seams and of flat shaded faces
+    // can't be shared by all faces around them, so
+    // each face corner gets its own vertex. Equal
+    // ones are welded again using a hash table,
+    // whose buckets and chains hold vertex indices.
+    eArray<eU32> buckets(eNextPowerOf2(em.getVertexCount()*2+1));
+    eArray<eU32> chain;
 
-    eArray<eU32> indices;
+    eMemSet(&buckets[0], -1, buckets.size()*sizeof(eU32));
+    chain.reserve(em.getFaceCount()*3);
 
     for (eU32 i=0; i<em.getFaceCount(); i++)
     {
@@ -500,49 +588,390 @@ void eMesh::_fromTriangleEditMesh(eEditMesh &em)
         const eMaterial *mat = face->material;
         eASSERT(mat != eNULL);
 
-        indices.clear();
+        eU32 indices[3];
+        eU32 corner = 0;
         eEditMesh::HalfEdge *he = face->he;
 
         do
         {
-            eEditMesh::Vertex *vtx = he->origin;
+            const eEditMesh::Vertex *vtx = he->origin;
             eASSERT(vtx != eNULL);
+            eASSERT(corner < 3);
+
+            const eVector3 &normal = (mat->getFlatShaded() ? face->normal : vtx->getNormal());
+            const eVector2 &texCoord = (he->texCoord.equals(vtx->getTexCoord()) ? vtx->getTexCoord() : he->texCoord);
+
+            indices[corner++] = _addWeldedVertex(eVertex(vtx->getPosition(), normal, texCoord, vtx->getColor()), buckets, chain);
+            he = he->next;
+        }
+        while (he != face->he);
+
+        // Add triangle to mesh.
+        addTriangle(indices[0], indices[1], indices[2], mat);
+    }
+}
+
+// Returns the index of the vertex equal to the
+// given one or adds it, if there's none yet.
+eU32 eMesh::_addWeldedVertex(const eVertex &vtx, eArray<eU32> &buckets, eArray<eU32> &chain)
+{
+    eASSERT(eIsPowerOf2(buckets.size()));
+
+    eU32 &head = buckets[_hashVertex(vtx)&(buckets.size()-1)];
+
+    for (eU32 index=head; index!=(eU32)-1; index=chain[index])
+    {
+        if (eMemEqual(&m_vertices[index], &vtx, sizeof(eVertex)))
+        {
+            return index;
+        }
+    }
+
+    m_vertices.append(vtx);
+    m_bbox.updateExtentFast(vtx.position);
+    chain.append(head);
+    head = m_vertices.size()-1;
+
+    return head;
+}
+
+// Hashes all components of the vertex bitwise, so
+// that only exactly equal vertices are welded.
+eU32 eMesh::_hashVertex(const eVertex &vtx)
+{
+    const eU32 *words = (const eU32 *)&vtx;
+    eU32 hash = 5381;
+
+    for (eU32 i=0; i<sizeof(eVertex)/sizeof(eU32); i++)
+    {
+        hash = eHashInt(hash*33+words[i]);
+    }
+
+    return hash;
+}
+
+// Reorders the triangles of a draw section for the
+// post-transform vertex cache and afterwards the
+// vertices in order of first use, so that vertex
+// fetches are as linear as possible.
+void eMesh::_optimizeDrawSection(DrawSection &ds)
+{
+    ePROFILER_ZONE("Optimize draw section");
+    eASSERT(ds.type == DrawSection::TYPE_TRIANGLES);
+
+    const eU32 triCount = ds.primitives.size();
+    const eU32 vertexCount = ds.vertices.size();
+
+    eArray<eU32> triOrder(triCount);
+    optimizeVertexCache(&ds.indices[0], triCount, vertexCount, &triOrder[0]);
+
+    const eArray<eU32> oldIndices = ds.indices;
+    const eArray<eU32> oldPrims = ds.primitives;
+    const eArray<eVertex *> oldVertices = ds.vertices;
+    eArray<eU32> vtxMap(vertexCount);
+
+    eMemSet(&vtxMap[0], -1, vertexCount*sizeof(eU32));
+    ds.vertices.clear();
+
+    for (eU32 i=0; i<triCount; i++)
+    {
+        const eU32 tri = triOrder[i];
+        ds.primitives[i] = oldPrims[tri];
+
+        for (eU32 j=0; j<3; j++)
+        {
+            const eU32 vtxIndex = oldIndices[tri*3+j];
+
+            if (vtxMap[vtxIndex] == (eU32)-1)
+            {
+                vtxMap[vtxIndex] = ds.vertices.size();
+                ds.vertices.append(oldVertices[vtxIndex]);
+            }
+
+            ds.indices[i*3+j] = vtxMap[vtxIndex];
+        }
+    }
+
+    eASSERT(ds.vertices.size() == vertexCount);
+
+#ifdef eEDITOR
+    const eU32 stats[VCACHE_STAT_COUNT] =
+    {
+        triCount,
+        calcCacheMisses(&oldIndices[0], oldIndices.size(), vertexCount),
+        calcCacheMisses(&ds.indices[0], ds.indices.size(), vertexCount)
+    };
+
+    for (eU32 i=0; i<VCACHE_STAT_COUNT; i++)
+    {
+        m_vcacheStats[i] += stats[i];
+        ePROFILER_ADD((eProfiler::Counter)(eProfiler::COUNTER_VCACHE_TRIANGLES+i), stats[i]);
+    }
+#endif
+}
+
+// Removes the vertex cache statistics of this mesh
+// from the profiler counters, so that they only
+// cover the meshes which are currently loaded.
+void eMesh::_resetVertexCacheStats()
+{
+#ifdef eEDITOR
+    for (eU32 i=0; i<VCACHE_STAT_COUNT; i++)
+    {
+        ePROFILER_ADD((eProfiler::Counter)(eProfiler::COUNTER_VCACHE_TRIANGLES+i), -(eInt)m_vcacheStats[i]);
+        m_vcacheStats[i] = 0;
+    }
+#endif
+}
+
+// Vertex cache optimization after Tom Forsyth's
+// "Linear-speed vertex cache optimisation". The
+// triangles are greedily added in order of the
+// highest score, which depends on the position
+// of their vertices in a simulated LRU cache and
+// on the number of triangles still using them.
+// The new triangle order is written to triOrder.
+void eMesh::optimizeVertexCache(const eU32 *indices, eU32 triCount, eU32 vertexCount, eU32 *triOrder)
+{
+    ePROFILER_ZONE("Optimize vertex cache");
+
+    eASSERT(indices != eNULL || triCount == 0);
+    eASSERT(triOrder != eNULL || triCount == 0);
+
+    if (triCount == 0)
+    {
+        return;
+    }
+
+    // Build vertex to triangle adjacency lists.
+    // Triangles are removed from the lists of
+    // their vertices when they're added.
+    const eU32 indexCount = triCount*3;
+    eArray<eU32> vtxTriCounts(vertexCount);
+    eArray<eU32> vtxTriOffsets(vertexCount);
+    eArray<eU32> vtxTris(indexCount);
+
+    eMemSet(&vtxTriCounts[0], 0, vertexCount*sizeof(eU32));
 
-            const eVector3 &normal = (mat->getFlatShaded() ? face->normal : vtx->normal);
+    for (eU32 i=0; i<indexCount; i++)
+    {
+        eASSERT(indices[i] < vertexCount);
+        vtxTriCounts[indices[i]]++;
+    }
+
+    for (eU32 i=0, offset=0; i<vertexCount; i++)
+    {
+        vtxTriOffsets[i] = offset;
+        offset += vtxTriCounts[i];
+        vtxTriCounts[i] = 0;
+    }
+
+    for (eU32 i=0; i<indexCount; i++)
+    {
+        const eU32 vtx = indices[i];
+        vtxTris[vtxTriOffsets[vtx]+vtxTriCounts[vtx]++] = i/3;
+    }
 
-            // Check if vertices have to be duplicated.
-            if (!he->texCoord.equals(vtx->texCoord))
+    // Calculate initial scores.
+    eArray<eInt> vtxCachePos(vertexCount);
+    eArray<eF32> vtxScores(vertexCount);
+    eArray<eF32> triScores(triCount);
+    eArray<eBool> triAdded(triCount);
+
+    for (eU32 i=0; i<vertexCount; i++)
+    {
+        vtxCachePos[i] = -1;
+        vtxScores[i] = _calcVertexScore(-1, vtxTriCounts[i]);
+    }
+
+    eInt bestTri = -1;
+    eF32 bestScore = -1.0f;
+
+    for (eU32 i=0; i<triCount; i++)
+    {
+        const eU32 *tri = &indices[i*3];
+
+        triAdded[i] = eFALSE;
+        triScores[i] = vtxScores[tri[0]]+vtxScores[tri[1]]+vtxScores[tri[2]];
+
+        if (triScores[i] > bestScore)
+        {
+            bestScore = triScores[i];
+            bestTri = i;
+        }
+    }
+
+    // Add triangles one by one.
+    eU32 cache[VCACHE_OPT_SIZE+3];
+    eU32 cacheSize = 0;
+    eU32 nextTri = 0;
+
+    for (eU32 i=0; i<triCount; i++)
+    {
+        // If no triangle in the cache is left,
+        // continue with the first one not yet
+        // added (the cache is cold anyway).
+        if (bestTri == -1)
+        {
+            while (triAdded[nextTri])
             {
-                // Yes, so add new vertex.
-                addVertex(vtx->position, normal, he->texCoord, vtx->color);
-                indices.append(m_vertices.size()-1);
+                nextTri++;
             }
-            else if (mat->getFlatShaded())
+
+            bestTri = nextTri;
+        }
+
+        const eU32 *tri = &indices[bestTri*3];
+        eU32 newCache[VCACHE_OPT_SIZE+3];
+        eU32 newCacheSize = 0;
+
+        triOrder[i] = bestTri;
+        triAdded[bestTri] = eTRUE;
+
+        for (eU32 j=0; j<3; j++)
+        {
+            const eU32 vtx = tri[j];
+            eU32 *vtxTriList = &vtxTris[vtxTriOffsets[vtx]];
+            eU32 &vtxTriCount = vtxTriCounts[vtx];
+
+            for (eU32 k=0; k<vtxTriCount; k++)
             {
-                addVertex(vtx->position, normal, vtx->texCoord, vtx->color);
-                indices.append(m_vertices.size()-1);
+                if (vtxTriList[k] == (eU32)bestTri)
+                {
+                    vtxTriList[k] = vtxTriList[--vtxTriCount];
+                    break;
+                }
             }
-            // With flat shading every vertex has to be duplicated,
-            // because vertices can't share normals anymore.
-            else if (vtx->_volatile_attribute1 == (ePtr)-1)
+
+            // Degenerated triangles reference
+            // vertices more than once.
+            if ((j == 0 || vtx != tri[0]) && (j < 2 || vtx != tri[1]))
             {
-                // No and vertex was not added yet.
-                addVertex(vtx->position, normal, vtx->texCoord, vtx->color);
-                indices.append(m_vertices.size()-1);
-                vtx->_volatile_attribute1 = (ePtr)(m_vertices.size()-1);
+                newCache[newCacheSize++] = vtx;
             }
-            else
+        }
+
+        // Vertices of the added triangle move to
+        // the front of the cache, the others are
+        // moved back. Vertices falling out of the
+        // cache are kept at the end of the new
+        // cache list, so that their scores are
+        // updated, too.
+        for (eU32 j=0; j<cacheSize; j++)
+        {
+            const eU32 vtx = cache[j];
+
+            if (vtx != tri[0] && vtx != tri[1] && vtx != tri[2])
             {
-                // Yes and vertex was already added before.
-                indices.append((eU32)vtx->_volatile_attribute1);
+                newCache[newCacheSize++] = vtx;
             }
-            he = he->next;
         }
-        while (he != face->he);
 
-        // Add triangle to mesh.
-        addTriangle(indices[0], indices[1], indices[2], mat);
+        for (eU32 j=0; j<newCacheSize; j++)
+        {
+            const eU32 vtx = newCache[j];
+
+            vtxCachePos[vtx] = (j < VCACHE_OPT_SIZE ? (eInt)j : -1);
+            vtxScores[vtx] = _calcVertexScore(vtxCachePos[vtx], vtxTriCounts[vtx]);
+        }
+
+        // Update scores of the triangles using
+        // vertices in the cache and find the
+        // best one of them for the next step.
+        bestTri = -1;
+        bestScore = -1.0f;
+
+        for (eU32 j=0; j<newCacheSize; j++)
+        {
+            const eU32 vtx = newCache[j];
+            const eU32 *vtxTriList = &vtxTris[vtxTriOffsets[vtx]];
+
+            for (eU32 k=0; k<vtxTriCounts[vtx]; k++)
+            {
+                const eU32 t = vtxTriList[k];
+                const eU32 *tvs = &indices[t*3];
+
+                triScores[t] = vtxScores[tvs[0]]+vtxScores[tvs[1]]+vtxScores[tvs[2]];
+
+                if (j < VCACHE_OPT_SIZE && triScores[t] > bestScore)
+                {
+                    bestScore = triScores[t];
+                    bestTri = t;
+                }
+            }
+        }
+
+        cacheSize = eMin(newCacheSize, (eU32)VCACHE_OPT_SIZE);
+        eMemCopy(cache, newCache, cacheSize*sizeof(eU32));
+    }
+}
+
+eF32 eMesh::_calcVertexScore(eInt cachePos, eU32 remainingTris)
+{
+    // Vertices not used anymore must not
+    // attract any triangles.
+    if (remainingTris == 0)
+    {
+        return -1.0f;
+    }
+
+    eF32 score = 0.0f;
+
+    if (cachePos >= 0)
+    {
+        if (cachePos < 3)
+        {
+            // Vertices of the last added triangle get a
+            // fixed score. Otherwise triangles sharing an
+            // edge with it would be preferred too much,
+            // which results in strip like orders.
+            score = 0.75f;
+        }
+        else
+        {
+            const eF32 pos = 1.0f-(eF32)(cachePos-3)/(eF32)(VCACHE_OPT_SIZE-3);
+            score = pos*eSqrt(pos);
+        }
+    }
+
+    // Boost vertices with few triangles left, so
+    // that no single triangles are left behind.
+    return score+2.0f/eSqrt((eF32)remainingTris);
+}
+
+// Counts the misses of a FIFO post-transform cache
+// for the given triangle list. Divided by the
+// triangle count it gives the average cache miss
+// ratio (ACMR), which is 0.5 at best and 3 at worst.
+eU32 eMesh::calcCacheMisses(const eU32 *indices, eU32 indexCount, eU32 vertexCount)
+{
+    if (indexCount == 0)
+    {
+        return 0;
+    }
+
+    eASSERT(indices != eNULL);
+
+    // Stores for each vertex the number of misses
+    // at the point in time it entered the cache.
+    eArray<eU32> vtxEntered(vertexCount);
+    eMemSet(&vtxEntered[0], 0, vertexCount*sizeof(eU32));
+
+    eU32 misses = 0;
+
+    for (eU32 i=0; i<indexCount; i++)
+    {
+        const eU32 vtx = indices[i];
+        eASSERT(vtx < vertexCount);
+
+        if (vtxEntered[vtx] == 0 || misses+1-vtxEntered[vtx] > VCACHE_SIZE)
+        {
+            misses++;
+            vtxEntered[vtx] = misses;
+        }
     }
+
+    return misses;
 }
 
 // Forbid usage of assignment operator by making it private.
@@ -552,6 +981,109 @@ eMesh & eMesh::operator = (const eMesh &mesh)
     return *this;
 }
 
+// Transforms the vertices of one instance and
+// rebases its primitive indices section by section.
+void eMesh::_mergeJob(ePtr arg, eU32 index)
+{
+    const MergeJob &job = *(const MergeJob *)arg;
+    const eSceneData::MeshInstance &inst = job.instances[index];
+    const MergeRange &range = job.ranges[index];
+    const eMesh &src = *inst.mesh;
+    eMesh &dst = *job.mesh;
+    eAABB &bbox = job.bboxes[index];
+
+    bbox.clear();
+
+    if (src.m_vertices.size() > 0)
+    {
+        _transformVertices(&src.m_vertices[0], &dst.m_vertices[range.firstVertex], src.m_vertices.size(),
+                           inst.matrix, inst.normalMatrix, bbox);
+    }
+
+    for (eU32 i=0; i<range.sectionCount; i++)
+    {
+        const MergeSection &ms = job.sections[range.firstSection+i];
+        const DrawSection &srcDs = src.m_drawSections[ms.srcSection];
+        const eU32 *srcPrims = &srcDs.primitives[0];
+        Primitive *prims = &dst.m_primitives[ms.firstPrim];
+        eU32 *entries = &dst.m_drawSections[ms.dstSection].primitives[ms.firstEntry];
+
+        for (eU32 j=0; j<srcDs.primitives.size(); j++)
+        {
+            const Primitive &srcPrim = src.m_primitives[srcPrims[j]];
+            Primitive &prim = prims[j];
+
+            prim.material = srcDs.material;
+            prim.indices[0] = srcPrim.indices[0]+range.firstVertex;
+            prim.indices[1] = srcPrim.indices[1]+range.firstVertex;
+            prim.indices[2] = srcPrim.indices[2]+range.firstVertex;
+            entries[j] = ms.firstPrim+j;
+        }
+    }
+}
+
+void eMesh::_transformVertices(const eVertex *src, eVertex *dst, eU32 count, const eMatrix4x4 &mtx, const eMatrix4x4 &normalMtx, eAABB &bbox)
+{
+#ifdef eUSE_SSE
+    const __m128 m0 = _mm_loadu_ps(&mtx.m11);
+    const __m128 m1 = _mm_loadu_ps(&mtx.m21);
+    const __m128 m2 = _mm_loadu_ps(&mtx.m31);
+    const __m128 m3 = _mm_loadu_ps(&mtx.m41);
+    const __m128 n0 = _mm_loadu_ps(&normalMtx.m11);
+    const __m128 n1 = _mm_loadu_ps(&normalMtx.m21);
+    const __m128 n2 = _mm_loadu_ps(&normalMtx.m31);
+
+    // The fourth lane of the normal load is the
+    // first texture coordinate, which is kept.
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+    __m128 minPos = _mm_set1_ps(eF32_MAX);
+    __m128 maxPos = _mm_set1_ps(-eF32_MAX);
+
+    for (eU32 i=0; i<count; i++)
+    {
+        const __m128 pos = _mm_loadu_ps(&src[i].position.x);
+        const __m128 nrm = _mm_loadu_ps(&src[i].normal.x);
+
+        const __m128 tp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(pos, pos, _MM_SHUFFLE(0, 0, 0, 0)), m0),
+                                                _mm_mul_ps(_mm_shuffle_ps(pos, pos, _MM_SHUFFLE(1, 1, 1, 1)), m1)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(pos, pos, _MM_SHUFFLE(2, 2, 2, 2)), m2), m3));
+        const __m128 tn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(nrm, nrm, _MM_SHUFFLE(0, 0, 0, 0)), n0),
+                                                _mm_mul_ps(_mm_shuffle_ps(nrm, nrm, _MM_SHUFFLE(1, 1, 1, 1)), n1)),
+                                     _mm_mul_ps(_mm_shuffle_ps(nrm, nrm, _MM_SHUFFLE(2, 2, 2, 2)), n2));
+
+        minPos = _mm_min_ps(minPos, tp);
+        maxPos = _mm_max_ps(maxPos, tp);
+
+        // Position store spills into the normal,
+        // which is written right afterwards.
+        dst[i] = src[i];
+        _mm_storeu_ps(&dst[i].position.x, tp);
+        _mm_storeu_ps(&dst[i].normal.x, _mm_or_ps(_mm_and_ps(xyzMask, tn), _mm_andnot_ps(xyzMask, nrm)));
+    }
+
+    if (count > 0)
+    {
+        eF32 minArr[4], maxArr[4];
+        _mm_storeu_ps(minArr, minPos);
+        _mm_storeu_ps(maxArr, maxPos);
+
+        bbox.updateExtentFast(eVector3(minArr[0], minArr[1], minArr[2]));
+        bbox.updateExtentFast(eVector3(maxArr[0], maxArr[1], maxArr[2]));
+    }
+#else
+    for (eU32 i=0; i<count; i++)
+    {
+        eVertex &v = dst[i];
+
+        v = src[i];
+        v.position = eVector3(v.position)*mtx;
+        v.normal = eVector3(v.normal)*normalMtx;
+        bbox.updateExtentFast(v.position);
+    }
+#endif
+}
+
 void eMesh::_fillDynamicBuffers(ePtr param, eGeometry *geo)
 {
 	ePROFILER_ZONE("Upload mesh");
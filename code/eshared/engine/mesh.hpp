@@ -105,8 +105,12 @@ public:
     const eAABB &               getBoundingBox() const;
 
     void                        merge(const eMesh &other, const eMatrix4x4& mtx = eMatrix4x4(), const eMatrix4x4& mtxRotOnly = eMatrix4x4());
+    void                        mergeInstances(const eSceneData::MeshInstance *instances, eU32 count);
+
 public:
     static void                 createWireCube(eMesh &mesh, const eVector3 &size, const eMaterial *mat);
+    static void                 optimizeVertexCache(const eU32 *indices, eU32 triCount, eU32 vertexCount, eU32 *triOrder);
+    static eU32                 calcCacheMisses(const eU32 *indices, eU32 indexCount, eU32 vertexCount);
 
 private:
     eU32                        _findDrawSectionIdx(const eMaterial *mat, DrawSection::Type dsType);
@@ -115,11 +119,56 @@ private:
     }
     eU32                        _addPrimitive(const eU32 *vertices, eU32 vertexCount, const eMaterial *mat, DrawSection::Type dsType);
     void                        _fromTriangleEditMesh(eEditMesh &em);
+    eU32                        _addWeldedVertex(const eVertex &vtx, eArray<eU32> &buckets, eArray<eU32> &chain);
+    void                        _optimizeDrawSection(DrawSection &ds);
+    void                        _resetVertexCacheStats();
 
     eMesh &                     operator = (const eMesh &mesh);
 
 private:
+    // Where the primitives of one draw section of a
+    // merged instance go in this mesh.
+    struct MergeSection
+    {
+        eU32                    srcSection;
+        eU32                    dstSection;
+        eU32                    firstPrim;
+        eU32                    firstEntry;
+    };
+
+    struct MergeRange
+    {
+        eU32                    firstVertex;
+        eU32                    firstSection;
+        eU32                    sectionCount;
+    };
+
+    struct MergeJob
+    {
+        eMesh *                 mesh;
+        const eSceneData::MeshInstance * instances;
+        const MergeRange *      ranges;
+        const MergeSection *    sections;
+        eAABB *                 bboxes;
+    };
+
+private:
+    static void                 _mergeJob(ePtr arg, eU32 index);
+    static void                 _transformVertices(const eVertex *src, eVertex *dst, eU32 count, const eMatrix4x4 &mtx, const eMatrix4x4 &normalMtx, eAABB &bbox);
     static void                 _fillDynamicBuffers(ePtr param, eGeometry *geo);
+    static eF32                 _calcVertexScore(eInt cachePos, eU32 remainingTris);
+    static eU32                 _hashVertex(const eVertex &vtx);
+
+private:
+    // Size of the FIFO post-transform cache used to
+    // measure the average cache miss ratio (ACMR)
+    // and of the LRU cache the optimizer simulates.
+    static const eU32           VCACHE_SIZE = 16;
+    static const eU32           VCACHE_OPT_SIZE = 32;
+
+    // Triangles, misses before and misses after
+    // optimizing, in order of the profiler counters.
+    static const eU32           VCACHE_STAT_COUNT = 3;
 
 private:
     typedef eArray<eVertex> eVertexArray;
@@ -133,6 +182,10 @@ private:
     
     Type			            m_type;
     eAABB                       m_bbox;
+
+#ifdef eEDITOR
+    eU32                        m_vcacheStats[VCACHE_STAT_COUNT];
+#endif
 };
 
 #endif // MESH_HPP
\ No newline at end of file
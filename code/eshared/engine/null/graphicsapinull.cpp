@@ -0,0 +1,405 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "../../eshared.hpp"
+
+#ifdef eNULL_GFX
+
+#include "resourcesnull.hpp"
+
+// Null implementation of the graphics API. It is
+// selected by defining eNULL_GFX and replaces the
+// Direct3D 9 implementation. No device or window
+// is created: resources live in system memory and
+// draw calls only update the render statistics.
+// This allows processing operator stacks headless
+// (e.g. for measuring the precalculation time).
+
+eGraphicsApiDx9::eGraphicsApiDx9() :
+    m_d3dMain(eNULL),
+    m_d3dDevice(eNULL),
+    m_d3dPp(eNULL),
+    m_d3dCaps(eNULL),
+    m_screenRt(eNULL),
+    m_screenDt(eNULL),
+    m_rtNull(eNULL),
+    m_deviceLost(eFALSE),
+    m_hwnd(eNULL),
+    m_ownWindow(eFALSE),
+    m_fullScreen(eFALSE),
+    m_vsync(eFALSE),
+    m_wndWidth(800),
+    m_wndHeight(600),
+    m_frameQuery(0),
+    m_frameCollect(-1),
+    m_startPull(eFALSE),
+    m_frame(0)
+{
+    eResourceManager::setGraphics(this);
+    eStateManager::setGraphics(this);
+    eStateManager::reset();
+
+    eMemSet(&m_renderStats, 0, sizeof(m_renderStats));
+    eMemSet(m_d3dVDecls, 0, sizeof(m_d3dVDecls));
+    eMemSet(m_occlQuery, 0, sizeof(m_occlQuery));
+}
+
+#ifdef eEDITOR
+eGraphicsApiDx9::~eGraphicsApiDx9()
+{
+    shutdown();
+}
+
+void eGraphicsApiDx9::shutdown()
+{
+    m_resolutions.clear();
+}
+#endif
+
+eBool eGraphicsApiDx9::initialize()
+{
+    _enumerateResolutions();
+    return eTRUE;
+}
+
+eBool eGraphicsApiDx9::getInitialized() const
+{
+    return (m_resolutions.size() > 0);
+}
+
+eU32 eGraphicsApiDx9::getResolutionCount() const
+{
+    return m_resolutions.size();
+}
+
+const eSize & eGraphicsApiDx9::getResolution(eU32 index) const
+{
+    return m_resolutions[index];
+}
+
+eBool eGraphicsApiDx9::openWindow(eU32 width, eU32 height, eBool fullScreen, eBool vsync, ePtr hwnd)
+{
+    m_wndWidth   = width;
+    m_wndHeight  = height;
+    m_fullScreen = fullScreen;
+    m_vsync      = vsync;
+    m_hwnd       = hwnd;
+
+    eStateManager::setViewport(0, 0, width, height);
+    eStateManager::forceApply();
+
+    return eTRUE;
+}
+
+void eGraphicsApiDx9::closeWindow()
+{
+    m_hwnd = eNULL;
+}
+
+void eGraphicsApiDx9::setWindowTitle(const eString &title)
+{
+}
+
+void eGraphicsApiDx9::handleMessages(eMessage &msg)
+{
+    msg = eMSG_IDLE;
+}
+
+void eGraphicsApiDx9::resizeBackbuffer(eU32 width, eU32 height)
+{
+    m_wndWidth = width;
+    m_wndHeight = height;
+}
+
+void eGraphicsApiDx9::clear(eClearMode mode, const eColor &color) const
+{
+}
+
+eBool eGraphicsApiDx9::renderStart()
+{
+    eMemSet(&m_renderStats, 0, sizeof(m_renderStats));
+    return eTRUE;
+}
+
+void eGraphicsApiDx9::renderEnd()
+{
+    m_renderStats.fps = _getFpsRate();
+}
+
+void eGraphicsApiDx9::flush()
+{
+}
+
+eRenderStats eGraphicsApiDx9::getRenderStats() const
+{
+    return m_renderStats;
+}
+
+eBool eGraphicsApiDx9::getFullScreen() const
+{
+    return m_fullScreen;
+}
+
+eU32 eGraphicsApiDx9::getWindowWidth() const
+{
+    return m_wndWidth;
+}
+
+eU32 eGraphicsApiDx9::getWindowHeight() const
+{
+    return m_wndHeight;
+}
+
+eSize eGraphicsApiDx9::getWindowSize() const
+{
+    return eSize(m_wndWidth, m_wndHeight);
+}
+
+void eGraphicsApiDx9::setCap(eRenderCap cap, eBool enabled)
+{
+    eASSERT(cap < eMAX_CAP_COUNT);
+}
+
+void eGraphicsApiDx9::setBlendModes(eBlendMode srcMode, eBlendMode dstMode, eBlendOp blendOp)
+{
+}
+
+void eGraphicsApiDx9::setAlphaTest(eBool enable)
+{
+}
+
+void eGraphicsApiDx9::setPolygonMode(ePolygonMode mode)
+{
+}
+
+void eGraphicsApiDx9::setViewport(eU32 x, eU32 y, eU32 width, eU32 height)
+{
+}
+
+void eGraphicsApiDx9::setCullingMode(eCullingMode cm)
+{
+}
+
+void eGraphicsApiDx9::setZFunction(eZFunction zFunc)
+{
+}
+
+void eGraphicsApiDx9::setScissorRect(const eRect &rect)
+{
+}
+
+void eGraphicsApiDx9::setTextureFilter(eU32 unit, eTextureFilter texFilter)
+{
+    eASSERT(unit < MAX_TEX_UNITS);
+}
+
+void eGraphicsApiDx9::setTextureAddressMode(eU32 unit, eTextureAddressMode tam)
+{
+    eASSERT(unit < MAX_TEX_UNITS);
+}
+
+void eGraphicsApiDx9::setPixelShader(eIPixelShader *ps)
+{
+}
+
+void eGraphicsApiDx9::setVertexShader(eIVertexShader *vs)
+{
+}
+
+void eGraphicsApiDx9::setPsConst(eU32 offset, eU32 count, const eF32 *data)
+{
+    eASSERT(count > 0);
+    eASSERT(data != eNULL);
+}
+
+void eGraphicsApiDx9::setVsConst(eU32 offset, eU32 count, const eF32 *data)
+{
+    eASSERT(count > 0);
+    eASSERT(data != eNULL);
+}
+
+void eGraphicsApiDx9::setRenderTarget(eU32 index, eITexture *tex, eCubeMapFace face)
+{
+    eASSERT(index < MAX_TARGETS);
+    eASSERT(face < eCMFACE_COUNT);
+}
+
+void eGraphicsApiDx9::setDepthTarget(eITexture2d *tex)
+{
+    eASSERT(tex != eNULL);
+}
+
+void eGraphicsApiDx9::setVertexBuffer(eU32 index, eIVertexBuffer *vb, eVertexType vertexType, eU32 byteOffset, eU32 instanceCount)
+{
+}
+
+void eGraphicsApiDx9::setIndexBuffer(eIIndexBuffer *ib)
+{
+}
+
+void eGraphicsApiDx9::setTexture(eU32 unit, eITexture *tex)
+{
+    eASSERT(unit < MAX_TEX_UNITS);
+}
+
+void eGraphicsApiDx9::drawPrimitives(ePrimitiveType type, eU32 startVertex, eU32 primitiveCount)
+{
+    eASSERT(primitiveCount > 0);
+
+    switch (type)
+    {
+        case ePRIMTYPE_TRIANGLELIST:
+        {
+            m_renderStats.triangles += primitiveCount;
+            m_renderStats.vertices += primitiveCount*3;
+            break;
+        }
+
+        case ePRIMTYPE_TRIANGLESTRIPS:
+        {
+            m_renderStats.triangles += primitiveCount;
+            m_renderStats.vertices += primitiveCount+2;
+            break;
+        }
+
+        case ePRIMTYPE_LINESTRIPS:
+        {
+            m_renderStats.vertices += primitiveCount+1;
+            m_renderStats.lines += primitiveCount;
+            break;
+        }
+
+        case ePRIMTYPE_LINELIST:
+        {
+            m_renderStats.vertices += primitiveCount*2;
+            m_renderStats.lines += primitiveCount;
+            break;
+        }
+    }
+
+    m_renderStats.batches++;
+}
+
+void eGraphicsApiDx9::drawIndexedPrimitives(ePrimitiveType type, eU32 startVertex, eU32 vertexCount, eU32 startIndex, eU32 primitiveCount, eU32 instanceCount)
+{
+    eASSERT(vertexCount > 0);
+    eASSERT(primitiveCount > 0);
+
+    const eU32 realInsts = (instanceCount == 0 ? 1 : instanceCount);
+
+    if (type == ePRIMTYPE_TRIANGLELIST || type == ePRIMTYPE_TRIANGLESTRIPS)
+    {
+        m_renderStats.triangles += primitiveCount*realInsts;
+    }
+    else
+    {
+        m_renderStats.lines += primitiveCount*realInsts;
+    }
+
+    m_renderStats.vertices += vertexCount*realInsts;
+    m_renderStats.batches++;
+}
+
+#ifdef eDEBUG
+eIVertexShader * eGraphicsApiDx9::createVertexShader(const eString &fileName) const
+{
+    return new eVertexShaderNull;
+}
+
+eIPixelShader * eGraphicsApiDx9::createPixelShader(const eString &fileName) const
+{
+    return new ePixelShaderNull;
+}
+#else
+eIPixelShader * eGraphicsApiDx9::createPixelShader(eConstPtr data) const
+{
+    return new ePixelShaderNull;
+}
+
+eIVertexShader * eGraphicsApiDx9::createVertexShader(eConstPtr data) const
+{
+    return new eVertexShaderNull;
+}
+#endif
+
+eIVertexBuffer * eGraphicsApiDx9::createVertexBuffer(eU32 byteSize, eBool dynamic) const
+{
+    return new eVertexBufferNull(byteSize, dynamic);
+}
+
+eIIndexBuffer * eGraphicsApiDx9::createIndexBuffer(eU32 indexCount, eBool dynamic) const
+{
+    return new eIndexBufferNull(indexCount, dynamic);
+}
+
+eITexture2d * eGraphicsApiDx9::createTexture2d(eU32 width, eU32 height, eBool renderTarget, eBool mipMapped, eBool dynamic, eFormat format) const
+{
+    return new eTexture2dNull(width, height, renderTarget, mipMapped, dynamic, format);
+}
+
+eITexture3d * eGraphicsApiDx9::createTexture3d(eU32 width, eU32 height, eU32 depth, eBool mipMapped, eBool dynamic, eFormat format)
+{
+    return new eTexture3dNull(width, height, depth, mipMapped, dynamic, format);
+}
+
+eITextureCube * eGraphicsApiDx9::createTextureCube(eU32 width, eBool renderTarget, eBool mipMapped, eBool dynamic, eFormat format) const
+{
+    return new eTextureCubeNull(width, renderTarget, mipMapped, dynamic, format);
+}
+
+#ifndef eINTRO
+// There's no image decoder without D3DX, so
+// importing images always fails. The import
+// operator falls back to an empty bitmap then.
+eBool eGraphicsApiDx9::loadImage(const eByteArray &fileData, eColor *&image, eU32 &width, eU32 &height) const
+{
+    return eFALSE;
+}
+#endif
+
+IDirect3DDevice9 * eGraphicsApiDx9::getDevice() const
+{
+    return eNULL;
+}
+
+eF32 eGraphicsApiDx9::_getFpsRate() const
+{
+    static const eU32 UPDATE_INTERVAL = 333;
+
+    static eTimer timer;
+    static eF32 fpsHolder = 0;
+    static eU32 oldTime = 0;
+    static eU32 frameCounter = 0;
+
+    const eU32 curTime = timer.getElapsedMs();
+    frameCounter++;
+
+    if (curTime-oldTime >= UPDATE_INTERVAL)
+    {
+        fpsHolder = (eF32)frameCounter*(1000.0f/(eF32)UPDATE_INTERVAL);
+        frameCounter = 0;
+        oldTime = curTime;
+    }
+
+    return fpsHolder;
+}
+
+eBool eGraphicsApiDx9::_enumerateResolutions()
+{
+    m_resolutions.clear();
+    m_resolutions.append(eSize(m_wndWidth, m_wndHeight));
+    return eTRUE;
+}
+
+#endif // eNULL_GFX
\ No newline at end of file
@@ -0,0 +1,459 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "../../eshared.hpp"
+
+#ifdef eNULL_GFX
+
+#include "resourcesnull.hpp"
+
+// Size of one pixel in bytes per texture format.
+static const eU32 PIXEL_SIZES[] =
+{
+    4, // eFORMAT_ARGB8
+    8, // eFORMAT_ARGB16
+    8, // eFORMAT_ARGB16F
+    2, // eFORMAT_DEPTH16
+    4, // eFORMAT_DEPTH24X8
+    2, // eFORMAT_R16F
+    4, // eFORMAT_R32F
+    4, // eFORMAT_GR16F
+    8  // eFORMAT_GR32F
+};
+
+eTexture2dNull::eTexture2dNull(eU32 width, eU32 height, eBool renderTarget, eBool mipMapped, eBool dynamic, eFormat format) :
+    m_width(width),
+    m_height(height),
+    m_renderTarget(renderTarget),
+    m_mipMapped(mipMapped),
+    m_locked(eFALSE),
+    m_dynamic(dynamic),
+    m_format(format),
+    m_data(eNULL)
+{
+    eASSERT(width*height > 0);
+
+    // Render targets are never written to, so
+    // they don't need any memory behind them.
+    if (!renderTarget)
+    {
+        const eU32 byteSize = width*height*PIXEL_SIZES[format];
+        m_data = new eU8[byteSize];
+        eASSERT(m_data != eNULL);
+        eMemSet(m_data, 255, byteSize);
+    }
+}
+
+eTexture2dNull::~eTexture2dNull()
+{
+    unload();
+    eSAFE_DELETE_ARRAY(m_data);
+}
+
+eBool eTexture2dNull::bind(eU32 unit, eCubeMapFace face, eBool targetAsTexture)
+{
+    eASSERT(unit < eGraphicsApiDx9::MAX_TEX_UNITS);
+    return eTRUE;
+}
+
+eBool eTexture2dNull::upload()
+{
+    return eTRUE;
+}
+
+eBool eTexture2dNull::unload()
+{
+    return eITexture2d::unload();
+}
+
+ePtr eTexture2dNull::lock()
+{
+    eASSERT(m_renderTarget == eFALSE);
+    eASSERT(m_locked == eFALSE);
+
+    m_locked = eTRUE;
+    return m_data;
+}
+
+eBool eTexture2dNull::unlock()
+{
+    eASSERT(m_locked == eTRUE);
+
+    m_locked = eFALSE;
+    return eTRUE;
+}
+
+#ifndef eINTRO
+void eTexture2dNull::saveToFile(const eChar *fileName)
+{
+    eASSERT(fileName != eNULL);
+}
+#endif
+
+eSize eTexture2dNull::getSize() const
+{
+    return eSize(m_width, m_height);
+}
+
+eU32 eTexture2dNull::getWidth() const
+{
+    return m_width;
+}
+
+eU32 eTexture2dNull::getHeight() const
+{
+    return m_height;
+}
+
+eFormat eTexture2dNull::getFormat() const
+{
+    return m_format;
+}
+
+eBool eTexture2dNull::isDynamic() const
+{
+    return m_dynamic;
+}
+
+eBool eTexture2dNull::isMipMapped() const
+{
+    return m_mipMapped;
+}
+
+eBool eTexture2dNull::isRenderTarget() const
+{
+    return m_renderTarget;
+}
+
+// 3D texture implementation starts here.
+eTexture3dNull::eTexture3dNull(eU32 width, eU32 height, eU32 depth, eBool mipMapped, eBool dynamic, eFormat format) :
+    m_width(width),
+    m_height(height),
+    m_depth(depth),
+    m_mipMapped(mipMapped),
+    m_locked(eFALSE),
+    m_dynamic(dynamic),
+    m_format(format),
+    m_data(eNULL)
+{
+    eASSERT(format != eFORMAT_DEPTH16 && format != eFORMAT_DEPTH24X8);
+    eASSERT(width*height*depth > 0);
+
+    const eU32 byteSize = width*height*depth*PIXEL_SIZES[format];
+    m_data = new eU8[byteSize];
+    eASSERT(m_data != eNULL);
+    eMemSet(m_data, 255, byteSize);
+}
+
+eTexture3dNull::~eTexture3dNull()
+{
+    unload();
+    eSAFE_DELETE_ARRAY(m_data);
+}
+
+eBool eTexture3dNull::bind(eU32 unit, eCubeMapFace face, eBool targetAsTexture)
+{
+    eASSERT(unit < eGraphicsApiDx9::MAX_TEX_UNITS);
+    return eTRUE;
+}
+
+eBool eTexture3dNull::upload()
+{
+    return eTRUE;
+}
+
+eBool eTexture3dNull::unload()
+{
+    return eITexture3d::unload();
+}
+
+ePtr eTexture3dNull::lock()
+{
+    eASSERT(m_locked == eFALSE);
+
+    m_locked = eTRUE;
+    return m_data;
+}
+
+eBool eTexture3dNull::unlock()
+{
+    eASSERT(m_locked == eTRUE);
+
+    m_locked = eFALSE;
+    return eTRUE;
+}
+
+eU32 eTexture3dNull::getWidth() const
+{
+    return m_width;
+}
+
+eU32 eTexture3dNull::getHeight() const
+{
+    return m_height;
+}
+
+eU32 eTexture3dNull::getDepth() const
+{
+    return m_depth;
+}
+
+eFormat eTexture3dNull::getFormat() const
+{
+    return m_format;
+}
+
+eBool eTexture3dNull::isDynamic() const
+{
+    return m_dynamic;
+}
+
+eBool eTexture3dNull::isMipMapped() const
+{
+    return m_mipMapped;
+}
+
+// Cube texture implementation starts here.
+eTextureCubeNull::eTextureCubeNull(eU32 width, eBool renderTarget, eBool mipMapped, eBool dynamic, eFormat format) :
+    m_width(width),
+    m_renderTarget(renderTarget),
+    m_mipMapped(mipMapped),
+    m_locked(eFALSE),
+    m_dynamic(dynamic),
+    m_format(format)
+{
+    eASSERT(width > 0);
+
+    for (eU32 i=0; i<eCMFACE_COUNT; i++)
+    {
+        m_data[i] = eNULL;
+
+        if (!renderTarget)
+        {
+            const eU32 byteSize = width*width*PIXEL_SIZES[format];
+            m_data[i] = new eU8[byteSize];
+            eASSERT(m_data[i] != eNULL);
+            eMemSet(m_data[i], 255, byteSize);
+        }
+    }
+}
+
+eTextureCubeNull::~eTextureCubeNull()
+{
+    unload();
+
+    for (eU32 i=0; i<eCMFACE_COUNT; i++)
+    {
+        eSAFE_DELETE_ARRAY(m_data[i]);
+    }
+}
+
+eBool eTextureCubeNull::bind(eU32 unit, eCubeMapFace face, eBool targetAsTexture)
+{
+    eASSERT(unit < eGraphicsApiDx9::MAX_TEX_UNITS);
+    eASSERT(face < eCMFACE_COUNT);
+
+    return eTRUE;
+}
+
+eBool eTextureCubeNull::upload()
+{
+    return eTRUE;
+}
+
+eBool eTextureCubeNull::unload()
+{
+    return eITextureCube::unload();
+}
+
+ePtr eTextureCubeNull::lock(eCubeMapFace face)
+{
+    eASSERT(m_renderTarget == eFALSE);
+    eASSERT(m_locked == eFALSE);
+    eASSERT(face < eCMFACE_COUNT);
+
+    m_locked = eTRUE;
+    return m_data[face];
+}
+
+eBool eTextureCubeNull::unlock()
+{
+    eASSERT(m_locked == eTRUE);
+
+    m_locked = eFALSE;
+    return eTRUE;
+}
+
+#ifndef eINTRO
+void eTextureCubeNull::saveToFile(const eChar *fileName)
+{
+    eASSERT(fileName != eNULL);
+}
+#endif
+
+eSize eTextureCubeNull::getSize() const
+{
+    return eSize(m_width, m_width);
+}
+
+eU32 eTextureCubeNull::getWidth() const
+{
+    return m_width;
+}
+
+eU32 eTextureCubeNull::getHeight() const
+{
+    return m_width;
+}
+
+eFormat eTextureCubeNull::getFormat() const
+{
+    return m_format;
+}
+
+eBool eTextureCubeNull::isDynamic() const
+{
+    return m_dynamic;
+}
+
+eBool eTextureCubeNull::isMipMapped() const
+{
+    return m_mipMapped;
+}
+
+eBool eTextureCubeNull::isRenderTarget() const
+{
+    return m_renderTarget;
+}
+
+// Index buffer implementation starts here.
+eIndexBufferNull::eIndexBufferNull(eU32 count, eBool dynamic) :
+    m_count(count),
+    m_dynamic(dynamic),
+    m_locked(eFALSE),
+    m_data(new eU32[count])
+{
+    eASSERT(count > 0);
+    eASSERT(m_data != eNULL);
+}
+
+eIndexBufferNull::~eIndexBufferNull()
+{
+    unload();
+    eSAFE_DELETE_ARRAY(m_data);
+}
+
+eBool eIndexBufferNull::bind()
+{
+    return eTRUE;
+}
+
+eBool eIndexBufferNull::upload()
+{
+    return eTRUE;
+}
+
+eBool eIndexBufferNull::unload()
+{
+    return eIIndexBuffer::unload();
+}
+
+eU32 * eIndexBufferNull::lock(eU32 offset, eU32 count, eBufferLock lockMode)
+{
+    eASSERT(m_locked == eFALSE);
+    eASSERT(offset+count <= m_count);
+
+    m_locked = eTRUE;
+    return m_data+offset;
+}
+
+eBool eIndexBufferNull::unlock()
+{
+    eASSERT(m_locked != eFALSE);
+
+    m_locked = eFALSE;
+    return eTRUE;
+}
+
+eU32 eIndexBufferNull::getCount() const
+{
+    return m_count;
+}
+
+eBool eIndexBufferNull::isDynamic() const
+{
+    return m_dynamic;
+}
+
+// Vertex buffer implementation starts here.
+eVertexBufferNull::eVertexBufferNull(eU32 byteSize, eBool dynamic) :
+    m_byteSize(byteSize),
+    m_dynamic(dynamic),
+    m_locked(eFALSE),
+    m_data(new eU8[byteSize])
+{
+    eASSERT(byteSize > 0);
+    eASSERT(m_data != eNULL);
+}
+
+eVertexBufferNull::~eVertexBufferNull()
+{
+    unload();
+    eSAFE_DELETE_ARRAY(m_data);
+}
+
+eBool eVertexBufferNull::bind(eU32 index, eVertexType vertexType, eU32 byteOffset, eU32 instanceCount)
+{
+    eASSERT(vertexType < eVTXTYPE_COUNT);
+    return eTRUE;
+}
+
+eBool eVertexBufferNull::upload()
+{
+    return eTRUE;
+}
+
+eBool eVertexBufferNull::unload()
+{
+    return eIVertexBuffer::unload();
+}
+
+ePtr eVertexBufferNull::lock(eU32 byteOffset, eU32 byteCount, eBufferLock lockMode)
+{
+    eASSERT(m_locked == eFALSE);
+    eASSERT(byteOffset+byteCount <= m_byteSize);
+
+    m_locked = eTRUE;
+    return m_data+byteOffset;
+}
+
+eBool eVertexBufferNull::unlock()
+{
+    eASSERT(m_locked != eFALSE);
+
+    m_locked = eFALSE;
+    return eTRUE;
+}
+
+eU32 eVertexBufferNull::getByteSize() const
+{
+    return m_byteSize;
+}
+
+eBool eVertexBufferNull::isDynamic() const
+{
+    return m_dynamic;
+}
+
+#endif // eNULL_GFX
\ No newline at end of file
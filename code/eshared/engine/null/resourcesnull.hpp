@@ -0,0 +1,200 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef RESOURCES_NULL_HPP
+#define RESOURCES_NULL_HPP
+
+// Resources of the null graphics API. They only
+// keep their data in system memory, so that the
+// operators can be processed without any device.
+
+class eTexture2dNull : public eITexture2d
+{
+public:
+    eTexture2dNull(eU32 width, eU32 height, eBool renderTarget, eBool mipMapped, eBool dynamic, eFormat format);
+    virtual ~eTexture2dNull();
+
+    virtual eBool               bind(eU32 unit, eCubeMapFace face, eBool targetAsTexture=eFALSE);
+    virtual eBool               upload();
+    virtual eBool               unload();
+    virtual ePtr                lock();
+    virtual eBool               unlock();
+
+#ifndef eINTRO
+    virtual void                saveToFile(const eChar *fileName);
+#endif
+
+    virtual eSize               getSize() const;
+    virtual eU32                getWidth() const;
+    virtual eU32                getHeight() const;
+    virtual eFormat             getFormat() const;
+    virtual eBool               isDynamic() const;
+    virtual eBool               isMipMapped() const;
+    virtual eBool               isRenderTarget() const;
+
+private:
+    eU32                        m_width;
+    eU32                        m_height;
+    eBool                       m_renderTarget;
+    eBool                       m_mipMapped;
+    eBool                       m_locked;
+    eBool                       m_dynamic;
+    eFormat                     m_format;
+    eU8 *                       m_data;
+};
+
+class eTexture3dNull : public eITexture3d
+{
+public:
+    eTexture3dNull(eU32 width, eU32 height, eU32 depth, eBool mipMapped, eBool dynamic, eFormat format);
+    virtual ~eTexture3dNull();
+
+    virtual eBool               bind(eU32 unit, eCubeMapFace face, eBool targetAsTexture=eFALSE);
+    virtual eBool               upload();
+    virtual eBool               unload();
+    virtual ePtr                lock();
+    virtual eBool               unlock();
+
+    virtual eU32                getWidth() const;
+    virtual eU32                getHeight() const;
+    virtual eU32                getDepth() const;
+    virtual eFormat             getFormat() const;
+    virtual eBool               isDynamic() const;
+    virtual eBool               isMipMapped() const;
+
+private:
+    eU32                        m_width;
+    eU32                        m_height;
+    eU32                        m_depth;
+    eBool                       m_mipMapped;
+    eBool                       m_locked;
+    eBool                       m_dynamic;
+    eFormat                     m_format;
+    eU8 *                       m_data;
+};
+
+class eTextureCubeNull : public eITextureCube
+{
+public:
+    eTextureCubeNull(eU32 width, eBool renderTarget, eBool mipMapped, eBool dynamic, eFormat format);
+    virtual ~eTextureCubeNull();
+
+    virtual eBool               bind(eU32 unit, eCubeMapFace face, eBool targetAsTexture=eFALSE);
+    virtual eBool               upload();
+    virtual eBool               unload();
+    virtual ePtr                lock(eCubeMapFace face);
+    virtual eBool               unlock();
+
+#ifndef eINTRO
+    virtual void                saveToFile(const eChar *fileName);
+#endif
+
+    virtual eSize               getSize() const;
+    virtual eU32                getWidth() const;
+    virtual eU32                getHeight() const;
+    virtual eFormat             getFormat() const;
+    virtual eBool               isDynamic() const;
+    virtual eBool               isMipMapped() const;
+    virtual eBool               isRenderTarget() const;
+
+private:
+    eU32                        m_width;
+    eBool                       m_renderTarget;
+    eBool                       m_mipMapped;
+    eBool                       m_locked;
+    eBool                       m_dynamic;
+    eFormat                     m_format;
+    eU8 *                       m_data[eCMFACE_COUNT];
+};
+
+class eIndexBufferNull : public eIIndexBuffer
+{
+public:
+    eIndexBufferNull(eU32 count, eBool dynamic);
+    virtual ~eIndexBufferNull();
+
+    virtual eBool               bind();
+    virtual eBool               upload();
+    virtual eBool               unload();
+    virtual eU32 *              lock(eU32 offset, eU32 count, eBufferLock lockMode);
+    virtual eBool               unlock();
+
+    virtual eU32                getCount() const;
+    virtual eBool               isDynamic() const;
+
+private:
+    eU32                        m_count;
+    eBool                       m_dynamic;
+    eBool                       m_locked;
+    eU32 *                      m_data;
+};
+
+class eVertexBufferNull : public eIVertexBuffer
+{
+public:
+    eVertexBufferNull(eU32 byteSize, eBool dynamic);
+    virtual ~eVertexBufferNull();
+
+    virtual eBool               bind(eU32 index, eVertexType vertexType, eU32 byteOffset, eU32 instanceCount);
+    virtual eBool               upload();
+    virtual eBool               unload();
+    virtual ePtr                lock(eU32 byteOffset, eU32 byteCount, eBufferLock lockMode);
+    virtual eBool               unlock();
+
+    virtual eU32                getByteSize() const;
+    virtual eBool               isDynamic() const;
+
+private:
+    eU32                        m_byteSize;
+    eBool                       m_dynamic;
+    eBool                       m_locked;
+    eU8 *                       m_data;
+};
+
+// Shaders are never executed, so both shader
+// types share the same empty implementation.
+template<class T> class eShaderNull : public T
+{
+public:
+    virtual eBool bind()
+    {
+        return eTRUE;
+    }
+
+#ifdef eDEBUG
+    virtual eBool load(const eString &fileName)
+    {
+        return eTRUE;
+    }
+#else
+    virtual eBool load(eConstPtr data)
+    {
+        return eTRUE;
+    }
+#endif
+
+    virtual eBool upload()
+    {
+        return eTRUE;
+    }
+
+    virtual eBool unload()
+    {
+        return eTRUE;
+    }
+};
+
+typedef eShaderNull<eIVertexShader> eVertexShaderNull;
+typedef eShaderNull<eIPixelShader> ePixelShaderNull;
+
+#endif // RESOURCES_NULL_HPP
\ No newline at end of file
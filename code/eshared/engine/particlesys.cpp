@@ -14,7 +14,9 @@
 #include "../system/system.hpp"
 #include "../math/math.hpp"
 #include "engine.hpp"
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 eParticleSystem::Instance::Instance(eParticleSystem &psys) : eIRenderable(),
     m_psys(psys)
@@ -62,7 +64,9 @@ eParticleSystem::eParticleSystem() :
     m_gfx(eNULL),
     m_geometry(eNULL),
     m_lastTime(0.0f),
-    m_timer(-1.0f),
+    m_step(0),
+    m_settingsStep(0),
+    m_stepFraction(0.0f),
     m_emitTime(0.0f),
     m_count(0),
     m_tex(eNULL),
@@ -71,13 +75,20 @@ eParticleSystem::eParticleSystem() :
     m_lifeTime(10.0f),
     m_stretchAmount(0.0f),
     m_gravity(0.0f),
+    m_seed(0),
 	m_blendSrc(eBLEND_SRCALPHA),
     m_blendDst(eBLEND_ONE),
     m_blendOp(eBLENDOP_ADD),
-    m_randomization(0)
+    m_randomization(0),
+    m_emitterChanged(eFALSE),
+    m_emitterHash(0),
+    m_snapshotBytes(0)
 {
 	for(eU32 i = 0; i < __PATHSAMPLERSIZE__; i++)
 		m_pathSampler[i] = eNULL;
+    eMemSet(&m_settings, 0, sizeof(m_settings));
+    for(eU32 i = 0; i < STREAM_COUNT; i++)
+        m_streams[i] = eNULL;
 	this->m_gravityConst = (eVector3*)eMemAllocAlignedAndZero(4 * sizeof(eF32), 16);
 }
 
@@ -85,8 +96,9 @@ eParticleSystem::~eParticleSystem()
 {
 	for(eU32 i = 0; i < __PATHSAMPLERSIZE__; i++)
 	    eSAFE_DELETE(m_pathSampler[i]);
-//    eSAFE_DELETE(m_emitterMesh);
+    _freeSnapshots();
     eSAFE_DELETE(m_geometry);
+    eFreeAligned(m_streams[0]);
     eFreeAligned(m_gravityConst);
 }
 
@@ -94,289 +106,642 @@ void
 eParticleSystem::init(eGraphicsApiDx9 * gfx) {
 	if((!this->m_gfx) && (gfx)) {
 		m_gfx = gfx;
-		m_particles.resize(PSYS_MAX_PARTICLES);
+
+        // All streams live in one 16 byte aligned block.
+        const eU32 streamSize = PSYS_MAX_PARTICLES+4;
+        eF32 *data = (eF32 *)eMemAllocAlignedAndZero(STREAM_COUNT*streamSize*sizeof(eF32), 16);
+        eASSERT(data != eNULL);
+        for(eU32 i = 0; i < STREAM_COUNT; i++)
+            m_streams[i] = data+i*streamSize;
+
 		m_geometry = new eGeometry(PSYS_MAX_PARTICLES*4, PSYS_MAX_PARTICLES*6, PSYS_MAX_PARTICLES*2, eVTXTYPE_PARTICLE, eGeometry::TYPE_DYNAMIC_INDEXED, ePRIMTYPE_TRIANGLELIST, _fillDynamicBuffers, this);
 		eASSERT(m_geometry != eNULL);
 	}
 }
 
-// Assumes time in seconds.
+// Assumes time in seconds. The system is simulated
+// in fixed time steps with one random seed per step,
+// so the particles at a given time don't depend on
+// the times update() was called with before. Seeking
+// to an already simulated time continues from the
+// latest snapshot before it, so it costs at most one
+// snapshot interval of simulation. Times between two
+// steps are rendered by moving the particles of the
+// earlier step the rest of the way.
+// If a simulation parameter or the emitter changes
+// between two calls (e.g. because it's animated),
+// the simulation continues from the current step
+// with the new values. Only the snapshots after the
+// current step are dropped, as they were simulated
+// with the old values.
 void eParticleSystem::update(eF32 time)
 {
-    if (time == m_lastTime)
+    eASSERT(m_streams[0] != eNULL);
+
+    Settings settings;
+    eMemSet(&settings, 0, sizeof(settings));
+    settings.emissionFreq = m_emissionFreq;
+    settings.emissionVel = m_emissionVel;
+    settings.lifeTime = m_lifeTime;
+    settings.randomization = m_randomization;
+    settings.gravity = *m_gravityConst;
+    settings.seed = m_seed;
+
+    if (m_snapshots.isEmpty()) {
+        m_settings = settings;
+        m_emitterChanged = eFALSE;
+        _resetSimulation();
+    } else if (m_emitterChanged || !eMemEqual(&settings, &m_settings, sizeof(Settings))) {
+        m_settings = settings;
+        m_emitterChanged = eFALSE;
+        m_settingsStep = m_step;
+        _removeSnapshotsAfter(m_step);
+    } else if (time == m_lastTime)
         return;
 
-	eU32 seed = eRandomSeed();
-
     ePROFILER_ZONE("Update particle system");
-    const eF32 deltaTime = eMax(0.0f, time-m_lastTime);
     m_lastTime = time;
-    time = deltaTime;
+
+    const eU32 step = (time > 0.0f ? eFloor(time/PSYS_TIME_STEP) : 0);
+    _seek(step);
+    m_stepFraction = eClamp(0.0f, time-(eF32)step*PSYS_TIME_STEP, PSYS_TIME_STEP);
+}
+
+eU32 eParticleSystem::getSnapshotMemory() const
+{
+    return m_snapshotBytes;
+}
+
+void eParticleSystem::_seek(eU32 step)
+{
+    // There's always a snapshot of the first step.
+    const eInt index = _findSnapshot(step);
+    eASSERT(index >= 0);
+
+    if (step < m_step || m_snapshots[index]->step > m_step)
+        _restoreSnapshot(*m_snapshots[index]);
+
+    // Seeking back before the step the current
+    // settings apply from: they apply from the
+    // restored step on, so later snapshots are
+    // outdated.
+    if (m_step < m_settingsStep) {
+        m_settingsStep = m_step;
+        _removeSnapshotsAfter(m_step);
+    }
+
+    while (m_step < step)
+        _simulateStep();
+}
+
+void eParticleSystem::_simulateStep()
+{
+    // The step's seed is salted with the system's
+    // seed, so that systems with equal settings
+    // don't emit identical particles.
+    eU32 seed = eHashInt((eInt)(eHashInt((eInt)m_seed)^m_step))%0x7ffffffe + 1;
+
+    // Add life, delete unused and move the
+    // remaining particles, then emit new ones.
+    m_boundingBox.clear();
+    _updateParticles(PSYS_TIME_STEP);
+
+    if (m_emissionFreq > 0.0f)
+        _emitParticles(PSYS_TIME_STEP, seed);
+
+    m_step++;
+
+    if (m_step%m_snapshotInterval == 0)
+        _takeSnapshot();
+}
+
+void eParticleSystem::_resetSimulation()
+{
+    _freeSnapshots();
+
+    m_step = 0;
+    m_settingsStep = 0;
+    m_count = 0;
+    m_emitTime = 0.0f;
     m_boundingBox.clear();
-    eF32 timeLeft = time > 1.0f ? 1.0f : time;
-    while (timeLeft > 0.0f) {
-        if (timeLeft <= PSYS_MAX_TIME_STEP) {
-            time = timeLeft;
-            timeLeft = 0.0f;
+    m_snapshotInterval = eMax(eFtoL(PSYS_SNAPSHOT_INTERVAL/PSYS_TIME_STEP), 1);
+    _takeSnapshot();
+}
+
+// Snapshots are kept within the memory budget by
+// thinning them out, which doubles the interval
+// between them (the first one is always kept).
+void eParticleSystem::_takeSnapshot()
+{
+    const eInt index = _findSnapshot(m_step);
+    if (index >= 0 && m_snapshots[index]->step == m_step)
+        return;
+
+    Snapshot *snapshot = new Snapshot;
+    eASSERT(snapshot != eNULL);
+    snapshot->step = m_step;
+    snapshot->count = m_count;
+    snapshot->emitTime = m_emitTime;
+    snapshot->boundingBox = m_boundingBox;
+    snapshot->data.resize(m_count*STREAM_COUNT);
+
+    if (m_count > 0)
+        for (eU32 i=0; i<STREAM_COUNT; i++)
+            eMemCopy(&snapshot->data[i*m_count], m_streams[i], m_count*sizeof(eF32));
+
+    m_snapshots.insert(index+1, snapshot);
+
+    const eU32 bytes = sizeof(Snapshot)+snapshot->data.size()*sizeof(eF32);
+    m_snapshotBytes += bytes;
+    ePROFILER_ADD(eProfiler::COUNTER_PSYS_SNAPSHOT_BYTES, bytes);
+
+    while (m_snapshotBytes > PSYS_SNAPSHOT_BUDGET && m_snapshots.size() > 1) {
+        m_snapshotInterval *= 2;
+
+        for (eInt i=(eInt)m_snapshots.size()-1; i>=0; i--)
+            if (m_snapshots[i]->step%m_snapshotInterval != 0)
+                _removeSnapshot(i);
+    }
+}
+
+void eParticleSystem::_restoreSnapshot(const Snapshot &snapshot)
+{
+    m_step = snapshot.step;
+    m_count = snapshot.count;
+    m_emitTime = snapshot.emitTime;
+    m_boundingBox = snapshot.boundingBox;
+
+    if (m_count > 0)
+        for (eU32 i=0; i<STREAM_COUNT; i++)
+            eMemCopy(m_streams[i], &snapshot.data[i*m_count], m_count*sizeof(eF32));
+}
+
+void eParticleSystem::_removeSnapshot(eU32 index)
+{
+    Snapshot *snapshot = m_snapshots[index];
+    const eU32 bytes = sizeof(Snapshot)+snapshot->data.size()*sizeof(eF32);
+
+    m_snapshotBytes -= bytes;
+    ePROFILER_ADD(eProfiler::COUNTER_PSYS_SNAPSHOT_BYTES, -(eInt)bytes);
+    eSAFE_DELETE(snapshot);
+    m_snapshots.removeAt(index);
+}
+
+void eParticleSystem::_removeSnapshotsAfter(eU32 step)
+{
+    while (!m_snapshots.isEmpty() && m_snapshots[m_snapshots.size()-1]->step > step)
+        _removeSnapshot(m_snapshots.size()-1);
+}
+
+void eParticleSystem::_freeSnapshots()
+{
+    while (!m_snapshots.isEmpty())
+        _removeSnapshot(m_snapshots.size()-1);
+}
+
+// Returns the index of the latest snapshot not
+// after the given step or -1 if there's none.
+eInt eParticleSystem::_findSnapshot(eU32 step) const
+{
+    eInt l = 0;
+    eInt r = (eInt)m_snapshots.size();
+
+    while (l < r) {
+        const eInt m = (l+r)>>1;
+        if (m_snapshots[m]->step <= step)
+            l = m+1;
+        else
+            r = m;
+    }
+
+    return l-1;
+}
+
+// The particles are processed in chunks, which
+// are aged in parallel. Then the dead particles
+// are removed and the surviving particles are
+// moved in parallel chunks again.
+void eParticleSystem::_updateParticles(eF32 deltaTime)
+{
+    UpdateJob job;
+    job.psys = this;
+    job.deltaTime = deltaTime;
+
+    eU32 chunkCount = (m_count+PARTICLES_PER_JOB-1)/PARTICLES_PER_JOB;
+    eThreadPool::get().parallelFor(_ageJob, &job, chunkCount);
+
+    m_count = _removeDeadParticles();
+
+    chunkCount = (m_count+PARTICLES_PER_JOB-1)/PARTICLES_PER_JOB;
+    m_chunkBoxes.resize(chunkCount);
+    eThreadPool::get().parallelFor(_moveJob, &job, chunkCount);
+
+    for (eU32 i=0; i<chunkCount; i++)
+        m_boundingBox.merge(m_chunkBoxes[i]);
+}
+
+void eParticleSystem::_ageJob(ePtr arg, eU32 index)
+{
+    const UpdateJob &job = *(const UpdateJob *)arg;
+    eParticleSystem *psys = job.psys;
+    const eU32 first = index*PARTICLES_PER_JOB;
+    const eU32 count = eMin((eU32)PARTICLES_PER_JOB, psys->m_count-first);
+
+    psys->_ageParticles(first, count, job.deltaTime);
+}
+
+void eParticleSystem::_moveJob(ePtr arg, eU32 index)
+{
+    const UpdateJob &job = *(const UpdateJob *)arg;
+    eParticleSystem *psys = job.psys;
+    const eU32 first = index*PARTICLES_PER_JOB;
+    const eU32 count = eMin((eU32)PARTICLES_PER_JOB, psys->m_count-first);
+
+    psys->m_chunkBoxes[index].clear();
+    psys->_moveParticles(first, count, eNULL, job.deltaTime, psys->m_chunkBoxes[index]);
+}
+
+// Emits the particles of this time step in one
+// batch. Each particle is moved by the time
+// between its emission and the end of the step.
+void eParticleSystem::_emitParticles(eF32 deltaTime, eU32 &seed)
+{
+    ePROFILER_ZONE("Emit particles");
+
+    const eF32 emitDelay = 1.0f/m_emissionFreq;
+    m_emitTime += deltaTime;
+
+    eU32 emitCount = 0;
+    for (eF32 t=m_emitTime; t>=emitDelay; t-=emitDelay)
+        emitCount++;
+
+    // Particles exceeding the maximum are dropped.
+    const eU32 first = m_count;
+    const eU32 newCount = eMin(emitCount, PSYS_MAX_PARTICLES-m_count);
+    const eBool useEmitter = !m_emitterSampler.isEmpty();
+
+    if (useEmitter)
+        m_emitterSampler.sampleBatch(newCount, m_emitterSamples, seed);
+
+    m_emitDelays.resize(newCount+4);
+
+    eF32 *posX = m_streams[STREAM_POS_X]+first;
+    eF32 *posY = m_streams[STREAM_POS_Y]+first;
+    eF32 *posZ = m_streams[STREAM_POS_Z]+first;
+    eF32 *velX = m_streams[STREAM_VEL_X]+first;
+    eF32 *velY = m_streams[STREAM_VEL_Y]+first;
+    eF32 *velZ = m_streams[STREAM_VEL_Z]+first;
+    eF32 *ttl = m_streams[STREAM_TIME_TO_LIVE]+first;
+    eF32 *tc = m_streams[STREAM_TIME_CONSTANT]+first;
+    eF32 *mass = m_streams[STREAM_MASS]+first;
+    eF32 *size = m_streams[STREAM_SIZE]+first;
+
+    for (eU32 i=0; i<emitCount; i++) {
+        m_emitTime -= emitDelay;
+        if (i >= newCount)
+            continue;
+
+		size[i] = 1.0f * (1.0f - eRandomF(seed) * this->m_randomization);
+		mass[i] = 1.0f * (1.0f - eRandomF(seed) * this->m_randomization);
+		const eF32 initVel = m_emissionVel * (1.0f - eRandomF(seed) * this->m_randomization);
+
+        eVector3 pos, vel;
+        if (!useEmitter) {
+            pos.null();
+            vel = eVector3(eRandomF(-1.0f, 1.0f, seed), 1.0f, eRandomF(-1.0f, 1.0f, seed))*initVel;
         } else {
-            timeLeft -= PSYS_MAX_TIME_STEP;
-            time = PSYS_MAX_TIME_STEP;
+            const eSurfaceSampler::SampleBuffer &sb = m_emitterSamples;
+            pos.set(sb.posX[i], sb.posY[i], sb.posZ[i]);
+            vel.set(sb.normalX[i], sb.normalY[i], sb.normalZ[i]);
+			vel.normalize();
+			vel *= initVel;
         }
 
-        const eF32 timeNow = m_timer+time;
-
-        // Add life and delete unused particles.
-		eS32 low = 0;
-		eS32 high = m_count - 1;
-		bool upwards = true;
-		while(high >= low) {
-            Particle &p = upwards ? m_particles[low] : m_particles[high];
-            p.timeToLive -= time*p.timeConstant;
-			if(upwards) {
-				if(p.timeToLive >= 0.0f)
-					low++;
-				else
-					upwards = false;
-			} else {
-				if(p.timeToLive >= 0.0f) {
-					m_particles[low++] = p;
-					upwards = true;
-				}
-				high--;
-			}
-		}
-		m_count = high + 1;
-
-        // Calculate movement of particles.
-        _moveParticles(&m_particles[0], m_count, m_timer, time);
-
-        // Emit new particles.
-        if (m_emissionFreq > 0.0f) {
-            eF32 emitDelay = 1.0f/m_emissionFreq;
-            eF32 relTime = m_timer;
-            m_emitTime += time;
-            while (m_emitTime >= emitDelay) {
-                m_emitTime -= emitDelay;
-                eF32 timeRemaining = m_emitTime;
-                // Emit new particles.
-                if (m_count < PSYS_MAX_PARTICLES) {
-                    Particle &p = m_particles[m_count];
-                    p.rotation = 0;
-					p.size = 1.0f * (1.0f - eRandomF(seed) * this->m_randomization);
-					p.mass = 1.0f * (1.0f - eRandomF(seed) * this->m_randomization);
-					eF32 initVel = m_emissionVel * (1.0f - eRandomF(seed) * this->m_randomization);
-                    if (m_emitterMesh == eNULL || m_emitterEntities.size() == 0) {
-                        p.dynamicEntity.position.null();
-                        p.dynamicEntity.velocity = eVector3(eRandomF(-1.0f, 1.0f, seed), 1.0f, eRandomF(-1.0f, 1.0f, seed))*initVel;
-                    } else {
-                        // lookup random entity with binary search
-                        eF32 a = eRandomF(seed) * m_emitterEmitSurfaceArea;
-                        eU32 l = 0;
-                        eU32 r = m_emitterEntities.size();
-                        while (l < r) {
-                            eU32 m = (l + r) >> 1;
-                            if (a < m_emitterEntities[m])   r = m;
-                            else                            l = m+1;
-                        }
-                        eU32 f = eClamp((eU32)0, r , m_emitterEntities.size()-1);
-                        eF32 w0 = eRandomF(seed);
-						eF32 w0Inv = 1.0f - w0;
-                        switch (m_emitterMode) {
-                            case EMITTERMODE_FACES: {
-                                const eEditMesh::Face *tri = m_emitterMesh->getFace(f);
-                                eASSERT(tri != eNULL);
-								tri->getRandomSurfacePoint(p.dynamicEntity.position, p.dynamicEntity.velocity);
-                                break;
-                            }
-                            case EMITTERMODE_EDGES: {
-                                const eEditMesh::Edge *edge = m_emitterMesh->getEdge(f);
-                                eASSERT(edge != eNULL);
-								const eEditMesh::HalfEdge *he = edge->he0;
-                                if (he->face == eNULL)
-                                    he = edge->he1;
-                                const eEditMesh::Vertex *v0 = he->origin;
-                                const eEditMesh::Vertex *v1 = he->next->origin;
-								p.dynamicEntity.position = v0->position.lerp(w0, v1->position);
-								p.dynamicEntity.velocity = v0->normal.lerp(w0, v1->normal);
-                                break;
-                            }
-                            case EMITTERMODE_VERTICES: {
-                                const eEditMesh::Vertex *vtx = m_emitterMesh->getVertex(f);
-                                eASSERT(vtx != eNULL);
-                                p.dynamicEntity.position = vtx->position;
-                                p.dynamicEntity.velocity = vtx->normal;
-                                break;
-                            }
-                        }
-						p.dynamicEntity.velocity.normalize();
-						p.dynamicEntity.velocity *= initVel;
-                    }
-                        
-					const eF32 lifeTime = this->m_lifeTime * (1.0f - eRandomF(seed) * this->m_randomization);
-                    p.timeConstant = (lifeTime <= 0.0f) ? 1.0f : 1.0f / lifeTime;
-                    p.timeToLive = 1.0f - timeRemaining * p.timeConstant;
-                    _moveParticles(&p, 1, timeNow - timeRemaining, timeRemaining);
-                    m_count++;
-                }
-            }
-        }
-        m_timer = timeNow;
+        posX[i] = pos.x;
+        posY[i] = pos.y;
+        posZ[i] = pos.z;
+        velX[i] = vel.x;
+        velY[i] = vel.y;
+        velZ[i] = vel.z;
+
+		const eF32 lifeTime = this->m_lifeTime * (1.0f - eRandomF(seed) * this->m_randomization);
+        tc[i] = (lifeTime <= 0.0f) ? 1.0f : 1.0f / lifeTime;
+        ttl[i] = 1.0f - m_emitTime * tc[i];
+        m_emitDelays[i] = m_emitTime;
     }
+
+    eAABB bbox;
+    _moveParticles(first, newCount, &m_emitDelays[0], 0.0f, bbox);
+    m_boundingBox.merge(bbox);
+    m_count += newCount;
 }
 
+// Adds life to the given particles, four at a
+// time. The streams are padded, so the last group
+// can be processed completely.
+void eParticleSystem::_ageParticles(eU32 first, eU32 count, eF32 deltaTime)
+{
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    eF32 *ttl = m_streams[STREAM_TIME_TO_LIVE]+first;
+    const eF32 *tc = m_streams[STREAM_TIME_CONSTANT]+first;
 
-void eParticleSystem::setEmitter(const eEditMesh *mesh, EmitterMode mode) {
-    m_emitterMode = mode;
-    if (mesh) {
-		m_emitterMesh = mesh;
-        eASSERT(m_emitterMesh != eNULL);
-        m_emitterEmitSurfaceArea = 0.0f;
-        switch (mode) {
-            case EMITTERMODE_FACES: {
-                m_emitterEntities.resize(m_emitterMesh->getFaceCount());
-                for (eU32 i=0; i<m_emitterMesh->getFaceCount(); i++) {
-                    // Calc face area.
-                    m_emitterEmitSurfaceArea += m_emitterMesh->getFace(i)->getArea();
-                    // Add to sum.
-                    m_emitterEntities[i] = m_emitterEmitSurfaceArea;
-                }
+    for (eU32 i=0; i<count; i+=4)
+        _mm_store_ps(ttl+i, _mm_sub_ps(_mm_load_ps(ttl+i), _mm_mul_ps(dt, _mm_load_ps(tc+i))));
+}
+
+// Removes the dead particles by moving living
+// ones from the end into their places, so only
+// as many particles are copied as died. Groups
+// of four living particles are skipped at once.
+// Returns the number of living particles.
+eU32 eParticleSystem::_removeDeadParticles()
+{
+    const __m128 zero = _mm_setzero_ps();
+    const eF32 *ttl = m_streams[STREAM_TIME_TO_LIVE];
+    eU32 count = m_count;
+    eU32 i = 0;
+
+    while (eTRUE) {
+        while (i < count) {
+            if ((i&3) == 0 && i+4 <= count && _mm_movemask_ps(_mm_cmplt_ps(_mm_load_ps(ttl+i), zero)) == 0)
+                i += 4;
+            else if (ttl[i] >= 0.0f)
+                i++;
+            else
                 break;
-            }
+        }
 
-            case EMITTERMODE_EDGES: {
-                m_emitterEntities.resize(m_emitterMesh->getEdgeCount());
-                for (eU32 i=0; i<m_emitterMesh->getEdgeCount(); i++) {
-                    // Calc edge area.
-                    const eEditMesh::Edge *edge = m_emitterMesh->getEdge(i);
-                    eASSERT(edge != eNULL);
+        while (count > i && ttl[count-1] < 0.0f)
+            count--;
 
-                    eEditMesh::HalfEdge *he = edge->he0;
-                    if (he->face == eNULL)
-                        he = edge->he1;
+        if (i >= count)
+            return count;
 
-					const eF32 area = (he->origin->position - he->next->origin->position).length();
+        // Particle i is dead and the last one lives.
+        count--;
+        for (eU32 j=0; j<STREAM_COUNT; j++)
+            m_streams[j][i] = m_streams[j][count];
+        i++;
+    }
+}
 
-                    // Add to sum.
-                    m_emitterEmitSurfaceArea += area;
-                    m_emitterEntities[i] = m_emitterEmitSurfaceArea;
-                }
-                break;
-            }
+// Time step of verlet integration for four
+// particles at a time. The acceleration is the
+// constant gravity, so the new velocity doesn't
+// depend on the new position. If deltaTimes
+// isn't eNULL, it gives the time step of each
+// particle. The bounding box is extended by the
+// new positions and the ones a step later.
+void eParticleSystem::_moveParticles(eU32 first, eU32 count, const eF32 *deltaTimes, eF32 deltaTime, eAABB &bbox)
+{
+    ePROFILER_ZONE("Move particles");
 
-            case EMITTERMODE_VERTICES: {
-                m_emitterEntities.resize(m_emitterMesh->getVertexCount());
-                for (eU32 i=0; i<m_emitterMesh->getVertexCount(); i++) {
-                    m_emitterEmitSurfaceArea += 1.0f;
-                    m_emitterEntities[i] = m_emitterEmitSurfaceArea;
-                }
-                break;
+    eF32 *posX = m_streams[STREAM_POS_X]+first;
+    eF32 *posY = m_streams[STREAM_POS_Y]+first;
+    eF32 *posZ = m_streams[STREAM_POS_Z]+first;
+    eF32 *velX = m_streams[STREAM_VEL_X]+first;
+    eF32 *velY = m_streams[STREAM_VEL_Y]+first;
+    eF32 *velZ = m_streams[STREAM_VEL_Z]+first;
+
+    const __m128 accX = _mm_set1_ps(m_gravityConst->x);
+    const __m128 accY = _mm_set1_ps(m_gravityConst->y);
+    const __m128 accZ = _mm_set1_ps(m_gravityConst->z);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 step = _mm_set1_ps(PSYS_TIME_STEP);
+    const __m128 stepStepHalf = _mm_set1_ps(0.5f*PSYS_TIME_STEP*PSYS_TIME_STEP);
+    const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 big = _mm_set1_ps(eF32_MAX);
+    const __m128 small = _mm_set1_ps(eF32_MIN);
+
+    __m128 minX = big, minY = big, minZ = big;
+    __m128 maxX = small, maxY = small, maxZ = small;
+
+    for (eU32 i=0; i<count; i+=4) {
+        const __m128 dt = (deltaTimes ? _mm_loadu_ps(deltaTimes+i) : _mm_set1_ps(deltaTime));
+        const __m128 dtdtHalf = _mm_mul_ps(_mm_mul_ps(half, dt), dt);
+
+        __m128 vx = _mm_loadu_ps(velX+i);
+        __m128 vy = _mm_loadu_ps(velY+i);
+        __m128 vz = _mm_loadu_ps(velZ+i);
+
+        const __m128 px = _mm_add_ps(_mm_loadu_ps(posX+i), _mm_add_ps(_mm_mul_ps(vx, dt), _mm_mul_ps(accX, dtdtHalf)));
+        const __m128 py = _mm_add_ps(_mm_loadu_ps(posY+i), _mm_add_ps(_mm_mul_ps(vy, dt), _mm_mul_ps(accY, dtdtHalf)));
+        const __m128 pz = _mm_add_ps(_mm_loadu_ps(posZ+i), _mm_add_ps(_mm_mul_ps(vz, dt), _mm_mul_ps(accZ, dtdtHalf)));
+        vx = _mm_add_ps(vx, _mm_mul_ps(accX, dt));
+        vy = _mm_add_ps(vy, _mm_mul_ps(accY, dt));
+        vz = _mm_add_ps(vz, _mm_mul_ps(accZ, dt));
+
+        _mm_storeu_ps(posX+i, px);
+        _mm_storeu_ps(posY+i, py);
+        _mm_storeu_ps(posZ+i, pz);
+        _mm_storeu_ps(velX+i, vx);
+        _mm_storeu_ps(velY+i, vy);
+        _mm_storeu_ps(velZ+i, vz);
+
+        // Positions one step ahead, so that the box
+        // also covers particles rendered between
+        // two steps.
+        const __m128 nx = _mm_add_ps(px, _mm_add_ps(_mm_mul_ps(vx, step), _mm_mul_ps(accX, stepStepHalf)));
+        const __m128 ny = _mm_add_ps(py, _mm_add_ps(_mm_mul_ps(vy, step), _mm_mul_ps(accY, stepStepHalf)));
+        const __m128 nz = _mm_add_ps(pz, _mm_add_ps(_mm_mul_ps(vz, step), _mm_mul_ps(accZ, stepStepHalf)));
+
+        // Lanes behind the last particle must not
+        // extend the bounding box.
+        const __m128 valid = _mm_cmplt_ps(lanes, _mm_set1_ps((eF32)(count-i)));
+        minX = _mm_min_ps(minX, _mm_or_ps(_mm_and_ps(valid, _mm_min_ps(px, nx)), _mm_andnot_ps(valid, big)));
+        minY = _mm_min_ps(minY, _mm_or_ps(_mm_and_ps(valid, _mm_min_ps(py, ny)), _mm_andnot_ps(valid, big)));
+        minZ = _mm_min_ps(minZ, _mm_or_ps(_mm_and_ps(valid, _mm_min_ps(pz, nz)), _mm_andnot_ps(valid, big)));
+        maxX = _mm_max_ps(maxX, _mm_or_ps(_mm_and_ps(valid, _mm_max_ps(px, nx)), _mm_andnot_ps(valid, small)));
+        maxY = _mm_max_ps(maxY, _mm_or_ps(_mm_and_ps(valid, _mm_max_ps(py, ny)), _mm_andnot_ps(valid, small)));
+        maxZ = _mm_max_ps(maxZ, _mm_or_ps(_mm_and_ps(valid, _mm_max_ps(pz, nz)), _mm_andnot_ps(valid, small)));
+    }
+
+    if (count > 0) {
+        eF32 mins[3][4], maxs[3][4];
+        _mm_storeu_ps(mins[0], minX);
+        _mm_storeu_ps(mins[1], minY);
+        _mm_storeu_ps(mins[2], minZ);
+        _mm_storeu_ps(maxs[0], maxX);
+        _mm_storeu_ps(maxs[1], maxY);
+        _mm_storeu_ps(maxs[2], maxZ);
+
+        eVector3 vmin, vmax;
+        for (eU32 i=0; i<3; i++) {
+            vmin[i] = eMin(eMin(mins[i][0], mins[i][1]), eMin(mins[i][2], mins[i][3]));
+            vmax[i] = eMax(eMax(maxs[i][0], maxs[i][1]), eMax(maxs[i][2], maxs[i][3]));
+        }
+
+        bbox.updateExtent(vmin);
+        bbox.updateExtent(vmax);
+    }
+}
+
+// The emitter's alias table is only rebuilt if the
+// mesh or the mode changed since the last call. If
+// the geometry or the mode actually changed (not if
+// the emitter mesh was just executed again), the
+// simulation continues with the new emitter.
+void eParticleSystem::setEmitter(const eEditMesh *mesh, EmitterMode mode) {
+    m_emitterMode = mode;
+    if (mesh) {
+        if (m_emitterSampler.update(*mesh, (eSurfaceSampler::Mode)mode)) {
+            const eU32 hash = _hashEmitter(*mesh, mode);
+            if (hash != m_emitterHash) {
+                m_emitterHash = hash;
+                m_emitterChanged = eTRUE;
             }
         }
+    } else if (!m_emitterSampler.isEmpty()) {
+        m_emitterSampler.clear();
+        m_emitterHash = 0;
+        m_emitterChanged = eTRUE;
     }
 }
 
-void eParticleSystem::_moveParticles(Particle *particles, eU32 count, eF32 nowTime, eF32 deltaTime)
-{
-    ePROFILER_ZONE("Move particles");
+// Hashes everything the surface sampler reads from
+// the emitter mesh: the vertices, the faces with
+// their vertex loops and the sampling mode.
+eU32 eParticleSystem::_hashEmitter(const eEditMesh &mesh, EmitterMode mode) {
+    eU32 hash = eHashInt((eInt)mode+1);
 
-	const eF32 dtHalf = 0.5f * deltaTime;
-	const eF32 dtdtHalf = dtHalf * deltaTime;
-    for (eU32 i=0; i<count; i++) {
-        // Time step of verlet integration.
-        Particle &p = particles[i];
+    const eVector3Array &positions = mesh.getPositions();
+    const eVector3Array &normals = mesh.getNormals();
 
-		__m128 pos = _mm_loadu_ps(p.dynamicEntity.position);
-		const __m128 oldAccel = _calcAcceleration(p.mass, pos);
+    for (eU32 i=0; i<mesh.getVertexCount(); i++) {
+        const eF32 values[6] = {
+            positions[i].x, positions[i].y, positions[i].z,
+            normals[i].x, normals[i].y, normals[i].z
+        };
 
-		__m128 vel = _mm_loadu_ps(p.dynamicEntity.velocity);
-		pos = _mm_add_ps(pos, _mm_mul_ps(vel, _mm_set1_ps(deltaTime)));
-		pos = _mm_add_ps(pos, _mm_mul_ps(oldAccel, _mm_set1_ps(dtdtHalf)));
+        for (eU32 j=0; j<6; j++)
+            hash = eHashInt((eInt)(hash^eFtoDW(values[j])));
+    }
 
-		const __m128 newAccel = _calcAcceleration(p.mass, pos);
-		vel = _mm_add_ps(vel, _mm_mul_ps(_mm_set1_ps(dtHalf), _mm_add_ps(newAccel, oldAccel)));
+    for (eU32 i=0; i<mesh.getFaceCount(); i++) {
+        const eEditMesh::Face *face = mesh.getFace(i);
+        const eF32 values[3] = { face->normal.x, face->normal.y, face->normal.z };
 
-		_mm_storeu_ps(&p.dynamicEntity.position.x, pos);
-		_mm_storeu_ps(&p.dynamicEntity.velocity.x, vel);
+        for (eU32 j=0; j<3; j++)
+            hash = eHashInt((eInt)(hash^eFtoDW(values[j])));
 
-        m_boundingBox.updateExtent(p.dynamicEntity.position);
+        const eEditMesh::HalfEdge *he = face->he;
+        do {
+            hash = eHashInt((eInt)(hash^he->origin->index));
+            he = he->next;
+        } while (he != face->he);
     }
+
+    // Zero is reserved for "no emitter".
+    return (hash == 0 ? 1 : hash);
 }
 
 void eParticleSystem::_fillDynamicBuffers(ePtr param, eGeometry *geo) {
     const eParticleSystem *psys = (eParticleSystem *)param;
     eASSERT(psys != eNULL);
 
-    eVector3 right, up, view;
-    geo->getGraphics()->getBillboardVectors(right, up, &view);
+    ePROFILER_ZONE("Fill particle buffers");
+
+    FillJob job;
+    job.psys = psys;
+
+    geo->getGraphics()->getBillboardVectors(job.right, job.up, &job.view);
 	eMatrix4x4 mat = geo->getGraphics()->getActiveModelMatrix();
-	view = mat * view;
-	right = mat * right;
-	up = mat * up;
-
-	view.normalize();
-	right.normalize();
-	up.normalize();
-
-	eParticleVertex *vertices = eNULL;
-    eU32 *indices = eNULL;
-    eU32 idxCount=0, vtxCount=0, primCount=0;
-    geo->startFilling((ePtr *)&vertices, &indices);
-    {
-		for (eU32 i=0; i<psys->m_count; i++) {
-            const Particle &p = psys->m_particles[i];
-
-            eF32 ptime = 1.0f-p.timeToLive;
-			eColor col = eColor::WHITE;
-            eF32 scale = psys->m_pathSampler[SIZE] == eNULL ? eSin(p.timeToLive * ePI) : 
-                                                            *psys->m_pathSampler[SIZE]->evaluate(ptime);
-			if (psys->m_pathSampler[COLOR]) {
-				const eVector4 &res = psys->m_pathSampler[COLOR]->evaluate(ptime);
-				col.setRedF(res.x);
-				col.setGreenF(res.y);
-				col.setBlueF(res.z);
-				col.setAlphaF(res.x);
-			} else 
-				col.setAlphaF(eClamp(0.0f, eSin(p.timeToLive * ePI), 1.0f));
-			scale *= p.size;
-            eF32 rot = psys->m_pathSampler[ROTATION] == eNULL ? 0.0f : 
-                                                         *psys->m_pathSampler[ROTATION]->evaluate(ptime);
-
-            eVector3 r = right * scale;
-            eVector3 u = up * scale;
-            eVector3 pos2 = p.dynamicEntity.position;
-            if(psys->m_stretchAmount != 0.0f) 
-			{
-                eVector3 flyDir = p.dynamicEntity.velocity;
-				const eVector3 velNorm = p.dynamicEntity.velocity.normalized();
-                const eF32 rightCos = view*velNorm;
-                const eQuat qr(view, rot);
-                const eQuat qr90(view, -eHALFPI);
-                r = -((velNorm * qr90)*qr) * scale;
-                u = (velNorm * qr) * scale;
-                pos2 = p.dynamicEntity.position+p.dynamicEntity.velocity*psys->m_stretchAmount;
-            } else 
-				if(rot != 0) {
-					r = (r * eQuat(view, rot));
-					u = (u * eQuat(view, rot));
-				}
-
-			const eVector3 mid = (p.dynamicEntity.position + pos2) * 0.5f;
-
-            vertices[vtxCount+0].set(pos2                     + u, eVector2(0.0f, 0.0f), col);
-            vertices[vtxCount+1].set(mid                      + r, eVector2(1.0f, 0.0f), col);
-            vertices[vtxCount+2].set(p.dynamicEntity.position - u, eVector2(1.0f, 1.0f), col);
-            vertices[vtxCount+3].set(mid                      - r, eVector2(0.0f, 1.0f), col);
-
-			indices[idxCount++] = vtxCount+0;
-            indices[idxCount++] = vtxCount+1;
-            indices[idxCount++] = vtxCount+2;
-            indices[idxCount++] = vtxCount+0;
-            indices[idxCount++] = vtxCount+2;
-            indices[idxCount++] = vtxCount+3;
-
-            vtxCount += 4;
-            primCount += 2;
-        }
+	job.view = mat * job.view;
+	job.right = mat * job.right;
+	job.up = mat * job.up;
+
+	job.view.normalize();
+	job.right.normalize();
+	job.up.normalize();
+
+    // Every particle is a quad, so the vertices and
+    // indices of each chunk of particles are known
+    // and the chunks can be filled in parallel.
+    geo->startFilling((ePtr *)&job.vertices, &job.indices);
+    const eU32 chunkCount = (psys->m_count+PARTICLES_PER_JOB-1)/PARTICLES_PER_JOB;
+    eThreadPool::get().parallelFor(_fillJob, &job, chunkCount);
+    geo->stopFilling(eTRUE, psys->m_count*4, psys->m_count*6, psys->m_count*2);
+}
+
+void eParticleSystem::_fillJob(ePtr arg, eU32 index) {
+    const FillJob &job = *(const FillJob *)arg;
+    const eParticleSystem *psys = job.psys;
+    const eU32 first = index*PARTICLES_PER_JOB;
+    const eU32 last = eMin(first+PARTICLES_PER_JOB, psys->m_count);
+
+    const eF32 *posX = psys->m_streams[STREAM_POS_X];
+    const eF32 *posY = psys->m_streams[STREAM_POS_Y];
+    const eF32 *posZ = psys->m_streams[STREAM_POS_Z];
+    const eF32 *velX = psys->m_streams[STREAM_VEL_X];
+    const eF32 *velY = psys->m_streams[STREAM_VEL_Y];
+    const eF32 *velZ = psys->m_streams[STREAM_VEL_Z];
+    const eF32 *ttl = psys->m_streams[STREAM_TIME_TO_LIVE];
+    const eF32 *tc = psys->m_streams[STREAM_TIME_CONSTANT];
+    const eF32 *size = psys->m_streams[STREAM_SIZE];
+    const eVector3 &view = job.view;
+
+    // Move the particles from the last simulated
+    // step to the requested time, like a partial
+    // time step would.
+    const eF32 dt = psys->m_stepFraction;
+    const eVector3 &acc = *psys->m_gravityConst;
+    const eVector3 accMove = acc*(0.5f*dt*dt);
+    const eVector3 accVel = acc*dt;
+
+    for (eU32 i=first; i<last; i++) {
+        const eVector3 oldVelocity(velX[i], velY[i], velZ[i]);
+        const eVector3 position = eVector3(posX[i], posY[i], posZ[i])+oldVelocity*dt+accMove;
+        const eVector3 velocity = oldVelocity+accVel;
+        const eF32 life = eMax(0.0f, ttl[i]-dt*tc[i]);
+
+        eF32 ptime = 1.0f-life;
+		eColor col = eColor::WHITE;
+        eF32 scale = psys->m_pathSampler[SIZE] == eNULL ? eSin(life * ePI) : 
+                                                        *psys->m_pathSampler[SIZE]->evaluate(ptime);
+		if (psys->m_pathSampler[COLOR]) {
+			const eVector4 &res = psys->m_pathSampler[COLOR]->evaluate(ptime);
+			col.setRedF(res.x);
+			col.setGreenF(res.y);
+			col.setBlueF(res.z);
+			col.setAlphaF(res.x);
+		} else 
+			col.setAlphaF(eClamp(0.0f, eSin(life * ePI), 1.0f));
+		scale *= size[i];
+        eF32 rot = psys->m_pathSampler[ROTATION] == eNULL ? 0.0f : 
+                                                     *psys->m_pathSampler[ROTATION]->evaluate(ptime);
+
+        eVector3 r = job.right * scale;
+        eVector3 u = job.up * scale;
+        eVector3 pos2 = position;
+        if(psys->m_stretchAmount != 0.0f) 
+		{
+			const eVector3 velNorm = velocity.normalized();
+            const eQuat qr(view, rot);
+            const eQuat qr90(view, -eHALFPI);
+            r = -((velNorm * qr90)*qr) * scale;
+            u = (velNorm * qr) * scale;
+            pos2 = position+velocity*psys->m_stretchAmount;
+        } else 
+			if(rot != 0) {
+				r = (r * eQuat(view, rot));
+				u = (u * eQuat(view, rot));
+			}
+
+		const eVector3 mid = (position + pos2) * 0.5f;
+        const eU32 vtxIndex = i*4;
+        eParticleVertex *vertices = job.vertices+vtxIndex;
+        eU32 *indices = job.indices+i*6;
+
+        vertices[0].set(pos2     + u, eVector2(0.0f, 0.0f), col);
+        vertices[1].set(mid      + r, eVector2(1.0f, 0.0f), col);
+        vertices[2].set(position - u, eVector2(1.0f, 1.0f), col);
+        vertices[3].set(mid      - r, eVector2(0.0f, 1.0f), col);
+
+		indices[0] = vtxIndex+0;
+        indices[1] = vtxIndex+1;
+        indices[2] = vtxIndex+2;
+        indices[3] = vtxIndex+0;
+        indices[4] = vtxIndex+2;
+        indices[5] = vtxIndex+3;
     }
-    geo->stopFilling(eTRUE, vtxCount, idxCount, primCount);
-}
\ No newline at end of file
+}
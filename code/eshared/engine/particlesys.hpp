@@ -14,8 +14,10 @@
 #ifndef PARTICLE_SYS_HPP
 #define PARTICLE_SYS_HPP
 
-#define PSYS_MAX_PARTICLES 20000
-#define PSYS_MAX_TIME_STEP (1.0f/30.0f)
+#define PSYS_MAX_PARTICLES 200000
+#define PSYS_TIME_STEP (1.0f/60.0f)
+#define PSYS_SNAPSHOT_INTERVAL 1.0f
+#define PSYS_SNAPSHOT_BUDGET (32*1024*1024)
 
 class eParticleSystem
 {
@@ -36,6 +38,7 @@ public:
         mutable eMaterial       m_mat;
     };
 
+    // Same order as the modes of eSurfaceSampler.
     enum EmitterMode {
         EMITTERMODE_FACES,
         EMITTERMODE_EDGES,
@@ -49,27 +52,29 @@ public:
 		__PATHSAMPLERSIZE__ = 3,
 	};
 
-    struct DynamicEntity {
-        eVector3            position;   // [m]
-        eVector3            velocity;   // [m/s]
+    // Particles are stored as structure of arrays,
+    // so that they can be processed four at a time.
+    // Each stream is padded by four particles.
+    enum Stream {
+        STREAM_POS_X,           // [m]
+        STREAM_POS_Y,
+        STREAM_POS_Z,
+        STREAM_VEL_X,           // [m/s]
+        STREAM_VEL_Y,
+        STREAM_VEL_Z,
+        STREAM_TIME_TO_LIVE,    // (0..1]
+        STREAM_TIME_CONSTANT,   // 1/ttl_max
+        STREAM_MASS,
+        STREAM_SIZE,
+        STREAM_COUNT
     };
 
-    struct Particle {
-        DynamicEntity       dynamicEntity;
-        eF32                timeToLive;     // (0..1]
-        eF32                timeConstant;   // 1/ttl_max
-        eF32                rotation;
-		eF32				mass;
-		eF32				size;
-    };
-
-    typedef eArray<Particle> ParticleArray;
-
 public:
     eParticleSystem();
     ~eParticleSystem();
 
     void                    update(eF32 time);
+    eU32                    getSnapshotMemory() const;
 	void					init(eGraphicsApiDx9 * gfx);
 	void                    setEmitter(const eEditMesh *mesh, EmitterMode mode);
     EmitterMode             m_emitterMode;
@@ -81,23 +86,24 @@ public:
     eF32                    m_stretchAmount;
     eF32                    m_gravity;
 	eVector3*				m_gravityConst;
+    eU32                    m_seed;         // Decorrelates systems with equal settings.
 
 //    static const eF32       MAX_TIME_STEP;
     eGraphicsApiDx9 *         m_gfx;
     eGeometry *             m_geometry;
-    ParticleArray           m_particles;
+    eF32 *                  m_streams[STREAM_COUNT];
     eAABB                   m_boundingBox;
 
     eF32                    m_lastTime;
-    eF32                    m_timer;
+    eU32                    m_step;
+    eF32                    m_stepFraction; // Time rendered past the last step.
     eF32                    m_emitTime;
     eU32                    m_count;
 
 	ePathSampler*			m_pathSampler[__PATHSAMPLERSIZE__];
 
-    const eEditMesh *       m_emitterMesh;
-    eF32                    m_emitterEmitSurfaceArea;
-    eArray<eF32>            m_emitterEntities;
+    eSurfaceSampler         m_emitterSampler;
+    eSurfaceSampler::SampleBuffer m_emitterSamples;
 
 
     eBlendMode              m_blendSrc;
@@ -105,13 +111,82 @@ public:
     eBlendOp                m_blendOp;
 
 private:
-    __forceinline __m128 _calcAcceleration(eF32 mass, const __m128 pos) const {
-		__m128 result = _mm_load_ps(&this->m_gravityConst->x);
-		return result;
-	}
+    // Parameters the simulation depends on. If they
+    // change, the simulation continues with the new
+    // values from the current step on.
+    struct Settings {
+        eF32                emissionFreq;
+        eF32                emissionVel;
+        eF32                lifeTime;
+        eF32                randomization;
+        eVector3            gravity;
+        eU32                seed;
+    };
+
+    // State of the simulation after a step. Only
+    // the living particles are stored (count
+    // floats of each stream).
+    struct Snapshot {
+        eU32                step;
+        eU32                count;
+        eF32                emitTime;
+        eAABB               boundingBox;
+        eArray<eF32>        data;
+    };
+
+    typedef eArray<Snapshot *> SnapshotPtrArray;
+
+    struct UpdateJob {
+        eParticleSystem *   psys;
+        eF32                deltaTime;
+    };
+
+    struct FillJob {
+        const eParticleSystem * psys;
+        eParticleVertex *   vertices;
+        eU32 *              indices;
+        eVector3            right;
+        eVector3            up;
+        eVector3            view;
+    };
 
-    void                    _moveParticles(Particle *particles, eU32 count, eF32 nowTime, eF32 deltaTime);
+private:
+    void                    _seek(eU32 step);
+    void                    _simulateStep();
+    void                    _resetSimulation();
+    void                    _takeSnapshot();
+    void                    _restoreSnapshot(const Snapshot &snapshot);
+    void                    _removeSnapshot(eU32 index);
+    void                    _removeSnapshotsAfter(eU32 step);
+    void                    _freeSnapshots();
+    eInt                    _findSnapshot(eU32 step) const;
+    void                    _updateParticles(eF32 deltaTime);
+    void                    _emitParticles(eF32 deltaTime, eU32 &seed);
+    void                    _ageParticles(eU32 first, eU32 count, eF32 deltaTime);
+    eU32                    _removeDeadParticles();
+    void                    _moveParticles(eU32 first, eU32 count, const eF32 *deltaTimes, eF32 deltaTime, eAABB &bbox);
+
+    static eU32             _hashEmitter(const eEditMesh &mesh, EmitterMode mode);
+
+    static void             _ageJob(ePtr arg, eU32 index);
+    static void             _moveJob(ePtr arg, eU32 index);
+    static void             _fillJob(ePtr arg, eU32 index);
     static void             _fillDynamicBuffers(ePtr param, eGeometry *geo);
+
+private:
+    static const eU32       PARTICLES_PER_JOB = 4096;
+
+private:
+    eArray<eAABB>           m_chunkBoxes;
+    eArray<eF32>            m_emitDelays;   // Time to move each emitted particle.
+
+    Settings                m_settings;
+    eU32                    m_settingsStep; // First step simulated with m_settings.
+    eBool                   m_emitterChanged;
+    eU32                    m_emitterHash;
+    SnapshotPtrArray        m_snapshots;    // Sorted by step.
+    eU32                    m_snapshotInterval; // In steps.
+    eU32                    m_snapshotBytes;
 };
 
 #endif // PARTICLE_SYS_HPP
\ No newline at end of file
@@ -124,20 +124,42 @@ eU32 eSceneData::getRenderableTotal() const
 	return this->m_renderableTotal;
 }
 
-void eSceneData::convertToMeshOrCount(eU32& verticeCount, eU32& faceCount, eMatrix4x4& mat, eMesh* targetMesh) const {
-    for(eU32 i = 0; i < getEntryCount(); i++) {
-        const eSceneData::Entry& e = getEntry(i);
-        if(e.renderableList != eNULL) {
-            e.renderableList->convertToMeshOrCount(verticeCount, faceCount, mat * e.matrix, targetMesh);
-        } else if(e.renderableObject->getType() == eIRenderable::TYPE_MESH) {
-            const eMesh::Instance& mi = (const eMesh::Instance&)*e.renderableObject;
-            const eMesh& m = mi.getMesh();
-            if(targetMesh)
-                targetMesh->merge(m, mat, mat.toRotationMatrix());
-
-            verticeCount += m.getVertexCount();
-            faceCount += m.getPrimitiveCount();
+// Gathers all meshes below this scene data with
+// their world matrices, so that they can be merged
+// in one go instead of walking the tree per mesh.
+void eSceneData::flattenMeshes(MeshInstanceArray &instances, const eMatrix4x4 &mtx) const
+{
+    for (eU32 i=0; i<m_entries.size(); i++)
+    {
+        const Entry &e = m_entries[i];
+        const eMatrix4x4 entryMtx = e.matrix*mtx;
+
+        if (e.renderableList != eNULL)
+        {
+            e.renderableList->flattenMeshes(instances, entryMtx);
         }
+        else if (e.renderableObject->getType() == eIRenderable::TYPE_MESH)
+        {
+            MeshInstance inst;
+
+            inst.matrix = entryMtx;
+            inst.normalMatrix = entryMtx.toRotationMatrix();
+            inst.mesh = &((const eMesh::Instance *)e.renderableObject)->getMesh();
+
+            instances.append(inst);
+        }
+    }
+}
+
+void eSceneData::convertToMeshOrCount(eU32& verticeCount, eU32& faceCount, const eMatrix4x4& mat, eMesh* targetMesh) const {
+    MeshInstanceArray instances;
+    flattenMeshes(instances, mat);
+
+    for(eU32 i = 0; i < instances.size(); i++) {
+        verticeCount += instances[i].mesh->getVertexCount();
+        faceCount += instances[i].mesh->getPrimitiveCount();
     }
 
+    if(targetMesh && instances.size() > 0)
+        targetMesh->mergeInstances(&instances[0], instances.size());
 }
@@ -18,7 +18,7 @@ class eMesh;
 class eSceneData
 {
 public:
-    __declspec(align(16)) struct Entry
+    struct eALIGN16 Entry
     {
         eMatrix4x4              matrix;
         eAABB                   aabb;
@@ -27,6 +27,17 @@ public:
         eU32                    renderableCount;
     };
 
+    // Mesh with its accumulated world matrix,
+    // as gathered when flattening scene data.
+    struct MeshInstance
+    {
+        eMatrix4x4              matrix;
+        eMatrix4x4              normalMatrix;
+        const eMesh *           mesh;
+    };
+
+    typedef eArray<MeshInstance> MeshInstanceArray;
+
 public:
     eSceneData();
 
@@ -43,7 +54,8 @@ public:
     eU32                    getLightCount() const;
     const eLight &          getLight(eU32 index) const;
     eU32                    getRenderableTotal() const;
-    void                    convertToMeshOrCount(eU32& verticeCount, eU32& faceCount, eMatrix4x4& mtx = eMatrix4x4(), eMesh* tagetMesh = eNULL) const;
+    void                    flattenMeshes(MeshInstanceArray &instances, const eMatrix4x4 &mtx=eMatrix4x4()) const;
+    void                    convertToMeshOrCount(eU32& verticeCount, eU32& faceCount, const eMatrix4x4& mtx = eMatrix4x4(), eMesh* tagetMesh = eNULL) const;
 
 private:
 
@@ -18,7 +18,7 @@
 eGraphicsApiDx9 *                     eShaderManager::m_gfx = eNULL;
 eShaderManager::ShaderEntryPtrArray eShaderManager::m_shaders;
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
 eString                             eShaderManager::m_shaderFolder("../code/eshared/engine/shaders/");
 #endif
 
@@ -30,7 +30,7 @@ void eShaderManager::initialize(eGraphicsApiDx9 *gfx)
 
 void eShaderManager::update()
 {
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
     for (eU32 i=0; i<m_shaders.size(); i++)
     {
         _reloadIfShaderChanged(*m_shaders[i]);
@@ -49,7 +49,7 @@ void eShaderManager::shutdown()
     m_shaders.clear();
 }
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
 void eShaderManager::setShaderFolder(const eString &shaderFolder)
 {
     m_shaderFolder = shaderFolder;
@@ -189,7 +189,7 @@ eIShader * eShaderManager::_findShader(eU32 hash)
     return eNULL;
 }
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
 #include <sys/stat.h>
 
 void eShaderManager::_reloadIfShaderChanged(ShaderEntry &se)
@@ -204,9 +204,15 @@ void eShaderManager::_reloadIfShaderChanged(ShaderEntry &se)
 
 eS64 eShaderManager::_getFileChangedTime(const eString &fileName)
 {
+#ifdef _WIN32
     struct _stat stat;
 
     if (_stat(fileName, &stat) == 0)
+#else
+    struct stat stat;
+
+    if (::stat(fileName, &stat) == 0)
+#endif
     {
         return stat.st_mtime;
     }
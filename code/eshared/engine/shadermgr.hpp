@@ -15,8 +15,14 @@
 #define SHADER_MANAGER_HPP
 
 // In editor load shaders from file (for live editing),
-// in player load shaders from arrays (for size).
-#ifdef eDEBUG
+// in player load shaders from arrays (for size). The
+// null graphics API ignores the shader code, so it
+// goes without the compiled shader headers.
+#if defined(eDEBUG) || defined(eNULL_GFX)
+    #define eSHADERS_FROM_FILES
+#endif
+
+#ifdef eSHADERS_FROM_FILES
     #define ePS(name) #name
     #define eVS(name) #name
 #else
@@ -39,7 +45,7 @@ private:
         eIShader *              shader;
         eU32                    hash;
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
         eString                 filePath;
         eS64                    lastTime;
 #endif
@@ -52,7 +58,7 @@ public:
     static void                 update();
     static void                 shutdown();
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
     static void                 setShaderFolder(const eString &shaderFolder);
 
     static eIPixelShader *      loadPixelShader(const eString &fileName);
@@ -65,7 +71,7 @@ public:
 private:
     static eIShader *           _findShader(eU32 hash);
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
     static void                 _reloadIfShaderChanged(ShaderEntry &se);
     static eS64                 _getFileChangedTime(const eString &fileName);
 #endif
@@ -74,7 +80,7 @@ private:
     static ShaderEntryPtrArray  m_shaders;
     static eGraphicsApiDx9 *      m_gfx;
 
-#ifdef eDEBUG
+#ifdef eSHADERS_FROM_FILES
     static eString              m_shaderFolder;
 #endif
 };
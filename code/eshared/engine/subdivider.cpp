@@ -0,0 +1,457 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "../system/system.hpp"
+#include "../math/math.hpp"
+#include "engine.hpp"
+
+#if defined(eUSE_SSE) && defined(_WIN32)
+#include <intrin.h>
+#endif
+
+eSubdivider::eSubdivider() :
+    m_inputCount(0),
+    m_resultVertexCount(0),
+    m_resultFaceCount(0)
+{
+}
+
+// Rebuilds the refined topology into the result
+// mesh and the stencils, if the topology of the
+// input mesh or the number of levels changed or
+// the result mesh was modified. Returns eTRUE if
+// anything was rebuilt. Vertex positions of the
+// result mesh are only valid after evaluate().
+eBool eSubdivider::refine(const eEditMesh &mesh, eU32 levels, eEditMesh &result)
+{
+    ePROFILER_ZONE("Subdivision refine");
+    eASSERT(levels > 0);
+
+    eArray<eU32> signature;
+    _buildSignature(mesh, levels, signature);
+
+    if (signature.size() == m_signature.size() &&
+        eMemEqual(&signature[0], &m_signature[0], signature.size()*sizeof(eU32)) &&
+        result.getVertexCount() == m_resultVertexCount &&
+        result.getFaceCount() == m_resultFaceCount)
+    {
+        return eFALSE;
+    }
+
+    m_signature = signature;
+    m_weights.clear();
+    m_stencils.clear();
+    m_phases.clear();
+    m_points.clear();
+    m_faceOrigins.resize(mesh.getFaceCount());
+
+    for (eU32 i=0; i<mesh.getFaceCount(); i++)
+    {
+        m_faceOrigins[i] = i;
+    }
+
+    m_inputCount = mesh.getVertexCount();
+    m_points.resize(m_inputCount);
+    m_stencils.append(0);
+
+    // Intermediate levels are only needed to
+    // build the next level's topology.
+    eEditMesh levelMeshes[2];
+    const eEditMesh *src = &mesh;
+    eU32 srcFirst = 0;
+
+    for (eU32 i=0; i<levels; i++)
+    {
+        eEditMesh *dst = (i == levels-1 ? &result : &levelMeshes[i&1]);
+        const eU32 dstFirst = m_points.size();
+
+        dst->clear();
+        _refineLevel(*src, srcFirst, *dst);
+
+        src = dst;
+        srcFirst = dstFirst;
+    }
+
+    m_resultVertexCount = result.getVertexCount();
+    m_resultFaceCount = result.getFaceCount();
+    eASSERT(m_points.size() == srcFirst+m_resultVertexCount);
+    eASSERT(m_faceOrigins.size() == m_resultFaceCount);
+
+    return eTRUE;
+}
+
+// Calculates the vertices of the result mesh by
+// evaluating the stencils level by level. The
+// input mesh must have the topology the result
+// was refined for.
+void eSubdivider::evaluate(const eEditMesh &mesh, eF32 smoothness, eEditMesh &result)
+{
+    ePROFILER_ZONE("Subdivision evaluate");
+
+    eASSERT(mesh.getVertexCount() == m_inputCount);
+    eASSERT(result.getVertexCount() == m_resultVertexCount);
+    eASSERT(result.getFaceCount() == m_resultFaceCount);
+
+    const eVector3Array &positions = mesh.getPositions();
+    const eVector2Array &texCoords = mesh.getTexCoords();
+
+    for (eU32 i=0; i<m_inputCount; i++)
+    {
+        Point &p = m_points[i];
+        p.pos[0] = positions[i].x;
+        p.pos[1] = positions[i].y;
+        p.pos[2] = positions[i].z;
+        p.pos[3] = 0.0f;
+        p.uv[0] = texCoords[i].x;
+        p.uv[1] = texCoords[i].y;
+        p.uv[2] = 0.0f;
+        p.uv[3] = 0.0f;
+    }
+
+    for (eU32 i=0; i<m_phases.size(); i++)
+    {
+        const Phase &phase = m_phases[i];
+
+        EvalJob job;
+        job.subdiv = this;
+        job.first = phase.first;
+        job.last = phase.first+phase.count;
+        job.smoothness = smoothness;
+
+        eThreadPool::get().parallelFor(_evalJob, &job, (phase.count+POINTS_PER_JOB-1)/POINTS_PER_JOB);
+    }
+
+    // Copy points of last level to result mesh.
+    const eU32 firstPoint = m_points.size()-m_resultVertexCount;
+    eVector3Array &resultPositions = result.getPositions();
+    eVector2Array &resultTexCoords = result.getTexCoords();
+
+    for (eU32 i=0; i<m_resultVertexCount; i++)
+    {
+        const Point &p = m_points[firstPoint+i];
+
+        resultPositions[i].set(p.pos[0], p.pos[1], p.pos[2]);
+        resultTexCoords[i].set(p.uv[0], p.uv[1]);
+    }
+
+    // Materials aren't part of the topology.
+    for (eU32 i=0; i<m_resultFaceCount; i++)
+    {
+        result.getFace(i)->material = mesh.getFace(m_faceOrigins[i])->material;
+    }
+
+    result.setChanged();
+}
+
+// Does one Catmull-Clark step. For every face, edge
+// and vertex of the source level a point is added
+// (in this order) and for every source face corner
+// a quad. The weights match the ones of the former
+// direct implementation of the subdivide operator:
+// new edge and vertex points are blended between
+// their linearly interpolated and smoothed positions
+// and vertex points are smoothed using the already
+// smoothed edge points.
+void eSubdivider::_refineLevel(const eEditMesh &src, eU32 srcFirst, eEditMesh &dst)
+{
+    const eU32 faceCount = src.getFaceCount();
+    const eU32 edgeCount = src.getEdgeCount();
+    const eU32 firstFacePt = m_points.size();
+    const eU32 firstEdgePt = firstFacePt+faceCount;
+    const eU32 firstVtxPt = firstEdgePt+edgeCount;
+
+    // Face points are the centers of the faces.
+    for (eU32 i=0; i<faceCount; i++)
+    {
+        const eEditMesh::Face *face = src.getFace(i);
+        eASSERT(face != eNULL);
+
+        const eF32 weight = 1.0f/(eF32)face->getEdgeCount();
+        const eEditMesh::HalfEdge *he = face->he;
+
+        do
+        {
+            _addWeight(srcFirst+he->origin->index, weight, 0.0f);
+            he = he->next;
+        }
+        while (he != face->he);
+
+        m_stencils.append(m_weights.size());
+    }
+
+    _addPoints(faceCount);
+
+    // Edge points are the middle of the edges,
+    // smoothed by the adjacent face points.
+    for (eU32 i=0; i<edgeCount; i++)
+    {
+        const eEditMesh::Edge *edge = src.getEdge(i);
+        eASSERT(edge != eNULL);
+        eASSERT(edge->he0->face != eNULL);
+
+        const eU32 endPt0 = srcFirst+edge->he0->origin->index;
+        const eU32 endPt1 = srcFirst+edge->he1->origin->index;
+
+        if (!edge->isBoundary() && edge->he1->face)
+        {
+            _addWeight(endPt0, 0.5f, -0.25f);
+            _addWeight(endPt1, 0.5f, -0.25f);
+            _addWeight(firstFacePt+edge->he0->face->index, 0.0f, 0.25f);
+            _addWeight(firstFacePt+edge->he1->face->index, 0.0f, 0.25f);
+        }
+        else
+        {
+            _addWeight(endPt0, 0.5f, 0.0f);
+            _addWeight(endPt1, 0.5f, 0.0f);
+        }
+
+        m_stencils.append(m_weights.size());
+    }
+
+    _addPoints(edgeCount);
+
+    // Vertex points are the original vertices,
+    // smoothed by the surrounding edge and face
+    // points. Vertices without any faces vanish.
+    eArray<eU32> vtxPoints(src.getVertexCount());
+    eU32 vtxPtCount = 0;
+
+    for (eU32 i=0; i<src.getVertexCount(); i++)
+    {
+        const eEditMesh::Vertex *vtx = src.getVertex(i);
+        eASSERT(vtx != eNULL);
+
+        if (vtx->he == eNULL)
+        {
+            continue;
+        }
+
+        const eEditMesh::HalfEdge *he = vtx->he;
+
+        if (!vtx->isBoundary())
+        {
+            eU32 valence = 0;
+
+            do
+            {
+                valence++;
+                he = he->twin->next;
+            }
+            while (he != vtx->he);
+
+            const eF32 weight = 1.0f/(eF32)(valence*valence);
+
+            _addWeight(srcFirst+i, 1.0f, -2.0f/(eF32)valence);
+
+            do
+            {
+                _addWeight(firstEdgePt+he->edge->index, 0.0f, weight);
+
+                if (he->face)
+                {
+                    _addWeight(firstFacePt+he->face->index, 0.0f, weight);
+                }
+
+                he = he->twin->next;
+            }
+            while (he != vtx->he);
+        }
+        else
+        {
+            _addWeight(srcFirst+i, 1.0f, -0.25f);
+
+            do
+            {
+                if (he->edge->isBoundary())
+                {
+                    _addWeight(firstEdgePt+he->edge->index, 0.0f, 0.125f);
+                }
+
+                he = he->twin->next;
+            }
+            while (he != vtx->he);
+        }
+
+        m_stencils.append(m_weights.size());
+        vtxPoints[i] = vtxPtCount++;
+    }
+
+    _addPoints(vtxPtCount);
+
+    // Build topology of the new level. Its vertices
+    // correspond to the points added above.
+    const eU32 newVtxCount = faceCount+edgeCount+vtxPtCount;
+
+    dst.reserveSpace(newVtxCount, faceCount*src.getMaxFaceValence());
+
+    for (eU32 i=0; i<newVtxCount; i++)
+    {
+        dst.addVertex(eVector3());
+    }
+
+    eArray<eU32> faceOrigins;
+    faceOrigins.reserve(edgeCount*2);
+
+    for (eU32 i=0; i<faceCount; i++)
+    {
+        const eEditMesh::Face *face = src.getFace(i);
+        const eEditMesh::HalfEdge *he = face->he;
+
+        do
+        {
+            const eEditMesh::HalfEdge *he0 = he;
+            const eEditMesh::HalfEdge *he1 = he->next;
+            const eEditMesh::HalfEdge *he2 = he->next->next;
+            const eEditMesh::HalfEdge *he3 = he->next->next->next;
+
+            eEditMesh::Vertex *verts[4] =
+            {
+                dst.getVertex(faceCount+edgeCount+vtxPoints[he->origin->index]),
+                dst.getVertex(faceCount+he->edge->index),
+                dst.getVertex(face->index),
+                dst.getVertex(faceCount+he->prev->edge->index)
+            };
+
+            const eVector2 texCoords[4] =
+            {
+                he0->texCoord,
+                (he0->texCoord+he1->texCoord)*0.5f,
+                (he0->texCoord+he1->texCoord+he2->texCoord+he3->texCoord)*0.25f,
+                (he3->texCoord+he0->texCoord)*0.5f
+            };
+
+            dst.addFace(verts, texCoords, 4)->material = face->material;
+            faceOrigins.append(m_faceOrigins[i]);
+            he = he->next;
+        }
+        while (he != face->he);
+    }
+
+    m_faceOrigins = faceOrigins;
+}
+
+void eSubdivider::_addWeight(eU32 src, eF32 base, eF32 delta)
+{
+    eASSERT(src < m_points.size());
+
+    Weight &w = m_weights.push();
+    w.src = src;
+    w.base = base;
+    w.delta = delta;
+}
+
+// Appends the points of a phase, whose stencils
+// have been added before.
+void eSubdivider::_addPoints(eU32 count)
+{
+    Phase &phase = m_phases.push();
+    phase.first = m_points.size();
+    phase.count = count;
+
+    m_points.resize(m_points.size()+count);
+    eASSERT(m_stencils.size() == m_points.size()-m_inputCount+1);
+}
+
+void eSubdivider::_evalPoint(eU32 index, eF32 smoothness)
+{
+    const eU32 stencil = index-m_inputCount;
+    const Weight *weights = &m_weights[m_stencils[stencil]];
+    const eU32 count = m_stencils[stencil+1]-m_stencils[stencil];
+
+    Point &p = m_points[index];
+
+#ifdef eUSE_SSE
+    const __m128 s = _mm_set1_ps(smoothness);
+    __m128 pos = _mm_setzero_ps();
+    __m128 uv = _mm_setzero_ps();
+
+    for (eU32 i=0; i<count; i++)
+    {
+        const Weight &w = weights[i];
+        const Point &srcPt = m_points[w.src];
+        const __m128 weight = _mm_add_ps(_mm_set1_ps(w.base), _mm_mul_ps(_mm_set1_ps(w.delta), s));
+
+        pos = _mm_add_ps(pos, _mm_mul_ps(weight, _mm_loadu_ps(srcPt.pos)));
+        uv = _mm_add_ps(uv, _mm_mul_ps(weight, _mm_loadu_ps(srcPt.uv)));
+    }
+
+    _mm_storeu_ps(p.pos, pos);
+    _mm_storeu_ps(p.uv, uv);
+#else
+    eMemSet(&p, 0, sizeof(Point));
+
+    for (eU32 i=0; i<count; i++)
+    {
+        const Weight &w = weights[i];
+        const Point &srcPt = m_points[w.src];
+        const eF32 weight = w.base+w.delta*smoothness;
+
+        for (eU32 j=0; j<4; j++)
+        {
+            p.pos[j] += weight*srcPt.pos[j];
+            p.uv[j] += weight*srcPt.uv[j];
+        }
+    }
+#endif
+}
+
+// The signature contains everything the refined
+// topology depends on. The face corner texture
+// coordinates are part of it, because they're
+// stored in the refined half-edges.
+void eSubdivider::_buildSignature(const eEditMesh &mesh, eU32 levels, eArray<eU32> &signature)
+{
+    signature.reserve(4+mesh.getVertexCount()+mesh.getFaceCount()+mesh.getEdgeCount()*2*4);
+    signature.append(levels);
+    signature.append(mesh.getVertexCount());
+    signature.append(mesh.getEdgeCount());
+    signature.append(mesh.getFaceCount());
+
+    for (eU32 i=0; i<mesh.getVertexCount(); i++)
+    {
+        const eEditMesh::HalfEdge *he = mesh.getVertex(i)->he;
+        signature.append(he ? he->index : (eU32)-1);
+    }
+
+    for (eU32 i=0; i<mesh.getFaceCount(); i++)
+    {
+        const eEditMesh::Face *face = mesh.getFace(i);
+        const eEditMesh::HalfEdge *he = face->he;
+
+        signature.append(face->getEdgeCount());
+
+        do
+        {
+            signature.append(he->index);
+            signature.append(he->origin->index);
+            signature.append(eFtoDW(he->texCoord.x));
+            signature.append(eFtoDW(he->texCoord.y));
+
+            he = he->next;
+        }
+        while (he != face->he);
+    }
+}
+
+void eSubdivider::_evalJob(ePtr arg, eU32 index)
+{
+    const EvalJob &job = *(const EvalJob *)arg;
+    const eU32 first = job.first+index*POINTS_PER_JOB;
+    const eU32 last = eMin(first+POINTS_PER_JOB, job.last);
+
+    for (eU32 i=first; i<last; i++)
+    {
+        job.subdiv->_evalPoint(i, job.smoothness);
+    }
+}
@@ -0,0 +1,92 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef SUBDIVIDER_HPP
+#define SUBDIVIDER_HPP
+
+// Catmull-Clark subdivision of edit meshes. The
+// refined topology and the stencils, which give
+// each refined vertex as weighted sum of coarser
+// vertices, are built once and reused as long as
+// the topology of the input mesh doesn't change.
+// For new vertex positions only the stencils have
+// to be evaluated, which is done in parallel.
+class eSubdivider
+{
+public:
+    eSubdivider();
+
+    eBool                   refine(const eEditMesh &mesh, eU32 levels, eEditMesh &result);
+    void                    evaluate(const eEditMesh &mesh, eF32 smoothness, eEditMesh &result);
+
+private:
+    // The weight of a source point is given by
+    // base+smoothness*delta, because the refined
+    // vertices are linearly blended between their
+    // unsmoothed and smoothed positions.
+    struct Weight
+    {
+        eU32                src;
+        eF32                base;
+        eF32                delta;
+    };
+
+    struct Point
+    {
+        eF32                pos[4];
+        eF32                uv[4];
+    };
+
+    // Range of points, whose stencils only refer
+    // to points before the range. Points of one
+    // phase can be evaluated in parallel.
+    struct Phase
+    {
+        eU32                first;
+        eU32                count;
+    };
+
+    struct EvalJob
+    {
+        eSubdivider *       subdiv;
+        eU32                first;
+        eU32                last;
+        eF32                smoothness;
+    };
+
+private:
+    void                    _refineLevel(const eEditMesh &src, eU32 srcFirst, eEditMesh &dst);
+    void                    _addWeight(eU32 src, eF32 base, eF32 delta);
+    void                    _addPoints(eU32 count);
+    void                    _evalPoint(eU32 index, eF32 smoothness);
+
+    static void             _buildSignature(const eEditMesh &mesh, eU32 levels, eArray<eU32> &signature);
+    static void             _evalJob(ePtr arg, eU32 index);
+
+private:
+    static const eU32       POINTS_PER_JOB = 2048;
+
+private:
+    eArray<eU32>            m_signature;
+    eArray<Weight>          m_weights;
+    eArray<eU32>            m_stencils;     // First weight of each point (and end of last one).
+    eArray<Phase>           m_phases;
+    eArray<Point>           m_points;       // Input vertices followed by all levels.
+    eArray<eU32>            m_faceOrigins;  // Input face of each result face.
+    eU32                    m_inputCount;
+    eU32                    m_resultVertexCount;
+    eU32                    m_resultFaceCount;
+};
+
+#endif // SUBDIVIDER_HPP
@@ -0,0 +1,276 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "../system/system.hpp"
+#include "../math/math.hpp"
+#include "engine.hpp"
+
+eSurfaceSampler::eSurfaceSampler() :
+    m_mesh(eNULL),
+    m_generation(0),
+    m_mode(MODE_FACES),
+    m_totalWeight(0.0f)
+{
+}
+
+// Rebuilds the alias table if the mesh or the mode
+// changed since the last call. Returns if it was
+// rebuilt.
+eBool eSurfaceSampler::update(const eEditMesh &mesh, Mode mode)
+{
+    if (m_mesh == &mesh && m_generation == mesh.getGeneration() && m_mode == mode)
+    {
+        return eFALSE;
+    }
+
+    ePROFILER_ZONE("Build surface sampler");
+
+    m_mesh = &mesh;
+    m_generation = mesh.getGeneration();
+    m_mode = mode;
+
+    eArray<eF32> weights;
+    _calcWeights(weights);
+    _buildAliasTable(weights);
+    return eTRUE;
+}
+
+void eSurfaceSampler::clear()
+{
+    m_mesh = eNULL;
+    m_totalWeight = 0.0f;
+    m_probs.clear();
+    m_aliases.clear();
+}
+
+// Selects an element with probability proportional
+// to its weight, given two uniformly distributed
+// random numbers in [0,1). The first one chooses
+// the table entry, the second one decides between
+// the entry and its alias.
+eU32 eSurfaceSampler::select(eF32 u0, eF32 u1) const
+{
+    eASSERT(!isEmpty());
+
+    const eU32 index = eMin((eU32)(u0*(eF32)m_probs.size()), m_probs.size()-1);
+    return (u1 < m_probs[index] ? index : m_aliases[index]);
+}
+
+// Returns the index of the sampled element.
+eU32 eSurfaceSampler::sample(eVector3 &pos, eVector3 &normal, eU32 &seed) const
+{
+    const eF32 u0 = eRandomF(seed);
+    const eU32 element = select(u0, eRandomF(seed));
+
+    _samplePoint(element, pos, normal, seed);
+    return element;
+}
+
+void eSurfaceSampler::sampleBatch(eU32 count, SampleBuffer &samples, eU32 &seed) const
+{
+    ePROFILER_ZONE("Sample surface");
+
+    samples.posX.resize(count);
+    samples.posY.resize(count);
+    samples.posZ.resize(count);
+    samples.normalX.resize(count);
+    samples.normalY.resize(count);
+    samples.normalZ.resize(count);
+    samples.elements.resize(count);
+
+    // Select all elements first, so that the table
+    // lookups don't interleave with the mesh walks.
+    for (eU32 i=0; i<count; i++)
+    {
+        const eF32 u0 = eRandomF(seed);
+        samples.elements[i] = select(u0, eRandomF(seed));
+    }
+
+    for (eU32 i=0; i<count; i++)
+    {
+        eVector3 pos, normal;
+        _samplePoint(samples.elements[i], pos, normal, seed);
+
+        samples.posX[i] = pos.x;
+        samples.posY[i] = pos.y;
+        samples.posZ[i] = pos.z;
+        samples.normalX[i] = normal.x;
+        samples.normalY[i] = normal.y;
+        samples.normalZ[i] = normal.z;
+    }
+}
+
+eBool eSurfaceSampler::isEmpty() const
+{
+    return (m_probs.size() == 0);
+}
+
+eF32 eSurfaceSampler::getTotalWeight() const
+{
+    return m_totalWeight;
+}
+
+eSurfaceSampler::Mode eSurfaceSampler::getMode() const
+{
+    return m_mode;
+}
+
+void eSurfaceSampler::_calcWeights(eArray<eF32> &weights) const
+{
+    eASSERT(m_mesh != eNULL);
+
+    switch (m_mode)
+    {
+        case MODE_FACES:
+        {
+            weights.resize(m_mesh->getFaceCount());
+
+            for (eU32 i=0; i<weights.size(); i++)
+            {
+                weights[i] = m_mesh->getFace(i)->getArea();
+            }
+            break;
+        }
+
+        case MODE_EDGES:
+        {
+            weights.resize(m_mesh->getEdgeCount());
+
+            for (eU32 i=0; i<weights.size(); i++)
+            {
+                const eEditMesh::HalfEdge *he = _getEdgeHalfEdge(m_mesh->getEdge(i));
+                weights[i] = (he->origin->getPosition()-he->next->origin->getPosition()).length();
+            }
+            break;
+        }
+
+        case MODE_VERTICES:
+        {
+            weights.resize(m_mesh->getVertexCount());
+
+            for (eU32 i=0; i<weights.size(); i++)
+            {
+                weights[i] = 1.0f;
+            }
+            break;
+        }
+    }
+}
+
+// Builds the alias table using Vose's method. The
+// weights are scaled so that their mean is one.
+// Each table entry is then filled by an element
+// with less than the mean and topped up by one
+// with more than the mean. If all weights are
+// zero, the elements are selected uniformly.
+void eSurfaceSampler::_buildAliasTable(const eArray<eF32> &weights)
+{
+    const eU32 count = weights.size();
+
+    m_probs.resize(count);
+    m_aliases.resize(count);
+    m_totalWeight = 0.0f;
+
+    for (eU32 i=0; i<count; i++)
+    {
+        eASSERT(weights[i] >= 0.0f);
+        m_totalWeight += weights[i];
+    }
+
+    const eF32 scale = (m_totalWeight > 0.0f ? (eF32)count/m_totalWeight : 0.0f);
+    eArray<eU32> small, large;
+
+    for (eU32 i=0; i<count; i++)
+    {
+        m_probs[i] = (m_totalWeight > 0.0f ? weights[i]*scale : 1.0f);
+        m_aliases[i] = i;
+
+        if (m_probs[i] < 1.0f)
+        {
+            small.append(i);
+        }
+        else
+        {
+            large.append(i);
+        }
+    }
+
+    while (!small.isEmpty() && !large.isEmpty())
+    {
+        const eU32 s = small.pop();
+        const eU32 l = large.lastElement();
+
+        m_aliases[s] = l;
+        m_probs[l] = (m_probs[l]+m_probs[s])-1.0f;
+
+        if (m_probs[l] < 1.0f)
+        {
+            large.pop();
+            small.append(l);
+        }
+    }
+
+    // Left over entries only differ from one due
+    // to rounding errors.
+    while (!large.isEmpty())
+    {
+        m_probs[large.pop()] = 1.0f;
+    }
+
+    while (!small.isEmpty())
+    {
+        m_probs[small.pop()] = 1.0f;
+    }
+}
+
+void eSurfaceSampler::_samplePoint(eU32 element, eVector3 &pos, eVector3 &normal, eU32 &seed) const
+{
+    switch (m_mode)
+    {
+        case MODE_FACES:
+        {
+            m_mesh->getFace(element)->getRandomSurfacePoint(pos, normal, seed);
+            break;
+        }
+
+        case MODE_EDGES:
+        {
+            const eEditMesh::HalfEdge *he = _getEdgeHalfEdge(m_mesh->getEdge(element));
+            const eEditMesh::Vertex *v0 = he->origin;
+            const eEditMesh::Vertex *v1 = he->next->origin;
+            const eF32 t = eRandomF(seed);
+
+            pos = v0->getPosition().lerp(t, v1->getPosition());
+            normal = v0->getNormal().lerp(t, v1->getNormal());
+            break;
+        }
+
+        case MODE_VERTICES:
+        {
+            const eEditMesh::Vertex *vtx = m_mesh->getVertex(element);
+            eASSERT(vtx != eNULL);
+
+            pos = vtx->getPosition();
+            normal = vtx->getNormal();
+            break;
+        }
+    }
+}
+
+// Returns the half-edge of the given edge, which
+// belongs to a face.
+const eEditMesh::HalfEdge * eSurfaceSampler::_getEdgeHalfEdge(const eEditMesh::Edge *edge)
+{
+    eASSERT(edge != eNULL);
+    return (edge->he0->face != eNULL ? edge->he0 : edge->he1);
+}
@@ -0,0 +1,76 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SURFACE_SAMPLER_HPP
+#define SURFACE_SAMPLER_HPP
+
+// Draws random points distributed uniformly over
+// the faces (by area), the edges (by length) or
+// the vertices of an edit mesh. The elements are
+// selected in O(1) using an alias table, which is
+// only rebuilt when the mesh (its generation) or
+// the sampling mode changes.
+class eSurfaceSampler
+{
+public:
+    enum Mode
+    {
+        MODE_FACES,
+        MODE_EDGES,
+        MODE_VERTICES
+    };
+
+    // Structure of arrays holding a batch of
+    // samples. The normals aren't normalized.
+    struct SampleBuffer
+    {
+        eArray<eF32>        posX;
+        eArray<eF32>        posY;
+        eArray<eF32>        posZ;
+        eArray<eF32>        normalX;
+        eArray<eF32>        normalY;
+        eArray<eF32>        normalZ;
+        eArray<eU32>        elements;
+    };
+
+public:
+    eSurfaceSampler();
+
+    eBool                   update(const eEditMesh &mesh, Mode mode);
+    void                    clear();
+
+    eU32                    select(eF32 u0, eF32 u1) const;
+    eU32                    sample(eVector3 &pos, eVector3 &normal, eU32 &seed) const;
+    void                    sampleBatch(eU32 count, SampleBuffer &samples, eU32 &seed) const;
+
+    eBool                   isEmpty() const;
+    eF32                    getTotalWeight() const;
+    Mode                    getMode() const;
+
+private:
+    void                    _calcWeights(eArray<eF32> &weights) const;
+    void                    _buildAliasTable(const eArray<eF32> &weights);
+    void                    _samplePoint(eU32 element, eVector3 &pos, eVector3 &normal, eU32 &seed) const;
+
+    static const eEditMesh::HalfEdge * _getEdgeHalfEdge(const eEditMesh::Edge *edge);
+
+private:
+    const eEditMesh *       m_mesh;
+    eU32                    m_generation;
+    Mode                    m_mode;
+    eF32                    m_totalWeight;
+    eArray<eF32>            m_probs;    // Probability of keeping the element.
+    eArray<eU32>            m_aliases;  // Element selected otherwise.
+};
+
+#endif // SURFACE_SAMPLER_HPP
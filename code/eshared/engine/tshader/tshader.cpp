@@ -16,7 +16,9 @@
 
 #include "tshader.hpp"
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 eTShader::eTShader() :
     m_machineCode(eNULL)
@@ -29,10 +31,15 @@ eTShader::~eTShader()
     free();
 }
 
+// The compiled code is 32 bit x86 code, so it's
+// only loaded on Windows. Elsewhere shaders don't
+// change their output.
 void eTShader::load(const eByteArray &code)
 {
-    DWORD oldprotect;
     free();
+
+#ifdef _WIN32
+    DWORD oldprotect;
     eU32 codeSize = code.size();
     if (codeSize > 4)
     {
@@ -40,15 +47,18 @@ void eTShader::load(const eByteArray &code)
         eMemCopy(m_machineCode, code.m_data, codeSize);
         VirtualProtect(m_machineCode, codeSize, PAGE_EXECUTE, &oldprotect);
     }
+#endif
 }
 
 void eTShader::free()
 {
+#ifdef _WIN32
     if (m_machineCode)
     {
         VirtualFree(m_machineCode, 0, MEM_RELEASE);
         m_machineCode = eNULL;
     }
+#endif
 }
 
 void eTShader::run(eConstPtr callerId, eVector4 &out)
@@ -88,6 +98,7 @@ void eTShader::run(eConstPtr callerId, eVector4 &out)
 	// ------------------------------------------------------------
 	//	call shader
 	// ------------------------------------------------------------
+#ifdef _WIN32
     __asm 
     {
         push eax
@@ -98,6 +109,7 @@ void eTShader::run(eConstPtr callerId, eVector4 &out)
         pop edx
         pop eax
     }
+#endif
 
 	// ------------------------------------------------------------
 	//	copy results from __m128 array back to variables
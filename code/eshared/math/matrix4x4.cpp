@@ -14,7 +14,7 @@
 #include "../system/system.hpp"
 #include "../math/math.hpp"
 
-#ifdef eUSE_SSE
+#if defined(eUSE_SSE) && defined(_WIN32)
 #include <intrin.h>
 #endif
 
@@ -249,7 +249,7 @@ const __m128 quat_mask=_mm_setr_ps( *(float*)&zero,
 eQuat eQuat::operator * (const eQuat &q) const {
 
 #ifdef eUSE_SSE
-	__declspec(align(16)) eQuat result;
+	eALIGN16 eQuat result;
 const __m128 a = _mm_loadu_ps(&this->x);
 const __m128 b = _mm_loadu_ps(&q.x);
 __m128 swiz1=vec4f_swizzle(b,3,3,3,3);
@@ -48,8 +48,10 @@ public:
         eF32 sa, ca;
         eSinCos(angle*0.5f, sa, ca);
 
+        // vs = (axis.x*sa, axis.y*sa, axis.z*sa, ca)
         __m128 vs = _mm_mul_ps(axis, _mm_set1_ps(sa));
-        vs.m128_f32[3] = ca;
+        const __m128 zw = _mm_unpackhi_ps(vs, _mm_set1_ps(ca));
+        vs = _mm_shuffle_ps(vs, zw, _MM_SHUFFLE(1, 0, 1, 0));
 
         // normalize
         __m128 mdot = _mm_mul_ps(vs, vs);
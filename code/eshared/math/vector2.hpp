@@ -87,6 +87,7 @@ public:
 
 	inline eVector2 c_conjugate() {
 		y = -y;
+		return *this;
 	}
 
 	inline eVector2 c_mul(const eVector2 &other) const {
@@ -114,7 +114,7 @@ eVector3 eVector3::distanceToTriangleOptimized(const eVector3& base, const eVect
                         sqrDistance = a + 2*d + f;
                     } else {
                         s = -d/a;
-                        sqrDistance = a + 2*d + f;
+                        sqrDistance = d*s + f;
                     }
                 } else {
                     s = 0;
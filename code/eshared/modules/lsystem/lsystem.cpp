@@ -12,7 +12,9 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #ifdef eEDITOR
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdio.h>
 #endif
 
@@ -27,7 +29,7 @@ eBezierSpline::eBezierSpline(const eVector3& pos0, const eVector3& pos1, const e
 void eBezierSpline::evaluate(eF32 t, eVector3& resultPos, eQuat& resultRot) const {
 	resultRot = rot0.slerp(t, rot1);
 
-    __declspec(align(16)) eVector3 distNorm;
+    eALIGN16 eVector3 distNorm;
 	eVector3::cubicBezier(t, control0, control1, control2, control3, resultPos, distNorm);
 
 	eVector3 look = resultRot.getVector(ax);
@@ -153,11 +155,22 @@ eS32 readValInstanciation(const eString& s, int start, int end, eU32* parMap, eF
 	return pos + 1;
 }
 
+static eBool isRotationSymbol(eU32 symbol) {
+	switch(symbol) {
+		case '|': case '+': case '-': case '<': case '>': case '\\': case '/':
+			return eTRUE;
+#ifdef eEDITOR
+		case '$':
+			return eTRUE;
+#endif
+	}
+	return eFALSE;
+}
+
 eLSystem::eLSystem() :
     m_initialRotation(eQuat())
 {
 	numProductions = 0;
-	stackPos = 0;
     polyStackPos = 0;
 }
 
@@ -271,6 +284,34 @@ void eLSystem::setParams(const eString& axiomStr, const eString& grammarStr, eU3
 		ruleCnt++;
 	}
 
+	// find rule bodies behind the conditions and
+	// count the symbols they produce
+	const eF32 dummyParams[LSYS_PAR_MAX] = {0};
+	for(eU32 r = 0; r < ruleCnt; r++) {
+		eS32 rpos = ruleOffsets[r];
+		if(this->grammar.at(rpos) == '(') {
+			eF32 ruleCondition;
+			rpos = 1 + calculateTerm(this->grammar, rpos + 1, this->grammar.length(), &paramTable[r][0], dummyParams, ruleCondition);
+		}
+		ruleBodies[r] = rpos;
+		ruleLengths[r] = 0;
+
+		while(rpos < (eS32)this->grammar.length()) {
+			int nsym = this->grammar.at(rpos++);
+			if(nsym == ';')
+				break;
+#ifdef eEDITOR
+			if(nsym == '$')
+				eShowError("Temporarily disabled");
+#endif
+			eF32 sparams[LSYS_PAR_MAX];
+			if(this->grammar.at(rpos) == '(')
+				rpos = readValInstanciation(this->grammar, rpos, this->grammar.length(), &paramTable[r][0], &sparams[0], dummyParams);
+			if(!isRotationSymbol(nsym))
+				ruleLengths[r]++;
+		}
+	}
+
 	// calc sincos table
 	for(eU32 i = 0; i <= m_gen_edges; i++) {
 		eF32 et = (eF32)i / (eF32)m_gen_edges;
@@ -296,182 +337,357 @@ void eLSystem::evaluate() {
 void eLSystem::evaluate(const tState& baseState) {
 	this->numProductions = 1;
 	ePROFILER_ZONE("L-System - Evaluate");
-	// interpret product
-	eU32 initialStackpos = stackPos;
 	this->reset();
+
+	tState rootState = baseState;
+	rootState.scopeStart = 0;
+	m_symbolMass = (baseState.turtle.size * baseState.turtle.height) * (baseState.turtle.size * baseState.turtle.width);
+
 	// now we can start derivating
 	for(eU32 it = 0; it < m_iterations; it++) {
+		eArray<tSymbol>& nextProduction = this->productions[numProductions];
+
+		// the sizes of all expansions are known up
+		// front, so branches can be derived in
+		// parallel into their final positions
+		const eU32 size = this->chooseRules(numProductions - 1);
+		nextProduction.resize(size);
+		m_massContrib.resize(size);
+
+		this->processBranches(numProductions - 1, rootState, &eLSystem::deriveBranch);
+		this->propagateMass(nextProduction);
+		numProductions++;
+	}
+}
 
-		tState					sstate = baseState;
-		tState				    *state = &sstate;
-
-		state->scopeStart = 0;
-
-		eArray<tSymbol>& curProduction = this->productions[numProductions - 1];			
-		eArray<tSymbol>& nextProduction = this->productions[numProductions++];	
-		nextProduction.clear();		
-		int ppos = 0;
-		while(ppos < (eS32)curProduction.size()) {
-			const tSymbol& curSymbol = curProduction[ppos];
-			eS32 symbolRaw = curSymbol.symbol;
-			eBool isVariable = (symbolRaw >= LSYS_VAR_MIN) && (symbolRaw <= LSYS_VAR_MAX);
-
-			state->turtle.rotation = state->curBaseRotation * curSymbol.rotation;
-			state->turtle.texAngle = curSymbol.texVecAngle;
-
-			if(symbolRaw == '[')	this->pushState(&state);
-			if(symbolRaw == ']')	this->popState(&state);
-
-			//////////////////////////////
-			/// Calculate next product ///
-			//////////////////////////////
-							
-			// initialize next
-			tSymbol& nextSymbol = nextProduction.push(curSymbol);
-			nextSymbol.rotation = state->turtle.rotation;
-			nextSymbol.texVecAngle = state->turtle.texAngle;
-            eSinCos(state->turtle.texAngle, nextSymbol.texVec.x, nextSymbol.texVec.y);
-//			nextSymbol.texVec = eVector2(eSin(state->turtle.texAngle), eCos(state->turtle.texAngle));
-			nextSymbol.parentIdx = ppos;
-			nextSymbol.scopeStartIdx = state->scopeStart;
+// Collects the rules with matching conditions for
+// a chunk of symbols as bit mask into symRules[].
+void eLSystem::chooseRulesJob(ePtr arg, eU32 index) {
+	eLSystem& lsys = *(eLSystem*)arg;
+	const eArray<tSymbol>& production = lsys.productions[lsys.m_jobProduction];
+	const eU32 first = index * LSYS_RULE_CHUNK_SIZE;
+	const eU32 last = eMin(first + LSYS_RULE_CHUNK_SIZE, production.size());
+
+	for(eU32 i = first; i < last; i++) {
+		const tSymbol& curSymbol = production[i];
+		eU32 mask = 0;
+
+		if((curSymbol.symbol != '[') && (curSymbol.symbol != ']')) {
+			const eArray<eU32>& rules = lsys.symRules[curSymbol.symbol];
+			for(eU32 j = 0; j < rules.size(); j++) {
+				const eU32 rule = rules[j];
+				const eS32 rpos = lsys.ruleOffsets[rule];
+
+				// read boolean expression
+				eF32 ruleCondition = 1.0f;
+				if(lsys.grammar.at(rpos) == '(')
+					calculateTerm(lsys.grammar, rpos + 1, lsys.grammar.length(), &lsys.paramTable[rule][0], &curSymbol.params[0], ruleCondition);
+				if(ruleCondition != 0)
+					mask |= (1 << j);
+			}
+		}
+
+		lsys.m_symbolRules[i] = mask;
+	}
+}
+
+// Picks the rule for each symbol of the production
+// and calculates the offsets of their expansions.
+// Returns the size of the next production.
+eU32 eLSystem::chooseRules(eU32 production) {
+	ePROFILER_ZONE("L-System - Choose Rules");
+	const eArray<tSymbol>& curProduction = this->productions[production];
+	const eU32 count = curProduction.size();
+
+	m_jobProduction = production;
+	m_symbolRules.resize(count);
+	m_offsets.resize(count + 1);
+	eThreadPool::get().parallelFor(chooseRulesJob, this, (count + LSYS_RULE_CHUNK_SIZE - 1) / LSYS_RULE_CHUNK_SIZE);
+
+	// random numbers are drawn in order of the
+	// symbols, so derivations stay the same
+	eU32 size = 0;
+	for(eU32 i = 0; i < count; i++) {
+		m_offsets[i] = size;
+
+		const eU32 mask = m_symbolRules[i];
+		if(mask == 0) {
+			m_symbolRules[i] = LSYS_NO_RULE;
+			size++;
+			continue;
+		}
+
+		eU32 numRules = 0;
+		for(eU32 m = mask; m != 0; m &= m - 1)
+			numRules++;
 
-			// TODO: reenable parameter copy
-			//for(int i = 0; i < LSYS_MAX_SYMBOLS; i++)
-			//	nextParam[nextProdLen * LSYS_MAX_SYMBOLS + i] = param[ppos * LSYS_MAX_SYMBOLS + i];
+		// pick rule at random
+		eU32 pick = eRandom(0, numRules);
+		eU32 j = 0;
+		while(!(mask & (1 << j)) || (pick-- != 0))
+			j++;
+
+		const eU32 rule = symRules[curProduction[i].symbol][j];
+		m_symbolRules[i] = rule;
+		size += ruleLengths[rule];
+	}
+
+	m_offsets[count] = size;
+	return size;
+}
+
+// Walking back from a new variable, its mass is
+// added to all symbols in front of it, but not to
+// closed scopes. Done in one pass from the end.
+void eLSystem::propagateMass(eArray<tSymbol>& production) {
+	ePROFILER_ZONE("L-System - Propagate Mass");
+	eF32 mass = 0.0f;
+	m_massStack.clear();
+
+	for(eS32 i = production.size() - 1; i >= 0; i--) {
+		tSymbol& symbol = production[i];
+
+		if(symbol.symbol == ']') {
+			m_massStack.append(mass);
+			mass = 0.0f;
+		} else {
+			symbol.mass += mass;
+			mass += m_massContrib[i];
+			if((symbol.symbol == '[') && (m_massStack.size() > 0))
+				mass += m_massStack.pop();
+		}
+	}
+}
+
+// Matches the brackets of the production and
+// collects all scopes with at least
+// LSYS_MIN_BRANCH_SIZE symbols as branches,
+// sorted by their nesting level.
+void eLSystem::findBranches(const eArray<tSymbol>& production, const tState& rootState) {
+	const eU32 count = production.size();
+
+	m_scopeEnds.resize(count);
+	m_openScopes.resize(count);
+	eU32 openCount = 0;
+	for(eU32 s = 0; s < count; s++) {
+		if(production[s].symbol == '[')
+			m_openScopes[openCount++] = s;
+		else if((production[s].symbol == ']') && (openCount > 0))
+			m_scopeEnds[m_openScopes[--openCount]] = s;
+	}
+	while(openCount > 0)
+		m_scopeEnds[m_openScopes[--openCount]] = count - 1;
+
+	m_branches.clear();
+	tBranch& root = m_branches.push();
+	root.entry = rootState;
+	root.first = 0;
+	root.end = count;
+	root.level = 0;
+	root.entered = eTRUE;
+
+	eU32 maxLevel = 0;
+	for(eU32 s = 0; s < count; s++) {
+		if((production[s].symbol != '[') || !this->isBranch(s))
+			continue;
+
+		while((openCount > 0) && (m_branches[m_openScopes[openCount - 1]].end <= s))
+			openCount--;
+
+		m_openScopes[openCount++] = m_branches.size();
+		tBranch& branch = m_branches.push();
+		branch.first = s;
+		branch.end = m_scopeEnds[s] + 1;
+		branch.level = openCount;
+		branch.entered = eFALSE;
+		maxLevel = eMax(maxLevel, branch.level);
+	}
+
+	// sort branches by level
+	m_levelStarts.resize(maxLevel + 2);
+	eMemSet(&m_levelStarts[0], 0, m_levelStarts.size() * sizeof(eU32));
+	for(eU32 i = 0; i < m_branches.size(); i++)
+		m_levelStarts[m_branches[i].level + 1]++;
+	for(eU32 i = 1; i < m_levelStarts.size(); i++)
+		m_levelStarts[i] += m_levelStarts[i - 1];
+
+	m_branchOrder.resize(m_branches.size());
+	for(eU32 i = 0; i < m_branches.size(); i++)
+		m_branchOrder[m_levelStarts[m_branches[i].level]++] = i;
+	for(eU32 i = maxLevel + 1; i > 0; i--)
+		m_levelStarts[i] = m_levelStarts[i - 1];
+	m_levelStarts[0] = 0;
+}
+
+// Stores the entry state of the branch starting
+// at the given position and returns its end, so
+// the caller can skip it.
+eU32 eLSystem::deferBranch(eU32 pos, const tState& entry) {
+	// branches are sorted by their first symbol
+	eU32 lo = 1;
+	eU32 hi = m_branches.size();
+	while(lo < hi) {
+		const eU32 mid = (lo + hi) / 2;
+		if(m_branches[mid].first < pos)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	eASSERT(lo < m_branches.size() && m_branches[lo].first == pos);
+	tBranch& branch = m_branches[lo];
+	branch.entry = entry;
+	branch.entered = eTRUE;
+	return branch.end;
+}
+
+void eLSystem::branchJob(ePtr arg, eU32 index) {
+	const tBranchJob& job = *(const tBranchJob*)arg;
+	(job.lsys->*job.func)(job.branches[index]);
+}
+
+// Runs func for all branches of the production.
+// Branches of one level are processed in
+// parallel, after their parents were done.
+void eLSystem::processBranches(eU32 production, const tState& rootState, void (eLSystem::*func)(eU32 branch)) {
+	this->findBranches(this->productions[production], rootState);
+	m_jobProduction = production;
+	m_forceHints.resize(m_branches.size() * m_forces.size());
+
+	tBranchJob job;
+	job.lsys = this;
+	job.func = func;
+
+	for(eU32 l = 0; l + 1 < m_levelStarts.size(); l++) {
+		job.branches = &m_branchOrder[m_levelStarts[l]];
+		eThreadPool::get().parallelFor(branchJob, &job, m_levelStarts[l + 1] - m_levelStarts[l]);
+	}
+}
+
+void eLSystem::deriveBranch(eU32 branch) {
+	const tBranch& b = m_branches[branch];
+	if(!b.entered)
+		return;
+
+	const eArray<tSymbol>& curProduction = this->productions[m_jobProduction];
+	eArray<tSymbol>& nextProduction = this->productions[m_jobProduction + 1];
+	const eU32 grammarLen = this->grammar.length();
+
+	tFrame frames[LSYS_MAX_STACK];
+	eU32 depth = 0;
+	tFrame state;
+	state.curBaseRotation = b.entry.curBaseRotation;
+	state.scopeStart = b.entry.scopeStart;
+
+	for(eU32 ppos = b.first; ppos < b.end; ppos++) {
+		const tSymbol& curSymbol = curProduction[ppos];
+		const eU32 symbolRaw = curSymbol.symbol;
+
+		if((symbolRaw == '[') && (ppos != b.first) && this->isBranch(ppos)) {
+			tState entry;
+			entry.curBaseRotation = state.curBaseRotation;
+			entry.scopeStart = state.scopeStart;
+			ppos = this->deferBranch(ppos, entry) - 1;
+			continue;
+		}
+
+		state.turtle.rotation = state.curBaseRotation * curSymbol.rotation;
+		state.turtle.texAngle = curSymbol.texVecAngle;
+
+		eU32 npos = m_offsets[ppos];
+		const eU32 rule = m_symbolRules[ppos];
+
+		if(rule == LSYS_NO_RULE) {
+			// closing brackets get the state of their
+			// opening ones
+			if((symbolRaw == ']') && (depth > 0))
+				state = frames[--depth];
+
+			// copy symbol
+			tSymbol& nextSymbol = nextProduction[npos];
+			nextSymbol = curSymbol;
+			nextSymbol.rotation = state.turtle.rotation;
+			nextSymbol.texVecAngle = state.turtle.texAngle;
+			eSinCos(state.turtle.texAngle, nextSymbol.texVec.x, nextSymbol.texVec.y);
+			nextSymbol.parentIdx = ppos;
+			nextSymbol.scopeStartIdx = state.scopeStart;
+			m_massContrib[npos] = 0.0f;
 
 			if(symbolRaw == '[') {
-				this->pushState(&state);
-				state->scopeStart = nextProduction.size() - 1;
-			} else if(symbolRaw == ']') {
-				this->popState(&state);
-			} else /*if(isVariable)*/ {
-				int		rpos[LSYS_MAX_RULES];
-				eU32	ruleNr[LSYS_MAX_RULES];
-				eU32 numRules = 0;
-
-				// iterate through rules and lookup those with matching boolean conditions
-				for(eU32 i = 0; i < symRules[symbolRaw].size(); i++) {
-					ruleNr[i] = symRules[symbolRaw][i];
-					rpos[numRules] = ruleOffsets[ruleNr[i]];
-
-					// read boolean expression
-					eF32 ruleCondition = 1.0f;
-                    if(this->grammar.at(rpos[numRules]) == '(') {
-					    rpos[numRules] = 1 + calculateTerm(this->grammar, rpos[numRules] + 1, this->grammar.length(), &paramTable[ruleNr[i]][0], &curSymbol.params[0], ruleCondition);
-					    eASSERT(rpos[numRules] != 0);
-                    }
-                    if(ruleCondition != 0) {
-						// rule can be applied
-						eASSERT(rpos[numRules] != 0);
-						numRules++;
-					}
-				}
+				eASSERT(depth < LSYS_MAX_STACK);
+				frames[depth++] = state;
+				state.scopeStart = npos;
+			}
+			continue;
+		}
 
-				if(numRules != 0) {
-					nextProduction.removeLastElement();
-					// pick rule at random
-                    eU32 i = eRandom(0, numRules);
-					eASSERT(rpos[i] >= 0);
-					// take this rule
-					while(rpos[i] < (eS32)this->grammar.length()) {
-						// read symbol
-						int nsym = this->grammar.at(rpos[i]++);
-						if(nsym == ';')
-							break;
-									
-						eF32 sparams[LSYS_PAR_MAX];
-						if(this->grammar.at(rpos[i]) == '(') 
-							rpos[i] = readValInstanciation(this->grammar, rpos[i], this->grammar.length(), 
-															&paramTable[ruleNr[i]][0], &sparams[0], &curSymbol.params[0]);
-						else
-							this->setDefaultParams(nsym, &sparams[0], &curSymbol.params[0]);
-									
-//								eVector3 rotateAxis;
-						eF32 rotateAmount = 0.0f;
-                        eU32 rotateAxis;
-						switch(nsym) {
-
-							case '|': rotateAxis = 0; rotateAmount = ePI; break;
-							case '+': rotateAxis = 0; rotateAmount = -sparams[0]; state->turtle.texAngle -= sparams[0]; break;
-							case '-': rotateAxis = 0; rotateAmount = sparams[0]; state->turtle.texAngle += sparams[0]; break;
-							case '<': rotateAxis = 1; rotateAmount = -sparams[0]; break;
-							case '>': rotateAxis = 1; rotateAmount = sparams[0]; break;
-							case '\\': rotateAxis = 2; rotateAmount = -sparams[0]; break;
-							case '/': rotateAxis = 2; rotateAmount = sparams[0]; break;
+		// take this rule
+		eS32 rpos = ruleBodies[rule];
+		while(rpos < (eS32)grammarLen) {
+			// read symbol
+			int nsym = this->grammar.at(rpos++);
+			if(nsym == ';')
+				break;
+
+			eF32 sparams[LSYS_PAR_MAX];
+			if(this->grammar.at(rpos) == '(')
+				rpos = readValInstanciation(this->grammar, rpos, grammarLen, &paramTable[rule][0], &sparams[0], &curSymbol.params[0]);
+			else
+				this->setDefaultParams(nsym, &sparams[0], &curSymbol.params[0]);
+
+			eF32 rotateAmount = 0.0f;
+			eU32 rotateAxis = 0;
+			switch(nsym) {
+				case '|': rotateAxis = 0; rotateAmount = ePI; break;
+				case '+': rotateAxis = 0; rotateAmount = -sparams[0]; state.turtle.texAngle -= sparams[0]; break;
+				case '-': rotateAxis = 0; rotateAmount = sparams[0]; state.turtle.texAngle += sparams[0]; break;
+				case '<': rotateAxis = 1; rotateAmount = -sparams[0]; break;
+				case '>': rotateAxis = 1; rotateAmount = sparams[0]; break;
+				case '\\': rotateAxis = 2; rotateAmount = -sparams[0]; break;
+				case '/': rotateAxis = 2; rotateAmount = sparams[0]; break;
 #ifdef eEDITOR
-							case '$':	// roll to horizontal left axis
-                                eShowError("Temporarily disabled");
-                                break;
+				case '$': break; // roll to horizontal left axis (disabled)
 #endif
-/*                                        
-							case '$':	// roll to horizontal left axis
-									{
-										eVector3 look = state->turtle.rotation.getVector(2);
-										eVector3 curLeft =		state->turtle.rotation.getVector(0);
-										eVector3 targetLeft = (eVector3(0,1,0) ^ look).normalized();
-										eF32 cosAngle = eClamp(-1.0f, curLeft * targetLeft, 1.0f);
-										eF32 angle = eACos(cosAngle);
-										rotateAxis = look;
-										rotateAmount = angle;
-										break;
-									}
-*/
-							default:
-//										ePROFILER_ZONE("L-System - Evaluate Expand");
-								tSymbol& nextSymbol = nextProduction.push(tSymbol());
-
-								nextSymbol.symbol = nsym;
-								for(eU32 p = 0; p < LSYS_PAR_MAX; p++)
-									nextSymbol.params[p] = sparams[p];
-								nextSymbol.parentIdx = ppos;
-								nextSymbol.scopeStartIdx = state->scopeStart;
-								nextSymbol.rotation = state->turtle.rotation;
-								nextSymbol.mass = (state->turtle.size * state->turtle.height) * (state->turtle.size * state->turtle.width);
-								nextSymbol.texVecAngle = state->turtle.texAngle;
-                                eSinCos(state->turtle.texAngle, nextSymbol.texVec.x, nextSymbol.texVec.y);
-//								nextSymbol.texVec = eVector2(eSin(state->turtle.texAngle), eCos(state->turtle.texAngle));
-
-								if(nsym == '[') {
-									this->pushState(&state);
-									state->scopeStart = nextProduction.size() - 1;
-								} else if(nsym == ']') {
-									this->popState(&state);
-								}
-
-								// propagate mass to parent symbols
-								if((nsym >= LSYS_VAR_MIN) && (nsym <= LSYS_VAR_MAX)) {
-//											ePROFILER_ZONE("L-System - Propagate Mass");
-									eU32 subCnt = 0;
-									for(int i = nextProduction.size() - 2; i >= 0; i--) {
-										if(nextProduction[i].symbol == ']')
-											i = nextProduction[i].scopeStartIdx;
-										else {
-											// add mass
-											nextProduction[i].mass += nextSymbol.mass;
-										}
-									}
-								}
-
-						}
-
-						if(rotateAmount != 0.0f) {
-							state->curBaseRotation = eQuat(state->turtle.rotation.getVector(rotateAxis), rotateAmount) * state->curBaseRotation;
-							state->turtle.rotation = state->curBaseRotation * curSymbol.rotation;
-						}
+				default:
+					tSymbol& nextSymbol = nextProduction[npos];
+					nextSymbol.symbol = nsym;
+					for(eU32 p = 0; p < LSYS_PAR_MAX; p++)
+						nextSymbol.params[p] = sparams[p];
+					nextSymbol.parentIdx = ppos;
+					nextSymbol.scopeStartIdx = state.scopeStart;
+					nextSymbol.rotation = state.turtle.rotation;
+					nextSymbol.mass = m_symbolMass;
+					nextSymbol.texVecAngle = state.turtle.texAngle;
+					eSinCos(state.turtle.texAngle, nextSymbol.texVec.x, nextSymbol.texVec.y);
+
+					// variables add their mass to the
+					// symbols in front of them later on
+					const eBool isVariable = (nsym >= LSYS_VAR_MIN) && (nsym <= LSYS_VAR_MAX);
+					m_massContrib[npos] = (isVariable ? m_symbolMass : 0.0f);
+
+					if(nsym == '[') {
+						eASSERT(depth < LSYS_MAX_STACK);
+						frames[depth++] = state;
+						state.scopeStart = npos;
+					} else if((nsym == ']') && (depth > 0)) {
+						state = frames[--depth];
 					}
-				}
+					npos++;
+			}
 
+			if(rotateAmount != 0.0f) {
+				state.curBaseRotation = eQuat(state.turtle.rotation.getVector(rotateAxis), rotateAmount) * state.curBaseRotation;
+				state.turtle.rotation = state.curBaseRotation * curSymbol.rotation;
 			}
-			ppos++;
 		}
-	}
 
-	eASSERT(stackPos==initialStackpos);
+		eASSERT(npos == m_offsets[ppos + 1]);
+	}
 }
 
 eLSystem::tState* eLSystem::getDefaultState(eF32 scale) {
 	tState *state;
-	state = &stack[0];
+	state = &defaultState;
 
     state->turtle.rotation = DEFAULT_ROTATION * this->m_initialRotation;
 //    state->turtle.rotation = eQuat();
@@ -542,6 +758,98 @@ void _mergeIntoMesh(eMesh& destMesh, const eMatrix4x4& mtx, eMatrix4x4& rotMtx,
     }
 }
 
+// Calculates the turtle states of a branch. For
+// the last production they are stored for drawing.
+void eLSystem::interpretBranch(eU32 branch) {
+	const tBranch& b = m_branches[branch];
+	if(!b.entered)
+		return;
+
+	const eU32 p = m_jobProduction;
+	const eBool isLastProduction = p == numProductions - 1;
+	const eArray<tSymbol>& production = productions[p];
+	const eArray<tProdSymbol>& prevProd = m_prodBuffer[(1-p % 2)];
+	eArray<tProdSymbol>& curProd = m_prodBuffer[p % 2];
+
+	eU32* hints = eNULL;
+	if(m_forces.size() > 0) {
+		hints = &m_forceHints[branch * m_forces.size()];
+		for(eU32 i = 0; i < m_forces.size(); i++)
+			hints[i] = eTriangleBvh::NO_HINT;
+	}
+
+	tFrame frames[LSYS_MAX_STACK];
+	eU32 depth = 0;
+	tTurtleState turtle = b.entry.turtle;
+	eQuat curBaseRotation = b.entry.curBaseRotation;
+
+	for(eU32 s = b.first; s < b.end; s++) {
+		const tSymbol& curSymbol = production[s];
+
+		if((curSymbol.symbol == '[') && (s != b.first) && this->isBranch(s)) {
+			tState entry;
+			entry.turtle = turtle;
+			entry.curBaseRotation = curBaseRotation;
+			s = this->deferBranch(s, entry) - 1;
+			continue;
+		}
+
+		tProdSymbol& curProdSym = curProd[s];
+		const tProdSymbol& parentProdSym = prevProd[curSymbol.parentIdx];
+
+		switch(curSymbol.symbol) {
+			case '^':	turtle.width *= 2.0f; break;
+			case '&':	turtle.width *= 0.5f; break;
+//			case '!':	turtle.width = curSymbol.params[0] * this->m_baseWidth; break;
+			case '\'':	if(turtle.polyMatIdx < this->m_gen_materials.size() - 1) turtle.polyMatIdx++; break;
+			case '[':
+				eASSERT(depth < LSYS_MAX_STACK);
+				frames[depth].turtle = turtle;
+				frames[depth].curBaseRotation = curBaseRotation;
+				frames[depth].scopeEnd = m_scopeEnds[s];
+				depth++;
+				break;
+			case ']':
+				if(depth > 0) {
+					depth--;
+					turtle = frames[depth].turtle;
+					curBaseRotation = frames[depth].curBaseRotation;
+				}
+				break;
+			case '{':
+			case '}':	break;
+			case 'F':
+			case 'G': {
+					eQuat currentRot = parentProdSym.correctRot * curSymbol.rotation;
+					eQuat currentGlobalRot = curBaseRotation * currentRot;
+					this->applyForce(currentGlobalRot, curBaseRotation, turtle.position, hints);
+
+					turtle.rotation = (curBaseRotation * currentRot);
+					eF32 amount = (turtle.size * turtle.height * curSymbol.params[0]);
+					turtle.texPos += curSymbol.texVec * (this->m_gen_texScale * amount);
+					turtle.position += turtle.rotation.getVector(2) * amount;
+				}
+			default:
+				turtle.size *= m_sizeDecayPar;
+				curProdSym.correctRot = curBaseRotation * parentProdSym.correctRot;
+				turtle.rotation = curProdSym.correctRot * curSymbol.rotation;
+		}
+
+		if(!isLastProduction)
+			continue;
+
+		m_turtles[s] = turtle;
+
+		// drawing skips the remaining scope
+		if(curSymbol.symbol == '%') {
+			const eU32 next = (depth > 0 ? frames[depth - 1].scopeEnd : production.size() - 1);
+			if(next <= s)
+				break;
+			s = next - 1;
+		}
+	}
+}
+
 void eLSystem::drawInternal(eSceneData& destsg, eMesh& destMesh, tState* state) {
 	ePROFILER_ZONE("L-System - Draw Internal Pre");
 
@@ -552,181 +860,137 @@ void eLSystem::drawInternal(eSceneData& destsg, eMesh& destMesh, tState* state)
 	eQuat originRot = state->curBaseRotation;
 	{
 		eArray<tProdSymbol>& curProd = m_prodBuffer[0];
-		curProd.clear();
+		curProd.resize(productions[0].size());
+		for(eU32 s = 0; s < curProd.size(); s++)
+			curProd[s].correctRot = originRot;
+	}
 
-		eArray<tSymbol>& production = productions[0];
-		for(eU32 s = 0; s < production.size(); s++) {
-			tSymbol& curSymbol = production[s];
-			tProdSymbol& ps = curProd.push();
-			ps.correctRot = originRot;
-		}
+	// calculate the turtle states of all productions,
+	// each production is interpreted branch-parallel
+	tState rootState = *state;
+	rootState.curBaseRotation = eQuat();
+
+    for(eU32 p = 1; p < numProductions; p++) {
+		const eU32 size = productions[p].size();
+		m_prodBuffer[p % 2].resize(size);
+		if(p == numProductions - 1)
+			m_turtles.resize(size);
+
+		this->processBranches(p, rootState, &eLSystem::interpretBranch);
 	}
 
+	// only draw last production
+	if(numProductions < 2)
+		return;
+
+	ePROFILER_ZONE("L-System - DrawInterpret");
+
 	eF32 accumulatedStepLen = 0.0f;
 	eU32 accumulatedStepCount = 0;
 	drawStackPos = 0;
 	tDrawState* drawState = getDefaultDrawState();
 	drawState->lastTurtle = state->turtle;
 
-    for(eU32 p = 1; p < numProductions; p++) {
-		this->pushState(&state);
-	
-		eBool isLastProduction = p == numProductions - 1;
-
-		state->curBaseRotation = eQuat();
-
-        eU32 polyScopeCnt = 0;
-		eArray<tSymbol>& prevProduction = productions[p - 1];
-		eArray<tSymbol>& production = productions[p];
-
-		eArray<tProdSymbol>& prevProd = m_prodBuffer[(1-p % 2)];
-		eArray<tProdSymbol>& curProd = m_prodBuffer[p % 2];
-
-		curProd.clear();
-		curProd.reserve(production.size());
-
-		for(eU32 s = 0; s < production.size(); s++) {
-			tSymbol& curSymbol = production[s];
-			const tSymbol& parentSymbol = prevProduction[curSymbol.parentIdx];
-				
-			tProdSymbol& curProdSym = curProd.push();
-			const tProdSymbol& parentProdSym = prevProd[curSymbol.parentIdx];
-
-			const eS32 symbolRaw = curSymbol.symbol;
-				
-			switch(curSymbol.symbol) {
-				case '^':	state->turtle.width *= 2.0f; break;
-				case '&':	state->turtle.width *= 0.5f; break;
-//                case '!':	state->turtle.width = curSymbol.params[0] * this->m_baseWidth; break;
-				case '\'':	if(state->turtle.polyMatIdx < this->m_gen_materials.size() - 1) state->turtle.polyMatIdx++; break;
-				case '[':	pushState(&state); break;
-				case ']':	popState(&state); break;
-				case '{':	polyScopeCnt++; break;
-				case '}':	polyScopeCnt--; break;
-				case 'F':
-				case 'G': {
-						eQuat currentRot = parentProdSym.correctRot * curSymbol.rotation;
-						eQuat currentGlobalRot = state->curBaseRotation * currentRot;
-						this->applyForce(curSymbol, currentGlobalRot, state->curBaseRotation, state->turtle.position);
-
-						state->turtle.rotation = (state->curBaseRotation * currentRot);
-						eF32 amount = (state->turtle.size * state->turtle.height * curSymbol.params[0]);
-						state->turtle.texPos += curSymbol.texVec * (this->m_gen_texScale * amount);
-						state->turtle.position += state->turtle.rotation.getVector(2) * amount;
-					}
-				default:
-					state->turtle.size *= m_sizeDecayPar;
-					curProdSym.correctRot = state->curBaseRotation * parentProdSym.correctRot;
-//                    {
-//	                ePROFILER_ZONE("L-System - Draw Internal Calc");
-					state->turtle.rotation = curProdSym.correctRot * curSymbol.rotation;
-//                    }
+	const eArray<tSymbol>& production = productions[numProductions - 1];
+	for(eU32 s = 0; s < production.size(); s++) {
+		const tSymbol& curSymbol = production[s];
+		const tTurtleState& turtle = m_turtles[s];
+		const eS32 symbolRaw = curSymbol.symbol;
+
+		switch(curSymbol.symbol) {
+		case '%': { // skip remaining
+				eU32 scopeCnt = 1;
+				while(((++s) < (eS32)production.size()) && (scopeCnt > 0))
+					if(production[s].symbol == '[')			scopeCnt++;
+					else if(production[s].symbol == ']')	scopeCnt--;
+				s -= 2;
 			}
-
-			// only draw last production
-			if(!isLastProduction)
-				continue;
-				
-			ePROFILER_ZONE("L-System - DrawInterpret");
-
-			switch(curSymbol.symbol) {
-
-			case '%': { // skip remaining
-					eU32 scopeCnt = 1;
-					while(((++s) < (eS32)production.size()) && (scopeCnt > 0))
-						if(production[s].symbol == '[')			scopeCnt++;
-						else if(production[s].symbol == ']')	scopeCnt--;
-					s -= 2;
-				}
-				continue;
-			case '[': this->pushDrawState(&drawState); break;
-			case ']': this->popDrawState(&drawState); break;
-			case '{': 
-						if(polyStackPos >= polygonStack.size())
-							polygonStack.append(eArray<eInt>()); 
-						polygon = &polygonStack[polyStackPos++];
-						polygon->clear(); 
-					break;
-			case '}': {
-					if((state->turtle.polyMatIdx >= 0) && (state->turtle.polyMatIdx < m_gen_materials.size())) {
-						for(eU32 p = 0; (eS32)p < (eS32)polygon->size() - 2; p++) {
-							// draw polys
-							destMesh.addTriangleFast((*polygon)[p], 
-								                 (*polygon)[p+1], 
-												 (*polygon)[polygon->size() - 1],
-												 m_gen_materials_dsIdx[state->turtle.polyMatIdx]);
-						}
+			continue;
+		case '[': this->pushDrawState(&drawState); break;
+		case ']': this->popDrawState(&drawState); break;
+		case '{': 
+					if(polyStackPos >= polygonStack.size())
+						polygonStack.append(eArray<eInt>()); 
+					polygon = &polygonStack[polyStackPos++];
+					polygon->clear(); 
+				break;
+		case '}': {
+				if((turtle.polyMatIdx >= 0) && (turtle.polyMatIdx < m_gen_materials.size())) {
+					for(eU32 p = 0; (eS32)p < (eS32)polygon->size() - 2; p++) {
+						// draw polys
+						destMesh.addTriangleFast((*polygon)[p], 
+							                 (*polygon)[p+1], 
+											 (*polygon)[polygon->size() - 1],
+											 m_gen_materials_dsIdx[turtle.polyMatIdx]);
 					}
-
-					// pop stack
-                    polyStackPos--;
-                    if(polyStackPos > 0)
-					    polygon = &polygonStack[polyStackPos - 1];
 				}
-				break;
-			case 'F':
-			case '.': if(polyStackPos > 0) {
-							polygon->append(destMesh.addVertex(state->turtle.position, state->turtle.rotation.getVector(2), state->turtle.texPos)); 
-                      }
-				// no break
-			default:
-				if((symbolRaw >= LSYS_VAR_MIN) && (symbolRaw <= LSYS_VAR_MAX)) {
-					if(this->m_subSystem[symbolRaw] != eNULL) {
+
+				// pop stack
+                polyStackPos--;
+                if(polyStackPos > 0)
+				    polygon = &polygonStack[polyStackPos - 1];
+			}
+			break;
+		case 'F':
+		case '.': if(polyStackPos > 0) {
+						polygon->append(destMesh.addVertex(turtle.position, turtle.rotation.getVector(2), turtle.texPos)); 
+                  }
+			// no break
+		default:
+			if((symbolRaw >= LSYS_VAR_MIN) && (symbolRaw <= LSYS_VAR_MAX)) {
+				if(this->m_subSystem[symbolRaw] != eNULL) {
 //						ePROFILER_ZONE("L-System - Draw Sub LSys");
-						this->m_subSystem[symbolRaw]->processSub(destsg, destMesh, state->turtle);
-					} else if(this->m_subMesh[symbolRaw] != eNULL) {
-						ePROFILER_ZONE("L-System - Draw Sub Model");
-
-						eMatrix4x4 mtx;
-						mtx.scale(state->turtle.size);
-						eQuat con = state->turtle.rotation;
-						con.conjugate();
-                        eMatrix4x4 rotMtx((eQuat(eVector3(1,0,0), -ePI * 0.5f) * (con)));
-						mtx = mtx * rotMtx;
-						mtx.translate(eVector3(state->turtle.position.x, state->turtle.position.y, state->turtle.position.z));
-
-                        if(m_subMeshInstancing[symbolRaw])
-                            destsg.merge(*this->m_subMesh[symbolRaw], mtx);
-                        else
-                            for(eU32 i = 0; i < m_subMesh[symbolRaw]->getEntryCount(); i++) 
-                                _mergeIntoMesh(destMesh, mtx, rotMtx, m_subMesh[symbolRaw]->getEntry(i));
+					this->m_subSystem[symbolRaw]->processSub(destsg, destMesh, turtle);
+				} else if(this->m_subMesh[symbolRaw] != eNULL) {
+					ePROFILER_ZONE("L-System - Draw Sub Model");
+
+					eMatrix4x4 mtx;
+					mtx.scale(turtle.size);
+					eQuat con = turtle.rotation;
+					con.conjugate();
+                    eMatrix4x4 rotMtx((eQuat(eVector3(1,0,0), -ePI * 0.5f) * (con)));
+					mtx = mtx * rotMtx;
+					mtx.translate(eVector3(turtle.position.x, turtle.position.y, turtle.position.z));
+
+                    if(m_subMeshInstancing[symbolRaw])
+                        destsg.merge(*this->m_subMesh[symbolRaw], mtx);
+                    else
+                        for(eU32 i = 0; i < m_subMesh[symbolRaw]->getEntryCount(); i++) 
+                            _mergeIntoMesh(destMesh, mtx, rotMtx, m_subMesh[symbolRaw]->getEntry(i));
 //                                _mergeIntoMesh(destMesh, mtx, mtx, m_subMesh[symbolRaw]->getEntry(i));
-					} else {
-						bool skipDraw = false;
-						if((polyStackPos == 0) || (polygon->size() == 0)) {
-							// draw aggregated shapes
-							if((symbolRaw != 'F') || (state->turtle.polyMatIdx < 0) || (state->turtle.polyMatIdx >= m_gen_materials.size()))
-							{
+				} else {
+					bool skipDraw = false;
+					if((polyStackPos == 0) || (polygon->size() == 0)) {
+						// draw aggregated shapes
+						if((symbolRaw != 'F') || (turtle.polyMatIdx < 0) || (turtle.polyMatIdx >= m_gen_materials.size()))
+						{
+						} else {
+
+							eBool forceDraw = (s >= production.size() - 1) ||
+								(production[s + 1].symbol != curSymbol.symbol);
+							eF32 stepLen = turtle.size * turtle.height;
+							skipDraw = !this->drawShapes(destMesh, *drawState, drawState->lastTurtle, turtle, accumulatedStepLen + stepLen, drawState->texYOffset, drawState->texYOffset + m_gen_texScale, forceDraw, accumulatedStepCount + 1);
+							if(skipDraw) {
+								accumulatedStepCount++;
+								accumulatedStepLen += stepLen;
 							} else {
-
-								eBool forceDraw = (s >= production.size() - 1) ||
-									(production[s + 1].symbol != curSymbol.symbol);
-								eF32 stepLen = state->turtle.size * state->turtle.height;
-								skipDraw = !this->drawShapes(destMesh, *drawState, drawState->lastTurtle, state->turtle, accumulatedStepLen + stepLen, drawState->texYOffset, drawState->texYOffset + m_gen_texScale, forceDraw, accumulatedStepCount + 1);
-								if(skipDraw) {
-									accumulatedStepCount++;
-									accumulatedStepLen += stepLen;
-								} else {
-									accumulatedStepCount = 0;
-									accumulatedStepLen = 0.0f;
-								}
+								accumulatedStepCount = 0;
+								accumulatedStepLen = 0.0f;
 							}
 						}
-
-						drawState->texYOffset += m_gen_texScale;
-						if(!skipDraw)
-							drawState->lastTurtle = state->turtle;
 					}
+
+					drawState->texYOffset += m_gen_texScale;
+					if(!skipDraw)
+						drawState->lastTurtle = turtle;
 				}
 			}
 		}
-		this->popState(&state);
-	} 
-
+	}
 }
 
 
-void eLSystem::applyForce(tSymbol& symbol, const eQuat& curRot, eQuat& targetRot, eVector3& targetPos) {
+void eLSystem::applyForce(const eQuat& curRot, eQuat& targetRot, const eVector3& targetPos, eU32* hints) const {
     ePROFILER_ZONE("L-System - Apply Force");
 	for(eS32 a = -1; a < (eS32)m_forces.size(); a++) {
 
@@ -739,30 +1003,22 @@ void eLSystem::applyForce(tSymbol& symbol, const eQuat& curRot, eQuat& targetRot
             eVector3 attractorPos = (*attractor.triDefs)[0];
             attractAmount = attractor.mass;
             axis = attractor.attractAxis;
-/*
-#ifdef eEDITOR
-            if(attractor.gen_type == FG_CLOSEST_FACE) {
-                eU32     bestFaceOffset = 0;
-                eVector3 bestFaceStats(eF32_MAX, 0, 0);
-                for(eU32 i = 0; i < attractor.triDefs->size(); i += 3) {
-                    const eVector3& B = (*attractor.triDefs)[i];
-                    const eVector3& E0 = (*attractor.triDefs)[i+1];
-                    const eVector3& E1 = (*attractor.triDefs)[i+2];
-                    eVector3 distTest = targetPos.distanceToTriangle(B, E0, E1);
-                    if(distTest.x < bestFaceStats.x) {
-                        bestFaceStats = distTest;
-                        bestFaceOffset = i;
-                    }
-                }
-                // calculate attractor face
-                const eVector3& B = (*attractor.triDefs)[bestFaceOffset];
-                const eVector3& E0 = (*attractor.triDefs)[bestFaceOffset+1];
-                const eVector3& E1 = (*attractor.triDefs)[bestFaceOffset+2];
-                attractorPos = B + E0 * bestFaceStats.y + E1 * bestFaceStats.z;
-                attractAmount = attractor.mass * (1.0f / bestFaceStats.x);
+
+            // Successive symbols lie close to each other,
+            // so the last closest triangle is used as hint
+            // to find the new one quickly.
+            if(attractor.gen_type == FG_CLOSEST_FACE && !attractor.bvh->isEmpty()) {
+                eTriangleBvh::Hit hit;
+                attractor.bvh->findClosest(targetPos, hit, hints[a]);
+                hints[a] = hit.triangle;
+
+                if(hit.sqrDist <= eALMOST_ZERO)
+                    continue;
+
+                attractorPos = hit.position;
+                attractAmount = attractor.mass * (1.0f / hit.sqrDist);
             }
-#endif
-*/
+
     		attractionVec = attractorPos - targetPos;
         }
 
@@ -838,27 +1094,9 @@ void eLSystem::addGeometryNeeds(eU32 &neededVerts, eU32& neededFaces) {
 	}
 }
 
-void eLSystem::pushState(tState** state) {
-//		ePROFILER_ZONE("L-System - Push State");
-#ifdef eEDITOR
-	if(stackPos >= LSYS_MAX_STACK)
-		MessageBox(0,"ERROR: Stack maximum exceeded",0,0);
-#endif
-	tState* lastState = (*state);
-	stackPos++;
-	(*state) = &stack[stackPos];
-	*(*state) = *lastState;
-	(*state)->parentState = lastState;
-}
-
-void eLSystem::popState(tState** state) {
-	stackPos--;
-	(*state) = (*state)->parentState;
-}
-
 void eLSystem::pushDrawState(tDrawState** state) {
 #ifdef eEDITOR
-	if(stackPos >= LSYS_MAX_STACK)
+	if(drawStackPos + 1 >= LSYS_MAX_STACK)
 		MessageBox(0,"ERROR: Stack maximum exceeded",0,0);
 #endif
 	tDrawState* lastState = (*state);
@@ -896,10 +1134,10 @@ eBool eLSystem::drawShapes(eMesh& destMesh, tDrawState& state, const tTurtleStat
 
     ePROFILER_ZONE("L-System - Draw Shapes");
 
-    __declspec(align(16)) const eVector3  control0 = turtle0.position;
-	__declspec(align(16)) const eVector3  control1 = control0   + turtle0.rotation.getVector(2) * 0.333333f * shapeLen;
-    __declspec(align(16)) const eVector3  control3 = turtle1.position;
-	__declspec(align(16)) const eVector3  control2 = control3   - turtle1.rotation.getVector(2) * 0.333333f * shapeLen;
+    eALIGN16 const eVector3  control0 = turtle0.position;
+	eALIGN16 const eVector3  control1 = control0   + turtle0.rotation.getVector(2) * 0.333333f * shapeLen;
+    eALIGN16 const eVector3  control3 = turtle1.position;
+	eALIGN16 const eVector3  control2 = control3   - turtle1.rotation.getVector(2) * 0.333333f * shapeLen;
 
     eF32 rscale0 = turtle0.size * turtle0.width;
 	eF32 rscale1 = turtle1.size * turtle1.width;
@@ -911,8 +1149,8 @@ eBool eLSystem::drawShapes(eMesh& destMesh, tDrawState& state, const tTurtleStat
 			eF32 rscale = eLerp(rscale0, rscale1, tt);
 			if((r != 0) || (state.lastVertices->size() == 0)) {
                 // create ring vertices
-                __declspec(align(16)) eVector3 position;
-                __declspec(align(16)) eVector3 normal;
+                eALIGN16 eVector3 position;
+                eALIGN16 eVector3 normal;
 
                 // calculate bezier curve position
                 __m128 mt = _mm_set1_ps(tt);
@@ -964,7 +1202,7 @@ eBool eLSystem::drawShapes(eMesh& destMesh, tDrawState& state, const tTurtleStat
                 mdot = _mm_mul_ps(mside, mside);
                 mdotagg = _mm_hadd_ps(mdot, mdot);
                 __m128 dotsum = _mm_hadd_ps(mdotagg, mdotagg);
-                const eF32 sideLenSqr = dotsum.m128_f32[0];
+                const eF32 sideLenSqr = _mm_cvtss_f32(dotsum);
                 if(sideLenSqr > eALMOST_ZERO) {
                     recipsqrt = _mm_rsqrt_ss( dotsum );
                     __m128 sidenorm = _mm_mul_ps(mside, _mm_shuffle_ps(recipsqrt, recipsqrt, _MM_SHUFFLE(0,0,0,0)));
@@ -973,7 +1211,7 @@ eBool eLSystem::drawShapes(eMesh& destMesh, tDrawState& state, const tTurtleStat
                     __m128 dotprod = _mm_mul_ps(mlook, sidenorm);
                     __m128 dph0 = _mm_hadd_ps(dotprod, dotprod);
                     __m128 dph1 = _mm_hadd_ps(dph0, dph0);
-                    const eF32 dot = eClamp(-1.0f, dph1.m128_f32[0], 1.0f);
+                    const eF32 dot = eClamp(-1.0f, _mm_cvtss_f32(dph1), 1.0f);
 		            eF32 alpha = eACos(dot) * (1.0f / (2.0f * ePI));
 
                     eQuat rotation(sidenorm, alpha);
@@ -982,8 +1220,8 @@ eBool eLSystem::drawShapes(eMesh& destMesh, tDrawState& state, const tTurtleStat
 
 
 				eMatrix4x4 curveMat(ringRot);
-                __declspec(align(16)) eVector3 ringX = curveMat.getVector(0);
-                __declspec(align(16)) eVector3 ringY = curveMat.getVector(1);
+                eALIGN16 eVector3 ringX = curveMat.getVector(0);
+                eALIGN16 eVector3 ringY = curveMat.getVector(1);
 
 				eF32 texY = eLerp(stexY0, stexY1, tt);
                 const eF32 texXStep = 1.0f / m_gen_edges;
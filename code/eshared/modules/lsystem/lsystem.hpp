@@ -30,6 +30,9 @@
 #define LSYS_NUM_INTERPRETATIONS (LSYS_POLY_INTERPRETATION + LSYS_NUM_POLY_INTERPRETATIONS)
 #define LSYS_MAX_EDGES 10
 #define LSYS_MAX_FACES 1000000
+#define LSYS_NO_RULE 0xffffffff
+#define LSYS_RULE_CHUNK_SIZE 1024
+#define LSYS_MIN_BRANCH_SIZE 256
 
 #define DEFAULT_ROTATION eQuat(eVector3(1,0,0), -ePI * 0.5f)
 #define DEFAULT_ROTATION_INV eQuat(eVector3(1,0,0), ePI * 0.5f)
@@ -63,11 +66,12 @@ public:
 		eU32		attractAxis;
 		eF32		mass;
 
-//        FORCE_GEN_TYPE      gen_type;
+        FORCE_GEN_TYPE      gen_type;
         eArray<eVector3>*   triDefs;
+        const eTriangleBvh* bvh;
 	};
 
-	__declspec(align(16)) struct tTurtleState {
+	struct eALIGN16 tTurtleState {
 		eQuat	curBaseRotation;
         eQuat		rotation;
 		eVector3	position;
@@ -79,7 +83,7 @@ public:
 		eVector2	texPos;
 	};
 
-	__declspec(align(16)) struct tSymbol {
+	struct eALIGN16 tSymbol {
         // 0
 		eQuat		rotation;		// basic rotation
         // 16
@@ -94,7 +98,7 @@ public:
         // 48
 	};
 
-	__declspec(align(16)) struct tProdSymbol {
+	struct eALIGN16 tProdSymbol {
 		eQuat		correctRot;
 //		eVector3	correctPos;
 	};
@@ -112,13 +116,40 @@ private:
 
 	typedef struct tState {
 		tTurtleState				turtle;
-		__declspec(align(16)) eQuat	curBaseRotation;
+		eALIGN16 eQuat	curBaseRotation;
 		tState*						parentState;
 		eInt						curPolyVertex;
 		eU32						scopeStart;
 
 	};
 
+	// bracket stack entry while deriving or
+	// interpreting a branch
+	struct eALIGN16 tFrame {
+		tTurtleState				turtle;
+		eQuat						curBaseRotation;
+		eU32						scopeStart;
+		eU32						scopeEnd;
+	};
+
+	// Bracketed scope of a production, which is
+	// processed by one job after its parent job
+	// stored the entry state. Branch 0 is the
+	// whole production.
+	struct eALIGN16 tBranch {
+		tState						entry;
+		eU32						first;
+		eU32						end;
+		eU32						level;
+		eBool						entered;
+	};
+
+	struct tBranchJob {
+		eLSystem*					lsys;
+		void						(eLSystem::*func)(eU32 branch);
+		const eU32*					branches;
+	};
+
 public:
 
 	eLSystem();
@@ -156,22 +187,37 @@ private:
 
 	void processSub(eSceneData& destsg, eMesh& destMesh, const tTurtleState& turtle);
 	void drawInternal(eSceneData& destsg, eMesh& destMesh, tState* state);
-	void applyForce(tSymbol& symbol, const eQuat& curRot, eQuat& targetRot, eVector3& targetPos);
-	void pushState(tState** state);
-	void popState(tState** state);
+	void applyForce(const eQuat& curRot, eQuat& targetRot, const eVector3& targetPos, eU32* hints) const;
+	eU32 chooseRules(eU32 production);
+	void propagateMass(eArray<tSymbol>& production);
+	void findBranches(const eArray<tSymbol>& production, const tState& rootState);
+	// whether the scope opened at pos is processed
+	// as own branch
+	eBool isBranch(eU32 pos) const {
+		return m_scopeEnds[pos] + 1 - pos >= LSYS_MIN_BRANCH_SIZE;
+	}
+	eU32 deferBranch(eU32 pos, const tState& entry);
+	void processBranches(eU32 production, const tState& rootState, void (eLSystem::*func)(eU32 branch));
+	void deriveBranch(eU32 branch);
+	void interpretBranch(eU32 branch);
 	void pushDrawState(tDrawState** state);
 	void popDrawState(tDrawState** state);
 	// returns whether the shape was drawn
 	eBool drawShapes(eMesh& destMesh, tDrawState& state, const tTurtleState& turtle0, const tTurtleState& turtle1, eF32 shapeLen, eF32 stexY0, eF32 stexY1, eBool forceDraw, eU32 numParts);
 
+	static void chooseRulesJob(ePtr arg, eU32 index);
+	static void branchJob(ePtr arg, eU32 index);
+
 	eU32			paramTable[LSYS_MAX_RULES][LSYS_PAR_MAX];
 	eArray<eU32>	symRules[256];
 	eU32			ruleOffsets[LSYS_MAX_RULES];
+	eU32			ruleBodies[LSYS_MAX_RULES];
+	eU32			ruleLengths[LSYS_MAX_RULES];
 
 	eArray<tSymbol>	productions[LSYS_MAX_PRODUCTIONS];
 	eU32			numProductions;
 
-    tState							stack[LSYS_MAX_STACK];
+    tState							defaultState;
     eArray<eInt>					verticeStack[LSYS_MAX_STACK];
     eArray<eInt>					verticeTempStack[LSYS_MAX_STACK];
     tDrawState						drawStack[LSYS_MAX_STACK];
@@ -180,7 +226,6 @@ private:
 	eArray<eArray<eInt>>	polygonStack;
 	eArray<eInt>*	        polygon;
 
-	eU32 stackPos;
 	eU32 drawStackPos;
 
 	eArray<eInt>	vtxLoop;
@@ -193,6 +238,7 @@ private:
 	eU32        m_iterations;
 	eF32		m_baseWidth;
 	eArray<tForceGenerator>		m_forces;
+    eArray<eU32>                m_forceHints;
 
 
 	eU32						m_gen_rings;
@@ -207,6 +253,21 @@ private:
     eBool				        m_subMeshInstancing[256];
 
 	eArray<tProdSymbol>		    m_prodBuffer[2];
+	eArray<tTurtleState>		m_turtles;
+
+	// derivation and interpretation buffers, they
+	// keep their memory between evaluations
+	eU32						m_jobProduction;
+	eF32						m_symbolMass;
+	eArray<eU32>				m_symbolRules;
+	eArray<eU32>				m_offsets;
+	eArray<eF32>				m_massContrib;
+	eArray<eF32>				m_massStack;
+	eArray<eU32>				m_scopeEnds;
+	eArray<eU32>				m_openScopes;
+	eArray<tBranch>				m_branches;
+	eArray<eU32>				m_branchOrder;
+	eArray<eU32>				m_levelStarts;
 
 };
 
@@ -15,7 +15,9 @@
 #include "lsystem.hpp"
 
 #ifdef eDEBUG
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdio.h>
 #endif
 
@@ -33,49 +35,34 @@ OP_DEFINE(eLAttractorOp, eLAttractorOp_ID, eIGenericOp, "LAttractor", Misc, Misc
         this->m_genData = &m_forceGen;
 	    eOP_PARAM_ADD_LABEL("Attractor", "Attractor");
         eOP_PARAM_ADD_LINK("Mesh", "Mesh");
-//	    eOP_PARAM_ADD_ENUM("Method", "Center|Faces", 0);
 	    eOP_PARAM_ADD_LABEL("Effect", "Effect");
         eOP_PARAM_ADD_FLOAT("Amount", -eF32_MAX, eF32_MAX, 1);
 	    eOP_PARAM_ADD_ENUM("Axis", "X|Y|Z", 0);
+	    eOP_PARAM_ADD_ENUM("Method", "Center|Faces", 0);
     }
 
-    OP_EXEC(eGraphicsApiDx9 *gfx, eIMeshOp* meshOp, /*eU32 method, */eF32 amount, eU32 axis)
+    OP_EXEC(eGraphicsApiDx9 *gfx, eIMeshOp* meshOp, eF32 amount, eU32 axis, eU32 method)
     {
         m_forceGen.triDefs = &m_triDefs;
+        m_forceGen.bvh = &m_bvh;
         m_forceGen.attractAxis = axis;
-//        m_forceGen.gen_type = (eLSystem::FORCE_GEN_TYPE)method;
+        m_forceGen.gen_type = (eLSystem::FORCE_GEN_TYPE)method;
         m_forceGen.mass = amount < 0.0f ? - amount * amount : amount * amount;
-        
 
+        // the center is kept as fallback for meshes
+        // without faces in closest face mode
         m_triDefs.clear();
-        if(meshOp) {
-            const eEditMesh& mesh = meshOp->getResult().mesh;
-/*
-#ifdef eEDITOR
-            if(m_forceGen.gen_type == eLSystem::FG_CLOSEST_FACE) {
-                m_triDefs.reserve(mesh.getFaceCount() * 3);
-                for(eU32 f = 0; f < mesh.getFaceCount(); f++) {
-                    const eEditMesh::Face* face = mesh.getFace(f);
-                    const eVector3& v0 = face->he->origin->position;
-                    const eVector3& v1 = face->he->next->origin->position;
-                    const eVector3& v2 = face->he->next->next->origin->position;
-                    m_triDefs.append(v0);
-                    m_triDefs.append(v1 - v0);
-                    m_triDefs.append(v2 - v0);
-                }
-            } else if(m_forceGen.gen_type == eLSystem::FG_POINT) {
-#endif
-*/
-                m_triDefs.append(mesh.getBoundingBox().getCenter());
-/*
-#ifdef eEDITOR
-            }
-#endif
-*/
-        }
+        if(meshOp && m_forceGen.gen_type == eLSystem::FG_CLOSEST_FACE)
+            m_bvh.update(meshOp->getResult().mesh);
+        else
+            m_bvh.clear();
+
+        if(meshOp)
+            m_triDefs.append(meshOp->getResult().mesh.getBoundingBox().getCenter());
     }
     eLSystem::tForceGenerator m_forceGen;
     eArray<eVector3>    m_triDefs;
+    eTriangleBvh        m_bvh;
 OP_END(eLAttractorOp);
 #endif
 
@@ -103,6 +90,118 @@ OP_END(eLSymbolOp);
 
 #if defined(HAVE_OP_MODEL_LSYSTEM) || defined(eEDITOR)
 
+#ifdef eEDITOR
+// Result cache format of drawn L-system meshes:
+// header, vertices and the draw sections with the
+// vertex indices of their primitives. Materials
+// are referred to by their index in the given
+// list. Increase the version whenever the format
+// changes.
+#define LSYS_STORED_MESH_VERSION 1
+
+struct tStoredMeshHeader {
+    eU32    version;
+    eU32    vertexCount;
+    eU32    primitiveCount;
+    eU32    sectionCount;
+};
+
+struct tStoredDrawSection {
+    eU32    type;
+    eU32    material;
+    eU32    primitiveCount;
+};
+
+static eU32 _getPrimitiveVertexCount(eU32 dsType) {
+    switch(dsType) {
+        case eMesh::DrawSection::TYPE_TRIANGLES:    return 3;
+        case eMesh::DrawSection::TYPE_LINES:        return 2;
+        case eMesh::DrawSection::TYPE_POINTS:       return 1;
+    }
+    return 0;
+}
+
+static void _storeMesh(const eMesh &mesh, const eArray<const eMaterial *> &materials, eByteArray &data) {
+    tStoredMeshHeader header;
+    header.version = LSYS_STORED_MESH_VERSION;
+    header.vertexCount = mesh.getVertexCount();
+    header.primitiveCount = mesh.getPrimitiveCount();
+    header.sectionCount = mesh.getDrawSectionCount();
+
+    eArray<eU32> sectionMats(header.sectionCount);
+    for(eU32 i = 0; i < header.sectionCount; i++) {
+        const eInt mat = materials.exists(mesh.getDrawSection(i).material);
+        if(mat == -1)
+            return;
+        sectionMats[i] = mat;
+    }
+
+    data.reserve(sizeof(header) + header.vertexCount * sizeof(eVertex) + header.primitiveCount * 3 * sizeof(eU32));
+    eOpResultCache::append(data, &header, sizeof(header));
+    for(eU32 i = 0; i < header.vertexCount; i++)
+        eOpResultCache::append(data, &mesh.getVertex(i), sizeof(eVertex));
+
+    for(eU32 i = 0; i < header.sectionCount; i++) {
+        const eMesh::DrawSection &ds = mesh.getDrawSection(i);
+        tStoredDrawSection sds;
+        sds.type = ds.type;
+        sds.material = sectionMats[i];
+        sds.primitiveCount = ds.primitives.size();
+        eOpResultCache::append(data, &sds, sizeof(sds));
+
+        const eU32 vtxCount = _getPrimitiveVertexCount(ds.type);
+        for(eU32 j = 0; j < ds.primitives.size(); j++)
+            eOpResultCache::append(data, mesh.getPrimitive(ds.primitives[j]).indices, vtxCount * sizeof(eU32));
+    }
+}
+
+static eBool _loadMesh(eMesh &mesh, const eArray<const eMaterial *> &materials, const eByteArray &data) {
+    eU32 pos = 0;
+    tStoredMeshHeader header;
+    if(!eOpResultCache::read(data, pos, &header, sizeof(header)) || header.version != LSYS_STORED_MESH_VERSION)
+        return eFALSE;
+
+    mesh.clear();
+    mesh.reserveSpace(header.primitiveCount, header.vertexCount);
+
+    for(eU32 i = 0; i < header.vertexCount; i++) {
+        eVertex vtx(eVector3(), eVector3(), eVector2(), eColor::WHITE);
+        if(!eOpResultCache::read(data, pos, &vtx, sizeof(vtx)))
+            return eFALSE;
+        mesh.addVertex(vtx.position, vtx.normal, vtx.texCoord, vtx.color);
+    }
+
+    for(eU32 i = 0; i < header.sectionCount; i++) {
+        tStoredDrawSection sds;
+        if(!eOpResultCache::read(data, pos, &sds, sizeof(sds)) || sds.material >= materials.size())
+            return eFALSE;
+
+        const eMaterial *mat = materials[sds.material];
+        const eU32 vtxCount = _getPrimitiveVertexCount(sds.type);
+        if(vtxCount == 0)
+            return eFALSE;
+
+        for(eU32 j = 0; j < sds.primitiveCount; j++) {
+            eU32 indices[3];
+            if(!eOpResultCache::read(data, pos, indices, vtxCount * sizeof(eU32)))
+                return eFALSE;
+            for(eU32 k = 0; k < vtxCount; k++)
+                if(indices[k] >= header.vertexCount)
+                    return eFALSE;
+
+            if(vtxCount == 3)
+                mesh.addTriangle(indices[0], indices[1], indices[2], mat);
+            else if(vtxCount == 2)
+                mesh.addLine(indices[0], indices[1], mat);
+            else
+                mesh.addPoint(indices[0], mat);
+        }
+    }
+
+    return (pos == data.size());
+}
+#endif
+
 OP_DEFINE_MODEL(eLSystemOp2, eLSystemOp2_ID, "LSystem", 'l', 0, 20, "-1,Path|Misc")
 
 	eLSystem		m_lsys;
@@ -163,6 +262,9 @@ OP_DEFINE_MODEL(eLSystemOp2, eLSystemOp2_ID, "LSystem", 'l', 0, 20, "-1,Path|Mis
 		eOP_PARAM_ADD_LINK("Material4","Misc");
 
         m_mi = eNULL;
+#ifdef eEDITOR
+        m_meshLoaded = eFALSE;
+#endif
     }
 
     OP_DEINIT()
@@ -303,14 +405,22 @@ OP_DEFINE_MODEL(eLSystemOp2, eLSystemOp2_ID, "LSystem", 'l', 0, 20, "-1,Path|Mis
 //        const eMesh::Type meshType = (isAffectedByAnimation() ? eMesh::TYPE_DYNAMIC : eMesh::TYPE_STATIC);
         const eMesh::Type meshType = eMesh::TYPE_DYNAMIC;
 
-		m_rmesh.clear();
-	    eU32 neededVerts = 0;
-	    eU32 neededFaces = 0;
-	    // prepare mesh generation
-	    m_lsys.addGeometryNeeds(neededVerts, neededFaces);
-	    m_rmesh.reserveSpace(neededFaces, neededVerts);
-
-		m_lsys.draw(m_sceneData, m_rmesh, 1.0f);
+        eBool drawMesh = eTRUE;
+#ifdef eEDITOR
+        // Mesh was restored from the result cache.
+        drawMesh = !m_meshLoaded;
+        m_meshLoaded = eFALSE;
+#endif
+        if(drawMesh) {
+		    m_rmesh.clear();
+	        eU32 neededVerts = 0;
+	        eU32 neededFaces = 0;
+	        // prepare mesh generation
+	        m_lsys.addGeometryNeeds(neededVerts, neededFaces);
+	        m_rmesh.reserveSpace(neededFaces, neededVerts);
+
+		    m_lsys.draw(m_sceneData, m_rmesh, 1.0f);
+        }
 
         m_rmesh.finishLoading(meshType);
 
@@ -320,6 +430,57 @@ OP_DEFINE_MODEL(eLSystemOp2, eLSystemOp2_ID, "LSystem", 'l', 0, 20, "-1,Path|Mis
 
         m_sceneData.addRenderable(m_mi);
     }
+
+#ifdef eEDITOR
+    // Only the drawn mesh is cached. The L-system is
+    // still evaluated on execution, because L-symbol
+    // and populate operators use it. Sub-models are
+    // drawn into the scene data instead of the mesh,
+    // so L-systems using them (directly or through
+    // sub-systems) aren't cached.
+    virtual eBool _canCacheResult() const
+    {
+        return !_usesSubModels();
+    }
+
+    virtual eBool _executesAfterLoad() const
+    {
+        return eTRUE;
+    }
+
+    virtual void _storeResult(eByteArray &data) const
+    {
+        eArray<const eMaterial *> materials;
+        _getDependentMaterials(materials);
+        _storeMesh(m_rmesh, materials, data);
+    }
+
+    virtual eBool _loadResult(const eByteArray &data)
+    {
+        eArray<const eMaterial *> materials;
+        _getDependentMaterials(materials);
+        m_meshLoaded = _loadMesh(m_rmesh, materials, data);
+        return m_meshLoaded;
+    }
+
+    eBool _usesSubModels() const
+    {
+        for(eU32 a = 0; a < getInputCount(); a++) {
+            if(TEST_OP_TYPE(getInputOperator(a), "Misc : LSymbol", eLSymbolOp_ID)) {
+                const tSymbolLink* symLink = (const tSymbolLink*)((eIGenericOp *)getInputOperator(a))->getResult().genericDataPtr;
+                if(symLink->modOp == eNULL)
+                    continue;
+                if(!TEST_OP_TYPE(symLink->modOp, "Model : LSystem", eLSystemOp2_ID) ||
+                   ((const eLSystemOp2*)symLink->modOp)->_usesSubModels())
+                    return eTRUE;
+            }
+        }
+        return eFALSE;
+    }
+
+    OP_VAR(eBool m_meshLoaded);
+#endif
+
     OP_VAR(eMesh::Instance *m_mi);
     OP_VAR(eMesh m_rmesh);
 OP_END(eLSystemOp2);
@@ -348,7 +509,35 @@ OP_DEFINE_MODEL(eModelPopulateSurfaceOp, eModelPopulateSurfaceOp_ID, "Populate S
     };
 
     eArray<rEntry>  m_rentries;
-	eArray<eF32>    m_faceAreas;
+    eSurfaceSampler m_sampler;
+
+    struct tCandidate {
+        eVector3    position;
+        eVector3    normal;
+        eF32        variation;
+        eF32        angle;
+    };
+
+    struct tCandidateJob {
+        eModelPopulateSurfaceOp*    op;
+        const eEditMesh*            mesh;
+        eU32                        seed;
+        eU32                        first;
+        eU32                        count;
+        eInt                        normalCalc;
+        eF32                        sizeVariation;
+    };
+
+    eArray<tCandidate>  m_candidates;
+
+    // Spatial hash of the placed entries for the
+    // minimum distance test. Cells are as large as
+    // the largest minimum distance, so only the 27
+    // cells around a candidate have to be tested.
+    // Heads and next hold entry indices (-1 ends).
+    eArray<eU32>    m_gridHeads;
+    eArray<eU32>    m_gridNext;
+    eF32            m_gridInvCellSize;
 
     OP_VAR(eMesh::Instance *m_mi);
     OP_VAR(eMesh m_rmesh);
@@ -366,24 +555,174 @@ OP_DEFINE_MODEL(eModelPopulateSurfaceOp, eModelPopulateSurfaceOp_ID, "Populate S
         eOP_PARAM_ADD_BOOL("Recalc Lsys", eFALSE);
         eOP_PARAM_ADD_BOOL("Instancing", eTRUE);
         eOP_PARAM_ADD_BOOL("Throws shadows", eFALSE);
+        eOP_PARAM_ADD_BOOL("Parallel", eFALSE);
         m_mi = eNULL;
+#ifdef eEDITOR
+        m_entriesLoaded = eFALSE;
+#endif
     }
 
+#ifdef eEDITOR
+    // Only the placed entries are cached, the scene
+    // data is built from them on execution.
+    virtual eBool _canCacheResult() const
+    {
+        return eTRUE;
+    }
+
+    virtual eBool _executesAfterLoad() const
+    {
+        return eTRUE;
+    }
+
+    virtual void _storeResult(eByteArray &data) const
+    {
+        const eU32 count = m_entries.size();
+        eOpResultCache::append(data, &count, sizeof(count));
+        if(count > 0)
+            eOpResultCache::append(data, &m_entries[0], count * sizeof(tEntry));
+    }
+
+    virtual eBool _loadResult(const eByteArray &data)
+    {
+        eU32 pos = 0;
+        eU32 count;
+        if(!eOpResultCache::read(data, pos, &count, sizeof(count)) || data.size() != sizeof(count) + count * sizeof(tEntry))
+            return eFALSE;
+
+        m_entries.resize(count);
+        if(count > 0)
+            eOpResultCache::read(data, pos, &m_entries[0], count * sizeof(tEntry));
+        m_entriesLoaded = eTRUE;
+        return eTRUE;
+    }
+
+    OP_VAR(eBool m_entriesLoaded);
+#endif
+
 #define POP_SURF_MAX_RETRIES 10
+#define POP_SURF_CANDIDATE_BATCH 8192
+#define POP_SURF_CANDIDATES_PER_JOB 512
+
+    void _initGrid(eU32 count, eF32 cellSize) {
+        m_gridHeads.resize(eNextPowerOf2(count));
+        eMemSet(&m_gridHeads[0], -1, m_gridHeads.size()*sizeof(eU32));
+        m_gridNext.clear();
+        m_gridNext.reserve(count);
+        m_gridInvCellSize = 1.0f / cellSize;
+    }
+
+    eU32 _hashGridCell(eInt x, eInt y, eInt z) const {
+        // Multiply unsigned, signed overflow is undefined.
+        const eU32 key = ((eU32)x*73856093u)^((eU32)y*19349663u)^((eU32)z*83492791u);
+        return eHashInt((eInt)key) & (m_gridHeads.size()-1);
+    }
+
+    eBool _isNearEntry(const eVector3 &pos, eF32 minDistSqr) const {
+        const eInt cx = eFloor(pos.x * m_gridInvCellSize);
+        const eInt cy = eFloor(pos.y * m_gridInvCellSize);
+        const eInt cz = eFloor(pos.z * m_gridInvCellSize);
+
+        for(eInt z = cz-1; z <= cz+1; z++)
+            for(eInt y = cy-1; y <= cy+1; y++)
+                for(eInt x = cx-1; x <= cx+1; x++)
+                    for(eU32 k = m_gridHeads[_hashGridCell(x, y, z)]; k != (eU32)-1; k = m_gridNext[k])
+                        if((pos - m_entries[k].position).sqrLength() < minDistSqr)
+                            return eTRUE;
+        return eFALSE;
+    }
+
+    void _addToGrid(eU32 index) {
+        const eVector3 &pos = m_entries[index].position;
+        eU32 &head = m_gridHeads[_hashGridCell(eFloor(pos.x * m_gridInvCellSize),
+                                               eFloor(pos.y * m_gridInvCellSize),
+                                               eFloor(pos.z * m_gridInvCellSize))];
+        eASSERT(m_gridNext.size() == index);
+        m_gridNext.append(head);
+        head = index;
+    }
+
+    void _addEntry(const eVector3 &pos, eVector3 normal, eF32 curSize, eF32 angle) {
+        tEntry& entry = m_entries.push();
+        entry.position = pos;
+        entry.size = curSize;
+
+        eQuat rot(eVector3(0,1,0), angle);
+        eVector3 up(0,1,0);
+        normal.normalize();
+        eF32 dot = up * normal;
+        if(dot < 0) {
+            rot = rot * eQuat(eVector3(1,0,0), ePI);
+            up = eVector3(0,-1,0);
+            dot = up * normal;
+        }
+        eVector3 cross = (normal ^ up).normalized();
+        eF32 angleToNormal = eACos(dot);
+
+        if(eAreFloatsEqual(cross.sqrLength(), 1.0f))
+            rot = rot * eQuat(cross, angleToNormal);
+
+        entry.rotation = rot;
+        entry.rotation.x = -entry.rotation.x;
+
+        entry.matrix = eMatrix4x4(rot);
+        entry.matrix.scale(eVector3(curSize));
+        entry.matrix.translate(pos);
+    }
+
+    // In parallel mode every candidate is a function
+    // of the seed, the entry index and the retry, so
+    // that the result doesn't depend on the number of
+    // threads. Variation and angle of an entry don't
+    // change with the retries.
+    void _generateCandidate(const tCandidateJob &job, eU32 index, eU32 retry, tCandidate &cand) const {
+        const eU32 entrySeed = eHashInt(eHashInt(job.seed)+index);
+        eU32 rseed = eHashInt(entrySeed+retry+1) % 0x7ffffffe + 1;
+
+        if(retry == 0) {
+            eU32 eseed = entrySeed % 0x7ffffffe + 1;
+            cand.variation = eRandomF(eseed) * job.sizeVariation;
+            cand.angle = eRandomF(eseed) * ePI * 2.0f;
+        }
+
+        const eF32 u0 = eRandomF(rseed);
+        const eEditMesh::Face *tri = job.mesh->getFace(m_sampler.select(u0, eRandomF(rseed)));
+        eASSERT(tri != eNULL);
+        tri->getRandomSurfacePoint(cand.position, cand.normal, rseed);
+        if(job.normalCalc == 1)
+            cand.normal = tri->normal;
+    }
+
+    static void _candidateJob(ePtr arg, eU32 index) {
+        const tCandidateJob &job = *(const tCandidateJob *)arg;
+        const eU32 first = index*POP_SURF_CANDIDATES_PER_JOB;
+        const eU32 last = eMin(first+POP_SURF_CANDIDATES_PER_JOB, job.count);
+
+        for(eU32 i = first; i < last; i++)
+            job.op->_generateCandidate(job, job.first+i, 0, job.op->m_candidates[i]);
+    }
+
 	OP_EXEC(eGraphicsApiDx9 *gfx, eInt seed, eU32 count, eF32 minDist, eF32 size, 
                                 eF32 sizeVariation, eInt normalCalc, eIModelOp* model, eBool recalcLsys, 
-                                eBool instancing, eBool throwsShadows)
+                                eBool instancing, eBool throwsShadows, eBool parallel)
     {
 		ePROFILER_ZONE("Populate Surface");
+        eBool entriesLoaded = eFALSE;
+#ifdef eEDITOR
+        // Entries were restored from the result cache.
+        entriesLoaded = m_entriesLoaded;
+        m_entriesLoaded = eFALSE;
+#endif
 		if(model != eNULL) {
 
-	        eBool doRecalc = (this->getParameter(0).getChanged() ||
+	        eBool doRecalc = !entriesLoaded && (this->getParameter(0).getChanged() ||
 			                      this->getParameter(1).getChanged() ||
 			                      this->getParameter(2).getChanged() ||
 			                      this->getParameter(3).getChanged() ||
 			                      this->getParameter(4).getChanged() ||
 			                      this->getParameter(5).getChanged() ||
 			                      this->getParameter(7).getChanged() ||
+			                      this->getParameter(10).getChanged() ||
 			                      (!this->getParameter(6).getChanged()) ||
 						          m_entries.size() == 0);
             if(doRecalc) {
@@ -391,84 +730,85 @@ OP_DEFINE_MODEL(eModelPopulateSurfaceOp, eModelPopulateSurfaceOp_ID, "Populate S
      
     		    eRandomize(seed);
                 const eEditMesh &mesh = ((eIMeshOp *)getInputOperator(0))->getResult().mesh;
-			    // TODO: the following code is largely similar to the random face-point selection in the psys module
-
-			    eF32 areaSum = 0.0f;
-			    m_faceAreas.resize(mesh.getFaceCount());
-			    for (eU32 i=0; i<mesh.getFaceCount(); i++) {
-				    // Calc face area.
-				    areaSum += mesh.getFace(i)->getArea();
-				    // Add to sum.
-				    m_faceAreas[i] = areaSum;
-			    }
+                m_sampler.update(mesh, eSurfaceSampler::MODE_FACES);
+                const eF32 areaSum = m_sampler.getTotalWeight();
 
                 m_entries.clear();
-    
-			    for(eU32 i = 0; i < count; i++) {
-				    eVector3 pos, normal;
-    //					eF32 curVariation = eRandomFNormal(useed) * sizeVariation;
-				    eF32 curVariation = eRandomF() * sizeVariation;
-				    eF32 curSize = size * (1.0f + curVariation);
-				    eF32 minimumDistance = minDist * (0.5f * eSqrt(areaSum)) * (1.0f + curVariation);
-				    eF32 minDistSqr = minimumDistance * minimumDistance;
-				    eU32 retries = 0;
-
-
-				    while(retries < POP_SURF_MAX_RETRIES) {
-					    // lookup random entity with binary search
-					    eF32 a = eRandomF() * areaSum;
-					    eU32 l = 0;
-					    eU32 r = m_faceAreas.size();
-					    while (l < r) {
-						    eU32 m = (l + r) >> 1;
-						    if (a < m_faceAreas[m])   r = m;
-						    else                    l = m+1;
-					    }
-					    eU32 f = eClamp((eU32)0, r , m_faceAreas.size()-1);
-
-					    const eEditMesh::Face *tri = mesh.getFace(f);
-					    eASSERT(tri != eNULL);
-					    tri->getRandomSurfacePoint(pos, normal);
-					    if(normalCalc == 1)
-						    normal = tri->normal;
-					    bool isnear = false;
-					    for(eU32 k = 0; k < m_entries.size(); k++) 
-                            isnear |= (pos - m_entries[k].position).sqrLength() < minDistSqr;
-					    if(!isnear)
-						    break;
-					    retries++;
-				    }
-
-				    if(retries < POP_SURF_MAX_RETRIES) {
-                        tEntry& entry = m_entries.push();
-                        entry.position = pos;
-                        entry.size = curSize;
-
-					    eQuat rot(eVector3(0,1,0), eRandomF() * ePI * 2.0f);
-					    eVector3 up(0,1,0);
-					    normal.normalize();
-					    eF32 dot = up * normal;
-					    if(dot < 0) {
-						    rot = rot * eQuat(eVector3(1,0,0), ePI);
-						    up = eVector3(0,-1,0);
-						    dot = up * normal;
-					    }
-					    eVector3 cross = (normal ^ up).normalized();
-					    eF32 angle = eACos(dot);
-
-					    if(eAreFloatsEqual(cross.sqrLength(), 1.0f))
-						    rot = rot * eQuat(cross, angle);
-
-                        entry.rotation = rot;
-                        entry.rotation.x = -entry.rotation.x;
-
-                        entry.matrix = eMatrix4x4(rot);
-					    entry.matrix.scale(eVector3(curSize));
-					    entry.matrix.translate(pos);
-
-				    }
-
-			    }
+                const eU32 genCount = (mesh.getFaceCount() > 0 ? count : 0);
+
+                // Minimum distances vary with the size, so
+                // the grid cells are as large as the largest
+                // one (but not too small, to keep the cell
+                // coordinates in integer range).
+                const eBool checkDist = (minDist > 0.0f && genCount > 0);
+                if(checkDist)
+                    _initGrid(genCount, eMax(minDist * (0.5f * eSqrt(areaSum)) * (1.0f + sizeVariation), eSqrt(areaSum) * 0.0001f));
+
+                if(!parallel) {
+			        for(eU32 i = 0; i < genCount; i++) {
+				        eVector3 pos, normal;
+    //					    eF32 curVariation = eRandomFNormal(useed) * sizeVariation;
+				        eF32 curVariation = eRandomF() * sizeVariation;
+				        eF32 curSize = size * (1.0f + curVariation);
+				        eF32 minimumDistance = minDist * (0.5f * eSqrt(areaSum)) * (1.0f + curVariation);
+				        eF32 minDistSqr = minimumDistance * minimumDistance;
+				        eU32 retries = 0;
+
+				        while(retries < POP_SURF_MAX_RETRIES) {
+					        const eF32 u0 = eRandomF();
+					        const eEditMesh::Face *tri = mesh.getFace(m_sampler.select(u0, eRandomF()));
+					        eASSERT(tri != eNULL);
+					        tri->getRandomSurfacePoint(pos, normal);
+					        if(normalCalc == 1)
+						        normal = tri->normal;
+					        if(!checkDist || !_isNearEntry(pos, minDistSqr))
+						        break;
+					        retries++;
+				        }
+
+				        if(retries < POP_SURF_MAX_RETRIES) {
+                            _addEntry(pos, normal, curSize, eRandomF() * ePI * 2.0f);
+                            if(checkDist)
+                                _addToGrid(m_entries.size()-1);
+                        }
+                    }
+                } else {
+                    // First candidates of a batch are generated
+                    // in parallel, retries (only needed if the
+                    // first candidate is rejected) serially.
+                    tCandidateJob job;
+                    job.op = this;
+                    job.mesh = &mesh;
+                    job.seed = seed;
+                    job.normalCalc = normalCalc;
+                    job.sizeVariation = sizeVariation;
+                    m_candidates.resize(eMin(genCount, (eU32)POP_SURF_CANDIDATE_BATCH));
+
+                    for(job.first = 0; job.first < genCount; job.first += POP_SURF_CANDIDATE_BATCH) {
+                        job.count = eMin(genCount-job.first, (eU32)POP_SURF_CANDIDATE_BATCH);
+                        eThreadPool::get().parallelFor(_candidateJob, &job, (job.count+POP_SURF_CANDIDATES_PER_JOB-1)/POP_SURF_CANDIDATES_PER_JOB);
+
+                        for(eU32 j = 0; j < job.count; j++) {
+                            tCandidate &cand = m_candidates[j];
+				            eF32 curSize = size * (1.0f + cand.variation);
+				            eF32 minimumDistance = minDist * (0.5f * eSqrt(areaSum)) * (1.0f + cand.variation);
+				            eF32 minDistSqr = minimumDistance * minimumDistance;
+				            eU32 retries = 0;
+
+                            while(checkDist && _isNearEntry(cand.position, minDistSqr)) {
+                                if(++retries == POP_SURF_MAX_RETRIES)
+                                    break;
+                                _generateCandidate(job, job.first+j, retries, cand);
+                            }
+
+				            if(retries < POP_SURF_MAX_RETRIES) {
+                                _addEntry(cand.position, cand.normal, curSize, cand.angle);
+                                if(checkDist)
+                                    _addToGrid(m_entries.size()-1);
+                            }
+                        }
+                    }
+                }
             }
 
             m_sceneData.clear();
@@ -533,12 +873,24 @@ OP_DEFINE_MODEL(eModelPopulateSurfaceOp, eModelPopulateSurfaceOp_ID, "Populate S
 			        for(eU32 k = 0; k < m_entries.size(); k++) 
                         m_sceneData.merge(sd, m_entries[k].matrix);
                 else {
-                    eU32 vcnt = 0, fcnt = 0;
-                    sd.convertToMeshOrCount(vcnt, fcnt);
+                    // flatten the model once and merge one copy
+                    // of it per entry in a single batch
+                    eSceneData::MeshInstanceArray meshes;
+                    sd.flattenMeshes(meshes);
+
+                    eSceneData::MeshInstanceArray instances(meshes.size() * m_entries.size());
+			        for(eU32 k = 0; k < m_entries.size(); k++) {
+                        for(eU32 j = 0; j < meshes.size(); j++) {
+                            eSceneData::MeshInstance& inst = instances[k * meshes.size() + j];
+                            inst.mesh = meshes[j].mesh;
+                            inst.matrix = meshes[j].matrix * m_entries[k].matrix;
+                            inst.normalMatrix = inst.matrix.toRotationMatrix();
+                        }
+                    }
+
                     m_rmesh.clear();
-                    m_rmesh.reserveSpace(fcnt * m_entries.size(), vcnt * m_entries.size());
-			        for(eU32 k = 0; k < m_entries.size(); k++) 
-                        sd.convertToMeshOrCount(vcnt, fcnt, m_entries[k].matrix, &m_rmesh);
+                    if(instances.size() > 0)
+                        m_rmesh.mergeInstances(&instances[0], instances.size());
 
                     const eMesh::Type meshType = (isAffectedByAnimation() ? eMesh::TYPE_DYNAMIC : eMesh::TYPE_STATIC);
                     m_rmesh.finishLoading(meshType);
@@ -11,141 +11,300 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 #include "../eshared.hpp"
 
 
-    static inline __m128 CalcWeights(float x, float y)
+// Number of coordinates the distortion operators
+// hand to the bilinear sampler at once.
+static const eU32 SAMPLE_BATCH_SIZE = 64;
+
+// Bilinear filters four pixels at once. Coordinates
+// are converted to 24.8 fixed point, so the filter
+// weights are integers and don't depend on the
+// rounding mode of the SSE unit. Coordinates can be
+// in arbitrary range and are wrapped to fit between
+// [0..width-1] and [0..height-1].
+static eFORCEINLINE __m128i _sampleBilinear4(const eIBitmapOp::Result &res, const __m128 &u, const __m128 &v)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 scale = _mm_set1_ps(256.0f);
+    const __m128i fracMask = _mm_set1_epi32(255);
+    const __m128i one = _mm_set1_epi32(256);
+
+    const __m128i fu = _mm_cvttps_epi32(_mm_mul_ps(_mm_and_ps(u, absMask), scale));
+    const __m128i fv = _mm_cvttps_epi32(_mm_mul_ps(_mm_and_ps(v, absMask), scale));
+
+    // Texel coordinates of the upper left texels.
+    eALIGN16 eU32 iu[4];
+    eALIGN16 eU32 iv[4];
+
+    _mm_store_si128((__m128i *)iu, _mm_srli_epi32(fu, 8));
+    _mm_store_si128((__m128i *)iv, _mm_srli_epi32(fv, 8));
+
+    // Weights of the four texels, which always
+    // sum up to at most 256. The factors are
+    // less than 2^15, so madd only does a 32 bit
+    // multiplication.
+    const __m128i wu1 = _mm_and_si128(fu, fracMask);
+    const __m128i wv1 = _mm_and_si128(fv, fracMask);
+    const __m128i wu0 = _mm_sub_epi32(one, wu1);
+    const __m128i wv0 = _mm_sub_epi32(one, wv1);
+
+    const __m128i w00 = _mm_srli_epi32(_mm_madd_epi16(wu0, wv0), 8);
+    const __m128i w01 = _mm_srli_epi32(_mm_madd_epi16(wu1, wv0), 8);
+    const __m128i w10 = _mm_srli_epi32(_mm_madd_epi16(wu0, wv1), 8);
+    const __m128i w11 = _mm_srli_epi32(_mm_madd_epi16(wu1, wv1), 8);
+
+    // Gather the texels.
+    eALIGN16 eU32 p00[4];
+    eALIGN16 eU32 p01[4];
+    eALIGN16 eU32 p10[4];
+    eALIGN16 eU32 p11[4];
+
+    const eU32 xMask = res.width-1;
+    const eU32 yMask = res.height-1;
+
+    for (eU32 i=0; i<4; i++)
     {
-        _MM_SET_ROUNDING_MODE(_MM_ROUND_TOWARD_ZERO);
-
-        static const __m128 CONST_1111 = _mm_set1_ps(1);
-        static const __m128 CONST_256 = _mm_set1_ps(256);
+        const eU32 x0 = iu[i]&xMask;
+        const eU32 x1 = (iu[i]+1)&xMask;
+        const eColor *row0 = res.bitmap+(iv[i]&yMask)*res.width;
+        const eColor *row1 = res.bitmap+((iv[i]+1)&yMask)*res.width;
+
+        p00[i] = row0[x0].toArgb();
+        p01[i] = row0[x1].toArgb();
+        p10[i] = row1[x0].toArgb();
+        p11[i] = row1[x1].toArgb();
+    }
 
-        __m128 ssx = _mm_set_ss(x);
-        __m128 ssy = _mm_set_ss(y);
-        __m128 psXY = _mm_unpacklo_ps(ssx, ssy);      // 0 0 y x
+    // Blend two pixels per register. Products and
+    // sums are at most 255*256, so they fit into
+    // unsigned 16 bit.
+    const __m128i zero = _mm_setzero_si128();
+    __m128i res01 = zero;
+    __m128i res23 = zero;
 
-        //__m128 psXYfloor = _mm_floor_ps(psXY); // use this line for if you have SSE4
-        __m128 psXYfloor = _mm_cvtepi32_ps(_mm_cvtps_epi32(psXY));
-        __m128 psXYfrac = _mm_sub_ps(psXY, psXYfloor); // = frac(psXY)
+    const __m128i *texels[4] = {(const __m128i *)p00, (const __m128i *)p01, (const __m128i *)p10, (const __m128i *)p11};
+    const __m128i weights[4] = {w00, w01, w10, w11};
 
-        __m128 psXYfrac1 = _mm_sub_ps(CONST_1111, psXYfrac); // ? ? (1-y) (1-x)
-        __m128 w_x = _mm_unpacklo_ps(psXYfrac1, psXYfrac);   // ? ?     x (1-x)
-        w_x = _mm_movelh_ps(w_x, w_x);      // x (1-x) x (1-x)
-        __m128 w_y = _mm_shuffle_ps(psXYfrac1, psXYfrac, _MM_SHUFFLE(1, 1, 1, 1)); // y y (1-y) (1-y)
+    for (eU32 i=0; i<4; i++)
+    {
+        const __m128i p = _mm_load_si128(texels[i]);
+        const __m128i w16 = _mm_packs_epi32(weights[i], weights[i]);
+        const __m128i w = _mm_unpacklo_epi16(w16, w16);
 
-        // complete weight vector
-        return _mm_mul_ps(w_x, w_y);
+        res01 = _mm_add_epi16(res01, _mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpacklo_epi32(w, w)));
+        res23 = _mm_add_epi16(res23, _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), _mm_unpackhi_epi32(w, w)));
     }
 
-    // Returns bilinear filtered color value.
-    // Coordinates can be in arbitrary range and
-    // are wrapped to fit between [0..width-1] and
-    // [0..height-1].
-    static eColor _getBilinearFiltered(const eIBitmapOp::Result &res, eF32 u, eF32 v)
-    {
-        eF32 fau = eAbs(u);
-        eF32 fav = eAbs(v);
-        int iau = eTrunc(fau);
-        int iav = eTrunc(fav);
+    return _mm_packus_epi16(_mm_srli_epi16(res01, 8), _mm_srli_epi16(res23, 8));
+}
+
+// Bilinear filters the input bitmap at the given
+// span of coordinates and writes the colors to
+// the given destination span.
+static void _sampleBilinear(const eIBitmapOp::Result &res, const eF32 *u, const eF32 *v, eColor *dst, eU32 count)
+{
+    eU32 i = 0;
 
-        int x0 = iau&(res.width-1);
-        int y0 = (iav&(res.height-1))*res.width;
-        int x1 = (iau+1)&(res.width-1);
-        int y1 = ((iav+1)&(res.height-1))*res.width;
+    for (; i+4<=count; i+=4)
+    {
+        const __m128i c = _sampleBilinear4(res, _mm_loadu_ps(&u[i]), _mm_loadu_ps(&v[i]));
+        _mm_storeu_si128((__m128i *)&dst[i], c);
+    }
 
-        __m128 weight = CalcWeights(fau, fav);
+    if (i < count)
+    {
+        eALIGN16 eF32 tailU[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        eALIGN16 eF32 tailV[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        eALIGN16 eColor tailDst[4];
 
-        eColor pixels[4] =
+        for (eU32 j=i; j<count; j++)
         {
-            res.bitmap[y0+x0],
-            res.bitmap[y0+x1],
-            res.bitmap[y1+x0],
-            res.bitmap[y1+x1],
-        };
-
-        __m128i p01 = _mm_loadl_epi64((const __m128i *)&pixels[0]);
-        __m128i p23 = _mm_loadl_epi64((const __m128i *)&pixels[2]);
+            tailU[j-i] = u[j];
+            tailV[j-i] = v[j];
+        }
 
-        p01 = _mm_unpacklo_epi8(p01, _mm_setzero_si128());
-        p23 = _mm_unpacklo_epi8(p23, _mm_setzero_si128());
+        _mm_store_si128((__m128i *)tailDst, _sampleBilinear4(res, _mm_load_ps(tailU), _mm_load_ps(tailV)));
 
-        static const __m128 CONST_1111 = _mm_set1_ps(1);
-        static const __m128 CONST_256 = _mm_set1_ps(256);
+        for (eU32 j=i; j<count; j++)
+        {
+            dst[j] = tailDst[j-i];
+        }
+    }
+}
 
-        weight = _mm_mul_ps(weight, CONST_256);
-        __m128i weighti = _mm_cvtps_epi32(weight); // w4 w3 w2 w1
-        weighti = _mm_packs_epi32(weighti, _mm_setzero_si128()); 
+#ifdef eHIGH_PRECISION_BITMAPS
+eBool eIBitmapOp::m_highPrecision = eTRUE;
+#else
+eBool eIBitmapOp::m_highPrecision = eFALSE;
+#endif
 
-        __m128i w12 = _mm_shufflelo_epi16(weighti, _MM_SHUFFLE(1, 1, 0, 0));
-        __m128i w34 = _mm_shufflelo_epi16(weighti, _MM_SHUFFLE(3, 3, 2, 2));
-        w12 = _mm_unpacklo_epi16(w12, w12); // w2 w2 w2 w2 w1 w1 w1 w1
-        w34 = _mm_unpacklo_epi16(w34, w34); // w4 w4 w4 w4 w3 w3 w3 w3
+// Converts a 16 bit channel value to 8 bit with
+// rounding, which equals (value+128)/257 for all
+// 16 bit values.
+static eFORCEINLINE eU8 _quantizeChannel(eU16 value)
+{
+    const eU32 x = eMin((eU32)value+128, (eU32)eU16_MAX);
+    return (eU8)((x-(x>>8))>>8);
+}
+
+// Converts a channel value in range [0,1] to 16 bit.
+static eFORCEINLINE eU16 _toChannel16(eF32 value)
+{
+    return (eU16)eFtoL(eClamp(0.0f, value, 1.0f)*65535.0f);
+}
+
+// Loads four high precision pixels and returns
+// their channels as floats, one pixel per lane.
+static eFORCEINLINE void _loadChannels16(const eColor16 *src, __m128 &b, __m128 &g, __m128 &r, __m128 &a)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i p01 = _mm_loadu_si128((const __m128i *)src);
+    const __m128i p23 = _mm_loadu_si128((const __m128i *)(src+2));
+
+    b = _mm_cvtepi32_ps(_mm_unpacklo_epi16(p01, zero));
+    g = _mm_cvtepi32_ps(_mm_unpackhi_epi16(p01, zero));
+    r = _mm_cvtepi32_ps(_mm_unpacklo_epi16(p23, zero));
+    a = _mm_cvtepi32_ps(_mm_unpackhi_epi16(p23, zero));
+
+    _MM_TRANSPOSE4_PS(b, g, r, a);
+}
+
+// Stores four high precision pixels, given as
+// channel values in range [0,65535] with one
+// pixel per lane.
+static eFORCEINLINE void _storeChannels16(eColor16 *dst, __m128 b, __m128 g, __m128 r, __m128 a)
+{
+    _MM_TRANSPOSE4_PS(b, g, r, a);
+
+    // Pack unsigned using signed saturation.
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16((eS16)0x8000);
+    const __m128i p01 = _mm_packs_epi32(_mm_sub_epi32(_mm_cvtps_epi32(b), bias32), _mm_sub_epi32(_mm_cvtps_epi32(g), bias32));
+    const __m128i p23 = _mm_packs_epi32(_mm_sub_epi32(_mm_cvtps_epi32(r), bias32), _mm_sub_epi32(_mm_cvtps_epi32(a), bias32));
+
+    _mm_storeu_si128((__m128i *)dst, _mm_xor_si128(p01, bias16));
+    _mm_storeu_si128((__m128i *)(dst+2), _mm_xor_si128(p23, bias16));
+}
+
+// Returns the reciprocal lengths of four vectors,
+// given by their squared lengths. Like in
+// eVector3::normalize(), vectors of (almost) zero
+// length are left as they are.
+static eFORCEINLINE __m128 _getInvLengths(const __m128 &sqrLen)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 len = _mm_sqrt_ps(sqrLen);
+    const __m128 valid = _mm_cmpge_ps(len, _mm_set1_ps(eALMOST_ZERO));
+
+    return _mm_or_ps(_mm_and_ps(valid, _mm_div_ps(one, len)), _mm_andnot_ps(valid, one));
+}
+
+// Returns clamp(min(k, 4-k), 0, 1) with k = x mod 6
+// for x in [0,12), the share by which a channel
+// falls below the value when converting HSV to RGB.
+static eFORCEINLINE eF32 _getHsvFactor(eF32 x)
+{
+    const eF32 k = (x >= 6.0f ? x-6.0f : x);
+    return eClamp(0.0f, eMin(k, 4.0f-k), 1.0f);
+}
+
+static eFORCEINLINE __m128 _getHsvFactors(const __m128 &x)
+{
+    const __m128 six = _mm_set1_ps(6.0f);
+    const __m128 k = _mm_sub_ps(x, _mm_and_ps(_mm_cmpge_ps(x, six), six));
+    const __m128 f = _mm_min_ps(k, _mm_sub_ps(_mm_set1_ps(4.0f), k));
+
+    return _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+// Returns the alpha channels of four 8 bit pixels
+// expanded to 16 bit as floats.
+static eFORCEINLINE __m128 _getAlphas16(const eColor *src)
+{
+    return _mm_setr_ps((eF32)(src[0].alpha()*257), (eF32)(src[1].alpha()*257),
+                       (eF32)(src[2].alpha()*257), (eF32)(src[3].alpha()*257));
+}
+
+static eFORCEINLINE __m128i _quantizeChannels(const __m128i &value, const __m128i &round)
+{
+    const __m128i x = _mm_adds_epu16(value, round);
+    return _mm_srli_epi16(_mm_sub_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Returns the high precision bitmap of the input
+// operator with the given index. If the input
+// doesn't have one, its 8 bit bitmap is expanded
+// into the given temporary array.
+const eColor16 * eIBitmapOp::_getInputBitmap16(eU32 index, eArray<eColor16> &temp) const
+{
+    const Result &res = ((eIBitmapOp *)getInputOperator(index))->getResult();
+
+    if (res.bitmap16)
+    {
+        return res.bitmap16;
+    }
 
-        __m128i L12 = _mm_mullo_epi16(p01, w12);
-        __m128i L34 = _mm_mullo_epi16(p23, w34);
+    temp.resize(res.size);
+    _expandColors(res.bitmap, &temp[0], res.size);
+    return &temp[0];
+}
+
+// Updates the 8 bit bitmap from the high
+// precision one.
+void eIBitmapOp::_quantizeBitmap16()
+{
+    eASSERT(m_bitmap16 != eNULL);
+    _quantizeColors(m_bitmap16, m_bitmap, m_bmpSize);
+}
+
+void eIBitmapOp::_expandColors(const eColor *src, eColor16 *dst, eU32 count)
+{
+    eU32 i = 0;
+
+    // Interleaving each byte with itself
+    // multiplies it by 257.
+    for (; i+4<=count; i+=4)
+    {
+        const __m128i c = _mm_loadu_si128((const __m128i *)&src[i]);
 
-        __m128i L1234 = _mm_add_epi16(L12, L34);
-        __m128i Lhi = _mm_shuffle_epi32(L1234, _MM_SHUFFLE(3, 2, 3, 2));
-        __m128i L = _mm_add_epi16(L1234, Lhi);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_unpacklo_epi8(c, c));
+        _mm_storeu_si128((__m128i *)&dst[i+2], _mm_unpackhi_epi8(c, c));
+    }
 
-        __m128i L8 = _mm_srli_epi16(L, 8); // divide by 256
-        L8 = _mm_packus_epi16(L8, _mm_setzero_si128());
+    for (; i<count; i++)
+    {
+        dst[i].red = src[i].red()*257;
+        dst[i].green = src[i].green()*257;
+        dst[i].blue = src[i].blue()*257;
+        dst[i].alpha = src[i].alpha()*257;
+    }
+}
 
-        eU32 rr;
-        rr = _mm_cvtsi128_si32(L8);
-        return eColor(rr);
+void eIBitmapOp::_quantizeColors(const eColor16 *src, eColor *dst, eU32 count)
+{
+    const __m128i round = _mm_set1_epi16(128);
+    eU32 i = 0;
 
-        // version 1
-        /*
-        eF32 fau = eAbs(u);
-        eF32 fav = eAbs(v);
-        int iau = eTrunc(fau);
-        int iav = eTrunc(fav);
-
-        const eF32 uf = fau-iau;
-        const eF32 vf = fav-iav;
-        const eF32 ufvf = uf*vf;
-
-        int x0 = iau%res.width;
-        int y0 = (iav%res.height)*res.width;
-        int x1 = (iau+1)%res.width;
-        int y1 = ((iav+1)%res.height)*res.width;
-
-        return (res.bitmap[y0+x0]*(1.0f-vf-uf+ufvf)+
-            res.bitmap[y0+x1]*(uf-ufvf)+
-            res.bitmap[y1+x0]*(vf-ufvf)+
-            res.bitmap[y1+x1]*ufvf);
-        */
+    for (; i+4<=count; i+=4)
+    {
+        const __m128i c01 = _quantizeChannels(_mm_loadu_si128((const __m128i *)&src[i]), round);
+        const __m128i c23 = _quantizeChannels(_mm_loadu_si128((const __m128i *)&src[i+2]), round);
 
-        // version 0
-        /*
-        const eInt iu = eTrunc(u);
-        const eInt iv = eTrunc(v);
-        const eU32 ut = (eU32)iu;
-        const eU32 vt = (eU32)iv;
-        const eF32 uf = (u >= 0.0f ? u-iu : 1.0f+u-iu);
-        const eF32 vf = (v >= 0.0f ? v-iv : 1.0f+v-iv);
-        const eF32 ufvf = uf*vf;
-
-        // Use modulo here, because width and
-        // height mustn't be powers of two.
-        const eU32 y0 = (vt%res.height)*res.width;
-        const eU32 y1 = ((vt+1)%res.height)*res.width;
-        const eU32 x0 = ut%res.width;
-        const eU32 x1 = (ut+1)%res.width;
-
-        return (res.bitmap[y0+x0]*(1.0f-vf-uf+ufvf)+
-                res.bitmap[y0+x1]*(uf-ufvf)+
-                res.bitmap[y1+x0]*(vf-ufvf)+
-                res.bitmap[y1+x1]*ufvf);
-        */
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packus_epi16(c01, c23));
     }
 
-
-
+    for (; i<count; i++)
+    {
+        dst[i].set(_quantizeChannel(src[i].red), _quantizeChannel(src[i].green),
+                   _quantizeChannel(src[i].blue), _quantizeChannel(src[i].alpha));
+    }
+}
 
 // Fill (bitmap) operator
 // ----------------------
@@ -285,20 +444,89 @@ OP_DEFINE_BITMAP(ePerlinOp, ePerlinOp_ID, "Perlin", 'p', 0, 0, "")
         _initPerlinNoise(seed);
 
         // Generate perlin noise.
+        PerlinArgs args;
+
+        args.octaves = octaves;
+        args.freq = freq;
+        args.persis = persis;
+        args.amplify = amplify;
+        args.color0 = color0;
+        args.color1 = color1;
+        args.color0f = &color0;
+        args.color1f = &color1;
+
+        if (getHighPrecision())
+        {
+            _reallocate16();
+            _forEachRowBand(&ePerlinOp::_perlinRows16, args);
+            _quantizeBitmap16();
+        }
+        else
+        {
+            _free16();
+            _forEachRowBand(&ePerlinOp::_perlinRows, args);
+        }
+    }
+
+    struct PerlinArgs
+    {
+        eU32                octaves;
+        eU32                freq;
+        eF32                persis;
+        eF32                amplify;
+        eColor              color0;
+        eColor              color1;
+        const eFloatColor * color0f;
+        const eFloatColor * color1f;
+    };
+
+    void _perlinRows(eU32 firstRow, eU32 lastRow, const PerlinArgs &args)
+    {
         const eF32 stepx = 1.0f/(eF32)m_bmpDimSize[0];
         const eF32 stepy = 1.0f/(eF32)m_bmpDimSize[1];
 
-        eVector2 v;
+        eVector2 v(0.0f, (eF32)firstRow*stepy);
 
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
         {
             v.x = 0.0f;
 
             for (eU32 x=0; x<m_bmpDimSize[0]; x++)
             {
-                const eF32 value = _getPerlinNoise(v, octaves, persis, freq, amplify);
+                const eF32 value = _getPerlinNoise(v, args.octaves, args.persis, args.freq, args.amplify);
                 const eF32 finalCol = eClamp(0.0f, (value+1.0f)*0.5f, 1.0f);
-                m_bitmap[index++] = eColor(color0).lerp(color1, finalCol);
+                m_bitmap[index++] = args.color0.lerp(args.color1, finalCol);
+
+                v.x += stepx;
+            }
+
+            v.y += stepy;
+        }
+    }
+
+    void _perlinRows16(eU32 firstRow, eU32 lastRow, const PerlinArgs &args)
+    {
+        const eFloatColor &c0 = *args.color0f;
+        const eFloatColor &c1 = *args.color1f;
+        const eF32 stepx = 1.0f/(eF32)m_bmpDimSize[0];
+        const eF32 stepy = 1.0f/(eF32)m_bmpDimSize[1];
+
+        eVector2 v(0.0f, (eF32)firstRow*stepy);
+
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
+        {
+            v.x = 0.0f;
+
+            for (eU32 x=0; x<m_bmpDimSize[0]; x++)
+            {
+                const eF32 value = _getPerlinNoise(v, args.octaves, args.persis, args.freq, args.amplify);
+                const eF32 t = eClamp(0.0f, (value+1.0f)*0.5f, 1.0f);
+                eColor16 &c = m_bitmap16[index++];
+
+                c.red = _toChannel16(eLerp(c0.r, c1.r, t));
+                c.green = _toChannel16(eLerp(c0.g, c1.g, t));
+                c.blue = _toChannel16(eLerp(c0.b, c1.b, t));
+                c.alpha = _toChannel16(eLerp(c0.a, c1.a, t));
 
                 v.x += stepx;
             }
@@ -309,12 +537,14 @@ OP_DEFINE_BITMAP(ePerlinOp, ePerlinOp_ID, "Perlin", 'p', 0, 0, "")
 
     void _initPerlinNoise(eU32 seed)
     {
-        eRandomize(seed);
+        // Use local seed instead of the global one,
+        // so that operator can be executed parallel.
+        eU32 randSeed = seed+1;
 
         for (eU32 i=0; i<LUT_SIZE; i++)
         {
-            m_perm[i] = eRandom(0, LUT_SIZE-1);
-            m_grad[i] = eRandomF(-1.0f, 1.0f);
+            m_perm[i] = eRandom(0, LUT_SIZE-1, randSeed);
+            m_grad[i] = eRandomF(-1.0f, 1.0f, randSeed);
         }
     }
 
@@ -555,7 +785,7 @@ OP_DEFINE_BITMAP(ePixelsOp, ePixelsOp_ID, "Pixels", ' ', 1, 1, "-1,Bitmap")
     OP_EXEC(eGraphicsApiDx9 *gfx, const eFloatColor &color0, const eFloatColor &color1, eU32 countVal, eU32 seed)
     {
         _copyFirstInputBitmap();
-        eRandomize(seed);
+        eU32 randSeed = seed+1;
 
         const eColor c0 = color0;
         const eColor c1 = color1;
@@ -569,10 +799,10 @@ OP_DEFINE_BITMAP(ePixelsOp, ePixelsOp_ID, "Pixels", ' ', 1, 1, "-1,Bitmap")
 
         while (count--)
         {
-            const eU32 x = eRandom(0, m_bmpDimSize[0]);
-            const eU32 y = eRandom(0, m_bmpDimSize[1]);
+            const eU32 x = eRandom(0, m_bmpDimSize[0], randSeed);
+            const eU32 y = eRandom(0, m_bmpDimSize[1], randSeed);
 
-            m_bitmap[y*m_bmpDimSize[0]+x] = c0.lerp(c1, eRandomF());
+            m_bitmap[y*m_bmpDimSize[0]+x] = c0.lerp(c1, eRandomF(randSeed));
         }
     }
 OP_END(ePixelsOp);
@@ -703,34 +933,181 @@ OP_DEFINE_BITMAP(eAdjustOp, eAdjustOp_ID, "Adjust", 'a', 1, 1, "-1,Bitmap")
 
     OP_EXEC(eGraphicsApiDx9 *gfx, eF32 brightness, eF32 contrast, eF32 hueVal, eF32 saturation)
     {
-        const eColor *inputBmp = ((eIBitmapOp *)getInputOperator(0))->getResult().bitmap;
-        eASSERT(inputBmp != eNULL);
+        AdjustArgs args;
 
-        const eInt hue = eFtoL((hueVal-1.0f)*359.0f);
+        args.inputBmp = ((eIBitmapOp *)getInputOperator(0))->getResult().bitmap;
+        eASSERT(args.inputBmp != eNULL);
 
-        // Adjust brightness and contrast.
-        const eF32 tcb = (128*contrast-128)*brightness;
-        const eF32 cmb = contrast*brightness;
+        args.hue = eFtoL((hueVal-1.0f)*359.0f);
+        args.saturation = saturation;
+        args.tcb = (128*contrast-128)*brightness;
+        args.cmb = contrast*brightness;
 
-        for (eU32 i=0; i<m_bmpSize; i++)
+        if (getHighPrecision())
         {
-            const eInt r = eClamp(0, eFtoL(inputBmp[i].red()*cmb-tcb), 255);
-            const eInt g = eClamp(0, eFtoL(inputBmp[i].green()*cmb-tcb), 255);
-            const eInt b = eClamp(0, eFtoL(inputBmp[i].blue()*cmb-tcb), 255);
-            const eInt a = inputBmp[i].alpha();
+            eArray<eColor16> temp;
+            args.inputBmp16 = _getInputBitmap16(0, temp);
 
-            m_bitmap[i].set(r, g, b, a);
+            _reallocate16();
+            _forEachRowBand(&eAdjustOp::_adjustRows16, args);
+            _quantizeBitmap16();
         }
+        else
+        {
+            _free16();
+            _forEachRowBand(&eAdjustOp::_adjustRows, args);
+        }
+    }
 
-        // Adjust hue and saturation.
-        for (eU32 i=0; i<m_bmpSize; i++)
+    struct AdjustArgs
+    {
+        const eColor *      inputBmp;
+        const eColor16 *    inputBmp16;
+        eInt                hue;
+        eF32                saturation;
+        eF32                tcb;
+        eF32                cmb;
+    };
+
+    // High precision version of _adjustRows(). HSV
+    // is calculated in floating point instead of
+    // integers, with channels, saturation and value
+    // in range [0,255] like in the 8 bit version.
+    // Hue is converted back branch free, using
+    // channel = v-v*s*clamp(min(k, 4-k), 0, 1) with
+    // k = (n+h/60) mod 6 and n = 5, 3, 1 for red,
+    // green and blue. Four pixels are adjusted at
+    // a time.
+    void _adjustRows16(eU32 firstRow, eU32 lastRow, const AdjustArgs &args)
+    {
+        const eU32 first = firstRow*m_bmpDimSize[0];
+        const eU32 last = lastRow*m_bmpDimSize[0];
+        const eF32 hue = (eF32)args.hue/60.0f;
+        eU32 i = first;
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 four = _mm_set1_ps(4.0f);
+        const __m128 six = _mm_set1_ps(6.0f);
+        const __m128 maxHue = _mm_set1_ps(359.0f/60.0f);
+        const __m128 max8 = _mm_set1_ps(255.0f);
+        const __m128 to8 = _mm_set1_ps(1.0f/257.0f);
+        const __m128 to16 = _mm_set1_ps(257.0f);
+        const __m128 cmb = _mm_set1_ps(args.cmb);
+        const __m128 tcb = _mm_set1_ps(args.tcb);
+        const __m128 hueShift = _mm_set1_ps(hue);
+        const __m128 satScale = _mm_set1_ps(args.saturation);
+
+        for (; i+4<=last; i+=4)
+        {
+            __m128 b, g, r, a;
+            _loadChannels16(&args.inputBmp16[i], b, g, r, a);
+
+            // Adjust brightness and contrast.
+            r = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(r, to8), cmb), tcb), zero), max8);
+            g = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(g, to8), cmb), tcb), zero), max8);
+            b = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(b, to8), cmb), tcb), zero), max8);
+
+            // To HSV. Like in eColor::toHsv(), red wins
+            // over green and green over blue on ties.
+            const __m128 v = _mm_max_ps(r, _mm_max_ps(g, b));
+            const __m128 delta = _mm_sub_ps(v, _mm_min_ps(r, _mm_min_ps(g, b)));
+            const __m128 chromatic = _mm_cmpgt_ps(delta, zero);
+            const __m128 invDelta = _mm_and_ps(chromatic, _mm_div_ps(one, _mm_or_ps(delta, _mm_andnot_ps(chromatic, one))));
+            const __m128 invV = _mm_div_ps(one, _mm_max_ps(v, one));
+
+            const __m128 isB = _mm_cmpgt_ps(b, _mm_max_ps(r, g));
+            const __m128 isG = _mm_andnot_ps(isB, _mm_cmpgt_ps(g, r));
+            const __m128 isR = _mm_andnot_ps(_mm_or_ps(isB, isG), chromatic);
+
+            __m128 hR = _mm_mul_ps(_mm_sub_ps(g, b), invDelta);
+            hR = _mm_add_ps(hR, _mm_and_ps(_mm_cmplt_ps(hR, zero), six));
+            const __m128 hG = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, r), invDelta), two);
+            const __m128 hB = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(r, g), invDelta), four);
+
+            __m128 h = _mm_or_ps(_mm_and_ps(isR, hR), _mm_or_ps(_mm_and_ps(isG, hG), _mm_and_ps(isB, hB)));
+            __m128 s = _mm_mul_ps(delta, invV);
+
+            // Adjust hue and saturation.
+            h = _mm_min_ps(_mm_max_ps(_mm_add_ps(h, hueShift), zero), maxHue);
+            s = _mm_min_ps(_mm_mul_ps(s, satScale), one);
+
+            // From HSV, scaled to 16 bit.
+            const __m128 vs = _mm_mul_ps(_mm_mul_ps(v, s), to16);
+            const __m128 v16 = _mm_mul_ps(v, to16);
+
+            r = _mm_sub_ps(v16, _mm_mul_ps(vs, _getHsvFactors(_mm_add_ps(h, _mm_set1_ps(5.0f)))));
+            g = _mm_sub_ps(v16, _mm_mul_ps(vs, _getHsvFactors(_mm_add_ps(h, _mm_set1_ps(3.0f)))));
+            b = _mm_sub_ps(v16, _mm_mul_ps(vs, _getHsvFactors(_mm_add_ps(h, one))));
+
+            _storeChannels16(&m_bitmap16[i], b, g, r, a);
+        }
+
+        for (; i<last; i++)
+        {
+            const eColor16 &src = args.inputBmp16[i];
+
+            const eF32 r = eClamp(0.0f, (eF32)src.red/257.0f*args.cmb-args.tcb, 255.0f);
+            const eF32 g = eClamp(0.0f, (eF32)src.green/257.0f*args.cmb-args.tcb, 255.0f);
+            const eF32 b = eClamp(0.0f, (eF32)src.blue/257.0f*args.cmb-args.tcb, 255.0f);
+
+            const eF32 v = eMax(r, eMax(g, b));
+            const eF32 delta = v-eMin(r, eMin(g, b));
+            eF32 h = 0.0f;
+
+            if (delta > 0.0f)
+            {
+                if (b > eMax(r, g))
+                {
+                    h = (r-g)/delta+4.0f;
+                }
+                else if (g > r)
+                {
+                    h = (b-r)/delta+2.0f;
+                }
+                else
+                {
+                    h = (g-b)/delta;
+                    h += (h < 0.0f ? 6.0f : 0.0f);
+                }
+            }
+
+            h = eClamp(0.0f, h+hue, 359.0f/60.0f);
+
+            const eF32 s = eMin(delta/eMax(v, 1.0f)*args.saturation, 1.0f);
+            const eF32 vs = v*s;
+
+            eColor16 &c = m_bitmap16[i];
+
+            c.red = _toChannel16((v-vs*_getHsvFactor(h+5.0f))/255.0f);
+            c.green = _toChannel16((v-vs*_getHsvFactor(h+3.0f))/255.0f);
+            c.blue = _toChannel16((v-vs*_getHsvFactor(h+1.0f))/255.0f);
+            c.alpha = src.alpha;
+        }
+    }
+
+    void _adjustRows(eU32 firstRow, eU32 lastRow, const AdjustArgs &args)
+    {
+        const eU32 last = lastRow*m_bmpDimSize[0];
+
+        for (eU32 i=firstRow*m_bmpDimSize[0]; i<last; i++)
         {
+            // Adjust brightness and contrast.
+            const eInt r = eClamp(0, eFtoL(args.inputBmp[i].red()*args.cmb-args.tcb), 255);
+            const eInt g = eClamp(0, eFtoL(args.inputBmp[i].green()*args.cmb-args.tcb), 255);
+            const eInt b = eClamp(0, eFtoL(args.inputBmp[i].blue()*args.cmb-args.tcb), 255);
+            const eInt a = args.inputBmp[i].alpha();
+
+            m_bitmap[i].set(r, g, b, a);
+
+            // Adjust hue and saturation.
             eInt h, s, v;
 
             m_bitmap[i].toHsv(h, s, v);
 
-            h = eClamp(0, h+hue, 359);
-            s = eMin(eFtoL((eF32)s*saturation), 255);
+            h = eClamp(0, h+args.hue, 359);
+            s = eMin(eFtoL((eF32)s*args.saturation), 255);
 
             m_bitmap[i].fromHsv(h, s, v);
         }
@@ -753,15 +1130,142 @@ OP_DEFINE_BITMAP(eNormalsOp, eNormalsOp_ID, "Normals", 'n', 1, 1, "-1,Bitmap")
     }
 
     OP_EXEC(eGraphicsApiDx9 *gfx, eInt strength)
+    {
+        NormalsArgs args;
+
+        args.inputBmp = ((eIBitmapOp *)getInputOperator(0))->getResult().bitmap;
+        eASSERT(args.inputBmp != eNULL);
+
+        args.strength = strength;
+
+        if (getHighPrecision())
+        {
+            eArray<eColor16> temp;
+            args.inputBmp16 = _getInputBitmap16(0, temp);
+
+            _reallocate16();
+            _forEachRowBand(&eNormalsOp::_normalsRows16, args);
+            _quantizeBitmap16();
+        }
+        else
+        {
+            _free16();
+            _forEachRowBand(&eNormalsOp::_normalsRows, args);
+        }
+    }
+
+    struct NormalsArgs
+    {
+        const eColor *      inputBmp;
+        const eColor16 *    inputBmp16;
+        eInt                strength;
+    };
+
+    // Returns the gray scale value of the given color
+    // in the value range of 8 bit colors.
+    static eF32 _getHeight16(const eColor16 &c)
+    {
+        return (eF32)((c.red*11+c.green*16+c.blue*5)/32)/257.0f;
+    }
+
+    // High precision version of _normalsRows(). The
+    // alpha channel is taken over from the 8 bit
+    // bitmap, which the 8 bit version leaves as is.
+    // The heights of the band and its neighbour rows
+    // are computed once, then four normals are
+    // calculated at a time.
+    void _normalsRows16(eU32 firstRow, eU32 lastRow, const NormalsArgs &args)
     {
         const eU32 andSize = m_bmpSize-1;
+        const eInt width = (eInt)m_bmpDimSize[0];
+        const eU32 first = firstRow*m_bmpDimSize[0];
+        const eU32 count = (lastRow-firstRow)*m_bmpDimSize[0];
 
-        const eColor *inputBmp = ((eIBitmapOp *)getInputOperator(0))->getResult().bitmap;
-        eASSERT(inputBmp != eNULL);
+        // Like in the 8 bit version, neighbours wrap
+        // around the pixel index, not the row.
+        eArray<eF32> heights(count+2*width+2);
+
+        for (eU32 i=0; i<heights.size(); i++)
+        {
+            heights[i] = _getHeight16(args.inputBmp16[(first-width-1+i)&andSize]);
+        }
+
+        const eF32 *h = &heights[width+1];
+        const eF32 nz = 255.0f-(eF32)args.strength;
+        eU32 j = 0;
+
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 max = _mm_set1_ps(65535.0f);
+
+        for (; j+4<=count; j+=4)
+        {
+            const eF32 *hj = h+j;
+            const __m128 v0 = _mm_loadu_ps(hj-width-1);
+            const __m128 v1 = _mm_loadu_ps(hj-width);
+            const __m128 v2 = _mm_loadu_ps(hj-width+1);
+            const __m128 v3 = _mm_loadu_ps(hj-1);
+            const __m128 v5 = _mm_loadu_ps(hj+1);
+            const __m128 v6 = _mm_loadu_ps(hj+width-1);
+            const __m128 v7 = _mm_loadu_ps(hj+width);
+            const __m128 v8 = _mm_loadu_ps(hj+width+1);
+
+            // Sobel filter, same order of operations
+            // as in the scalar version.
+            __m128 x = _mm_sub_ps(v0, v2);
+            x = _mm_add_ps(x, _mm_mul_ps(two, _mm_sub_ps(v3, v5)));
+            x = _mm_sub_ps(_mm_add_ps(x, v6), v8);
+
+            __m128 y = _mm_add_ps(v0, _mm_mul_ps(two, _mm_sub_ps(v1, v7)));
+            y = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(y, v2), v6), v8);
+
+            __m128 z = _mm_set1_ps(nz);
+
+            const __m128 sqrLen = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+            const __m128 invLen = _getInvLengths(sqrLen);
+
+            x = _mm_mul_ps(x, invLen);
+            y = _mm_mul_ps(y, invLen);
+            z = _mm_mul_ps(z, invLen);
+
+            // Range [-1,1] to [0,65535].
+            const __m128 one = _mm_set1_ps(1.0f);
+            x = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(x, one), half), zero), one), max);
+            y = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(y, one), half), zero), one), max);
+            z = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(z, one), half), zero), one), max);
+
+            _storeChannels16(&m_bitmap16[first+j], z, y, x, _getAlphas16(&m_bitmap[first+j]));
+        }
+
+        for (; j<count; j++)
+        {
+            const eF32 *hj = h+j;
+
+            eVector3 normal;
+            normal.x = (hj[-width-1]-hj[-width+1]+2.0f*(hj[-1]-hj[1])+hj[width-1]-hj[width+1]);
+            normal.y = (hj[-width-1]+2.0f*(hj[-width]-hj[width])+hj[-width+1]-hj[width-1]-hj[width+1]);
+            normal.z = nz;
+            normal.normalize();
+
+            eColor16 &c = m_bitmap16[first+j];
+
+            c.red = _toChannel16((normal.x+1.0f)*0.5f);
+            c.green = _toChannel16((normal.y+1.0f)*0.5f);
+            c.blue = _toChannel16((normal.z+1.0f)*0.5f);
+            c.alpha = m_bitmap[first+j].alpha()*257;
+        }
+    }
+
+    void _normalsRows(eU32 firstRow, eU32 lastRow, const NormalsArgs &args)
+    {
+        const eU32 andSize = m_bmpSize-1;
+        const eU32 last = lastRow*m_bmpDimSize[0];
+        const eColor *inputBmp = args.inputBmp;
 
         eVector3 normal;
 
-        for (eU32 i=0; i<m_bmpSize; i++)
+        for (eU32 i=firstRow*m_bmpDimSize[0]; i<last; i++)
         {
             // Heights are stored in the v<0..8> variables.
             const eU8 v0 = inputBmp[((i-m_bmpDimSize[0]-1)&andSize)].grayScale();
@@ -777,7 +1281,7 @@ OP_DEFINE_BITMAP(eNormalsOp, eNormalsOp_ID, "Normals", 'n', 1, 1, "-1,Bitmap")
             // a 2-dimensional sobel filter.
             normal.x = (v0-v2+2.0f*(v3-v5)+v6-v8);
             normal.y = (v0+2.0f*(v1-v7)+v2-v6-v8);
-            normal.z = 255.0f-(eF32)strength;
+            normal.z = 255.0f-(eF32)args.strength;
         
             normal.normalize();
 
@@ -825,6 +1329,11 @@ OP_DEFINE_BITMAP(eTextOp, eTextOp_ID, "Text", 't', 1, 1, "-1,Bitmap")
 
         const ePoint position(eFtoL(fltPos.x*m_bmpDimSize[0]), eFtoL(fltPos.y*m_bmpDimSize[1]));
 
+#ifndef _WIN32
+        // Text is rendered with GDI, which only
+        // exists on Windows. Pass input through.
+        _copyFirstInputBitmap();
+#else
         // Create DCs and bitmap for rendering text on.
         HDC hdc = GetDC(eNULL);
         eASSERT(hdc != eNULL);
@@ -938,6 +1447,14 @@ OP_DEFINE_BITMAP(eTextOp, eTextOp_ID, "Text", 't', 1, 1, "-1,Bitmap")
         DeleteObject(bmp);
         DeleteDC(compDc);
         DeleteDC(hdc);
+#endif
+    }
+
+    // GDI is used for rendering the text, so
+    // the operator has to be executed serially.
+    virtual eBool _canExecuteParallel() const
+    {
+        return eFALSE;
     }
 OP_END(eTextOp);
 #endif
@@ -958,17 +1475,129 @@ OP_DEFINE_BITMAP(eColorOp, eColorOp_ID, "Color", 'c', 1, 1, "-1,Bitmap")
 
     OP_EXEC(eGraphicsApiDx9 *gfx, eInt mode, const eFloatColor &color)
     {
-        _copyFirstInputBitmap();
+        ColorArgs args;
 
-        eU32 size = m_bmpSize;
+        args.mode = mode;
+        args.color = color;
 
+        if (getHighPrecision())
+        {
+            eArray<eColor16> temp;
+            const eColor16 *inputBmp = _getInputBitmap16(0, temp);
+
+            eMemCopy(_reallocate16(), inputBmp, m_bmpSize*sizeof(eColor16));
+            _forEachRowBand(&eColorOp::_colorRows16, args);
+            _quantizeBitmap16();
+        }
+        else
+        {
+            _free16();
+            _copyFirstInputBitmap();
+            _forEachRowBand(&eColorOp::_colorRows, args);
+        }
+    }
+
+    struct ColorArgs
+    {
+        eInt                mode;
+        eColor              color;
+    };
+
+    // Applies the operation to the two high
+    // precision pixels in the given register.
+    static eFORCEINLINE __m128i _applyColor16(const __m128i &c, const __m128i &color, eInt mode)
+    {
         switch (mode)
         {
             case 0: // Add
             {
-                while (size--)
+                return _mm_adds_epu16(c, color);
+            }
+
+            case 1: // Subtract
+            {
+                return _mm_subs_epu16(c, color);
+            }
+
+            case 2: // Multiply (c*color/65535, rounded).
+            {
+                const __m128i lo = _mm_mullo_epi16(c, color);
+                const __m128i hi = _mm_mulhi_epu16(c, color);
+                const __m128i round = _mm_set1_epi32(32768);
+
+                __m128i p0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round);
+                __m128i p1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round);
+
+                p0 = _mm_srli_epi32(_mm_add_epi32(p0, _mm_srli_epi32(p0, 16)), 16);
+                p1 = _mm_srli_epi32(_mm_add_epi32(p1, _mm_srli_epi32(p1, 16)), 16);
+
+                // Pack unsigned using signed saturation.
+                const __m128i bias32 = _mm_set1_epi32(32768);
+                const __m128i bias16 = _mm_set1_epi16((eS16)0x8000);
+                const __m128i res = _mm_packs_epi32(_mm_sub_epi32(p0, bias32), _mm_sub_epi32(p1, bias32));
+
+                return _mm_xor_si128(res, bias16);
+            }
+
+            case 3: // Grayscale
+            {
+                eALIGN16 eColor16 px[2];
+                _mm_store_si128((__m128i *)px, c);
+
+                for (eU32 i=0; i<2; i++)
+                {
+                    const eU16 gray = (eU16)((px[i].red*11+px[i].green*16+px[i].blue*5)/32);
+                    px[i].red = px[i].green = px[i].blue = gray;
+                }
+
+                return _mm_load_si128((const __m128i *)px);
+            }
+
+            case 4: // Invert (preserves alpha channel).
+            {
+                return _mm_xor_si128(c, _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1));
+            }
+        }
+
+        return c;
+    }
+
+    void _colorRows16(eU32 firstRow, eU32 lastRow, const ColorArgs &args)
+    {
+        const eU32 last = lastRow*m_bmpDimSize[0];
+
+        eColor16 color16;
+        _expandColors(&args.color, &color16, 1);
+
+        const __m128i col = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)&color16), _mm_loadl_epi64((const __m128i *)&color16));
+        eU32 i = firstRow*m_bmpDimSize[0];
+
+        for (; i+2<=last; i+=2)
+        {
+            __m128i *p = (__m128i *)&m_bitmap16[i];
+            _mm_storeu_si128(p, _applyColor16(_mm_loadu_si128(p), col, args.mode));
+        }
+
+        // Bitmaps with a width of 1 leave one pixel.
+        if (i < last)
+        {
+            __m128i *p = (__m128i *)&m_bitmap16[i];
+            _mm_storel_epi64(p, _applyColor16(_mm_loadl_epi64(p), col, args.mode));
+        }
+    }
+
+    void _colorRows(eU32 firstRow, eU32 lastRow, const ColorArgs &args)
+    {
+        const eU32 first = firstRow*m_bmpDimSize[0];
+        const eU32 last = lastRow*m_bmpDimSize[0];
+
+        switch (args.mode)
+        {
+            case 0: // Add
+            {
+                for (eU32 i=first; i<last; i++)
                 {
-                    m_bitmap[size] += color;
+                    m_bitmap[i] += args.color;
                 }
 
                 break;
@@ -976,9 +1605,9 @@ OP_DEFINE_BITMAP(eColorOp, eColorOp_ID, "Color", 'c', 1, 1, "-1,Bitmap")
 
             case 1: // Subtract
             {
-                while (size--)
+                for (eU32 i=first; i<last; i++)
                 {
-                    m_bitmap[size] -= color;
+                    m_bitmap[i] -= args.color;
                 }
 
                 break;
@@ -986,9 +1615,9 @@ OP_DEFINE_BITMAP(eColorOp, eColorOp_ID, "Color", 'c', 1, 1, "-1,Bitmap")
 
             case 2: // Multiply
             {
-                while (size--)
+                for (eU32 i=first; i<last; i++)
                 {
-                    m_bitmap[size] *= color;
+                    m_bitmap[i] *= args.color;
                 }
 
                 break;
@@ -996,9 +1625,9 @@ OP_DEFINE_BITMAP(eColorOp, eColorOp_ID, "Color", 'c', 1, 1, "-1,Bitmap")
 
             case 3: // Grayscale (ignores color parameter).
             {
-                while (size--)
+                for (eU32 i=first; i<last; i++)
                 {
-                    m_bitmap[size].toGrayScale();
+                    m_bitmap[i].toGrayScale();
                 }
 
                 break;
@@ -1006,12 +1635,12 @@ OP_DEFINE_BITMAP(eColorOp, eColorOp_ID, "Color", 'c', 1, 1, "-1,Bitmap")
 
             case 4: // Invert (ignores color parameter). Preserves alpha channel.
             {
-                while (size--)
+                for (eU32 i=first; i<last; i++)
                 {
-                    eColor col = eColor::WHITE-m_bitmap[size];
-                    col.setAlpha(m_bitmap[size].alpha());
+                    eColor col = eColor::WHITE-m_bitmap[i];
+                    col.setAlpha(m_bitmap[i].alpha());
 
-                    m_bitmap[size] = col;
+                    m_bitmap[i] = col;
                 }
 
                 break;
@@ -1039,46 +1668,23 @@ OP_DEFINE_BITMAP(eRotoZoomOp, eRotoZoomOp_ID, "Rotozoom", 'r', 1, 1, "-1,Bitmap"
     OP_EXEC(eGraphicsApiDx9 *gfx, eF32 angleVal, const eVector2 &zoomVal, const eVector2 &scrollVal, eU8 clampBorders)
     {
         const eF32 angle = angleVal*eTWOPI;
-        const eBool xClamp = eGetBit(clampBorders, 0);
-        const eBool yClamp = eGetBit(clampBorders, 1);
 
-        const eVector2 zoom(ePow(0.05f, zoomVal.x-1.0f), ePow(0.05f, zoomVal.y-1.0f));
-        const eVector2 scroll(scrollVal.x*(eF32)m_bmpDimSize[0], scrollVal.y*(eF32)m_bmpDimSize[1]);
+        RotoZoomArgs args;
+
+        args.inputRes = &((eIBitmapOp *)getInputOperator(0))->getResult();
+        args.xClamp = eGetBit(clampBorders, 0);
+        args.yClamp = eGetBit(clampBorders, 1);
+        args.zoom.set(ePow(0.05f, zoomVal.x-1.0f), ePow(0.05f, zoomVal.y-1.0f));
+        args.scroll.set(scrollVal.x*(eF32)m_bmpDimSize[0], scrollVal.y*(eF32)m_bmpDimSize[1]);
 
         // Pre-calculate some values.
-        eF32 s, c;
+        eSinCos(angle, args.s, args.c);
 
-        eSinCos(angle, s, c);
-
-        const eF32 uRot = -0.5f*(m_bmpDimSize[0]*c-m_bmpDimSize[1]*s);
-        const eF32 vRot = -0.5f*(m_bmpDimSize[0]*s+m_bmpDimSize[1]*c);
+        args.uRot = -0.5f*(m_bmpDimSize[0]*args.c-m_bmpDimSize[1]*args.s);
+        args.vRot = -0.5f*(m_bmpDimSize[0]*args.s+m_bmpDimSize[1]*args.c);
 
         // Zoom, rotate and scroll bitmap.
-        const Result &inputRes = ((eIBitmapOp *)getInputOperator(0))->getResult();
-
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
-        {
-            const eF32 xp = vRot+y*c;
-            const eF32 yp = uRot-y*s;
-
-            for (eU32 x=0; x<m_bmpDimSize[0]; x++)
-            {
-                eF32 u = (yp+x*c)*zoom.x+scroll.x;
-                eF32 v = (xp+x*s)*zoom.y+scroll.y;
-
-                if (xClamp)
-                {
-                    u = eClamp(0.0f, u, (eF32)(m_bmpDimSize[0]-1));
-                }
-
-                if (yClamp)
-                {
-                    v = eClamp(0.0f, v, (eF32)(m_bmpDimSize[1]-1));
-                }
-
-                m_bitmap[index++] = _getBilinearFiltered(inputRes, u, v);
-            }
-        }
+        _forEachRowBand(&eRotoZoomOp::_rotoZoomRows, args);
 
         /*
         const eF32 angle = angleVal*eTWOPI;
@@ -1134,6 +1740,58 @@ OP_DEFINE_BITMAP(eRotoZoomOp, eRotoZoomOp_ID, "Rotozoom", 'r', 1, 1, "-1,Bitmap"
         }
         */
     }
+
+    struct RotoZoomArgs
+    {
+        const Result *      inputRes;
+        eBool               xClamp;
+        eBool               yClamp;
+        eVector2            zoom;
+        eVector2            scroll;
+        eF32                s;
+        eF32                c;
+        eF32                uRot;
+        eF32                vRot;
+    };
+
+    void _rotoZoomRows(eU32 firstRow, eU32 lastRow, const RotoZoomArgs &args)
+    {
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
+        {
+            const eF32 xp = args.vRot+y*args.c;
+            const eF32 yp = args.uRot-y*args.s;
+
+            for (eU32 x=0; x<m_bmpDimSize[0]; x+=SAMPLE_BATCH_SIZE)
+            {
+                const eU32 count = eMin(SAMPLE_BATCH_SIZE, m_bmpDimSize[0]-x);
+                eF32 us[SAMPLE_BATCH_SIZE];
+                eF32 vs[SAMPLE_BATCH_SIZE];
+
+                for (eU32 i=0; i<count; i++)
+                {
+                    eF32 u = (yp+(x+i)*args.c)*args.zoom.x+args.scroll.x;
+                    eF32 v = (xp+(x+i)*args.s)*args.zoom.y+args.scroll.y;
+
+                    if (args.xClamp)
+                    {
+                        u = eClamp(0.0f, u, (eF32)(m_bmpDimSize[0]-1));
+                    }
+
+                    if (args.yClamp)
+                    {
+                        v = eClamp(0.0f, v, (eF32)(m_bmpDimSize[1]-1));
+                    }
+
+                    us[i] = u;
+                    vs[i] = v;
+                }
+
+                _sampleBilinear(*args.inputRes, us, vs, &m_bitmap[index], count);
+                index += count;
+            }
+        }
+    }
+    OP_IMPL_VERSION(2);
 OP_END(eRotoZoomOp);
 #endif
 
@@ -1157,21 +1815,69 @@ OP_DEFINE_BITMAP(eBumpOp, eBumpOp_ID, "Bump", 'u', 2, 2, "-1,Bitmap")
     OP_EXEC(eGraphicsApiDx9 *gfx, const eFloatColor &ambient, const eFloatColor &diffuse,
             const eFloatColor &specular, const eVector3 &pos, eF32 specAmount, eF32 bumpAmount)
     {
-        eVector3 position = pos;
-        position.x -= 0.5f;
-        position.y = -position.y+0.5f;
-        position.z = position.z-0.5f;
+        BumpArgs args;
+
+        args.position = pos;
+        args.position.x -= 0.5f;
+        args.position.y = -args.position.y+0.5f;
+        args.position.z = args.position.z-0.5f;
 
         // Get bitmap of input operator, which
         // is used as normal map.
-        const eColor *normalMap = ((eIBitmapOp *)getInputOperator(1))->getResult().bitmap;
-        eASSERT(normalMap != eNULL);
+        args.normalMap = ((eIBitmapOp *)getInputOperator(1))->getResult().bitmap;
+        eASSERT(args.normalMap != eNULL);
+
+        args.inputBmp = ((eIBitmapOp *)getInputOperator(0))->getResult().bitmap;
+        eASSERT(args.inputBmp != eNULL);
+
+        args.ambient = &ambient;
+        args.diffuse = &diffuse;
+        args.specular = &specular;
+        args.specAmount = specAmount;
+        args.bumpAmount = bumpAmount;
 
         // Perform bump operation.
-        const eColor *inputBmp = ((eIBitmapOp *)getInputOperator(0))->getResult().bitmap;
-        eASSERT(inputBmp != eNULL);
+        if (getHighPrecision())
+        {
+            eArray<eColor16> tempNormals, tempInput;
 
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
+            args.normalMap16 = _getInputBitmap16(1, tempNormals);
+            args.inputBmp16 = _getInputBitmap16(0, tempInput);
+
+            _reallocate16();
+            _forEachRowBand(&eBumpOp::_bumpRows16, args);
+            _quantizeBitmap16();
+        }
+        else
+        {
+            _free16();
+            _forEachRowBand(&eBumpOp::_bumpRows, args);
+        }
+    }
+
+    struct BumpArgs
+    {
+        const eColor *      normalMap;
+        const eColor *      inputBmp;
+        const eColor16 *    normalMap16;
+        const eColor16 *    inputBmp16;
+        const eFloatColor * ambient;
+        const eFloatColor * diffuse;
+        const eFloatColor * specular;
+        eVector3            position;
+        eF32                specAmount;
+        eF32                bumpAmount;
+    };
+
+    void _bumpRows(eU32 firstRow, eU32 lastRow, const BumpArgs &args)
+    {
+        const eColor *normalMap = args.normalMap;
+        const eColor *inputBmp = args.inputBmp;
+        const eFloatColor &ambient = *args.ambient;
+        const eFloatColor &diffuse = *args.diffuse;
+        const eFloatColor &specular = *args.specular;
+
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
         {
             for (eU32 x=0; x<m_bmpDimSize[0]; x++, index++)
             {
@@ -1183,14 +1889,14 @@ OP_DEFINE_BITMAP(eBumpOp, eBumpOp_ID, "Bump", 'u', 2, 2, "-1,Bitmap")
                 // Compute the angle between normal
                 // and light position. Angle is scaled
                 // by bump amount.
-                const eF32 angle = eMax(0.0f, n*position*bumpAmount);
+                const eF32 angle = eMax(0.0f, n*args.position*args.bumpAmount);
 
                 // Calculate lighting values based on
                 // the phong model:
                 // color = ambient+diffuse*angle+angle^2*specular
-                const eF32 r = ambient.r+angle*(diffuse.r+angle*specular.r*specAmount);
-                const eF32 g = ambient.g+angle*(diffuse.g+angle*specular.g*specAmount);
-                const eF32 b = ambient.b+angle*(diffuse.b+angle*specular.b*specAmount);
+                const eF32 r = ambient.r+angle*(diffuse.r+angle*specular.r*args.specAmount);
+                const eF32 g = ambient.g+angle*(diffuse.g+angle*specular.g*args.specAmount);
+                const eF32 b = ambient.b+angle*(diffuse.b+angle*specular.b*args.specAmount);
 
                 // Calculate final average color.
                 m_bitmap[index].setRed(eMin(eFtoL(r)*inputBmp[index].red()/255, 255));
@@ -1199,6 +1905,88 @@ OP_DEFINE_BITMAP(eBumpOp, eBumpOp_ID, "Bump", 'u', 2, 2, "-1,Bitmap")
             }
         }
     }
+
+    // High precision version of _bumpRows(). Like
+    // there, the alpha channel isn't changed. Four
+    // pixels are lit at a time and the lighting
+    // term stays in floating point until the final
+    // store.
+    void _bumpRows16(eU32 firstRow, eU32 lastRow, const BumpArgs &args)
+    {
+        const eColor16 *normalMap = args.normalMap16;
+        const eColor16 *inputBmp = args.inputBmp16;
+        const eFloatColor &ambient = *args.ambient;
+        const eFloatColor &diffuse = *args.diffuse;
+        const eFloatColor &specular = *args.specular;
+        const eU32 last = lastRow*m_bmpDimSize[0];
+        eU32 i = firstRow*m_bmpDimSize[0];
+
+        const __m128 inv257 = _mm_set1_ps(1.0f/257.0f);
+        const __m128 inv255 = _mm_set1_ps(1.0f/255.0f);
+        const __m128 center = _mm_set1_ps(127.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 max = _mm_set1_ps(65535.0f);
+        const __m128 posX = _mm_set1_ps(args.position.x);
+        const __m128 posY = _mm_set1_ps(args.position.y);
+        const __m128 posZ = _mm_set1_ps(args.position.z);
+        const __m128 bumpAmount = _mm_set1_ps(args.bumpAmount);
+        const __m128 ambR = _mm_set1_ps(ambient.r);
+        const __m128 ambG = _mm_set1_ps(ambient.g);
+        const __m128 ambB = _mm_set1_ps(ambient.b);
+        const __m128 difR = _mm_set1_ps(diffuse.r);
+        const __m128 difG = _mm_set1_ps(diffuse.g);
+        const __m128 difB = _mm_set1_ps(diffuse.b);
+        const __m128 specR = _mm_set1_ps(specular.r*args.specAmount);
+        const __m128 specG = _mm_set1_ps(specular.g*args.specAmount);
+        const __m128 specB = _mm_set1_ps(specular.b*args.specAmount);
+
+        for (; i+4<=last; i+=4)
+        {
+            __m128 nb, ng, nr, na;
+            _loadChannels16(&normalMap[i], nb, ng, nr, na);
+
+            const __m128 nx = _mm_sub_ps(_mm_mul_ps(nr, inv257), center);
+            const __m128 ny = _mm_sub_ps(_mm_mul_ps(ng, inv257), center);
+            const __m128 nz = _mm_sub_ps(_mm_mul_ps(nb, inv257), center);
+
+            const __m128 sqrLen = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+            const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, posX), _mm_mul_ps(ny, posY)), _mm_mul_ps(nz, posZ));
+            const __m128 angle = _mm_max_ps(zero, _mm_mul_ps(_mm_mul_ps(dot, _getInvLengths(sqrLen)), bumpAmount));
+
+            const __m128 r = _mm_add_ps(ambR, _mm_mul_ps(angle, _mm_add_ps(difR, _mm_mul_ps(angle, specR))));
+            const __m128 g = _mm_add_ps(ambG, _mm_mul_ps(angle, _mm_add_ps(difG, _mm_mul_ps(angle, specG))));
+            const __m128 b = _mm_add_ps(ambB, _mm_mul_ps(angle, _mm_add_ps(difB, _mm_mul_ps(angle, specB))));
+
+            __m128 ib, ig, ir, ia;
+            _loadChannels16(&inputBmp[i], ib, ig, ir, ia);
+
+            const __m128 outR = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_mul_ps(r, ir), inv255), zero), max);
+            const __m128 outG = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_mul_ps(g, ig), inv255), zero), max);
+            const __m128 outB = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_mul_ps(b, ib), inv255), zero), max);
+
+            _storeChannels16(&m_bitmap16[i], outB, outG, outR, _getAlphas16(&m_bitmap[i]));
+        }
+
+        for (; i<last; i++)
+        {
+            eVector3 n(normalMap[i].red/257.0f, normalMap[i].green/257.0f, normalMap[i].blue/257.0f);
+            n -= 127.0f;
+            n.normalize();
+
+            const eF32 angle = eMax(0.0f, n*args.position*args.bumpAmount);
+
+            const eF32 r = ambient.r+angle*(diffuse.r+angle*specular.r*args.specAmount);
+            const eF32 g = ambient.g+angle*(diffuse.g+angle*specular.g*args.specAmount);
+            const eF32 b = ambient.b+angle*(diffuse.b+angle*specular.b*args.specAmount);
+
+            eColor16 &c = m_bitmap16[i];
+
+            c.red = (eU16)eFtoL(eClamp(0.0f, r*(eF32)inputBmp[i].red/255.0f, 65535.0f));
+            c.green = (eU16)eFtoL(eClamp(0.0f, g*(eF32)inputBmp[i].green/255.0f, 65535.0f));
+            c.blue = (eU16)eFtoL(eClamp(0.0f, b*(eF32)inputBmp[i].blue/255.0f, 65535.0f));
+            c.alpha = m_bitmap[i].alpha()*257;
+        }
+    }
 OP_END(eBumpOp);
 #endif
 
@@ -1209,6 +1997,103 @@ OP_END(eBumpOp);
 // blur when choosing n=3.
 
 #if defined(HAVE_OP_BITMAP_BLUR) || defined(eEDITOR)
+// Work item of the multithreaded blur passes.
+// Each job processes a band of rows of the
+// source bitmap.
+struct eBlurJob
+{
+    const eColor *  src;
+    eColor *        dst;
+    eU32            width;
+    eU32            height;
+    eU32            radius;
+    const eU32 *    div;
+};
+
+static const eU32 BLUR_BAND_SIZE = 16;
+
+static eU32 _getBlurJobCount(const eBlurJob &job)
+{
+    return (job.height+BLUR_BAND_SIZE-1)/BLUR_BAND_SIZE;
+}
+
+static eFORCEINLINE __m128i _unpackColor(const eColor &c, const __m128i &zero)
+{
+    const __m128i c8 = _mm_cvtsi32_si128(c.toArgb());
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(c8, zero), zero);
+}
+
+// Divides the four channel sums by looking them
+// up in the division table and packs the results.
+static eFORCEINLINE eColor _packBlurSum(const __m128i &sum, const eU32 *div)
+{
+    const eU32 c0 = div[_mm_cvtsi128_si32(sum)];
+    const eU32 c1 = div[_mm_cvtsi128_si32(_mm_srli_si128(sum, 4))];
+    const eU32 c2 = div[_mm_cvtsi128_si32(_mm_srli_si128(sum, 8))];
+    const eU32 c3 = div[_mm_cvtsi128_si32(_mm_srli_si128(sum, 12))];
+
+    return eColor(c0|(c1<<8)|(c2<<16)|(c3<<24));
+}
+
+// Box blurs one line of pixels (wrapping around
+// at the borders) using a running sum, which
+// holds all four channels in one register.
+static void _blurLine(const eColor *src, eColor *dst, eU32 count, eU32 radius, const eU32 *div)
+{
+    const eU32 andMask = count-1;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+
+    for (eInt i=-(eInt)radius; i<=(eInt)radius; i++)
+    {
+        sum = _mm_add_epi32(sum, _unpackColor(src[i&andMask], zero));
+    }
+
+    dst[0] = _packBlurSum(sum, div);
+
+    for (eU32 i=1; i<count; i++)
+    {
+        const __m128i add = _unpackColor(src[(i+radius)&andMask], zero);
+        const __m128i sub = _unpackColor(src[(i-radius-1)&andMask], zero);
+
+        sum = _mm_add_epi32(sum, _mm_sub_epi32(add, sub));
+        dst[i] = _packBlurSum(sum, div);
+    }
+}
+
+static void _blurRowsJob(ePtr arg, eU32 index)
+{
+    const eBlurJob &job = *(const eBlurJob *)arg;
+    const eU32 lastRow = eMin((index+1)*BLUR_BAND_SIZE, job.height);
+
+    for (eU32 y=index*BLUR_BAND_SIZE; y<lastRow; y++)
+    {
+        _blurLine(job.src+y*job.width, job.dst+y*job.width, job.width, job.radius, job.div);
+    }
+}
+
+// Transposes a band of rows tile by tile, so
+// that reading and writing stay cache friendly.
+static void _transposeJob(ePtr arg, eU32 index)
+{
+    const eBlurJob &job = *(const eBlurJob *)arg;
+    const eU32 firstRow = index*BLUR_BAND_SIZE;
+    const eU32 lastRow = eMin(firstRow+BLUR_BAND_SIZE, job.height);
+
+    for (eU32 x0=0; x0<job.width; x0+=BLUR_BAND_SIZE)
+    {
+        const eU32 lastCol = eMin(x0+BLUR_BAND_SIZE, job.width);
+
+        for (eU32 y=firstRow; y<lastRow; y++)
+        {
+            for (eU32 x=x0; x<lastCol; x++)
+            {
+                job.dst[x*job.height+y] = job.src[y*job.width+x];
+            }
+        }
+    }
+}
+
 OP_DEFINE_BITMAP(eBlurOp, eBlurOp_ID, "Blur", 'b', 1, 1, "-1,Bitmap")
     OP_INIT()
     {
@@ -1224,82 +2109,58 @@ OP_DEFINE_BITMAP(eBlurOp, eBlurOp_ID, "Blur", 'b', 1, 1, "-1,Bitmap")
         const eU32 passes = passesVal+1;
         const ePoint blurriness(eFtoL(amount.x*m_bmpDimSize[0]), eFtoL(amount.y*m_bmpDimSize[1]));
 
-        // Create bitmap for temporary results.
-        eColor *temp = new eColor[m_bmpSize];
-        eASSERT(temp != eNULL);
+        // Create bitmaps for temporary results.
+        eColor *temp0 = new eColor[m_bmpSize];
+        eASSERT(temp0 != eNULL);
+        eColor *temp1 = new eColor[m_bmpSize];
+        eASSERT(temp1 != eNULL);
 
-        // Precalculate some values.
-	    eU32 andDim[2];
-	    eU32 blurSize[2];
-	    eU32 *div[2];
-	    eU32 deltaDim[] = {1, m_bmpDimSize[0]};
+        // Precalculate division tables. Channel sums
+        // are at most 255 times the blur size.
+        eU32 *div[2];
 
-	    for(eU32 d = 0; d < 2; d++)
+        for (eU32 d=0; d<2; d++)
         {
-		    andDim[d] = m_bmpDimSize[d]-1;
-		    blurSize[d] = 2*blurriness[d]+1;
-		    eU32 dsize = blurSize[d]*m_bmpDimSize[d];
+            const eU32 blurSize = 2*blurriness[d]+1;
+            const eU32 divSize = blurSize*256;
 
-		    div[d] = new eU32[dsize];
+            div[d] = new eU32[divSize];
             eASSERT(div[d] != eNULL);
 
-		    for(eU32 i = 0; i < dsize; i++)
+            for (eU32 i=0; i<divSize; i++)
             {
-	            div[d][i] = eMin(eFtoL((eF32)i/(eF32)blurSize[d]*amplify), 255);
+                div[d][i] = eMin(eFtoL((eF32)i/(eF32)blurSize*amplify), 255);
             }
-	    };
-    
-	    // Apply blur for the given number of passes.
-	    eColor* source = m_bitmap;
-	    eColor* target = temp;
-
-        for (eU32 i=0; i<passes; i++)
-        {
-		    for (eU32 d=0; d<2; d++)
-            {
-			    for (eU32 k=0, index=0; k<m_bmpDimSize[1-d]; k++)
-                {
-				    eU32 t[] = {0, 0, 0, 0};
-
-				    const eU32 delta = k * deltaDim[1-d];
-
-				    for (eInt kd=-blurriness[d]; kd<=blurriness[d]; kd++)
-                    {
-					    const eColor &c = source[delta+(kd&andDim[d]) * deltaDim[d]];
-
-					    for (eU32 ch=0; ch<4; ch++)
-                        {
-						    t[ch] += c.get(ch);
-                        }
-				    }
+        }
 
-				    for (eU32 ch=0; ch<4; ch++)
-                    {
-					    target[delta].set(ch, div[d][t[ch]]);
-                    }
+        // Apply blur for the given number of passes.
+        // Columns are blurred as rows of the
+        // transposed bitmap.
+        const eU32 width = m_bmpDimSize[0];
+        const eU32 height = m_bmpDimSize[1];
 
-				    for (eU32 j=1; j<m_bmpDimSize[d]; j++)
-                    {
-					    const eColor &csub = source[delta+((j-blurriness[d]-1)&andDim[d]) * deltaDim[d]];
-					    const eColor &cadd = source[delta+((j+blurriness[d])&andDim[d]) * deltaDim[d]];
+        const eBlurJob horzBlur = {m_bitmap, temp0, width, height, blurriness.x, div[0]};
+        const eBlurJob transpose = {temp0, temp1, width, height, 0, eNULL};
+        const eBlurJob vertBlur = {temp1, temp0, height, width, blurriness.y, div[1]};
+        const eBlurJob transposeBack = {temp0, m_bitmap, height, width, 0, eNULL};
 
-					    for (eU32 ch=0; ch<4; ch++)
-                        {
-						    t[ch] += (eInt)(cadd.get(ch)-csub.get(ch));
-						    target[delta+j * deltaDim[d]].set(ch, div[d][t[ch]]);
-					    }
-				    }
-			    }
+        eThreadPool &pool = eThreadPool::get();
 
-			    eSwap(source, target);
-		    }
-	    }
+        for (eU32 i=0; i<passes; i++)
+        {
+            pool.parallelFor(_blurRowsJob, (ePtr)&horzBlur, _getBlurJobCount(horzBlur));
+            pool.parallelFor(_transposeJob, (ePtr)&transpose, _getBlurJobCount(transpose));
+            pool.parallelFor(_blurRowsJob, (ePtr)&vertBlur, _getBlurJobCount(vertBlur));
+            pool.parallelFor(_transposeJob, (ePtr)&transposeBack, _getBlurJobCount(transposeBack));
+        }
 
         // Free memory.
         eSAFE_DELETE_ARRAY(div[0]);
         eSAFE_DELETE_ARRAY(div[1]);
-        eSAFE_DELETE_ARRAY(temp);
+        eSAFE_DELETE_ARRAY(temp0);
+        eSAFE_DELETE_ARRAY(temp1);
     }
+    OP_IMPL_VERSION(2);
 OP_END(eBlurOp);
 #endif
 
@@ -1318,25 +2179,47 @@ OP_DEFINE_BITMAP(eDistortOp, eDistortOp_ID, "Distort", 'd', 2, 2, "-1,Bitmap")
 
     OP_EXEC(eGraphicsApiDx9 *gfx, const eVector2 &amountVal)
     {
-        const eVector2 amount(amountVal.x*(eF32)m_bmpDimSize[0]/256.0f,
-                              amountVal.y*(eF32)m_bmpDimSize[1]/256.0f);
+        DistortArgs args;
 
-        const Result &inputRes = ((eIBitmapOp *)getInputOperator(0))->getResult();
+        args.amount.set(amountVal.x*(eF32)m_bmpDimSize[0]/256.0f,
+                        amountVal.y*(eF32)m_bmpDimSize[1]/256.0f);
 
-        const eColor *map = ((eIBitmapOp *)getInputOperator(1))->getResult().bitmap;
-        eASSERT(map != eNULL);
+        args.inputRes = &((eIBitmapOp *)getInputOperator(0))->getResult();
+        args.map = ((eIBitmapOp *)getInputOperator(1))->getResult().bitmap;
+        eASSERT(args.map != eNULL);
 
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
+        _forEachRowBand(&eDistortOp::_distortRows, args);
+    }
+
+    struct DistortArgs
+    {
+        const Result *      inputRes;
+        const eColor *      map;
+        eVector2            amount;
+    };
+
+    void _distortRows(eU32 firstRow, eU32 lastRow, const DistortArgs &args)
+    {
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
         {
-            for (eU32 x=0; x<m_bmpDimSize[0]; x++)
+            for (eU32 x=0; x<m_bmpDimSize[0]; x+=SAMPLE_BATCH_SIZE)
             {
-                const eF32 u = x+amount.x*(eF32)map[index].red();
-                const eF32 v = y+amount.y*(eF32)map[index].green();
+                const eU32 count = eMin(SAMPLE_BATCH_SIZE, m_bmpDimSize[0]-x);
+                eF32 us[SAMPLE_BATCH_SIZE];
+                eF32 vs[SAMPLE_BATCH_SIZE];
 
-                m_bitmap[index++] = _getBilinearFiltered(inputRes, u, v);
+                for (eU32 i=0; i<count; i++)
+                {
+                    us[i] = (eF32)(x+i)+args.amount.x*(eF32)args.map[index+i].red();
+                    vs[i] = (eF32)y+args.amount.y*(eF32)args.map[index+i].green();
+                }
+
+                _sampleBilinear(*args.inputRes, us, vs, &m_bitmap[index], count);
+                index += count;
             }
         }
     }
+    OP_IMPL_VERSION(2);
 OP_END(eDistortOp);
 #endif
 
@@ -1346,6 +2229,132 @@ OP_END(eDistortOp);
 // e.g. to create bitmaps that look like stone.
 
 #if defined(HAVE_OP_BITMAP_CELLS) || defined(eEDITOR)
+// Work item of the multithreaded cell evaluation.
+// Each job processes a band of rows.
+struct eCellsJob
+{
+    const eVector2 *    points;
+    const eU32 *        colCells;
+    eU32                numPoints;
+    eU32                width;
+    eU32                height;
+    eF32                amplify;
+    eF32                gamma;
+    eInt                pattern;
+    eColor              color0;
+    eColor              color1;
+    eColor *            bitmap;
+};
+
+static const eU32 CELLS_BAND_SIZE = 16;
+static const eU32 CELLS_MAX_POINTS = 64;
+
+// Returns the indices of the previous, current
+// and next cell (wrapping around) together with
+// the offsets, which make the cells tileable.
+static void _getNeighbourCells(eU32 cell, eU32 numPoints, eU32 indices[3], eF32 offsets[3])
+{
+    indices[0] = (cell == 0 ? numPoints-1 : cell-1);
+    indices[1] = cell;
+    indices[2] = (cell == numPoints-1 ? 0 : cell+1);
+
+    offsets[0] = (cell == 0 ? -1.0f : 0.0f);
+    offsets[1] = 0.0f;
+    offsets[2] = (cell == numPoints-1 ? 1.0f : 0.0f);
+}
+
+static void _cellsRowsJob(ePtr arg, eU32 index)
+{
+    const eCellsJob &job = *(const eCellsJob *)arg;
+    const eU32 n = job.numPoints;
+    const eU32 lastRow = eMin((index+1)*CELLS_BAND_SIZE, job.height);
+
+    // Positions of the nine neighbour cell points
+    // of each cell in the current row.
+    eF32 candX[CELLS_MAX_POINTS][9];
+    eF32 candY[CELLS_MAX_POINTS][9];
+
+    const __m128 invWidth = _mm_set1_ps(1.0f/(eF32)job.width);
+    const __m128 amplify = _mm_set1_ps(job.amplify);
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+    for (eU32 y=index*CELLS_BAND_SIZE; y<lastRow; y++)
+    {
+        eU32 rows[3], cols[3];
+        eF32 rowOffs[3], colOffs[3];
+
+        _getNeighbourCells(y*n/job.height, n, rows, rowOffs);
+
+        for (eU32 c=0; c<n; c++)
+        {
+            _getNeighbourCells(c, n, cols, colOffs);
+
+            for (eU32 i=0, k=0; i<3; i++)
+            {
+                for (eU32 j=0; j<3; j++, k++)
+                {
+                    const eVector2 &p = job.points[rows[i]*n+cols[j]];
+
+                    candX[c][k] = p.x+colOffs[j];
+                    candY[c][k] = p.y+rowOffs[i];
+                }
+            }
+        }
+
+        // Evaluate four pixels at once. Lanes beyond
+        // the bitmap's width repeat the last pixel.
+        const __m128 yp = _mm_set1_ps((eF32)y/(eF32)job.height);
+        eColor *row = job.bitmap+y*job.width;
+
+        for (eU32 x=0; x<job.width; x+=4)
+        {
+            eU32 cells[4];
+
+            for (eU32 l=0; l<4; l++)
+            {
+                cells[l] = job.colCells[eMin(x+l, job.width-1)];
+            }
+
+            const __m128 xp = _mm_mul_ps(_mm_add_ps(_mm_set1_ps((eF32)x), lane), invWidth);
+            __m128 minDist = _mm_set1_ps(eF32_MAX);
+            __m128 nextMinDist = minDist;
+
+            for (eU32 k=0; k<9; k++)
+            {
+                const __m128 cx = _mm_set_ps(candX[cells[3]][k], candX[cells[2]][k], candX[cells[1]][k], candX[cells[0]][k]);
+                const __m128 cy = _mm_set_ps(candY[cells[3]][k], candY[cells[2]][k], candY[cells[1]][k], candY[cells[0]][k]);
+                const __m128 dx = _mm_sub_ps(xp, cx);
+                const __m128 dy = _mm_sub_ps(yp, cy);
+                const __m128 dist = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), amplify);
+
+                // Keep the two shortest distances.
+                const __m128 closer = _mm_cmplt_ps(dist, minDist);
+                const __m128 next = _mm_min_ps(nextMinDist, dist);
+
+                nextMinDist = _mm_or_ps(_mm_and_ps(closer, minDist), _mm_andnot_ps(closer, next));
+                minDist = _mm_min_ps(minDist, dist);
+            }
+
+            // Set pixel intensities based on
+            // calculated distances and pattern.
+            const __m128 dist = (job.pattern == 0 ? _mm_sub_ps(nextMinDist, minDist) : minDist);
+            const __m128 one = _mm_set1_ps(1.0f);
+            __m128 intensity = _mm_sub_ps(one, _mm_mul_ps(dist, _mm_set1_ps((eF32)n)));
+
+            intensity = _mm_mul_ps(intensity, _mm_set1_ps(job.gamma));
+            intensity = _mm_min_ps(_mm_max_ps(intensity, _mm_setzero_ps()), one);
+
+            eALIGN16 eF32 intensities[4];
+            _mm_store_ps(intensities, intensity);
+
+            for (eU32 l=0; l<4 && x+l<job.width; l++)
+            {
+                row[x+l] = job.color0.lerp(job.color1, intensities[l]);
+            }
+        }
+    }
+}
+
 OP_DEFINE_BITMAP(eCellsOp, eCellsOp_ID, "Cells", ' ', 0, 0, "")
     OP_INIT()
     {
@@ -1365,6 +2374,8 @@ OP_DEFINE_BITMAP(eCellsOp, eCellsOp_ID, "Cells", ' ', 0, 0, "")
     OP_EXEC(eGraphicsApiDx9 *gfx, eInt widthSel, eInt heightSel, eU32 numPoints, eF32 regularityVal, eInt pattern,
             eU32 seed, eF32 amplify, eF32 gamma, const eFloatColor &color0, const eFloatColor &color1)
     {
+        eASSERT(numPoints >= 1 && numPoints <= CELLS_MAX_POINTS);
+
         const eF32 regularity = 1.0f-regularityVal;
 
         // Reallocate memory for bitmap, if
@@ -1375,7 +2386,7 @@ OP_DEFINE_BITMAP(eCellsOp, eCellsOp_ID, "Cells", ' ', 0, 0, "")
         _reallocate(newWidth, newHeight);
 
         // Generate control points for cells.
-        eRandomize(seed);
+        eU32 randSeed = seed+1;
 
         eVector2 *points = new eVector2[numPoints*numPoints];
         eASSERT(points != eNULL);
@@ -1386,103 +2397,45 @@ OP_DEFINE_BITMAP(eCellsOp, eCellsOp_ID, "Cells", ' ', 0, 0, "")
             {
                 eVector2 &p = points[index++];
 
-                p.x = (x+0.5f+eRandomF(-0.5f, 0.5f)*regularity)/(eF32)numPoints;
-                p.y = (y+0.5f+eRandomF(-0.5f, 0.5f)*regularity)/(eF32)numPoints;
+                p.x = (x+0.5f+eRandomF(-0.5f, 0.5f, randSeed)*regularity)/(eF32)numPoints;
+                p.y = (y+0.5f+eRandomF(-0.5f, 0.5f, randSeed)*regularity)/(eF32)numPoints;
             }
         }
 
-        // Calculate point with shortest distance to
-        // current pixel position. Using this distance,
-        // the final pixel color is calculated.
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
-        {
-            const eU32 yo = y*numPoints/m_bmpDimSize[1]+numPoints;
-            const eF32 yp = (eF32)y/(eF32)m_bmpDimSize[1];
-
-            for (eU32 x=0; x<m_bmpDimSize[0]; x++)
-            {
-                const eU32 xo = x*numPoints/m_bmpDimSize[0]+numPoints;
-                const eF32 xp = (eF32)x/(eF32)m_bmpDimSize[0];
-
-                eF32 maxDist = eF32_MIN;
-                eF32 minDist = eF32_MAX;
-                eF32 nextMinDist = eF32_MAX;
-
-                for (eInt i=-1; i<2; i++)
-                {
-                    const eInt io = ((yo+i)%numPoints)*numPoints;
-
-                    for (eInt j=-1; j<2; j++)
-                    {
-                        eVector2 cellPos = points[((xo+j)%numPoints)+io];
-
-                        // Make cells tileable.
-                        if (j == -1 && x*numPoints < m_bmpDimSize[0])
-                        {
-                            cellPos.x--;
-                        }
-                        else if (j == 1 && x*numPoints >= m_bmpDimSize[0]*(numPoints-1))
-                        {
-                            cellPos.x++;
-                        }
-
-                        if (i == 1 && y*numPoints >= m_bmpDimSize[1]*(numPoints-1))
-                        {
-                            cellPos.y++;
-                        }
-                        else if (i == -1 && y*numPoints < m_bmpDimSize[1])
-                        {
-                            cellPos.y--;
-                        }
-
-                        // Calculate the two shortest distances.
-                        const eF32 dist = (eVector2(xp, yp)-cellPos).length()*amplify;
-
-                        if (dist < minDist)
-                        {
-                            nextMinDist = minDist;
-                            minDist = dist;
-                        }
-                        else if (dist < nextMinDist)
-                        {
-                            nextMinDist = dist;
-                        }
-
-                        if (dist > maxDist)
-                        {
-                            maxDist = dist;
-                        }
-                    }
-                }
-
-                // Set pixel intensity based on
-                // calculated distances and pattern.
-                eF32 intensity;
+        // Precalculate the cell column of each pixel.
+        eU32 *colCells = new eU32[m_bmpDimSize[0]];
+        eASSERT(colCells != eNULL);
 
-                switch (pattern)
-                {
-                    case 0: // Stone
-                    {
-                        intensity = 1.0f-(nextMinDist-minDist)*(eF32)numPoints;
-                        break;
-                    }
-
-                    case 1: // Cobweb
-                    {
-                        intensity = 1.0f-minDist*(eF32)numPoints;
-                        break;
-                    }
-                }
-
-                intensity = eClamp(0.0f, intensity*gamma, 1.0f);
-
-                // Set color value for current pixel.
-                m_bitmap[index++] = eColor(color0).lerp(color1, intensity);
-            }
+        for (eU32 x=0; x<m_bmpDimSize[0]; x++)
+        {
+            colCells[x] = x*numPoints/m_bmpDimSize[0];
         }
 
+        // Calculate the two shortest distances from
+        // each pixel to the points of its neighbour
+        // cells. Using these distances, the final
+        // pixel color is calculated.
+        eCellsJob job;
+
+        job.points = points;
+        job.colCells = colCells;
+        job.numPoints = numPoints;
+        job.width = m_bmpDimSize[0];
+        job.height = m_bmpDimSize[1];
+        job.amplify = amplify;
+        job.gamma = gamma;
+        job.pattern = pattern;
+        job.color0 = color0;
+        job.color1 = color1;
+        job.bitmap = m_bitmap;
+
+        const eU32 jobCount = (m_bmpDimSize[1]+CELLS_BAND_SIZE-1)/CELLS_BAND_SIZE;
+        eThreadPool::get().parallelFor(_cellsRowsJob, &job, jobCount);
+
+        eSAFE_DELETE_ARRAY(colCells);
         eSAFE_DELETE_ARRAY(points);
     }
+    OP_IMPL_VERSION(2);
 OP_END(eCellsOp);
 #endif
 
@@ -1526,45 +2479,76 @@ OP_DEFINE_BITMAP(eTwirlOp, eTwirlOp_ID, "Twirl", ' ', 1, 1, "-1,Bitmap")
 
     OP_EXEC(eGraphicsApiDx9 *gfx, eF32 strength, const eVector2 &centerVal, const eVector2 &radiusVal)
     {
-        // Calculate absolute coordinates.
-        const eVector2 center(centerVal.x*(eF32)m_bmpDimSize[0], centerVal.y*(eF32)m_bmpDimSize[1]);
-        const eVector2 radius(radiusVal.x*(eF32)m_bmpDimSize[0], radiusVal.y*(eF32)m_bmpDimSize[1]);
+        TwirlArgs args;
 
-        const eF32 rr = radius.x*radius.y;
+        // Calculate absolute coordinates.
+        args.center.set(centerVal.x*(eF32)m_bmpDimSize[0], centerVal.y*(eF32)m_bmpDimSize[1]);
+        args.radius.set(radiusVal.x*(eF32)m_bmpDimSize[0], radiusVal.y*(eF32)m_bmpDimSize[1]);
+        args.strength = strength;
 
         // Twirl input bitmap.
-        const Result &inputRes = ((eIBitmapOp *)getInputOperator(0))->getResult();
+        args.inputRes = &((eIBitmapOp *)getInputOperator(0))->getResult();
 
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
+        _forEachRowBand(&eTwirlOp::_twirlRows, args);
+    }
+
+    struct TwirlArgs
+    {
+        const Result *      inputRes;
+        eVector2            center;
+        eVector2            radius;
+        eF32                strength;
+    };
+
+    void _twirlRows(eU32 firstRow, eU32 lastRow, const TwirlArgs &args)
+    {
+        const eVector2 &center = args.center;
+        const eVector2 &radius = args.radius;
+
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
         {
             const eF32 dy = ((eF32)y-center.y)/radius.y;
             const eF32 dy2 = dy*dy;
 
-            for (eU32 x=0; x<m_bmpDimSize[0]; x++, index++)
+            for (eU32 x=0; x<m_bmpDimSize[0]; x+=SAMPLE_BATCH_SIZE)
             {
-                const eF32 dx = ((eF32)x-center.x)/radius.x;
-                const eF32 dist = eSqrt(dx*dx+dy2);
+                const eU32 count = eMin(SAMPLE_BATCH_SIZE, m_bmpDimSize[0]-x);
+                eF32 us[SAMPLE_BATCH_SIZE];
+                eF32 vs[SAMPLE_BATCH_SIZE];
 
-                if (dist >= 1.0f)
+                for (eU32 i=0; i<count; i++)
                 {
-                    m_bitmap[index] = inputRes.bitmap[index];
-                }
-                else
-                {
-                    // angle = sin(distance*PI/2)
-                    // approximate using:
-                    // angle = fastCos(distance*PI/2-PI/2);
-                    const eF32 amount = (1.0f-eFastCos(dist*eHALFPI-eHALFPI))*strength;
+                    const eF32 dx = ((eF32)(x+i)-center.x)/radius.x;
+                    const eF32 dist = eSqrt(dx*dx+dy2);
 
-                    eVector2 pos((eF32)x-center.x, (eF32)y-center.y);
-                    pos.rotate(amount);
-                    pos += eVector2(center.x, center.y);
+                    // Pixels outside the radius sample at
+                    // integer coordinates, which returns
+                    // the input pixel unchanged.
+                    us[i] = (eF32)(x+i);
+                    vs[i] = (eF32)y;
 
-                    m_bitmap[index] = _getBilinearFiltered(inputRes, pos.x, pos.y);
+                    if (dist < 1.0f)
+                    {
+                        // angle = sin(distance*PI/2)
+                        // approximate using:
+                        // angle = fastCos(distance*PI/2-PI/2);
+                        const eF32 amount = (1.0f-eFastCos(dist*eHALFPI-eHALFPI))*args.strength;
+
+                        eVector2 pos((eF32)(x+i)-center.x, (eF32)y-center.y);
+                        pos.rotate(amount);
+                        pos += eVector2(center.x, center.y);
+
+                        us[i] = pos.x;
+                        vs[i] = pos.y;
+                    }
                 }
+
+                _sampleBilinear(*args.inputRes, us, vs, &m_bitmap[index], count);
+                index += count;
             }
         }
     }
+    OP_IMPL_VERSION(2);
 OP_END(eTwirlOp);
 #endif
 
@@ -1613,18 +2597,31 @@ OP_DEFINE_BITMAP(eBitmapImportOp, eBitmapImportOp_ID, "Import", 'i', 0, 0, "")
                 const eF32 stepy = (!mode ? (eF32)imgHeight/(eF32)newHeight : (eF32)newHeight/(eF32)imgHeight);
 
                 // Copy image data to bitmap buffer.
+                eU32 imgSize = imgWidth*imgHeight;
+                eColor16 *imgData16 = eNULL;
+                const Result res(imgWidth, imgHeight, imgSize, imgData, imgData16);
+
                 for (eU32 y=0, index=0; y<newHeight; y++)
                 {
-                    const eF32 v = (eF32)y*stepy;
+                    eF32 us[SAMPLE_BATCH_SIZE];
+                    eF32 vs[SAMPLE_BATCH_SIZE];
 
-                    for (eU32 x=0; x<newWidth; x++)
+                    for (eU32 i=0; i<SAMPLE_BATCH_SIZE; i++)
                     {
-                        const eF32 u = (eF32)x*stepx;
+                        vs[i] = (eF32)y*stepy;
+                    }
 
-                        eU32 imgSize = imgWidth*imgHeight;
-                        Result res(imgWidth, imgHeight, imgSize, imgData);
+                    for (eU32 x=0; x<newWidth; x+=SAMPLE_BATCH_SIZE)
+                    {
+                        const eU32 count = eMin(SAMPLE_BATCH_SIZE, newWidth-x);
+
+                        for (eU32 i=0; i<count; i++)
+                        {
+                            us[i] = (eF32)(x+i)*stepx;
+                        }
 
-                        m_bitmap[index++] = _getBilinearFiltered(res, u, v);
+                        _sampleBilinear(res, us, vs, &m_bitmap[index], count);
+                        index += count;
                     }
                 }
 
@@ -1645,6 +2642,13 @@ OP_DEFINE_BITMAP(eBitmapImportOp, eBitmapImportOp_ID, "Import", 'i', 0, 0, "")
         _reallocate(DEFAULT_SIZE, DEFAULT_SIZE);
         eMemSet(m_bitmap, 0, m_bmpSize*sizeof(eColor));
     }
+
+    // Loading the image requires the graphics API.
+    virtual eBool _canExecuteParallel() const
+    {
+        return eFALSE;
+    }
+    OP_IMPL_VERSION(2);
 OP_END(eBitmapImportOp);
 #endif
 
@@ -1672,19 +2676,38 @@ OP_DEFINE_BITMAP(eSinePlasmaOp, eSinePlasmaOp_ID, "Sine plasma", 's', 0, 0, "")
 
         _reallocate(newWidth, newHeight);
 
-        const eF32 sinDelta = eTWOPI/((eF32)m_bmpDimSize[0]/count.x);
-        const eF32 cosDelta = eTWOPI/((eF32)m_bmpDimSize[1]/count.y);
+        SinePlasmaArgs args;
 
-        for (eU32 y=0, index=0; y<m_bmpDimSize[1]; y++)
+        args.sinDelta = eTWOPI/((eF32)m_bmpDimSize[0]/count.x);
+        args.cosDelta = eTWOPI/((eF32)m_bmpDimSize[1]/count.y);
+        args.shift = shift;
+        args.plasmaCol = plasmaCol;
+        args.bgCol = bgCol;
+
+        _forEachRowBand(&eSinePlasmaOp::_sinePlasmaRows, args);
+    }
+
+    struct SinePlasmaArgs
+    {
+        eF32                sinDelta;
+        eF32                cosDelta;
+        eIXY                shift;
+        eColor              plasmaCol;
+        eColor              bgCol;
+    };
+
+    void _sinePlasmaRows(eU32 firstRow, eU32 lastRow, const SinePlasmaArgs &args)
+    {
+        for (eU32 y=firstRow, index=firstRow*m_bmpDimSize[0]; y<lastRow; y++)
         {
-            eF32 cosVal = eCos(y*cosDelta+(eF32)shift.y); // In range [-1,1].
+            eF32 cosVal = eCos(y*args.cosDelta+(eF32)args.shift.y); // In range [-1,1].
 
             for (eU32 x=0; x<m_bmpDimSize[0]; x++) 
             {
-                const eF32 sinVal = eSin(x*sinDelta+(eF32)shift.x); // In range [-1,1].
+                const eF32 sinVal = eSin(x*args.sinDelta+(eF32)args.shift.x); // In range [-1,1].
                 const eF32 alpha = (sinVal+cosVal+2.0f)*0.25f; // In range [0,1].
 
-                m_bitmap[index++] = alpha*eColor(plasmaCol)+(1.0f-alpha)*eColor(bgCol);
+                m_bitmap[index++] = alpha*args.plasmaCol+(1.0f-alpha)*args.bgCol;
             }
         }
     }
@@ -1865,11 +2888,8 @@ OP_DEFINE_BITMAP(eBricksOp, eBricksOp_ID, "Bricks", ' ', 0, 0, "")
         _reallocate(newWidth, newHeight);
 
         // Fill bitmap with color.
-        eU32 count = m_bmpSize;
-        while (count--)
-        {
-            m_bitmap[count] = color;
-        }
+        const eColor fillCol = color;
+        _forEachRowBand(&eBricksOp::_fillRows, fillCol);
 
         // Precalculate some values.
         const eU32 contrast = eFtoL(contrastVal*128.0f);
@@ -1942,6 +2962,16 @@ OP_DEFINE_BITMAP(eBricksOp, eBricksOp_ID, "Bricks", ' ', 0, 0, "")
             b++;
         }
     }
+
+    void _fillRows(eU32 firstRow, eU32 lastRow, const eColor &color)
+    {
+        const eU32 last = lastRow*m_bmpDimSize[0];
+
+        for (eU32 i=firstRow*m_bmpDimSize[0]; i<last; i++)
+        {
+            m_bitmap[i] = color;
+        }
+    }
 OP_END(eBricksOp);
 #endif
 
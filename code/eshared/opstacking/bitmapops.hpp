@@ -20,11 +20,12 @@ class eIBitmapOp : public eIOperator
 public:
     struct Result : public eIOperator::Result
     {
-        Result(eU32 &w, eU32 &h, eU32 &s, eColor *&bmp) :
+        Result(eU32 &w, eU32 &h, eU32 &s, eColor *&bmp, eColor16 *&bmp16) :
             width(w),
             height(h),
             size(s),
-            bitmap(bmp)
+            bitmap(bmp),
+            bitmap16(bmp16)
         {
         }
 
@@ -32,12 +33,14 @@ public:
         eU32 &              height;
         eU32 &              size;
         eColor *&           bitmap;
+        eColor16 *&         bitmap16; // eNULL if not in high precision.
     };
 
 public:
     eIBitmapOp() :
-        m_result(m_bmpDimSize[0], m_bmpDimSize[1], m_bmpSize, m_bitmap),
+        m_result(m_bmpDimSize[0], m_bmpDimSize[1], m_bmpSize, m_bitmap, m_bitmap16),
         m_bitmap(eNULL),
+        m_bitmap16(eNULL),
         m_bmpSize(0)
     {
 	    m_bmpDimSize[0] = 0;
@@ -48,9 +51,26 @@ public:
     virtual ~eIBitmapOp()
     {
         eSAFE_DELETE_ARRAY(m_bitmap);
+        eSAFE_DELETE_ARRAY(m_bitmap16);
     }
 #endif
 
+    // In high precision mode, operators supporting
+    // it additionally produce 16 bit per channel
+    // bitmaps, which are used by following operators
+    // instead of the 8 bit ones. The 8 bit bitmap
+    // is always kept up to date for texture uploads
+    // and operators without high precision support.
+    static void setHighPrecision(eBool highPrecision)
+    {
+        m_highPrecision = highPrecision;
+    }
+
+    static eBool getHighPrecision()
+    {
+        return m_highPrecision;
+    }
+
     virtual const Result &  getResult() const
     {
         return m_result;
@@ -82,6 +102,14 @@ private:
         }
     }
 
+    // Bitmap operators only work on their own and
+    // their input's bitmaps, so they can be executed
+    // in parallel with other operators.
+    virtual eBool _canExecuteParallel() const
+    {
+        return eTRUE;
+    }
+
 protected:
     void _reallocate(eU32 newWidth, eU32 newHeight)
     {
@@ -91,6 +119,7 @@ protected:
         if (m_bmpDimSize[0] != newWidth || m_bmpDimSize[1] != newHeight)
         {
             eSAFE_DELETE_ARRAY(m_bitmap);
+            eSAFE_DELETE_ARRAY(m_bitmap16);
             m_bitmap = new eColor[newWidth*newHeight];
             eASSERT(m_bitmap != eNULL);
 
@@ -109,6 +138,73 @@ protected:
         }
     }
 
+    // Allocates the high precision bitmap (if not
+    // yet done) and returns it.
+    eColor16 * _reallocate16()
+    {
+        if (!m_bitmap16)
+        {
+            m_bitmap16 = new eColor16[m_bmpSize];
+            eASSERT(m_bitmap16 != eNULL);
+        }
+
+        return m_bitmap16;
+    }
+
+    // Has to be called by high precision operators
+    // when they produced an 8 bit bitmap only.
+    void _free16()
+    {
+        eSAFE_DELETE_ARRAY(m_bitmap16);
+    }
+
+    const eColor16 *        _getInputBitmap16(eU32 index, eArray<eColor16> &temp) const;
+    void                    _quantizeBitmap16();
+
+    static void             _expandColors(const eColor *src, eColor16 *dst, eU32 count);
+    static void             _quantizeColors(const eColor16 *src, eColor *dst, eU32 count);
+
+    // Calls (op->*func)(firstRow, lastRow, args)
+    // for bands of rows of the bitmap, which are
+    // processed in parallel by the thread pool.
+    // A band holds about ROW_BAND_PIXELS pixels,
+    // so that it fits into the cache.
+    template<class T, class A> void _forEachRowBand(void (T::*func)(eU32 firstRow, eU32 lastRow, const A &args), const A &args)
+    {
+        eASSERT(func != eNULL);
+
+        RowBandJob<T, A> job;
+
+        job.op = static_cast<T *>(this);
+        job.func = func;
+        job.args = &args;
+        job.bandSize = eMax(ROW_BAND_PIXELS/m_bmpDimSize[0], (eU32)1);
+        job.height = m_bmpDimSize[1];
+
+        const eU32 bandCount = (job.height+job.bandSize-1)/job.bandSize;
+        eThreadPool::get().parallelFor(_rowBandJob<T, A>, &job, bandCount);
+    }
+
+private:
+    template<class T, class A> struct RowBandJob
+    {
+        T *                 op;
+        void                (T::*func)(eU32 firstRow, eU32 lastRow, const A &args);
+        const A *           args;
+        eU32                bandSize;
+        eU32                height;
+    };
+
+    template<class T, class A> static void _rowBandJob(ePtr arg, eU32 index)
+    {
+        const RowBandJob<T, A> &job = *(const RowBandJob<T, A> *)arg;
+        const eU32 firstRow = index*job.bandSize;
+
+        (job.op->*job.func)(firstRow, eMin(firstRow+job.bandSize, job.height), *job.args);
+    }
+
+protected:
+
 #ifdef eEDITOR
     virtual eBool checkValidity() const
     {
@@ -140,6 +236,46 @@ protected:
 
         return eIOperator::checkValidity();
     }
+
+private:
+    // High precision bitmaps aren't cached.
+    virtual eBool _canCacheResult() const
+    {
+        return !m_highPrecision;
+    }
+
+    // Stored format: width, height and the raw
+    // pixel data of the bitmap.
+    virtual void _storeResult(eByteArray &data) const
+    {
+        const eU32 bmpBytes = m_bmpSize*sizeof(eColor);
+
+        data.resize(2*sizeof(eU32)+bmpBytes);
+        eMemCopy(&data[0], m_bmpDimSize, 2*sizeof(eU32));
+        eMemCopy(&data[2*sizeof(eU32)], m_bitmap, bmpBytes);
+    }
+
+    virtual eBool _loadResult(const eByteArray &data)
+    {
+        if (data.size() < 2*sizeof(eU32))
+        {
+            return eFALSE;
+        }
+
+        eU32 dimSize[2];
+        eMemCopy(dimSize, &data[0], 2*sizeof(eU32));
+
+        if (!eIsPowerOf2(dimSize[0]) || !eIsPowerOf2(dimSize[1]) ||
+            data.size() != 2*sizeof(eU32)+dimSize[0]*dimSize[1]*sizeof(eColor))
+        {
+            return eFALSE;
+        }
+
+        _reallocate(dimSize[0], dimSize[1]);
+        _free16();
+        eMemCopy(m_bitmap, &data[2*sizeof(eU32)], m_bmpSize*sizeof(eColor));
+        return eTRUE;
+    }
 #endif
 
 protected:
@@ -149,13 +285,18 @@ protected:
     static const eU32   DEFAULT_SIZE = 256;
     static const eU32   DEFSIZE_SEL = 8;
 	static const eU32	COLOR_GRADING_SIZE = 16;
+    static const eU32   ROW_BAND_PIXELS = 16384;
 
 protected:
     eU32        m_bmpDimSize[2];
     eU32        m_bmpSize;
     eColor *    m_bitmap;
+    eColor16 *  m_bitmap16;
 
     Result      m_result;
+
+private:
+    static eBool m_highPrecision;
 };
 
 #endif // BITMAP_OPS_HPP
\ No newline at end of file
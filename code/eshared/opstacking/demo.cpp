@@ -14,7 +14,11 @@
 #include "../eshared.hpp"
 
 // Initialize static members.
+#ifdef _WIN32
 tfISoundOut *   eDemo::m_soundOut = new tfSoundOutDx8(512, 44100);
+#else
+tfISoundOut *   eDemo::m_soundOut = new tfSoundOutNull(512, 44100);
+#endif
 tfPlayer *      eDemo::m_player = new tfPlayer(eDemo::m_soundOut);
 
 void eDemo::shutdown()
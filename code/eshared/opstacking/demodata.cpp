@@ -16,7 +16,9 @@
 #define USE_EQUIVALENT_OP_SEARCH
 
 #ifdef eDEBUG
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdio.h>
 #endif
 
@@ -14,14 +14,59 @@
 #include "../eshared.hpp"
 
 #ifdef eDEBUG
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdio.h>
 #endif
 
+// Execution state of one changed operator while
+// processing an operator stack.
+struct eOpExecJob
+{
+    eIOperator *        op;
+    eGraphicsApiDx9 *   gfx;
+    eBool               execute;
+    eU32                depCount;
+    eU32                firstDependent;
+    eU32                dependentCount;
+};
+
+// State shared by all jobs of one process() call.
+// Finished jobs are reported back to the processing
+// thread using the finished jobs list.
+struct eOpExecContext
+{
+    eOpExecJob *        jobs;
+    eU32                fpuState[2];
+    eCriticalSection    lock;
+    eSemaphore          finishedSignal;
+    eArray<eU32>        finishedJobs;
+};
+
+static void _prepareJob(eOpExecJob &job)
+{
+#ifdef eEDITOR
+    job.execute = job.op->getValid();
+#else
+    job.execute = eTRUE;
+#endif
+}
+
+// Incremented whenever connections between operators
+// change, which invalidates all cached stack orders.
+eU32 eIOperator::m_structureGeneration = 1;
+
+// Incremented whenever operators are set to changed.
+// If it didn't change since a stack was processed
+// the last time, nothing in the stack has changed.
+eU32 eIOperator::m_changeGeneration = 1;
+
 eIOperator::eIOperator() :
 #ifdef eEDITOR
     m_valid(eTRUE),
     m_checkValidity(eTRUE),
+    m_resultHash(0),
 #endif
     m_id(_generateNewId()),
     m_changed(eTRUE),
@@ -29,7 +74,9 @@ eIOperator::eIOperator() :
     m_hidden(eFALSE),
     m_ownerPage(eNULL),
     m_width(4),
-    m_visited(eFALSE)
+    m_visited(eFALSE),
+    m_stackGeneration(0),
+    m_processedGeneration(0)
 {
 }
 
@@ -37,6 +84,7 @@ eIOperator::eIOperator() :
 eIOperator::~eIOperator()
 {
     _clearParameters();
+    setStructureChanged();
 }
 #endif
 
@@ -126,73 +174,247 @@ eBool eIOperator::process(eIRenderer *renderer, eF32 time, eBool (*callback)(eIR
 
     eASSERT(time >= 0.0f);
 
+    // Nothing to do, if neither an operator in the
+    // stack has been set to changed since the last
+    // call nor any parameter is animated.
+    _updateStackCache();
+
+    if (m_processedGeneration == m_changeGeneration && m_animatedOps.isEmpty())
+    {
+        return eFALSE;
+    }
+
     // First animate parameters.
-    eIOperatorPtrArray stackOps;
-    getOpsInStack(stackOps);
+    for (eU32 i=0; i<m_animatedOps.size(); i++)
+    {
+        m_animatedOps[i]->_animateParameters(time);
+    }
 
-    for (eU32 i=0; i<stackOps.size(); i++)
+    if (m_processedGeneration == m_changeGeneration)
     {
-        stackOps[i]->_animateParameters(time);
-        stackOps[i]->m_visited = eFALSE;
+        return eFALSE;
     }
 
     // Fetch all operators to process (changed
     // input and changed linked operators).
+    const eU32 changeGeneration = m_changeGeneration;
     eIOperatorPtrArray changedOps;
-    
-    for (eU32 i=0; i<stackOps.size(); i++)
+
+    for (eU32 i=0; i<m_stackOps.size(); i++)
     {
-        eASSERT(changedOps.exists(stackOps[i]) == -1);
+        eIOperator *op = m_stackOps[i];
 
-        if (stackOps[i]->getChanged())
+#ifdef eEDITOR
+        // Do we have to update validity status?
+        if (op->m_checkValidity)
         {
-            changedOps.append(stackOps[i]);
+            op->m_valid = op->checkValidity();
+            op->m_checkValidity = eFALSE;
+        }
+#endif
+
+        if (op->getChanged())
+        {
+            changedOps.append(op);
         }
     }
 
     if (changedOps.isEmpty())
     {
+        m_processedGeneration = changeGeneration;
         return eFALSE;
     }
 
-    // Iterate over list of changed operators
-    // and execute them.
+    // Build the dependency graph of the changed
+    // operators. Every job counts its dependencies
+    // which still have to be executed and knows the
+    // jobs depending on it, so that independent
+    // sub-trees can be executed concurrently.
+    eGraphicsApiDx9 *gfx = (renderer ? renderer->getGraphicsApi() : eNULL);
+    eHashMap<const eIOperator *, eU32> jobIndices(changedOps.size());
+    eArray<eOpExecJob> jobs(changedOps.size());
+    eArray<eU32> edges;
+
     for (eU32 i=0; i<changedOps.size(); i++)
     {
-        eIOperator *op = changedOps[i];
-        eASSERT(op != eNULL);
+        eOpExecJob &job = jobs[i];
 
-#ifdef eEDITOR
-        if (op->getValid())
-#endif
+        job.op = changedOps[i];
+        job.gfx = gfx;
+        job.depCount = 0;
+        job.firstDependent = 0;
+        job.dependentCount = 0;
+
+        jobIndices.insert(changedOps[i], i);
+    }
+
+    eIOperatorPtrArray deps;
+
+    for (eU32 i=0; i<changedOps.size(); i++)
+    {
+        deps.clear();
+        changedOps[i]->_getDependencies(deps);
+
+        for (eU32 j=0; j<deps.size(); j++)
         {
-            eGraphicsApiDx9 *gfx = (renderer ? renderer->getGraphicsApi() : eNULL);
+            // Count every dependency only once (an
+            // operator may be linked multiple times).
+            if (deps.exists(deps[j]) == (eInt)j && jobIndices.exists(deps[j]))
+            {
+                const eU32 depIndex = jobIndices[deps[j]];
 
-            op->_preExecute(gfx);
-            op->_callExecute(gfx);
+                edges.append(depIndex);
+                edges.append(i);
+                jobs[depIndex].dependentCount++;
+                jobs[i].depCount++;
+            }
         }
+    }
 
-        // Set operator and all its parameters to unchanged.
-        op->m_changed = eFALSE;
+    eArray<eU32> dependents(edges.size()/2);
 
-        for (eU32 j=0; j<op->m_params.size(); j++)
+    for (eU32 i=0, first=0; i<jobs.size(); i++)
+    {
+        jobs[i].firstDependent = first;
+        first += jobs[i].dependentCount;
+        jobs[i].dependentCount = 0;
+    }
+
+    for (eU32 i=0; i<edges.size(); i+=2)
+    {
+        eOpExecJob &job = jobs[edges[i]];
+        dependents[job.firstDependent+job.dependentCount++] = edges[i+1];
+    }
+
+    // Operators which aren't safe to be executed
+    // on worker threads (e.g. because they call
+    // the graphics API) are executed on the calling
+    // thread in exactly the same order as they were
+    // executed serially.
+    eOpExecContext ctx;
+    eArray<eU32> readyJobs;
+    eArray<eU32> serialJobs;
+
+    ctx.jobs = &jobs[0];
+    eFpuStateStore(ctx.fpuState);
+
+    for (eU32 i=0; i<jobs.size(); i++)
+    {
+        if (!jobs[i].op->_canExecuteParallel())
+        {
+            serialJobs.append(i);
+        }
+        else if (jobs[i].depCount == 0)
+        {
+            readyJobs.append(i);
+        }
+    }
+
+    eThreadPool &pool = eThreadPool::get();
+    eArray<eU32> finishedJobs;
+    eU32 nextSerialJob = 0;
+    eU32 runningCount = 0;
+    eU32 processedCount = 0;
+    eBool interrupted = eFALSE;
+
+    while (processedCount < jobs.size())
+    {
+        // Hand out all jobs, whose dependencies
+        // have been executed, to worker threads.
+        for (eU32 i=0; i<readyJobs.size() && !interrupted; i++)
+        {
+            eOpExecJob &job = jobs[readyJobs[i]];
+
+            _prepareJob(job);
+            pool.push(_executeJob, &ctx, readyJobs[i]);
+            runningCount++;
+        }
+
+        readyJobs.clear();
+
+        // Execute next serial job or wait for
+        // jobs to finish (helping the workers).
+        const eBool serialReady = (nextSerialJob < serialJobs.size() && jobs[serialJobs[nextSerialJob]].depCount == 0);
+
+        if (serialReady && !interrupted)
+        {
+            const eU32 index = serialJobs[nextSerialJob++];
+
+            _prepareJob(jobs[index]);
+            _executeJob(&ctx, index);
+            runningCount++;
+        }
+        else if (runningCount > 0)
+        {
+            if (!pool.runPendingJob())
+            {
+                ctx.finishedSignal.wait();
+            }
+        }
+        else
         {
-            op->m_params[j]->setChanged(eFALSE);
+            // Interrupted and all workers are done.
+            eASSERT(interrupted);
+            break;
         }
 
-        // Call callback procedure (used for
-        // progress information in calling code).
-        if (callback)
+        ctx.lock.enter();
+        finishedJobs = ctx.finishedJobs;
+        ctx.finishedJobs.clear();
+        ctx.lock.leave();
+
+        for (eU32 i=0; i<finishedJobs.size(); i++)
         {
-            if (!callback(renderer, i+1, changedOps.size(), param))
+            eOpExecJob &job = jobs[finishedJobs[i]];
+            eIOperator *op = job.op;
+
+            // Set operator and all its parameters to unchanged.
+            op->m_changed = eFALSE;
+
+            for (eU32 j=0; j<op->m_params.size(); j++)
+            {
+                op->m_params[j]->setChanged(eFALSE);
+            }
+
+            // Release operators depending on this one.
+            for (eU32 j=0; j<job.dependentCount; j++)
             {
-                // Interrupt generation of demo content.
-                return eFALSE;
+                const eU32 depIndex = dependents[job.firstDependent+j];
+                eOpExecJob &depJob = jobs[depIndex];
+
+                if (--depJob.depCount == 0 && depJob.op->_canExecuteParallel())
+                {
+                    readyJobs.append(depIndex);
+                }
+            }
+
+            runningCount--;
+            processedCount++;
+
+            // Call callback procedure (used for
+            // progress information in calling code).
+            if (callback && !interrupted)
+            {
+                if (!callback(renderer, processedCount, jobs.size(), param))
+                {
+                    // Interrupt generation of demo content,
+                    // but wait for running jobs first.
+                    interrupted = eTRUE;
+                }
             }
         }
+
+        finishedJobs.clear();
     }
 
-    return eTRUE;
+    // Operators set to changed while executing
+    // are picked up by the next call.
+    if (!interrupted)
+    {
+        m_processedGeneration = changeGeneration;
+    }
+
+    return !interrupted;
 }
 
 void eIOperator::setChanged()
@@ -206,57 +428,77 @@ void eIOperator::setChanged()
         return;
     }
 
-#ifdef eEDITOR
-    // Update validity status.
-    m_valid = checkValidity();
-    m_checkValidity = !m_valid;
-#endif
+    // Set us and all operators depending on us
+    // (outputs and linking operators) to changed.
+    // Every operator is visited only once, because
+    // it's marked as changed when it's queued.
+    eIOperatorPtrArray pending;
 
-    // Set all output operators (below us) to changed.
-    for (eU32 i=0; i<m_outputOps.size(); i++)
-    {
-        m_outputOps[i]->setChanged();
-    }
+    m_changed = eTRUE;
+    pending.append(this);
 
-    // Set operators which are linking us to changed.
-    for (eU32 i=0; i<m_linkingOps.size(); i++)
+    while (!pending.isEmpty())
     {
-        eIOperator *op = eDemoData::findOperator(m_linkingOps[i]);
+        eIOperator *curOp = pending.pop();
+
+#ifdef eEDITOR
+        // Update validity status.
+        curOp->m_valid = curOp->checkValidity();
+        curOp->m_checkValidity = !curOp->m_valid;
+#endif
 
-        if (op)
+        for (eU32 i=0; i<curOp->m_outputOps.size(); i++)
         {
-            // Set linking parameters explicitly to changed.
-            for (eU32 j=0; j<op->m_params.size(); j++)
+            eIOperator *outOp = curOp->m_outputOps[i];
+
+            if (!outOp->m_changed)
             {
-                eParameter &param = *op->m_params[j];
+                outOp->m_changed = eTRUE;
+                pending.append(outOp);
+            }
+        }
+
+        for (eU32 i=0; i<curOp->m_linkingOps.size(); i++)
+        {
+            eIOperator *op = eDemoData::findOperator(curOp->m_linkingOps[i]);
 
-                if (param.getType() == eParameter::TYPE_LINK)
+            if (op)
+            {
+                // Set linking parameters explicitly to changed.
+                for (eU32 j=0; j<op->m_params.size(); j++)
                 {
-                    eIOperator *linkingOp = eDemoData::findOperator(param.getValue().linkedOpId);
+                    eParameter &param = *op->m_params[j];
 
-                    if (linkingOp == this)
+                    if (param.getType() == eParameter::TYPE_LINK)
                     {
-                        param.setChanged(eTRUE);
-                    }
-                }
-                else if (param.isAnimated())
-                {
-                    eIOperator *animOp = eDemoData::findOperator(param.getAnimationPathOpId());
+                        eIOperator *linkingOp = eDemoData::findOperator(param.getValue().linkedOpId);
 
-                    if (animOp == this)
+                        if (linkingOp == curOp)
+                        {
+                            param.setChanged(eTRUE);
+                        }
+                    }
+                    else if (param.isAnimated())
                     {
-                        param.setChanged(eTRUE);
+                        eIOperator *animOp = eDemoData::findOperator(param.getAnimationPathOpId());
+
+                        if (animOp == curOp)
+                        {
+                            param.setChanged(eTRUE);
+                        }
                     }
                 }
-            }
 
-            // Set linking operator to changed.
-            op->setChanged();
+                if (!op->m_changed)
+                {
+                    op->m_changed = eTRUE;
+                    pending.append(op);
+                }
+            }
         }
     }
 
-    // Set us to changed, too.
-    m_changed = eTRUE;
+    m_changeGeneration++;
 }
 
 void eIOperator::setPosition(const ePoint &pos)
@@ -442,14 +684,18 @@ const eString & eIOperator::getRealType() const
 
 void eIOperator::getOpsInStack(eIOperatorPtrArray &ops)
 {
-    ePROFILER_ZONE("Collect stack operators");
-
-    _getOpsInStackInternal(ops);
+    _updateStackCache();
+    ops.append(m_stackOps);
+}
 
-    for (eU32 i=0; i<ops.size(); i++)
-    {
-        ops[i]->m_visited = eFALSE;
-    }
+// Has to be called whenever input, output, linking
+// or animation path connections of operators change
+// or parameters are (un-)animated.
+// Invalidates the cached execution order of all
+// operator stacks.
+void eIOperator::setStructureChanged()
+{
+    m_structureGeneration++;
 }
 
 #ifdef eEDITOR
@@ -659,33 +905,37 @@ void eIOperator::_deinitialize()
 {
 }
 
+// Collects the values of all parameters as
+// arguments and calls the operator's execute
+// function via its typed dispatch function.
 void eIOperator::_callExecute(eGraphicsApiDx9 *gfx)
 {
     ePROFILER_ZONE("Call operator execute");
 
 #ifdef eEDITOR
-    ePtr func = m_metaInfos->execFunc;
+    ExecFunc func = m_metaInfos->execFunc;
 #else
-    ePtr func = m_metaExecFunc;
+    ExecFunc func = m_metaExecFunc;
 #endif
     eASSERT(func != eNULL);
 
-    eU32 stackSize = 4;
+    ExecArg args[MAX_EXEC_ARGS];
+    eU32 argCount = 0;
 
-    for (eInt i=(eInt)m_params.size()-1; i>=0; i--)
+    for (eU32 i=0; i<m_params.size(); i++)
     {
         const eParameter &p = *m_params[i];
         const eParameter::Value &val = p.getValue();
 
+        // Every parameter adds at most one argument.
+        eASSERT(argCount < MAX_EXEC_ARGS);
+
         switch (p.getType())
         {
 #ifdef ePLAYER
             case eParameter::TYPE_TSHADERCODE:
             {
-                const eByteArray &bc = val.byteCode;
-
-                __asm push dword ptr [bc]
-                stackSize += 4;
+                args[argCount++].ptr = (ePtr)&val.byteCode;
                 break;
             }
 #endif
@@ -698,18 +948,13 @@ void eIOperator::_callExecute(eGraphicsApiDx9 *gfx)
             case eParameter::TYPE_RGB:
             case eParameter::TYPE_RGBA:
             {
-                const eFXYZ &v = val.fxyz;
-
-                __asm push dword ptr [v]
-                stackSize += 4;
+                args[argCount++].ptr = (ePtr)&val.fxyz;
                 break;
             }
 
             case eParameter::TYPE_LINK:
             {
-                eIOperator *linkedOp = eDemoData::findOperator(val.linkedOpId);
-                __asm push dword ptr [linkedOp];
-                stackSize += 4;
+                args[argCount++].ptr = eDemoData::findOperator(val.linkedOpId);
                 break;
             }
 
@@ -721,51 +966,29 @@ void eIOperator::_callExecute(eGraphicsApiDx9 *gfx)
             case eParameter::TYPE_TEXT:
             case eParameter::TYPE_FILE:
             {
-                const eChar *string = val.string;
-                __asm push dword ptr [string]
-                stackSize += 4;
+                args[argCount++].ptr = (ePtr)val.string;
                 break;
             }
 
-            
             case eParameter::TYPE_BOOL:
             case eParameter::TYPE_ENUM:
             case eParameter::TYPE_FLAGS:
             case eParameter::TYPE_INT:
             {
-                const int integer = val.integer;
-                __asm push dword ptr [integer]
-                stackSize += 4;
+                args[argCount++].integer = val.integer;
                 break;
             }
 
             case eParameter::TYPE_FLOAT:
             {
-                const float flt = val.flt;
-
-                __asm
-                {
-                    fld     dword ptr [flt]
-                    sub     esp, 4
-                    fstp    dword ptr [esp]
-                }
-
-                stackSize += 4;
+                args[argCount++].flt = val.flt;
                 break;
             }
         }
     }
 
-    // Call execute function. The calling convention
-    // used for non-static member functions is
-    // this-call. Hence no stack clean up required here.
-    __asm
-    {
-        push    dword ptr [gfx] // first parameter is always graphics API
-        mov     ecx, dword ptr [this]
-        call    dword ptr [func]
-    }
-
+    // First parameter is always graphics API.
+    func(this, gfx, args);
 }
 
 void eIOperator::_animateParameters(eF32 time)
@@ -810,6 +1033,360 @@ void eIOperator::_preExecute(eGraphicsApiDx9 *gfx)
 {
 }
 
+// Returns wether or not the operator can be
+// executed on a worker thread while other
+// operators are executed. Operators doing so
+// must not use the graphics API or any other
+// global state (like the global random seed).
+eBool eIOperator::_canExecuteParallel() const
+{
+    return eFALSE;
+}
+
+// Thread pool job which executes one operator
+// of an operator stack (see process()).
+void eIOperator::_executeJob(ePtr arg, eU32 index)
+{
+    eOpExecContext *ctx = (eOpExecContext *)arg;
+    eASSERT(ctx != eNULL);
+    eOpExecJob &job = ctx->jobs[index];
+
+    if (job.execute)
+    {
+        eFpuStateLoad(ctx->fpuState);
+
+        job.op->_preExecute(job.gfx);
+
+#ifdef eEDITOR
+        // Results of operators which are expensive
+        // to execute are stored in the on-disk cache
+        // and restored from there, if the operator's
+        // type, parameters and inputs didn't change.
+        job.op->_computeResultHash();
+
+        const eBool cacheable = (job.op->m_resultHash != 0 && job.op->_canCacheResult() && eOpResultCache::isEnabled());
+        eBool loaded = eFALSE;
+
+        if (cacheable)
+        {
+            eByteArray data;
+
+            if (eOpResultCache::load(job.op->m_resultHash, data) && job.op->_loadResult(data))
+            {
+                ePROFILER_COUNT(eProfiler::COUNTER_OPCACHE_HITS);
+                loaded = eTRUE;
+            }
+            else
+            {
+                ePROFILER_COUNT(eProfiler::COUNTER_OPCACHE_MISSES);
+            }
+        }
+
+        if (!loaded)
+        {
+            const eTimer timer;
+            job.op->_callExecute(job.gfx);
+
+            if (cacheable && timer.getElapsedMs() >= eOpResultCache::MIN_EXEC_TIME_MS)
+            {
+                eByteArray data;
+                job.op->_storeResult(data);
+
+                if (!data.isEmpty())
+                {
+                    eOpResultCache::store(job.op->m_resultHash, data);
+                }
+            }
+        }
+        else if (job.op->_executesAfterLoad())
+        {
+            job.op->_callExecute(job.gfx);
+        }
+#else
+        job.op->_callExecute(job.gfx);
+#endif
+    }
+#ifdef eEDITOR
+    else
+    {
+        job.op->m_resultHash = 0;
+    }
+#endif
+
+    ctx->lock.enter();
+    ctx->finishedJobs.append(index);
+    ctx->lock.leave();
+
+    ctx->finishedSignal.signal();
+}
+
+#ifdef eEDITOR
+// Calculates the hash identifying the operator's
+// result from its type, its parameter values and
+// the result hashes of all operators it depends
+// on. Operators reading external data (files or
+// the synth) or being animated get a hash of 0,
+// meaning their results can't be cached. The
+// same is true for all operators depending on
+// them.
+void eIOperator::_computeResultHash()
+{
+    m_resultHash = 0;
+
+    if (isAffectedByAnimation())
+    {
+        return;
+    }
+
+    const eString &type = getType();
+    const eU32 implVersion = _getImplVersion();
+    eU64 hash = eOpResultCache::hashData(type, type.length());
+    hash = eOpResultCache::hashData(&implVersion, sizeof(implVersion), hash);
+
+    for (eU32 i=0; i<m_params.size(); i++)
+    {
+        const eParameter &param = *m_params[i];
+        const eParameter::Value &val = param.getValue();
+
+        switch (param.getType())
+        {
+            case eParameter::TYPE_INT:
+            case eParameter::TYPE_ENUM:
+            {
+                hash = eOpResultCache::hashData(&val.integer, sizeof(val.integer), hash);
+                break;
+            }
+
+            case eParameter::TYPE_FLAGS:
+            {
+                hash = eOpResultCache::hashData(&val.flags, sizeof(val.flags), hash);
+                break;
+            }
+
+            case eParameter::TYPE_BOOL:
+            {
+                hash = eOpResultCache::hashData(&val.boolean, sizeof(val.boolean), hash);
+                break;
+            }
+
+            case eParameter::TYPE_FLOAT:
+            {
+                hash = eOpResultCache::hashData(&val.flt, sizeof(val.flt), hash);
+                break;
+            }
+
+            case eParameter::TYPE_FXY:
+            {
+                hash = eOpResultCache::hashData(&val.fxy, sizeof(val.fxy), hash);
+                break;
+            }
+
+            case eParameter::TYPE_FXYZ:
+            {
+                hash = eOpResultCache::hashData(&val.fxyz, sizeof(val.fxyz), hash);
+                break;
+            }
+
+            case eParameter::TYPE_FXYZW:
+            {
+                hash = eOpResultCache::hashData(&val.fxyzw, sizeof(val.fxyzw), hash);
+                break;
+            }
+
+            case eParameter::TYPE_RGB:
+            {
+                hash = eOpResultCache::hashData(&val.color, 3*sizeof(eF32), hash);
+                break;
+            }
+
+            case eParameter::TYPE_RGBA:
+            {
+                hash = eOpResultCache::hashData(&val.color, sizeof(val.color), hash);
+                break;
+            }
+
+            case eParameter::TYPE_IXY:
+            {
+                hash = eOpResultCache::hashData(&val.ixy, sizeof(val.ixy), hash);
+                break;
+            }
+
+            case eParameter::TYPE_IXYZ:
+            {
+                hash = eOpResultCache::hashData(&val.ixyz, sizeof(val.ixyz), hash);
+                break;
+            }
+
+            case eParameter::TYPE_IXYXY:
+            {
+                hash = eOpResultCache::hashData(&val.ixyxy, sizeof(val.ixyxy), hash);
+                break;
+            }
+
+            case eParameter::TYPE_STRING:
+            case eParameter::TYPE_TEXT:
+            case eParameter::TYPE_TSHADERCODE:
+            {
+                hash = eOpResultCache::hashData(val.string, eStrLength(val.string)+1, hash);
+                break;
+            }
+
+            case eParameter::TYPE_FILE:
+            case eParameter::TYPE_SYNTH:
+            {
+                return;
+            }
+
+            // Labels don't influence the result and
+            // linked operators are covered by the
+            // dependencies below.
+            case eParameter::TYPE_LABEL:
+            case eParameter::TYPE_LINK:
+            {
+                break;
+            }
+        }
+    }
+
+    eIOperatorPtrArray deps;
+    _getDependencies(deps);
+
+    for (eU32 i=0; i<deps.size(); i++)
+    {
+        const eU64 depHash = deps[i]->m_resultHash;
+
+        if (depHash == 0)
+        {
+            return;
+        }
+
+        hash = eOpResultCache::hashData(&depHash, sizeof(depHash), hash);
+    }
+
+    // Hash of 0 is reserved for "not cacheable".
+    m_resultHash = (hash != 0 ? hash : 1);
+}
+
+// Returns the version of the operator's
+// implementation (see OP_IMPL_VERSION). It's part
+// of the result hash, so that cached results of
+// an older implementation aren't used anymore.
+eU32 eIOperator::_getImplVersion() const
+{
+    return 1;
+}
+
+// Returns wether or not the operator's result
+// can be written to and read from the result
+// cache (see _storeResult() and _loadResult()).
+eBool eIOperator::_canCacheResult() const
+{
+    return eFALSE;
+}
+
+// Operators which cache only the expensive part
+// of their result return true here. They are
+// executed after loading it and have to rebuild
+// the rest of their result then.
+eBool eIOperator::_executesAfterLoad() const
+{
+    return eFALSE;
+}
+
+// Leaving the data empty means that the result
+// can't be stored.
+void eIOperator::_storeResult(eByteArray &data) const
+{
+}
+
+// Returns false if the result couldn't be
+// restored from the given data.
+eBool eIOperator::_loadResult(const eByteArray &data)
+{
+    return eFALSE;
+}
+
+// Collects the materials of all material operators
+// the operator depends on, directly or indirectly,
+// in a fixed order. The first entry is the default
+// material. Stored results refer to materials by
+// their index in this list, because operators with
+// the same result hash have the same list.
+void eIOperator::_getDependentMaterials(eArray<const eMaterial *> &materials) const
+{
+    materials.clear();
+    materials.append(eMaterial::getDefault());
+
+    eIOperatorPtrArray ops;
+    _getDependencies(ops);
+
+    for (eU32 i=0; i<ops.size(); i++)
+    {
+        eIOperator *op = ops[i];
+
+        if (TEST_OP_TYPE(op, "Misc : Material", eMaterialOp_ID))
+        {
+            const eMaterial *mat = &((eIMaterialOp *)op)->getResult().material;
+
+            if (materials.exists(mat) == -1)
+            {
+                materials.append(mat);
+            }
+        }
+
+        eIOperatorPtrArray deps;
+        op->_getDependencies(deps);
+
+        for (eU32 j=0; j<deps.size(); j++)
+        {
+            if (ops.exists(deps[j]) == -1)
+            {
+                ops.append(deps[j]);
+            }
+        }
+    }
+}
+#endif
+
+// Rebuilds the cached execution order of the stack
+// and the list of animated operators in it, if
+// operator connections or animated parameters
+// changed since the last call.
+void eIOperator::_updateStackCache()
+{
+    if (m_stackGeneration == m_structureGeneration)
+    {
+        return;
+    }
+
+    ePROFILER_ZONE("Collect stack operators");
+
+    m_stackOps.clear();
+    m_animatedOps.clear();
+    _getOpsInStackInternal(m_stackOps);
+
+    for (eU32 i=0; i<m_stackOps.size(); i++)
+    {
+        eIOperator *op = m_stackOps[i];
+        op->m_visited = eFALSE;
+
+        for (eU32 j=0; j<op->m_params.size(); j++)
+        {
+            if (op->m_params[j]->isAnimated())
+            {
+                m_animatedOps.append(op);
+                break;
+            }
+        }
+    }
+
+    // Operators of the new stack may have been
+    // changed before, so changed operators have
+    // to be searched on the next process() call.
+    m_stackGeneration = m_structureGeneration;
+    m_processedGeneration = m_changeGeneration-1;
+}
+
 // Returns a list of all changed operators to
 // process when executing. The operators in the
 // list are in the following order: the first one
@@ -823,6 +1400,33 @@ void eIOperator::_getOpsInStackInternal(eIOperatorPtrArray &ops)
         return;
     }
 
+    // Get linked and input operators.
+    eIOperatorPtrArray deps;
+    _getDependencies(deps);
+
+    for (eU32 i=0; i<deps.size(); i++)
+    {
+        deps[i]->_getOpsInStackInternal(ops);
+    }
+
+#ifdef eEDITOR
+    // Do we have to update our validity status?
+    if (m_checkValidity)
+    {
+        m_valid = checkValidity();
+        m_checkValidity = eFALSE;
+    }
+#endif
+
+    ops.append(this);
+    m_visited = eTRUE;
+}
+
+// Returns all operators which have to be executed
+// before this operator can be executed: linked
+// operators, animation paths and input operators.
+void eIOperator::_getDependencies(eIOperatorPtrArray &deps) const
+{
     // Get linked operators.
     for (eU32 i=0; i<m_params.size(); i++)
     {
@@ -834,7 +1438,7 @@ void eIOperator::_getOpsInStackInternal(eIOperatorPtrArray &ops)
 
             if (op)
             {
-                op->_getOpsInStackInternal(ops);
+                deps.append(op);
             }
         }
         else if (param.getType() == eParameter::TYPE_LINK)
@@ -843,28 +1447,13 @@ void eIOperator::_getOpsInStackInternal(eIOperatorPtrArray &ops)
 
             if (op)
             {
-                op->_getOpsInStackInternal(ops);
+                deps.append(op);
             }
         }
     }
 
-    // Get changed input operators.
-    for (eU32 i=0; i<m_inputOps.size(); i++)
-    {
-        m_inputOps[i]->_getOpsInStackInternal(ops);
-    }
-
-#ifdef eEDITOR
-    // Do we have to update our validity status?
-    if (m_checkValidity)
-    {
-        m_valid = checkValidity();
-        m_checkValidity = eFALSE;
-    }
-#endif
-
-    ops.append(this);
-    m_visited = eTRUE;
+    // Get input operators.
+    deps.append(m_inputOps);
 }
 
 // Generates a randomized ID. It is checked
@@ -18,6 +18,8 @@
 typedef eArray<class eIOperator *> eIOperatorPtrArray;
 typedef eArray<const class eIOperator *> eIOpConstPtrArray;
 
+class eOperatorPage;
+
 class eIOperator
 {
     friend class eOperatorPage;
@@ -33,6 +35,25 @@ public:
     {
     };
 
+    // Value of one argument passed to the execute
+    // function of an operator. Vectors, colors,
+    // strings and byte code are passed by address.
+    union ExecArg
+    {
+        eInt                    integer;
+        eF32                    flt;
+        ePtr                    ptr;
+    };
+
+    // Type of the dispatch functions, generated for
+    // each operator class, which call the typed
+    // execute function using the given arguments.
+    typedef void (* ExecFunc)(eIOperator *op, eGraphicsApiDx9 *gfx, const ExecArg *args);
+
+    // Maximum number of arguments an execute
+    // function can have (graphics API excluded).
+    static const eU32           MAX_EXEC_ARGS = 40;
+
 #ifdef eEDITOR
     struct MetaInfos
     {
@@ -46,7 +67,7 @@ public:
         eString                 classNameString;
         eString                 sourceFileName;
         eString                 type;
-        ePtr                    execFunc;
+        ExecFunc                execFunc;
     };
 #endif
 
@@ -90,6 +111,8 @@ public:
     eBool                       isAffectedByAnimation() const;
     void                        getOpsInStack(eIOperatorPtrArray &ops);
 
+    static void                 setStructureChanged();
+
 #ifdef eEDITOR
     virtual const MetaInfos &   getMetaInfos() const;
 
@@ -125,7 +148,7 @@ public:
 #else
     eU32                        m_metaOpID;
     eU32                        m_metaCategoryID;
-    ePtr                        m_metaExecFunc;
+    ExecFunc                    m_metaExecFunc;
 #endif
 
 protected:
@@ -136,11 +159,32 @@ private:
     void                        _callExecute(eGraphicsApiDx9 *gfx);
     void                        _animateParameters(eF32 time);
     void                        _clearParameters();
+    void                        _updateStackCache();
     void                        _getOpsInStackInternal(eIOperatorPtrArray &ops);
+    void                        _getDependencies(eIOperatorPtrArray &deps) const;
     eID                         _generateNewId() const;
 
+private:
+    static void                 _executeJob(ePtr arg, eU32 index);
+
 private:
     virtual void                _preExecute(eGraphicsApiDx9 *gfx);
+    virtual eBool               _canExecuteParallel() const;
+
+#ifdef eEDITOR
+protected:
+    void                        _getDependentMaterials(eArray<const eMaterial *> &materials) const;
+
+private:
+    void                        _computeResultHash();
+
+private:
+    virtual eU32                _getImplVersion() const;
+    virtual eBool               _canCacheResult() const;
+    virtual eBool               _executesAfterLoad() const;
+    virtual void                _storeResult(eByteArray &data) const;
+    virtual eBool               _loadResult(const eByteArray &data);
+#endif
 
 private:
     eID                         m_id;
@@ -156,9 +200,18 @@ private:
     eParameterPtrArray          m_params;
     eBool                       m_visited;
 
+    eIOperatorPtrArray          m_stackOps;     // Cached execution order of stack.
+    eIOperatorPtrArray          m_animatedOps;  // Operators in stack with animated parameters.
+    eU32                        m_stackGeneration;
+    eU32                        m_processedGeneration;
+
+    static eU32                 m_structureGeneration;
+    static eU32                 m_changeGeneration;
+
 #ifdef eEDITOR    
     mutable eBool               m_valid;
     mutable eBool               m_checkValidity;
+    eU64                        m_resultHash; // 0 if result can't be cached.
 
     eString                     m_userName;
 
@@ -11,14 +11,269 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#endif
 
 #include "../eshared.hpp"
 #include "../math/math.hpp"
 #include "../engine/engine.hpp"
 #include "../modules/lsystem/lsystem.hpp"
 
+#ifdef eEDITOR
+// Stored format: header, vertices, faces with
+// their corners (half-edges) and edges. Faces
+// refer to materials by their index in the list
+// of dependent materials. The half-edge structure
+// is rebuilt by adding the faces again in their
+// original order, so edges which don't belong to
+// any face can't be stored.
+void eIMeshOp::_storeResult(eByteArray &data) const
+{
+    eArray<const eMaterial *> materials;
+    _getDependentMaterials(materials);
+
+    eArray<eU32> faceMats(m_mesh.getFaceCount());
+    eArray<eBool> edgeUsed(m_mesh.getEdgeCount());
+    StoredHeader header;
+
+    // Zero padding bytes, so that equal meshes
+    // are stored equally.
+    eMemSet(&header, 0, sizeof(header));
+    header.version = STORED_MESH_VERSION;
+    header.vertexCount = m_mesh.getVertexCount();
+    header.faceCount = m_mesh.getFaceCount();
+    header.edgeCount = m_mesh.getEdgeCount();
+    header.cornerCount = 0;
+    header.bbox = m_mesh.getBoundingBox();
+
+    for (eU32 i=0; i<edgeUsed.size(); i++)
+    {
+        edgeUsed[i] = eFALSE;
+    }
+
+    for (eU32 i=0; i<m_mesh.getFaceCount(); i++)
+    {
+        const eEditMesh::Face *face = m_mesh.getFace(i);
+        const eInt mat = materials.exists(face->material);
+
+        if (mat == -1)
+        {
+            return;
+        }
+
+        faceMats[i] = mat;
+
+        const eEditMesh::HalfEdge *he = face->he;
+
+        do
+        {
+            edgeUsed[he->edge->index] = eTRUE;
+            header.cornerCount++;
+            he = he->next;
+        }
+        while (he != face->he);
+    }
+
+    for (eU32 i=0; i<edgeUsed.size(); i++)
+    {
+        if (!edgeUsed[i])
+        {
+            return;
+        }
+    }
+
+    data.reserve(sizeof(header)+header.vertexCount*sizeof(StoredVertex)+header.faceCount*sizeof(StoredFace)+
+                 header.cornerCount*sizeof(StoredCorner)+header.edgeCount*sizeof(StoredEdge));
+    eOpResultCache::append(data, &header, sizeof(header));
+
+    for (eU32 i=0; i<m_mesh.getVertexCount(); i++)
+    {
+        const eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
+        StoredVertex sv;
+        eMemSet(&sv, 0, sizeof(sv));
+
+        sv.position = vtx->getPosition();
+        sv.normal = vtx->getNormal();
+        sv.texCoord = vtx->getTexCoord();
+        sv.color = vtx->getColor();
+        sv.tag = vtx->tag;
+        sv.selected = vtx->selected;
+
+        eOpResultCache::append(data, &sv, sizeof(sv));
+    }
+
+    for (eU32 i=0; i<m_mesh.getFaceCount(); i++)
+    {
+        const eEditMesh::Face *face = m_mesh.getFace(i);
+        StoredFace sf;
+        eMemSet(&sf, 0, sizeof(sf));
+
+        sf.normal = face->normal;
+        sf.material = faceMats[i];
+        sf.cornerCount = face->getEdgeCount();
+        sf.tag = face->tag;
+        sf.selected = face->selected;
+
+        eOpResultCache::append(data, &sf, sizeof(sf));
+
+        const eEditMesh::HalfEdge *he = face->he;
+
+        do
+        {
+            StoredCorner sc;
+            eMemSet(&sc, 0, sizeof(sc));
+
+            sc.texCoord = he->texCoord;
+            sc.vertex = he->origin->index;
+            sc.edge = he->edge->index;
+
+            eOpResultCache::append(data, &sc, sizeof(sc));
+            he = he->next;
+        }
+        while (he != face->he);
+    }
+
+    for (eU32 i=0; i<m_mesh.getEdgeCount(); i++)
+    {
+        const eEditMesh::Edge *edge = m_mesh.getEdge(i);
+        StoredEdge se;
+        eMemSet(&se, 0, sizeof(se));
+
+        se.tag = edge->tag;
+        se.selected = edge->selected;
+
+        eOpResultCache::append(data, &se, sizeof(se));
+    }
+}
+
+eBool eIMeshOp::_loadResult(const eByteArray &data)
+{
+    if (!_loadMesh(data))
+    {
+        // Operators append to the mesh when
+        // executed, so don't leave anything.
+        m_mesh.clear();
+        return eFALSE;
+    }
+
+    return eTRUE;
+}
+
+eBool eIMeshOp::_loadMesh(const eByteArray &data)
+{
+    eArray<const eMaterial *> materials;
+    _getDependentMaterials(materials);
+
+    eU32 pos = 0;
+    StoredHeader header;
+
+    if (!eOpResultCache::read(data, pos, &header, sizeof(header)) || header.version != STORED_MESH_VERSION ||
+        data.size() != sizeof(header)+header.vertexCount*sizeof(StoredVertex)+header.faceCount*sizeof(StoredFace)+
+                       header.cornerCount*sizeof(StoredCorner)+header.edgeCount*sizeof(StoredEdge))
+    {
+        return eFALSE;
+    }
+
+    m_mesh.clear();
+    m_mesh.reserveSpace(header.vertexCount, header.faceCount);
+
+    for (eU32 i=0; i<header.vertexCount; i++)
+    {
+        StoredVertex sv;
+        eOpResultCache::read(data, pos, &sv, sizeof(sv));
+
+        eEditMesh::Vertex *vtx = m_mesh.addVertex(sv.position, sv.texCoord, sv.normal);
+        vtx->getColor() = sv.color;
+        vtx->tag = sv.tag;
+        vtx->selected = sv.selected;
+    }
+
+    // New edges of the restored mesh, indexed by
+    // the stored edge index.
+    eArray<eEditMesh::Edge *> edges(header.edgeCount);
+    eArray<StoredCorner> corners;
+    eArray<eU32> indices;
+    eArray<eVector2> texCoords;
+    eU32 cornersLeft = header.cornerCount;
+
+    for (eU32 i=0; i<header.edgeCount; i++)
+    {
+        edges[i] = eNULL;
+    }
+
+    for (eU32 i=0; i<header.faceCount; i++)
+    {
+        StoredFace sf;
+        eOpResultCache::read(data, pos, &sf, sizeof(sf));
+
+        if (sf.cornerCount < 3 || sf.cornerCount > cornersLeft || sf.material >= materials.size())
+        {
+            return eFALSE;
+        }
+
+        cornersLeft -= sf.cornerCount;
+        corners.resize(sf.cornerCount);
+        eOpResultCache::read(data, pos, &corners[0], sf.cornerCount*sizeof(StoredCorner));
+        indices.resize(sf.cornerCount);
+        texCoords.resize(sf.cornerCount);
+
+        for (eU32 j=0; j<sf.cornerCount; j++)
+        {
+            if (corners[j].vertex >= header.vertexCount || corners[j].edge >= header.edgeCount)
+            {
+                return eFALSE;
+            }
+
+            indices[j] = corners[j].vertex;
+            texCoords[j] = corners[j].texCoord;
+        }
+
+        eEditMesh::Face *face = m_mesh.addFace(&indices[0], &texCoords[0], sf.cornerCount);
+
+        if (face == eNULL)
+        {
+            return eFALSE;
+        }
+
+        face->normal = sf.normal;
+        face->material = materials[sf.material];
+        face->tag = sf.tag;
+        face->selected = sf.selected;
+
+        eEditMesh::HalfEdge *he = face->he;
+
+        for (eU32 j=0; j<sf.cornerCount; j++, he=he->next)
+        {
+            edges[corners[j].edge] = he->edge;
+        }
+    }
+
+    if (cornersLeft > 0 || m_mesh.getEdgeCount() != header.edgeCount)
+    {
+        return eFALSE;
+    }
+
+    for (eU32 i=0; i<header.edgeCount; i++)
+    {
+        StoredEdge se;
+        eOpResultCache::read(data, pos, &se, sizeof(se));
+
+        if (edges[i] == eNULL)
+        {
+            return eFALSE;
+        }
+
+        edges[i]->tag = se.tag;
+        edges[i]->selected = se.selected;
+    }
+
+    m_mesh.setBoundingBox(header.bbox);
+    return eTRUE;
+}
+#endif
+
 // Import ESVG (mesh) operator
 // ---------------------------
 // Imports a scalable vector graphic as a mesh
@@ -516,7 +771,7 @@ OP_DEFINE_MESH(eCubeOp, eCubeOp_ID, "Cube", 'q', 0, 0, "")
 
 		for(eU32 i = 0; i < 8; i++)
         {
-			m_mesh.getVertex(i)->position.scale(size);
+			m_mesh.getVertex(i)->getPosition().scale(size);
         }
 
         // Set material if specified.
@@ -602,7 +857,7 @@ OP_DEFINE_MESH(eBicubicPatchOp, eBicubicPatchOp_ID, "BicubicPatch", ' ', 0, 0, "
 		}
         m_mesh.updateNormals();
 		for(eU32 i = 0; i < vcnt; i++)
-			m_mesh.getVertex(i)->position.scale(size);
+			m_mesh.getVertex(i)->getPosition().scale(size);
 		m_mesh.updateBoundingBox();
     }
 
@@ -748,8 +1003,8 @@ OP_DEFINE_MESH(eMeshTransformOp, eMeshTransformOp_ID, "Transform", 't', 1, 1, "-
                 {
                     if (tagging)
                     {
-                        vtx->position *= mtxPos;
-                        vtx->normal *= mtxNrm;
+                        vtx->getPosition() *= mtxPos;
+                        vtx->getNormal() *= mtxNrm;
                     }
 
                     break;
@@ -759,8 +1014,8 @@ OP_DEFINE_MESH(eMeshTransformOp, eMeshTransformOp_ID, "Transform", 't', 1, 1, "-
                 {
                     if (vtx->selected && tagging)
                     {
-                        vtx->position *= mtxPos;
-                        vtx->normal *= mtxNrm;
+                        vtx->getPosition() *= mtxPos;
+                        vtx->getNormal() *= mtxNrm;
                     }
 
                     break;
@@ -770,8 +1025,8 @@ OP_DEFINE_MESH(eMeshTransformOp, eMeshTransformOp_ID, "Transform", 't', 1, 1, "-
                 {
                     if (!vtx->selected && tagging)
                     {
-                        vtx->position *= mtxPos;
-                        vtx->normal *= mtxNrm;
+                        vtx->getPosition() *= mtxPos;
+                        vtx->getNormal() *= mtxNrm;
                     }
 
                     break;
@@ -948,14 +1203,14 @@ OP_DEFINE_MESH(eMeshOutlineOp, eMeshOutlineOp_ID, "Outline", ' ', 1, 1, "-1,Mesh
                 do
                 {
                     curEdge->edge->selected = eFALSE;
-                    len[cnt] = (curEdge->origin->position - curEdge->twin->origin->position).length();
+                    len[cnt] = (curEdge->origin->getPosition() - curEdge->twin->origin->getPosition()).length();
 
                     if (len[cnt] != 0)
                     {
-                        pos0[cnt] = curEdge->origin->position;
-                        pos1[cnt] = curEdge->twin->origin->position;
-                        norm0[cnt] = curEdge->origin->normal;
-                        norm1[cnt] = curEdge->twin->origin->normal;
+                        pos0[cnt] = curEdge->origin->getPosition();
+                        pos1[cnt] = curEdge->twin->origin->getPosition();
+                        norm0[cnt] = curEdge->origin->getNormal();
+                        norm1[cnt] = curEdge->twin->origin->getNormal();
                         sumLen += len[cnt];
                         cnt++;
                     }
@@ -1013,8 +1268,10 @@ OP_DEFINE_MESH(eOptionsUvOp, eOptionsUvOp_ID, "Options UV", ' ', 1, 1, "-1,Mesh"
     {
         _copyFirstInputMesh();
 
-        for(eU32 i = 0; i< m_mesh.getVertexCount(); i++)
-            m_mesh.getVertex(i)->_volatile_attribute0 = eNULL;
+        // Vertices shared by multiple faces have to
+        // be transformed only once.
+        eArray<eBool> transformed(m_mesh.getVertexCount());
+        eMemSet(&transformed[0], 0, transformed.size()*sizeof(eBool));
 
         for (eU32 i=0; i<m_mesh.getFaceCount(); i++)
         {
@@ -1033,11 +1290,11 @@ OP_DEFINE_MESH(eOptionsUvOp, eOptionsUvOp_ID, "Options UV", ' ', 1, 1, "-1,Mesh"
 
                     eEditMesh::Vertex *vtx = he->origin;
 
-                    if (vtx->_volatile_attribute0 == eNULL)
+                    if (!transformed[vtx->index])
                     {
-                        vtx->texCoord.scale(scale);
-                        vtx->texCoord += scroll;
-                        vtx->_volatile_attribute0 = (void*)1;
+                        vtx->getTexCoord().scale(scale);
+                        vtx->getTexCoord() += scroll;
+                        transformed[vtx->index] = eTRUE;
                     }
 
                     he = he->next;
@@ -1087,9 +1344,9 @@ OP_DEFINE_MESH(eTorusOp, eTorusOp_ID, "Torus", 'o', 0, 0, "")
                 const eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
                 eASSERT(vtx != eNULL);
 
-                eVector3 v = vtx->position;
+                eVector3 v = vtx->getPosition();
                 v.rotate(eVector3(0.0f, j*eTWOPI/(eF32)segs.y, 0.0f));
-                m_mesh.addVertex(v, eVector2(1.0f-j/(eF32)segs.y, vtx->texCoord.y)); 
+                m_mesh.addVertex(v, eVector2(1.0f-j/(eF32)segs.y, vtx->getTexCoord().y)); 
             }
         }
 
@@ -1108,10 +1365,10 @@ OP_DEFINE_MESH(eTorusOp, eTorusOp_ID, "Torus", 'o', 0, 0, "")
 
                 eVector2 texCoords[4] =
                 {
-                    m_mesh.getVertex(indices[0])->texCoord,
-                    m_mesh.getVertex(indices[1])->texCoord,
-                    m_mesh.getVertex(indices[2])->texCoord,
-                    m_mesh.getVertex(indices[3])->texCoord
+                    m_mesh.getVertex(indices[0])->getTexCoord(),
+                    m_mesh.getVertex(indices[1])->getTexCoord(),
+                    m_mesh.getVertex(indices[2])->getTexCoord(),
+                    m_mesh.getVertex(indices[3])->getTexCoord()
                 };
 
                 // Fix texture coordinates.
@@ -1273,13 +1530,13 @@ OP_DEFINE_MESH(eMeshAttractorOp, eMeshAttractorOp_ID, "Attractor", 'a', 1, 1, "-
             eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
             eASSERT(vtx != NULL);
 
-            const eVector3 dv = pos-vtx->position;
+            const eVector3 dv = pos-vtx->getPosition();
             const eF32 dist = dv.sqrLength();
 
             if (dist <= rr)
             {
                 const eF32 att = 1.0f-ePow(dist/rr, power);
-                vtx->position += dv*att;
+                vtx->getPosition() += dv*att;
             }
         }
 
@@ -1313,9 +1570,9 @@ OP_DEFINE_MESH(eVertexNoiseOp, eVertexNoiseOp_ID, "Vertex noise", 'n', 1, 1, "-1
                 eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
                 eASSERT(vtx != NULL);
 
-                vtx->position.x += amount.x*(eRandomF()-0.5f);
-                vtx->position.y += amount.y*(eRandomF()-0.5f);
-                vtx->position.z += amount.z*(eRandomF()-0.5f);
+                vtx->getPosition().x += amount.x*(eRandomF()-0.5f);
+                vtx->getPosition().y += amount.y*(eRandomF()-0.5f);
+                vtx->getPosition().z += amount.z*(eRandomF()-0.5f);
             }
         }
         else if (mode == 1) // by normal
@@ -1325,9 +1582,9 @@ OP_DEFINE_MESH(eVertexNoiseOp, eVertexNoiseOp_ID, "Vertex noise", 'n', 1, 1, "-1
                 eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
                 eASSERT(vtx != NULL);
 
-                vtx->position.x += vtx->normal.x*(amount.x*(eRandomF()-0.5f));
-                vtx->position.y += vtx->normal.y*(amount.y*(eRandomF()-0.5f));
-                vtx->position.z += vtx->normal.z*(amount.z*(eRandomF()-0.5f));
+                vtx->getPosition().x += vtx->getNormal().x*(amount.x*(eRandomF()-0.5f));
+                vtx->getPosition().y += vtx->getNormal().y*(amount.y*(eRandomF()-0.5f));
+                vtx->getPosition().z += vtx->getNormal().z*(amount.z*(eRandomF()-0.5f));
             }
         }
 
@@ -1391,7 +1648,7 @@ OP_DEFINE_MESH(eSelectCubeOp, eSelectCubeOp_ID, "Select cube", ' ', 1, 1, "-1,Me
                 eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
                 eASSERT(vtx != eNULL);
 
-                if (vtx->position.isInsideCube(cubePlanes))
+                if (vtx->getPosition().isInsideCube(cubePlanes))
                 {
                     selectPrimitive(vtx->selected, mode);
                     vtx->tag = tag;
@@ -1410,8 +1667,8 @@ OP_DEFINE_MESH(eSelectCubeOp, eSelectCubeOp_ID, "Select cube", ' ', 1, 1, "-1,Me
                 eEditMesh::Edge *edge = m_mesh.getEdge(i);
                 eASSERT(edge != eNULL);
 
-                const eVector3 &v0 = edge->he0->origin->position;
-                const eVector3 &v1 = edge->he1->origin->position;
+                const eVector3 &v0 = edge->he0->origin->getPosition();
+                const eVector3 &v1 = edge->he1->origin->getPosition();
 
                 if (v0.isInsideCube(cubePlanes) && v1.isInsideCube(cubePlanes))
                 {
@@ -1445,7 +1702,7 @@ OP_DEFINE_MESH(eSelectCubeOp, eSelectCubeOp_ID, "Select cube", ' ', 1, 1, "-1,Me
 
                 do
                 {
-                    if (!he->origin->position.isInsideCube(cubePlanes))
+                    if (!he->origin->getPosition().isInsideCube(cubePlanes))
                     {
                         selectFace = eFALSE;
                         break;
@@ -1649,11 +1906,11 @@ OP_DEFINE_MESH(eDisplaceOp, eDisplaceOp_ID, "Displace", 'd', 2, 2, "0,Mesh|1,Bit
 
             if (mode == 0) // All directions
             {
-                vtx->position *= displace;
+                vtx->getPosition() *= displace;
             }
             else // Normal direction
             {
-                vtx->position += vtx->normal*displace;
+                vtx->getPosition() += vtx->getNormal()*displace;
             }
         }
 
@@ -1674,7 +1931,7 @@ OP_DEFINE_MESH(eInsideOutOp, eInsideOutOp_ID, "Insideout", 'i', 1, 1, "-1,Mesh")
 
         for (eU32 i=0; i<m_mesh.getVertexCount(); i++)
         {
-            m_mesh.getVertex(i)->position.negate();
+            m_mesh.getVertex(i)->getPosition().negate();
         }
 
         m_mesh.updateBoundingBox();
@@ -1796,218 +2053,27 @@ OP_DEFINE_MESH(eSubdivideOp, eSubdivideOp_ID, "Subdivide", 'u', 1, 1, "-1,Mesh")
 
     OP_EXEC(eGraphicsApiDx9 *gfx, eU32 iterations, eF32 smoothness)
     {
-        _copyFirstInputMesh();
-
-        eEditMesh wm;
-
-        eEditMesh *workMesh = &wm;
-        eEditMesh *realMesh = &m_mesh;
+        const eEditMesh &mesh = ((eIMeshOp *)getInputOperator(0))->getResult().mesh;
 
-        for (eU32 iters = 0; iters <= iterations; iters++)
-        {
-            eASSERT(workMesh->isEmpty());
-            const eU32 newVertexCount = realMesh->getVertexCount() + realMesh->getEdgeCount() + realMesh->getFaceCount();
-            const eU32 newPolyCount = realMesh->getFaceCount() * realMesh->getMaxFaceValence();
-
-            workMesh->clear();
-            workMesh->reserveSpace(newVertexCount, newPolyCount);
-
-            // Add the P vertices, which are inserted into the middle of the faces.
-		    for (eU32 i = 0; i < realMesh->getFaceCount(); i++)
-            {
-                eEditMesh::Face *face = realMesh->getFace(i);
-                eASSERT(face != eNULL);
-
-			    eEditMesh::Vertex *newVtx = workMesh->addVertex(face->getCenter());
-			    face->_volatile_attribute0 = newVtx;
-            }
-
-            // Add the E vertices that are inserted in the middle of the edges.
-		    for (eU32 i = 0; i < realMesh->getEdgeCount(); i++)
-            {
-                eEditMesh::Edge *edge = realMesh->getEdge(i);
-                eASSERT(edge != eNULL);
-
-                // Calculate non-smoothed position.
-                const eEditMesh::Vertex *endVtx0 = edge->he0->origin;
-                const eEditMesh::Vertex *endVtx1 = edge->he1->origin;
-			    const eEditMesh::Vertex *faceVtx0 = (const eEditMesh::Vertex *)edge->he0->face->_volatile_attribute0;
-			    const eEditMesh::Vertex *faceVtx1 = edge->he1->face ? (const eEditMesh::Vertex *)edge->he1->face->_volatile_attribute0 : eNULL;
-            
-			    eEditMesh::Vertex vtx;
-			    vtx.lerp(*endVtx0, *endVtx1, 0.5f);
-
-			    if (!edge->isBoundary())
-                {
-                    eASSERT(edge->he0 == edge->he1->twin);
-
-				    // Sum up the two end vertices of the edge and
-                    // add the data from the center face vertex from
-                    // both adjacent faces.
-				    eEditMesh::Vertex vtx2;
-
-				    vtx2.lerp(*endVtx0, *endVtx0, 0);
-				    vtx2.add(*endVtx1);
-
-				    if (faceVtx1)
-                    {
-					    vtx2.add(*faceVtx0);
-					    vtx2.add(*faceVtx1);
-					    vtx2.mul(0.25f);
-				    }
-                    else
-                    {
-					    vtx2.mul(0.5f);
-				    }
-			
-				    vtx.lerp(vtx,vtx2,smoothness);
-			    };
-
-			    eEditMesh::Vertex* newVtx = workMesh->addVertex(vtx);
-			    edge->_volatile_attribute0 = newVtx;
-            }
-
-            // Add the V vertices (the original vertices of the mesh).
-		    for (eU32 i = 0; i < realMesh->getVertexCount(); i++)
-            {
-                eEditMesh::Vertex *vtx = realMesh->getVertex(i);
-                eASSERT(vtx != eNULL);
-
-			    if(vtx->he == eNULL)
-                {
-				    continue;
-                }
-
-			    eEditMesh::HalfEdge *he = vtx->he;
-			    eEditMesh::Vertex v;
-
-			    v.position = eVector3(0.0f);
-			    v.normal = eVector3(0.0f);
-			    v.texCoord = eVector2(0.0f);
-
-                if (!vtx->isBoundary())
-                {
-                    // Accumulate mid vertices of edges.
-                    eU32 edgeCount = 0;
-
-                    do
-                    {
-					    v.add(*((const eEditMesh::Vertex *)he->edge->_volatile_attribute0));
-
-                        edgeCount++;
-                        he = he->twin->next;
-                    }
-                    while (he != vtx->he);
-
-                    // Accumulate mid vertices of faces.
-                    he = vtx->he;
-
-                    do
-                    {
-                        if(he->face)
-                        {
-						    v.add(*((const eEditMesh::Vertex *)he->face->_volatile_attribute0));
-                        }
-
-                        he = he->twin->next;
-                    }
-                    while (he != vtx->he);
-
-                    // Do affine combination between vertices.
-                    const eF32 ee = 1.0f/((eF32)(edgeCount*edgeCount));
-                    const eF32 nm2dn = (eF32)(edgeCount-2)/(eF32)edgeCount;
-
-				    v.mul(ee);
-
-				    eEditMesh::Vertex v2;
-
-				    v2.lerp(*vtx,*vtx,0);
-				    v2.mul(nm2dn);
-				    v.add(v2);
-                }
-                else
-                {
-				    v.lerp(*vtx,*vtx,0.0f);
-				    v.mul(6.0f);
-
-                    eEditMesh::HalfEdge *he = vtx->he;
-
-                    do
-                    {
-                        if (he->edge->isBoundary())
-                        {
-                            v.add(*((eEditMesh::Vertex *)he->edge->_volatile_attribute0));
-                        }
-
-                        he = he->twin->next;
-                    }
-                    while (he != vtx->he);
-
-				    v.mul(1.0f / 8.0f);
-                }
-
-			    v.lerp(*vtx, v, smoothness);
-                eEditMesh::Vertex *newVtx = workMesh->addVertex(v);
-
-                he = vtx->he;
-                do {
-				    he->_volatile_attribute0 = newVtx;
-                    he = he->twin->next;
-                } while (he != vtx->he);
-
-            }
-
-            // Now add the faces.
-            for (eU32 i=0; i<realMesh->getFaceCount(); i++)
-            {
-                const eEditMesh::Face *face = realMesh->getFace(i);
-                eASSERT(face != eNULL);
-
-                eEditMesh::HalfEdge *he = face->he;
-
-                do
-                {
-                    const eEditMesh::HalfEdge *he0 = he;
-                    const eEditMesh::HalfEdge *he1 = he->next;
-                    const eEditMesh::HalfEdge *he2 = he->next->next;
-                    const eEditMesh::HalfEdge *he3 = he->next->next->next;
-
-                    eEditMesh::Vertex *verts[4] =
-                    {
-					    (eEditMesh::Vertex *)he->_volatile_attribute0,
-					    (eEditMesh::Vertex *)he->edge->_volatile_attribute0,
-					    (eEditMesh::Vertex *)face->_volatile_attribute0,
-					    (eEditMesh::Vertex *)he->prev->edge->_volatile_attribute0
-                    };
-
-                    const eVector2 texCoords[4] =
-                    {
-                        he0->texCoord,
-                        (he0->texCoord+he1->texCoord)*0.5f,
-                        (he0->texCoord+he1->texCoord+he2->texCoord+he3->texCoord)*0.25f,
-                        (he3->texCoord+he0->texCoord)*0.5f
-                    };
-
-                    workMesh->addFace(verts, texCoords, 4)->material = face->material;
-                    he = he->next;
-                }
-                while (he != face->he);
-            }
-            eSwap(workMesh, realMesh);
-            workMesh->clear();
-        }
-
-        // Delete working mesh and copy back result.
-        if (realMesh != &m_mesh)
-        {
-            m_mesh.clear();
-            m_mesh.merge(*realMesh);
-        }
+        // The refined topology is only rebuilt if
+        // the input's topology changed, otherwise
+        // just the vertices are recalculated.
+        m_subdiv.refine(mesh, iterations+1, m_mesh);
+        m_subdiv.evaluate(mesh, smoothness, m_mesh);
 
         // Finally update bounding box and normals.
         m_mesh.updateBoundingBox();
         m_mesh.updateNormals();
     }
+
+private:
+    // The subdivided mesh is kept between the
+    // executions, so don't clear it beforehand.
+    virtual void _preExecute(eGraphicsApiDx9 *gfx)
+    {
+    }
+
+    OP_VAR(eSubdivider m_subdiv);
 OP_END(eSubdivideOp);
 #endif
 
@@ -2294,10 +2360,10 @@ OP_DEFINE_MESH(eExtrudeOp, eExtrudeOp_ID, "Extrude", 'x', 1, 1, "-1,Mesh")
                         // than one time in contour then add it.
                         if (va.exists(vtx) == -1 || count > 1)
                         {
-                            const eVector3 normal = (dir == 0 ? face->normal : vtx->normal);
-                            const eVector3 newPos = vtx->position*trans+normal*trans*length;
+                            const eVector3 normal = (dir == 0 ? face->normal : vtx->getNormal());
+                            const eVector3 newPos = vtx->getPosition()*trans+normal*trans*length;
 
-                            eEditMesh::Vertex *newVtx = m_mesh.addVertex(newPos, vtx->texCoord, vtx->normal);
+                            eEditMesh::Vertex *newVtx = m_mesh.addVertex(newPos, vtx->getTexCoord(), vtx->getNormal());
                             eASSERT(newVtx != eNULL);
 
                             // For vertices existing multiple times a direct
@@ -2597,6 +2663,9 @@ OP_DEFINE_MESH(eText3dOp, eText3dOp_ID, "Text 3D", ' ', 0, 0, "")
     {
         const eF32 scale = size*0.0025f;
 
+        // Glyph outlines come from GDI, which only
+        // exists on Windows. Elsewhere the text is empty.
+#ifdef _WIN32
         HDC memDc = CreateCompatibleDC(NULL);
         eASSERT(memDc != eNULL);
         HDC screenDc = GetDC(NULL);
@@ -2641,25 +2710,26 @@ OP_DEFINE_MESH(eText3dOp, eText3dOp_ID, "Text 3D", ' ', 0, 0, "")
 
             // Add front and back triangles to mesh.
             const eVector3Array &verts = trg.getVertices();
+            const eU32 firstVtx = m_mesh.getVertexCount();
+            const eU32 firstFace = m_mesh.getFaceCount();
 
             for (eU32 i=0; i<verts.size(); i++)
             {
-                eEditMesh::Vertex *vf = m_mesh.addVertex(verts[i]);
+                m_mesh.addVertex(verts[i]);
                 eEditMesh::Vertex *vb = m_mesh.addVertex(verts[i]);
 			    vb->position.z = -vb->position.z;
-			    vf->_volatile_attribute1 = vb;
             }
 
             const eArray<eU32> &indices = trg.getIndices();
 
             for (eU32 i=0; i<indices.size(); i+=3)
             {
-                m_mesh.addTriangle(indices[i]*2, indices[i+1]*2, indices[i+2]*2);
-                m_mesh.addTriangle(indices[i+2]*2+1, indices[i+1]*2+1, indices[i]*2+1);
+                m_mesh.addTriangle(firstVtx+indices[i]*2, firstVtx+indices[i+1]*2, firstVtx+indices[i+2]*2);
+                m_mesh.addTriangle(firstVtx+indices[i+2]*2+1, firstVtx+indices[i+1]*2+1, firstVtx+indices[i]*2+1);
             }
 
             // Add side faces to mesh.
-            for (eU32 i=0; i<m_mesh.getFaceCount(); i++)
+            for (eU32 i=firstFace; i<m_mesh.getFaceCount(); i++)
             {
 			    eEditMesh::Face* face = m_mesh.getFace(i);
                 eEditMesh::HalfEdge *he = face->he;
@@ -2668,10 +2738,13 @@ OP_DEFINE_MESH(eText3dOp, eText3dOp_ID, "Text 3D", ' ', 0, 0, "")
                 {
 				    const eEditMesh::HalfEdge *twin = he->twin;
 
-                    if (twin->isBoundary())
+                    // Counted from the first text vertex, front
+                    // vertices have even indices and each back
+                    // vertex follows its front vertex.
+                    if (twin->isBoundary() && ((twin->origin->index-firstVtx)&1) == 0)
                     {
-                        m_mesh.addQuad((eEditMesh::Vertex*)twin->destination()->_volatile_attribute1, 
-						               (eEditMesh::Vertex*)twin->origin->_volatile_attribute1,
+                        m_mesh.addQuad(m_mesh.getVertex(twin->destination()->index+1),
+						               m_mesh.getVertex(twin->origin->index+1),
 								       twin->origin, 
 								       twin->destination());
 
@@ -2683,17 +2756,18 @@ OP_DEFINE_MESH(eText3dOp, eText3dOp_ID, "Text 3D", ' ', 0, 0, "")
             }
         }
 
-        // Center text mesh.
-	    m_mesh.centerMesh();
-        m_mesh.updateNormals();
-        m_mesh.triangulate();
-	    m_mesh.mapUVs(eEditMesh::CUBE, eVector3::ZAXIS, eVector3::YAXIS, eVector3(), eVector2(5));
-
         // delete the GDI objects
         ReleaseDC(NULL, screenDc);
         DeleteDC(memDc);
         DeleteObject(memBmp);
         DeleteObject(font);
+#endif
+
+        // Center text mesh.
+	    m_mesh.centerMesh();
+        m_mesh.updateNormals();
+        m_mesh.triangulate();
+	    m_mesh.mapUVs(eEditMesh::CUBE, eVector3::ZAXIS, eVector3::YAXIS, eVector3(), eVector2(5));
 
         // Set material if specified.
         if (matOp)
@@ -2739,14 +2813,14 @@ OP_DEFINE_MESH(eWaveOp, eWaveOp_ID, "Wave", 'w', 1, 1, "-1,Mesh")
             eEditMesh::Vertex *vtx = m_mesh.getVertex(i);
             eASSERT(vtx != eNULL);
 
-            const eF32 dist = vtx->position.sqrLength()/sqrRadius;
+            const eF32 dist = vtx->getPosition().sqrLength()/sqrRadius;
             const eF32 sine = eSin(time*speed+dist)*amount;
 
             switch (target)
             {
                 case 0:  // Translate
                 {
-                    vtx->position += eVector3(affectX ? sine : 0.0f, affectY ? sine : 0.0f, affectZ ? sine : 0.0f);
+                    vtx->getPosition() += eVector3(affectX ? sine : 0.0f, affectY ? sine : 0.0f, affectZ ? sine : 0.0f);
                     break;
                 }
 
@@ -2756,7 +2830,7 @@ OP_DEFINE_MESH(eWaveOp, eWaveOp_ID, "Wave", 'w', 1, 1, "-1,Mesh")
                     const eF32 val = eDegToRad(sine);
                     const eVector3 rot(affectX ? val : 0.0f, affectY ? val : 0.0f, affectZ ? val : 0.0f);
 
-                    vtx->position.rotate(rot);
+                    vtx->getPosition().rotate(rot);
                     break;
                 }
 
@@ -2766,7 +2840,7 @@ OP_DEFINE_MESH(eWaveOp, eWaveOp_ID, "Wave", 'w', 1, 1, "-1,Mesh")
                     const eF32 val = sine+(1.0f-amount);
                     const eVector3 scale(affectX ? val : 1.0f, affectY ? val : 1.0f, affectZ ? val : 1.0f);
 
-                    vtx->position.scale(scale);
+                    vtx->getPosition().scale(scale);
                     break;
                 }
             }
@@ -2899,7 +2973,7 @@ OP_DEFINE_MESH(eMeshColorOp, eMeshColorOp_ID, "Color", ' ', 1, 1, "-1,Mesh")
 
         for (eU32 i=0; i<m_mesh.getVertexCount(); i++)
         {
-            m_mesh.getVertex(i)->color = color;
+            m_mesh.getVertex(i)->getColor() = color;
         }
     }
 OP_END(eMeshColorOp);
@@ -2934,13 +3008,13 @@ OP_DEFINE_MESH(eMeshMultiplyOp, eMeshMultiplyOp_ID, "Multiply", ' ', 1, 1, "-1,M
             mtxNrm.invert();
             mtxNrm.transpose();
 
-            for (eU32 j=0; j<em.getVertexCount(); j++)
-            {
-                eEditMesh::Vertex *vtx = em.getVertex(j);
-                eASSERT(vtx != eNULL);
+            eVector3Array &positions = em.getPositions();
+            eVector3Array &normals = em.getNormals();
 
-                vtx->position *= mtxPos;
-                vtx->normal *= mtxNrm;
+            for (eU32 j=0; j<positions.size(); j++)
+            {
+                positions[j] *= mtxPos;
+                normals[j] *= mtxNrm;
             }
 
             m_mesh.merge(em);
@@ -2994,7 +3068,7 @@ OP_DEFINE_MESH(eBendOp, eBendOp_ID, "Bend", 'b', 1, 1, "-1,Mesh")
 
         for (eU32 i=0; i<m_mesh.getVertexCount(); i++)
         {
-            eVector3 pos = m_mesh.getVertex(i)->position-axis0;
+            eVector3 pos = m_mesh.getVertex(i)->getPosition()-axis0;
 		    eVector3 posRelAxis = mtxInv*pos;
 		    eF32 t = posRelAxis.z/axisLen;
 		    eF32 tclamp = eClamp(0.0f, t, 1.0f);
@@ -3011,11 +3085,11 @@ OP_DEFINE_MESH(eBendOp, eBendOp_ID, "Bend", 'b', 1, 1, "-1,Mesh")
 
 		    if (keepAlignment)
             {
-			    m_mesh.getVertex(i)->position = mtx*posRelAxis+bezPos;
+			    m_mesh.getVertex(i)->getPosition() = mtx*posRelAxis+bezPos;
 		    }
             else
             {
-			    m_mesh.getVertex(i)->position = bezMtx*posRelAxis+bezPos;
+			    m_mesh.getVertex(i)->getPosition() = bezMtx*posRelAxis+bezPos;
 		    }
 	    }
     }
@@ -3150,13 +3224,13 @@ OP_DEFINE_MESH(eMeshDuplicateCircularOp, eMeshDuplicateCircularOp_ID, "Dup. circ
             const eU32 curVertexCount = m_mesh.getVertexCount();
             m_mesh.merge(em);
 
-            for (eU32 j=curVertexCount; j<m_mesh.getVertexCount(); j++)
-            {
-                eEditMesh::Vertex *vtx = m_mesh.getVertex(j);
-                eASSERT(vtx != eNULL);
+            eVector3Array &positions = m_mesh.getPositions();
+            eVector3Array &normals = m_mesh.getNormals();
 
-                vtx->position *= mtxPos;
-                vtx->normal *= mtxNrm;
+            for (eU32 j=curVertexCount; j<positions.size(); j++)
+            {
+                positions[j] *= mtxPos;
+                normals[j] *= mtxNrm;
             }
         }
 
@@ -3166,7 +3240,7 @@ OP_DEFINE_MESH(eMeshDuplicateCircularOp, eMeshDuplicateCircularOp_ID, "Dup. circ
 
         for (eU32 i=0; i<oldVertexCount; i++)
         {
-            m_mesh.getVertex(i)->position *= mtx;
+            m_mesh.getVertex(i)->getPosition() *= mtx;
         }
 
         // Update face normals.
@@ -3194,28 +3268,39 @@ OP_DEFINE_MESH(eModel2MeshOp, eModel2MeshOp_ID, "Model2Mesh", ' ', 1, 1, "-1,Mod
         m_mesh.clear();
         const eSceneData& sd = ((eIModelOp*)getInputOperator(0))->getResult().sceneData;
 
-        for(eU32 i = 0; i < sd.getEntryCount(); i++) {
-            const eSceneData::Entry& e = sd.getEntry(i);
-            if((e.renderableList == eNULL) && (e.renderableObject->getType() == eIRenderable::TYPE_MESH)) {
-                const eMesh::Instance& mi = (const eMesh::Instance&)*e.renderableObject;
-                const eMesh& mesh = mi.getMesh();
-                m_mesh.reserveSpace(mesh.getVertexCount(), mesh.getPrimitiveCount());
-                m_mesh.clearAndPreallocate(mesh.getVertexCount(), mesh.getPrimitiveCount(), mesh.getPrimitiveCount() * 6);
-                for(eU32 i = 0; i < mesh.getVertexCount(); i++) {
-                    const eVertex& v = mesh.getVertex(i);
-                    m_mesh.addVertex(v.position, v.texCoord, v.normal);
-                }
-                for(eU32 i = 0; i < mesh.getPrimitiveCount(); i++) {
-                    const eMesh::Primitive& p = mesh.getPrimitive(i);
-                    eEditMesh::Vertex* verts[] = {m_mesh.getVertex(p.indices[0]), 
-                                                  m_mesh.getVertex(p.indices[1]),
-                                                  m_mesh.getVertex(p.indices[2])};
-                    const eVector2 texCoords[] = { verts[0]->texCoord,
-                                                   verts[1]->texCoord,
-                                                   verts[2]->texCoord };
-                    eEditMesh::Face* face = m_mesh.addTriangleFast(verts, texCoords);
-                    face->material = p.material;
-                }
+        // Gather all meshes first, so the edit mesh
+        // is allocated once with its exact size.
+        eSceneData::MeshInstanceArray instances;
+        sd.flattenMeshes(instances);
+
+        eU32 vertexCount = 0, primCount = 0;
+        for(eU32 i = 0; i < instances.size(); i++) {
+            vertexCount += instances[i].mesh->getVertexCount();
+            primCount += instances[i].mesh->getPrimitiveCount();
+        }
+
+        m_mesh.reserveSpace(vertexCount, primCount);
+        m_mesh.clearAndPreallocate(vertexCount, primCount, primCount * 6);
+
+        for(eU32 i = 0; i < instances.size(); i++) {
+            const eSceneData::MeshInstance& inst = instances[i];
+            const eMesh& mesh = *inst.mesh;
+            const eU32 firstVtx = m_mesh.getVertexCount();
+
+            for(eU32 j = 0; j < mesh.getVertexCount(); j++) {
+                const eVertex& v = mesh.getVertex(j);
+                m_mesh.addVertex(eVector3(v.position) * inst.matrix, v.texCoord, eVector3(v.normal) * inst.normalMatrix);
+            }
+            for(eU32 j = 0; j < mesh.getPrimitiveCount(); j++) {
+                const eMesh::Primitive& p = mesh.getPrimitive(j);
+                eEditMesh::Vertex* verts[] = {m_mesh.getVertex(firstVtx + p.indices[0]), 
+                                              m_mesh.getVertex(firstVtx + p.indices[1]),
+                                              m_mesh.getVertex(firstVtx + p.indices[2])};
+                const eVector2 texCoords[] = { verts[0]->getTexCoord(),
+                                               verts[1]->getTexCoord(),
+                                               verts[2]->getTexCoord() };
+                eEditMesh::Face* face = m_mesh.addTriangleFast(verts, texCoords);
+                face->material = p.material;
             }
         }
     }
@@ -48,6 +48,64 @@ private:
         m_mesh.clear();
     }
 
+#ifdef eEDITOR
+private:
+    virtual eBool _canCacheResult() const
+    {
+        return eTRUE;
+    }
+
+    virtual void    _storeResult(eByteArray &data) const;
+    virtual eBool   _loadResult(const eByteArray &data);
+    eBool           _loadMesh(const eByteArray &data);
+
+private:
+    // Increase whenever the stored format changes.
+    static const eU32 STORED_MESH_VERSION = 1;
+
+    struct StoredHeader
+    {
+        eU32                version;
+        eU32                vertexCount;
+        eU32                faceCount;
+        eU32                edgeCount;
+        eU32                cornerCount;
+        eAABB               bbox;
+    };
+
+    struct StoredVertex
+    {
+        eVector3            position;
+        eVector3            normal;
+        eVector2            texCoord;
+        eColor              color;
+        eID                 tag;
+        eBool               selected;
+    };
+
+    struct StoredFace
+    {
+        eVector3            normal;
+        eU32                material;
+        eU32                cornerCount;
+        eID                 tag;
+        eBool               selected;
+    };
+
+    struct StoredCorner
+    {
+        eVector2            texCoord;
+        eU32                vertex;
+        eU32                edge;
+    };
+
+    struct StoredEdge
+    {
+        eID                 tag;
+        eBool               selected;
+    };
+#endif
+
 protected:
     void _copyFirstInputMesh()
     {
@@ -11,7 +11,9 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 #include "../eshared.hpp"
 
@@ -355,7 +357,7 @@ OP_DEFINE(eMaterialOp, eMaterialOp_ID, eIMaterialOp, "Material", Misc, Misc_CID,
             }
         }
 #if defined(HAVE_OP_R2T_R2T) || defined(eEDITOR)
-        else if (op && op->getType() == "Misc : R2T")
+        else if (op && TEST_OP_TYPE(op, "Misc : R2T", eRenderToTextureOp_ID))
         {
             owns = eFALSE;
             return ((eIRenderToTextureOp *)op)->getResult().renderTarget;
@@ -481,17 +483,19 @@ OP_DEFINE(eLoadOp, eLoadOp_ID, eIStructureOp, "Load", Misc, Misc_CID, eColor(170
     {
     }
 
-    virtual const eString & eLoadOp::getUserName() const
+#ifdef eEDITOR
+    virtual const eString & getUserName() const
     {
         const eIOperator *realOp = eDemoData::findOperator(getParameter(0).getValue().linkedOpId);
         return (realOp ? realOp->getUserName() : eIStructureOp::getUserName());
     }
 
-    virtual eBool eLoadOp::checkValidity() const
+    virtual eBool checkValidity() const
     {
         const eIOperator *op = _getRealOp();
         return (op ? op->checkValidity() : eIStructureOp::checkValidity());
     }
+#endif
 
     virtual eIOperator * _getRealOp() const
     {
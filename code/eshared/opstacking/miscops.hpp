@@ -228,7 +228,7 @@ public:
         {
         }
 
-        (void*) & genericDataPtr;
+        void *&                 genericDataPtr;
     };
 
 public:
@@ -338,6 +338,10 @@ OP_DEFINE_MODEL(eParticleSystemOp, eParticleSystemOp_ID, "Particles", 'a', 0, 0,
     {
 	    m_psys.init(gfx);
 
+        // The operator's ID is unique and doesn't
+        // change between runs, so it's used to give
+        // each system its own random sequence.
+        m_psys.m_seed = getId();
 	    m_psys.m_stretchAmount = stretch;
 	    m_psys.m_randomization = randomization;
 	    m_psys.m_emissionFreq = emissionFreq;
@@ -0,0 +1,199 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifdef eEDITOR
+#include <fstream>
+#include <stdio.h>
+#endif
+
+#include "../eshared.hpp"
+
+#ifdef eEDITOR
+
+using namespace std;
+
+eString eOpResultCache::m_dir;
+
+// An empty directory disables the cache.
+void eOpResultCache::setDirectory(const eString &dir)
+{
+    m_dir = dir;
+}
+
+eBool eOpResultCache::isEnabled()
+{
+    return (m_dir.length() > 0);
+}
+
+eBool eOpResultCache::load(eU64 hash, eByteArray &data)
+{
+    if (!isEnabled() || hash == 0)
+    {
+        return eFALSE;
+    }
+
+    ifstream f(_getFileName(hash), ifstream::binary | ifstream::in);
+
+    if (!f.is_open())
+    {
+        return eFALSE;
+    }
+
+    eU32 header[3];
+    f.read((eChar *)header, sizeof(header));
+
+    if (!f.good() || header[0] != FILE_MAGIC || header[1] != FILE_VERSION)
+    {
+        return eFALSE;
+    }
+
+    data.resize(header[2]);
+
+    if (data.size() > 0)
+    {
+        f.read((eChar *)&data[0], data.size());
+    }
+
+    return (eU32)f.gcount() == data.size();
+}
+
+// The result is written to a temporary file first,
+// so that an interrupted write can never leave a
+// truncated cache entry behind.
+void eOpResultCache::store(eU64 hash, const eByteArray &data)
+{
+    if (!isEnabled() || hash == 0)
+    {
+        return;
+    }
+
+    eChar threadId[17];
+    _toHex(eThreadGetCurrentId(), threadId);
+
+    const eString fileName = _getFileName(hash);
+    const eString tempName = fileName+"."+threadId;
+
+    ofstream f(tempName, ofstream::binary | ofstream::out | ofstream::trunc);
+
+    if (!f.is_open())
+    {
+        return;
+    }
+
+    const eU32 header[3] =
+    {
+        FILE_MAGIC,
+        FILE_VERSION,
+        data.size()
+    };
+
+    f.write((const eChar *)header, sizeof(header));
+
+    if (data.size() > 0)
+    {
+        f.write((const eChar *)&data[0], data.size());
+    }
+
+    const eBool ok = f.good();
+    f.close();
+
+    if (!ok || rename(tempName, fileName) != 0)
+    {
+        remove(tempName);
+    }
+}
+
+// 64-bit FNV-1a hash. 32 bits aren't enough, as a
+// collision would silently return a wrong result.
+eU64 eOpResultCache::hashData(eConstPtr data, eU32 size, eU64 hash)
+{
+    eASSERT(data != eNULL || size == 0);
+
+    const eU8 *bytes = (const eU8 *)data;
+
+    for (eU32 i=0; i<size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Appends raw data to a stored result.
+void eOpResultCache::append(eByteArray &data, eConstPtr src, eU32 size)
+{
+    eASSERT(src != eNULL || size == 0);
+
+    // Grow geometrically, because results are
+    // appended element by element.
+    const eU32 pos = data.size();
+
+    if (pos+size > data.capacity())
+    {
+        data.reserve(eMax(data.capacity()*2, pos+size));
+    }
+
+    data.resize(pos+size);
+
+    if (size > 0)
+    {
+        eMemCopy(&data[pos], src, size);
+    }
+}
+
+// Reads raw data from a stored result, starting
+// at the given position, which is advanced. Fails
+// if the stored result is too short.
+eBool eOpResultCache::read(const eByteArray &data, eU32 &pos, ePtr dst, eU32 size)
+{
+    eASSERT(dst != eNULL || size == 0);
+
+    if (pos > data.size() || size > data.size()-pos)
+    {
+        return eFALSE;
+    }
+
+    if (size > 0)
+    {
+        eMemCopy(dst, &data[pos], size);
+    }
+
+    pos += size;
+    return eTRUE;
+}
+
+eString eOpResultCache::_getFileName(eU64 hash)
+{
+    eChar name[17];
+    _toHex(hash, name);
+    return m_dir+name+".opc";
+}
+
+void eOpResultCache::_toHex(eU64 value, eChar *buffer)
+{
+    eASSERT(buffer != eNULL);
+
+    static const eChar HEX_DIGITS[] = "0123456789abcdef";
+
+    for (eInt i=15; i>=0; i--)
+    {
+        buffer[i] = HEX_DIGITS[value&15];
+        value >>= 4;
+    }
+
+    buffer[16] = '\0';
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *       _______   ______________  ______     _____
+ *      / ____/ | / /  _/ ____/  |/  /   |   |__  /
+ *     / __/ /  |/ // // / __/ /|_/ / /| |    /_ <
+ *    / /___/ /|  // // /_/ / /  / / ___ |  ___/ /
+ *   /_____/_/ |_/___/\____/_/  /_/_/  |_| /____/.
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef OP_CACHE_HPP
+#define OP_CACHE_HPP
+
+#ifdef eEDITOR
+
+// Persistent cache for operator results. Each
+// result is stored in its own file, named after
+// the operator's result hash. The hash is built
+// from the operator type, the parameter values
+// and the result hashes of all operators it
+// depends on, so results of unchanged operators
+// survive across editor sessions.
+class eOpResultCache
+{
+public:
+    static void         setDirectory(const eString &dir);
+    static eBool        isEnabled();
+
+    static eBool        load(eU64 hash, eByteArray &data);
+    static void         store(eU64 hash, const eByteArray &data);
+
+    static eU64         hashData(eConstPtr data, eU32 size, eU64 hash=HASH_INIT);
+
+    static void         append(eByteArray &data, eConstPtr src, eU32 size);
+    static eBool        read(const eByteArray &data, eU32 &pos, ePtr dst, eU32 size);
+
+public:
+    static const eU64   HASH_INIT = 14695981039346656037ULL;
+
+    // Results of operators which are executed
+    // faster than this aren't worth storing.
+    static const eU32   MIN_EXEC_TIME_MS = 10;
+
+private:
+    static eString      _getFileName(eU64 hash);
+    static void         _toHex(eU64 value, eChar *buffer);
+
+private:
+    static const eU32   FILE_MAGIC = 0x4370417a;
+    static const eU32   FILE_VERSION = 1;
+
+private:
+    static eString      m_dir;
+};
+
+#endif
+
+#endif // OP_CACHE_HPP
\ No newline at end of file
@@ -14,6 +14,161 @@
 #ifndef OP_MACROS_HPP
 #define OP_MACROS_HPP
 
+// Typed dispatching of execute functions. For each
+// operator class a dispatch function is generated,
+// which casts the arguments collected from the
+// parameters to the argument types of the execute
+// function and calls it. The argument types are
+// deduced from the execute function's signature.
+
+template<class T> struct eOpExecArg
+{
+    static eFORCEINLINE T get(const eIOperator::ExecArg &arg)
+    {
+        return (T)arg.integer;
+    }
+};
+
+template<> struct eOpExecArg<eF32>
+{
+    static eFORCEINLINE eF32 get(const eIOperator::ExecArg &arg)
+    {
+        return arg.flt;
+    }
+};
+
+template<class T> struct eOpExecArg<T *>
+{
+    static eFORCEINLINE T * get(const eIOperator::ExecArg &arg)
+    {
+        return (T *)arg.ptr;
+    }
+};
+
+template<class T> struct eOpExecArg<T &>
+{
+    static eFORCEINLINE T & get(const eIOperator::ExecArg &arg)
+    {
+        return *(T *)arg.ptr;
+    }
+};
+
+// Repeats macro m for 0,...,n-1.
+#define eOP_REPEAT_0(m)
+#define eOP_REPEAT_1(m)  eOP_REPEAT_0(m) m(0)
+#define eOP_REPEAT_2(m)  eOP_REPEAT_1(m) m(1)
+#define eOP_REPEAT_3(m)  eOP_REPEAT_2(m) m(2)
+#define eOP_REPEAT_4(m)  eOP_REPEAT_3(m) m(3)
+#define eOP_REPEAT_5(m)  eOP_REPEAT_4(m) m(4)
+#define eOP_REPEAT_6(m)  eOP_REPEAT_5(m) m(5)
+#define eOP_REPEAT_7(m)  eOP_REPEAT_6(m) m(6)
+#define eOP_REPEAT_8(m)  eOP_REPEAT_7(m) m(7)
+#define eOP_REPEAT_9(m)  eOP_REPEAT_8(m) m(8)
+#define eOP_REPEAT_10(m) eOP_REPEAT_9(m) m(9)
+#define eOP_REPEAT_11(m) eOP_REPEAT_10(m) m(10)
+#define eOP_REPEAT_12(m) eOP_REPEAT_11(m) m(11)
+#define eOP_REPEAT_13(m) eOP_REPEAT_12(m) m(12)
+#define eOP_REPEAT_14(m) eOP_REPEAT_13(m) m(13)
+#define eOP_REPEAT_15(m) eOP_REPEAT_14(m) m(14)
+#define eOP_REPEAT_16(m) eOP_REPEAT_15(m) m(15)
+#define eOP_REPEAT_17(m) eOP_REPEAT_16(m) m(16)
+#define eOP_REPEAT_18(m) eOP_REPEAT_17(m) m(17)
+#define eOP_REPEAT_19(m) eOP_REPEAT_18(m) m(18)
+#define eOP_REPEAT_20(m) eOP_REPEAT_19(m) m(19)
+#define eOP_REPEAT_21(m) eOP_REPEAT_20(m) m(20)
+#define eOP_REPEAT_22(m) eOP_REPEAT_21(m) m(21)
+#define eOP_REPEAT_23(m) eOP_REPEAT_22(m) m(22)
+#define eOP_REPEAT_24(m) eOP_REPEAT_23(m) m(23)
+#define eOP_REPEAT_25(m) eOP_REPEAT_24(m) m(24)
+#define eOP_REPEAT_26(m) eOP_REPEAT_25(m) m(25)
+#define eOP_REPEAT_27(m) eOP_REPEAT_26(m) m(26)
+#define eOP_REPEAT_28(m) eOP_REPEAT_27(m) m(27)
+#define eOP_REPEAT_29(m) eOP_REPEAT_28(m) m(28)
+#define eOP_REPEAT_30(m) eOP_REPEAT_29(m) m(29)
+#define eOP_REPEAT_31(m) eOP_REPEAT_30(m) m(30)
+#define eOP_REPEAT_32(m) eOP_REPEAT_31(m) m(31)
+#define eOP_REPEAT_33(m) eOP_REPEAT_32(m) m(32)
+#define eOP_REPEAT_34(m) eOP_REPEAT_33(m) m(33)
+#define eOP_REPEAT_35(m) eOP_REPEAT_34(m) m(34)
+#define eOP_REPEAT_36(m) eOP_REPEAT_35(m) m(35)
+#define eOP_REPEAT_37(m) eOP_REPEAT_36(m) m(36)
+#define eOP_REPEAT_38(m) eOP_REPEAT_37(m) m(37)
+#define eOP_REPEAT_39(m) eOP_REPEAT_38(m) m(38)
+#define eOP_REPEAT_40(m) eOP_REPEAT_39(m) m(39)
+
+#define eOP_EXEC_TYPENAME(n)    , class A##n
+#define eOP_EXEC_TYPE(n)        , A##n
+#define eOP_EXEC_ARG(n)         , eOpExecArg<A##n>::get(args[n])
+
+#define eOP_EXEC_DISPATCHER(n)                                                                                  \
+    template<class T eOP_REPEAT_##n(eOP_EXEC_TYPENAME)> struct eOpExec##n                                       \
+    {                                                                                                           \
+        template<void (T::*F)(eGraphicsApiDx9 * eOP_REPEAT_##n(eOP_EXEC_TYPE))>                                 \
+        static void call(eIOperator *op, eGraphicsApiDx9 *gfx, const eIOperator::ExecArg *args)                 \
+        {                                                                                                       \
+            (((T *)op)->*F)(gfx eOP_REPEAT_##n(eOP_EXEC_ARG));                                                  \
+        }                                                                                                       \
+                                                                                                                \
+        template<void (T::*F)(eGraphicsApiDx9 * eOP_REPEAT_##n(eOP_EXEC_TYPE))>                                 \
+        static eIOperator::ExecFunc get()                                                                       \
+        {                                                                                                       \
+            return &call<F>;                                                                                    \
+        }                                                                                                       \
+    };                                                                                                          \
+                                                                                                                \
+    template<class T eOP_REPEAT_##n(eOP_EXEC_TYPENAME)>                                                         \
+    eOpExec##n<T eOP_REPEAT_##n(eOP_EXEC_TYPE)> eOpGetExec(void (T::*)(eGraphicsApiDx9 * eOP_REPEAT_##n(eOP_EXEC_TYPE))) \
+    {                                                                                                           \
+        return eOpExec##n<T eOP_REPEAT_##n(eOP_EXEC_TYPE)>();                                                   \
+    }
+
+eOP_EXEC_DISPATCHER(0)
+eOP_EXEC_DISPATCHER(1)
+eOP_EXEC_DISPATCHER(2)
+eOP_EXEC_DISPATCHER(3)
+eOP_EXEC_DISPATCHER(4)
+eOP_EXEC_DISPATCHER(5)
+eOP_EXEC_DISPATCHER(6)
+eOP_EXEC_DISPATCHER(7)
+eOP_EXEC_DISPATCHER(8)
+eOP_EXEC_DISPATCHER(9)
+eOP_EXEC_DISPATCHER(10)
+eOP_EXEC_DISPATCHER(11)
+eOP_EXEC_DISPATCHER(12)
+eOP_EXEC_DISPATCHER(13)
+eOP_EXEC_DISPATCHER(14)
+eOP_EXEC_DISPATCHER(15)
+eOP_EXEC_DISPATCHER(16)
+eOP_EXEC_DISPATCHER(17)
+eOP_EXEC_DISPATCHER(18)
+eOP_EXEC_DISPATCHER(19)
+eOP_EXEC_DISPATCHER(20)
+eOP_EXEC_DISPATCHER(21)
+eOP_EXEC_DISPATCHER(22)
+eOP_EXEC_DISPATCHER(23)
+eOP_EXEC_DISPATCHER(24)
+eOP_EXEC_DISPATCHER(25)
+eOP_EXEC_DISPATCHER(26)
+eOP_EXEC_DISPATCHER(27)
+eOP_EXEC_DISPATCHER(28)
+eOP_EXEC_DISPATCHER(29)
+eOP_EXEC_DISPATCHER(30)
+eOP_EXEC_DISPATCHER(31)
+eOP_EXEC_DISPATCHER(32)
+eOP_EXEC_DISPATCHER(33)
+eOP_EXEC_DISPATCHER(34)
+eOP_EXEC_DISPATCHER(35)
+eOP_EXEC_DISPATCHER(36)
+eOP_EXEC_DISPATCHER(37)
+eOP_EXEC_DISPATCHER(38)
+eOP_EXEC_DISPATCHER(39)
+eOP_EXEC_DISPATCHER(40)
+
+// Returns the dispatch function of the given
+// operator class's execute function.
+#define eOP_EXEC_FUNC(className)                                                                                \
+    eOpGetExec(&className::execute).get<&className::execute>()
+
 #ifdef eEDITOR
 #define OP_DEFINE(className, opID, baseClass, name, category, catID, color, shortcut, minInput, maxInput, allowedInput)      \
     static eIOperator::MetaInfos className##MetaInfos =                                                         \
@@ -52,13 +207,7 @@
         {                                                                                                       \
             m_metaOpID = opID;                                                                                  \
             m_metaCategoryID = catID;                                                                           \
-            ePtr func = eNULL;                                                                                  \
-            __asm                                                                                               \
-            {                                                                                                   \
-                __asm mov eax, dword ptr [className::execute]                                                   \
-                __asm mov dword ptr [func], eax                                                                 \
-            }                                                                                                   \
-            m_metaExecFunc = func;                                                                              \
+            m_metaExecFunc = eOP_EXEC_FUNC(className);                                                          \
             _initialize();                                                                                      \
         }                                                                                                       
 
@@ -93,15 +242,7 @@
         {                                                                                                       \
             RegisterExecFunc()                                                                                  \
             {                                                                                                   \
-                ePtr func = eNULL;                                                                              \
-                                                                                                                \
-                __asm                                                                                           \
-                {                                                                                               \
-                    __asm mov eax, dword ptr [className::execute]                                               \
-                    __asm mov dword ptr [func], eax                                                             \
-                }                                                                                               \
-                                                                                                                \
-                className##MetaInfos.execFunc = func;                                                           \
+                className##MetaInfos.execFunc = eOP_EXEC_FUNC(className);                                       \
                 eOpMetaInfoManager::addMetaInfos(&className##MetaInfos);                                        \
             }                                                                                                   \
         }                                                                                                       \
@@ -140,6 +281,21 @@
     private:                                                                                                    \
         var
 
+// Increase the implementation version of an
+// operator whenever a change alters its output,
+// because the version is part of the key of the
+// editor's result cache.
+#ifdef eEDITOR
+#define OP_IMPL_VERSION(version)                                                                                \
+    private:                                                                                                    \
+        virtual eU32 _getImplVersion() const                                                                    \
+        {                                                                                                       \
+            return version;                                                                                     \
+        }
+#else
+#define OP_IMPL_VERSION(version)
+#endif
+
 
 #ifdef eEDITOR
 
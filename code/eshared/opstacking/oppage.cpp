@@ -140,6 +140,8 @@ void eOperatorPage::clearOperators()
 #ifdef eEDITOR
 void eOperatorPage::updateLinks()
 {
+    eIOperator::setStructureChanged();
+
     static eIOperator *opField[WIDTH][HEIGHT];
     _buildOpField(opField);
 
@@ -296,6 +298,8 @@ void eOperatorPage::updateLinks()
 #else
 void eOperatorPage::updateLinks()
 {
+    eIOperator::setStructureChanged();
+
     for (eU32 i=0; i<m_ops.size(); i++)
     {
         eIOperator *op = m_ops[i];
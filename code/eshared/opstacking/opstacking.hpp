@@ -24,6 +24,7 @@
 #include "opinput.hpp"
 #include "parameter.hpp"
 #include "ioperator.hpp"
+#include "opcache.hpp"
 #include "demoscript.hpp"
 #include "opmacros.hpp"
 #include "bitmapops.hpp"
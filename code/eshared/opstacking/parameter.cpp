@@ -14,7 +14,9 @@
 #include "../eshared.hpp"
 
 #ifdef eDEBUG
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdio.h>
 #endif
 
@@ -670,9 +672,16 @@ void eParameter::setAllowedLinks(const eString &config)
     m_allowedLinks.parseConfig(config);
 }
 
+// Animation changes decide whether the owner is
+// in the animated operator list of its stacks,
+// so the cached stack structure is invalidated.
 void eParameter::setAnimationPathOpId(eID opId)
 {
-    m_animPathOpId = opId;
+    if (opId != m_animPathOpId)
+    {
+        m_animPathOpId = opId;
+        eIOperator::setStructureChanged();
+    }
 }
 
 void eParameter::setAnimatable(eBool animatable)
@@ -683,7 +692,11 @@ void eParameter::setAnimatable(eBool animatable)
 
 void eParameter::setAnimated(eBool animated)
 {
-    m_animated = animated;
+    if (animated != m_animated)
+    {
+        m_animated = animated;
+        eIOperator::setStructureChanged();
+    }
 }
 
 void eParameter::setAnimationChannel(AnimationChannel ac)
@@ -0,0 +1,62 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *
+ *    ------  /   /  /\   /  /---  -----  /  ----  /   /
+ *       /   /   /  /  \ /  /---   -/-   /   \--  /---/   version 3
+ *      /    \---  /    /  /---    /    /  ----/ /   /.
+ *
+ *       t i n y   m u s i c   s y n t h e s i z e r
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "../../eshared.hpp"
+
+tfSoundOutNull::tfSoundOutNull(eU32 latency, eU32 sampleRate) :
+    m_sampleRate(0)
+{
+    initialize(latency, sampleRate);
+}
+
+tfSoundOutNull::~tfSoundOutNull()
+{
+    shutdown();
+}
+
+eBool tfSoundOutNull::initialize(eU32 latency, eU32 sampleRate)
+{
+    m_sampleRate = sampleRate;
+    return eTRUE;
+}
+
+void tfSoundOutNull::shutdown()
+{
+}
+
+void tfSoundOutNull::play()
+{
+}
+
+void tfSoundOutNull::stop()
+{
+}
+
+void tfSoundOutNull::clear()
+{
+}
+
+void tfSoundOutNull::fill(const eU8 *data, eU32 count)
+{
+}
+
+eBool tfSoundOutNull::isFilled() const
+{
+    return eTRUE;
+}
+
+eU32 tfSoundOutNull::getSampleRate() const
+{
+    return m_sampleRate;
+}
@@ -0,0 +1,43 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *
+ *    ------  /   /  /\   /  /---  -----  /  ----  /   /
+ *       /   /   /  /  \ /  /---   -/-   /   \--  /---/   version 3
+ *      /    \---  /    /  /---    /    /  ----/ /   /.
+ *
+ *       t i n y   m u s i c   s y n t h e s i z e r
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TF_SOUND_OUT_NULL_HPP
+#define TF_SOUND_OUT_NULL_HPP
+
+// Sound output which discards all samples. It's
+// used where no sound device is available (e.g.
+// the headless tools). As it always reports its
+// buffer as filled, a playing song isn't rendered.
+class tfSoundOutNull : public tfISoundOut
+{
+public:
+    tfSoundOutNull(eU32 latency, eU32 sampleRate);
+    virtual ~tfSoundOutNull();
+
+    virtual eBool           initialize(eU32 latency, eU32 sampleRate);
+    virtual void            shutdown();
+
+    virtual void            play();
+    virtual void            stop();
+    virtual void            clear();
+    virtual void            fill(const eU8 *data, eU32 count);
+
+    virtual eBool           isFilled() const;
+    virtual eU32            getSampleRate() const;
+
+private:
+    eU32                    m_sampleRate;
+};
+
+#endif // TF_SOUND_OUT_NULL_HPP
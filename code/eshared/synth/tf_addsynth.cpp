@@ -18,39 +18,9 @@
 
 #ifndef NO_ADDSYNTH
 
-static eU32 g_noiseCounter = 0;
-static eF32 *g_rnd = eNULL;
-    
-static void genRand()
-{
-    if (g_rnd == eNULL)
-    {
-        g_rnd = new eF32[2048*32];
-        eASSERT(g_rnd != eNULL);
-        
-		eU32 seed = eRandomSeed();
-        for (eU32 i=0; i<2048*32; i++)
-        {
-            g_rnd[i] = eRandomF(0.0f, eTWOPI, seed);
-        }
-    }
-}
-
-eFORCEINLINE static eF32 noise()
-{
-    eF32 n = g_rnd[g_noiseCounter++];
-
-    if (g_noiseCounter >= 2048*32)
-    {
-        g_noiseCounter = 0;
-    }
-    
-    return n;
-}
-
 void tfAddSynth::State::reset()
 {
-	eU32 seed = eRandomSeed();
+	eU32 seed = tfRandomSeed();
 	phase1 = eRandomF(seed);
 	phase2 = eRandomF(seed);
 	freq1 = 0.0f;
@@ -58,41 +28,45 @@ void tfAddSynth::State::reset()
 }
 
 tfAddSynth::tfAddSynth() :
-    m_padSynthTable(eNULL),
-    m_padSynthTableTemp(eNULL),
-    m_bandwidth(-1.0f),
-    m_damp(-1.0f),
-    m_numHarmonics(-1.0f),
-    m_bwScale(-1.0f),
-    m_profile(0),
-    m_sampleRate(0),
-    m_padRefresh(eFALSE)
+    m_table(eNULL)
 {
+    // Created on the main thread, so the table
+    // builder is running before rendering starts.
+    tfPadSynthCache::get().start();
 }
 
 tfAddSynth::~tfAddSynth()
 {
-    eSAFE_DELETE_ARRAY(m_padSynthTable);
-    eSAFE_DELETE_ARRAY(m_padSynthTableTemp);
+    tfPadSynthCache::get().release(m_table);
 }
 
-void tfAddSynth::update(eF32 *params, eU32 sampleRate)
+// While a new table is built in the background,
+// the current table keeps playing. The audio
+// thread mustn't wait for the cache's lock.
+void tfAddSynth::update(eF32 *params, eU32 sampleRate, eBool wait)
 {
     eF32 volume = params[TF_ADD_VOLUME];
 
     if (volume > 0.0f)
     {
-        eF32 bandwidth = params[TF_ADD_BANDWIDTH];
-        eF32 damp = params[TF_ADD_DAMP];
-        eF32 scale = params[TF_ADD_SCALE];
-        eF32 harmonics = params[TF_ADD_HARMONICS];
-        eU32 profile = eFtoL(eRound(params[TF_ADD_PROFILE] * 3.0f));
+        tfPadSynthCache::Key key;
+
+        key.bandwidth = params[TF_ADD_BANDWIDTH];
+        key.damp = params[TF_ADD_DAMP];
+        key.harmonics = params[TF_ADD_HARMONICS]/4.0f;
+        key.bwScale = params[TF_ADD_SCALE]*params[TF_ADD_SCALE];
+        key.profile = eFtoL(eRound(params[TF_ADD_PROFILE] * 3.0f));
+        key.sampleRate = sampleRate;
 
-        harmonics /= 4.0f;
-        scale *= scale;
+        if (!m_table || !eMemEqual(&m_table->key, &key, sizeof(key)))
+        {
+            const tfPadSynthCache::Table *table = tfPadSynthCache::get().acquire(key, m_table, wait);
 
-        gen(bandwidth, scale, damp, harmonics, profile, sampleRate);
-        check();
+            if (table)
+            {
+                m_table = table;
+            }
+        }
     }
 }
 
@@ -108,7 +82,7 @@ eBool tfAddSynth::process(State *state,
 {
     eF32 vol = params[TF_ADD_VOLUME];
 
-    if (vol > 0.0f)
+    if (vol > 0.0f && m_table)
     {
         eF32 freq       = params[TF_OSC_FREQ];
         eF32 drive      = params[TF_ADD_DRIVE];
@@ -175,8 +149,8 @@ eBool tfAddSynth::process(State *state,
             eU32 off1 = eFtoL(state->phase1 * offset_f);
             eU32 off2 = eFtoL(state->phase2 * offset_f);
 
-			eF32 val1 = m_padSynthTable[off1];
-			eF32 val2 = m_padSynthTable[off2];
+			eF32 val1 = m_table->samples[off1];
+			eF32 val2 = m_table->samples[off2];
 
 			eF32x2 mval = eSIMDMul(
 							eSIMDMax(
@@ -207,262 +181,4 @@ eBool tfAddSynth::process(State *state,
     return eFALSE;
 }
 
-eF32 tfAddSynth::profileGauss(eF32 fi, eF32 bwi)
-{
-    eF32 x=fi/bwi;
-    x*=x;
-    //this avoids computing the e^(-x^2) where it's results are very close to zero
-    if (x>14.71280603) return 0.0;
-    return eExp(-x)/bwi;
-}
-
-eF32 tfAddSynth::profileSingle(eF32 fi, eF32 bwi)
-{
-    eF32 x=fi/bwi;
-    if (x>0.1f || x < -0.1f) return 0.0f;
-    return 1.0f/bwi;
-}
-
-eF32 tfAddSynth::profileDetune(eF32 fi, eF32 bwi)
-{
-    eF32 x=fi/bwi;
-    if (x<-0.5f || (x > -0.4f && x < 0.4f) || x > 0.5f) return 0.0f;
-    return 1.0f/bwi;
-}
-
-eF32 tfAddSynth::profileSpread(eF32 fi, eF32 bwi)
-{
-    eF32 x=fi/bwi;
-    if (x>5.0f || x < -5.0f) return 0.0f;
-    return 1.0f/bwi;
-}
-
-eINLINE void tfAddSynth::normalize(eInt N, eF32 *smp)
-{
-    eF32 max=0.0;
-    for (eInt i=0;i<N/2;i++) 
-    {
-        eF32 abs_smp = eAbs(smp[i]);
-
-        if (abs_smp > max) 
-            max=abs_smp;
-    }
-    if (max<1e-5f) max=1e-5f;
-        
-    max = 1.0f/(max*1.4142f);
-    for (eInt i=0;i<N;i++) 
-    {
-        smp[i]*=max;
-    }
-}
-
-void tfAddSynth::extendedAlgorithm(eInt N, eInt profile, eInt sampleRate, eF32 f, eF32 bw, eF32 bwscale, eInt number_harmonics, eF32 *A, eF32 *smp)
-{
-    eInt i,nh;
-    eInt NH=N>>1;
-    eF32 *freq_amp     = new eF32[NH];
-    eF32 *freq_phase   = new eF32[NH];
-    eMemSet(freq_amp,0,sizeof(eF32)*NH);
-    //eF32 recdsr = 1.0f/(2.0f*sampleRate);
-    eF32 recsr = 1.0f/sampleRate;
-    eF32 recdsr = recsr/2.0f;
-    eF32 Nrec = 1.0f/(eF32)N;
-    eF32 precalcbw = (ePow(2.0f,bw / 1200.0f)-1.0f)*f;
-    bwscale *= 19.0f;
-    bwscale += 1.0f;
-
-    eF32 (*profile_func)(eF32 fi, eF32 bwi);
-
-    switch (profile)
-    {
-    default:
-    case 0: profile_func = profileSingle; break;
-    case 1: profile_func = profileDetune; break;
-    case 2: profile_func = profileSpread; break;
-    case 3: profile_func = profileGauss; break;
-    } 
-
-    for (nh=1;nh<number_harmonics;nh++)
-    {
-        eF32 bw_Hz; //bandwidth of the current harmonic measured in Hz
-        eF32 bwi;
-        eF32 fi;
-
-        //bw_Hz=precalcbw*nh;
-        bw_Hz = precalcbw*ePow((eF32)nh, bwscale);
-
-        bwi = bw_Hz *recdsr;
-        fi  = f * nh * recsr;
-        //fi  = f * nh * recsr;
-
-        for (i=0;i<NH;i++)
-        {
-            eF32 hprofile;
-
-            hprofile = profile_func((i*Nrec)-fi,bwi);
-            freq_amp[i] += hprofile*A[nh];
-        }
-    }
-
-    //Add random phases
-    for (i=0;i<NH;i++)
-    {
-        freq_phase[i] = noise();
-    }
-
-    ifft(N,freq_amp,freq_phase,smp);
-    normalize(N,smp);
-
-    eSAFE_DELETE_ARRAY(freq_amp);
-    eSAFE_DELETE_ARRAY(freq_phase);
-}
-
-void tfAddSynth::ifft(eInt N, eF32 *freq_amp, eF32 *freq_phase, eF32 *smp)
-{
-    eF32 *freqs = new eF32[N];
-    eInt NH = N>>1;
-
-    for (eInt i=0;i<NH;i++)
-    {
-        freqs[i*2]   = freq_amp[i] * eCos(freq_phase[i]);
-        freqs[i*2+1] = freq_amp[i] * eSin(freq_phase[i]);
-    }
-
-    fft(freqs, NH, 1);
-
-    for (eInt j=0;j<NH;j++)
-        smp[j] = freqs[j*2];
-}
-
-void tfAddSynth::fft(eF32 *fftBuffer, eInt fftFrameSize, eInt sign)
-{
-    eF32 wr, wi, arg, *p1, *p2, temp;
-    eF32 tr, ti, ur, ui, *p1r, *p1i, *p2r, *p2i;
-    long i, bitm, j, le, le2, k;
-
-    for (i = 2; i < 2*fftFrameSize-2; i += 2) 
-    {
-        for (bitm = 2, j = 0; bitm < 2*fftFrameSize; bitm <<= 1) 
-        {
-            if (i & bitm) j++;
-            j <<= 1;
-        }
-
-        if (i < j) 
-        {
-            p1 = fftBuffer+i; p2 = fftBuffer+j;
-            temp = *p1; *(p1++) = *p2;
-            *(p2++) = temp; temp = *p1;
-            *p1 = *p2; *p2 = temp;
-        }
-    }
-    for (k = 0, le = 2; k < eFtoL(eLog((eF32)fftFrameSize)/eLog(2.0f)); k++) 
-    {
-        le <<= 1;
-        le2 = le>>1;
-        ur = 1.0;
-        ui = 0.0;
-        arg = ePI / (le2>>1);
-        wr = (eF32)eCos(arg);
-        wi = (eF32)(sign*eSin(arg));
-
-        for (j = 0; j < le2; j += 2) 
-        {
-            p1r = fftBuffer+j; p1i = p1r+1;
-            p2r = p1r+le2; p2i = p2r+1;
-
-            for (i = j; i < 2*fftFrameSize; i += le) 
-            {
-                tr = *p2r * ur - *p2i * ui;
-                ti = *p2r * ui + *p2i * ur;
-                *p2r = *p1r - tr; *p2i = *p1i - ti;
-                *p1r += tr; *p1i += ti;
-                p1r += le; p1i += le;
-                p2r += le; p2i += le;
-            }
-
-            tr = ur*wr - ui*wi;
-            ui = ur*wi + ui*wr;
-            ur = tr;
-        }
-    }
-}
-
-void tfAddSynth::gen(eF32 bandwidth, eF32 bwscale, eF32 damp, eF32 numharmonics, eInt profile, eInt sampleRate)
-{
-    if (!m_padSynthTable || 
-        m_bandwidth != bandwidth || 
-        m_damp != damp ||
-        m_numHarmonics != numharmonics ||
-        m_bwScale != bwscale ||
-        m_profile != profile ||
-        m_sampleRate != m_sampleRate)
-    {
-        m_bandwidth = bandwidth;
-        m_damp = damp;
-        m_numHarmonics = numharmonics;
-        m_bwScale = bwscale;
-        m_profile = profile;
-        m_sampleRate = sampleRate;
-
-        if (!m_padSynthTable)
-        {
-            m_padSynthTable = new eF32[TF_ADDSYNTHTABLESIZE];
-            eMemSet(m_padSynthTable, 0, sizeof(eF32) * TF_ADDSYNTHTABLESIZE);
-        }
-
-        m_padRefresh = true;
-    }
-}
-
-void tfAddSynth::check()
-{
-    if (m_padRefresh)
-    {
-        m_padRefresh = false;
-
-        if (!m_padSynthTableTemp)
-            m_padSynthTableTemp = new eF32[TF_ADDSYNTHTABLESIZE];
-
-        eF32 basefreq = tfInstrument::m_freqTable[29];
-        eInt max_harmonics = eFtoL(m_sampleRate/basefreq);
-
-        eInt number_harmonics = eFtoL(m_numHarmonics*255);
-        number_harmonics = 16 + eMin(number_harmonics, max_harmonics);
-
-        eF32 bw = m_bandwidth * 256;
-
-        eF32 *A = new eF32[number_harmonics];
-
-        A[0]=0.0;
-
-        for (eInt i=1;i<number_harmonics;i+=2) 
-        {
-            eF32 div = 1.0f + i * (1.0f-m_damp);
-
-            A[i]=1.0f/div;
-        }
-        for (eInt i=2;i<number_harmonics;i+=2) 
-        {
-            eF32 div = 1.0f + i * (1.0f-m_damp);
-            A[i]=2.0f/div;
-        }
-
-        genRand();
-        extendedAlgorithm(TF_ADDSYNTHTABLESIZE,
-                        m_profile,
-                        m_sampleRate,
-                        basefreq,
-                        bw,
-                        m_bwScale,
-                        number_harmonics,
-                        A,
-                        m_padSynthTableTemp);
-
-        eSAFE_DELETE_ARRAY(A);
-
-        eMemCopy(m_padSynthTable, m_padSynthTableTemp, sizeof(eF32) * TF_ADDSYNTHTABLESIZE);
-    }
-}
-
 #endif
\ No newline at end of file
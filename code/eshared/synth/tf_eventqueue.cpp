@@ -0,0 +1,246 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *
+ *    ------  /   /  /\   /  /---  -----  /  ----  /   /
+ *       /   /   /  /  \ /  /---   -/-   /   \--  /---/   version 3
+ *      /    \---  /    /  /---    /    /  ----/ /   /.
+ *
+ *       t i n y   m u s i c   s y n t h e s i z e r
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../system/system.hpp"
+#include "../math/math.hpp"
+#include "tunefish3.hpp"
+
+tfEventQueue::tfEventQueue() :
+    m_enqueuePos(0),
+    m_dequeuePos(0),
+    m_lost(0),
+    m_pushed(0),
+    m_dropped(0),
+    m_escalated(0),
+    m_maxDepth(0),
+    m_avgLatency(0.0f),
+    m_maxLatency(0)
+{
+    eASSERT(eIsPowerOf2(CAPACITY));
+    eASSERT(RESERVED < CAPACITY);
+
+    for (eU32 i=0; i<CAPACITY; i++)
+    {
+        m_cells[i].sequence = i;
+    }
+}
+
+// Can be called from any thread. Returns eFALSE
+// if the event was dropped, because the queue
+// is full. Silencing events are never dropped.
+eBool tfEventQueue::push(const Event &ev)
+{
+    const eBool silencing = _isSilencing(ev);
+    const eBool reserved = _isReserved(ev);
+    eInt pos = m_enqueuePos;
+
+    while (eTRUE)
+    {
+        Cell &cell = m_cells[pos&(CAPACITY-1)];
+        const eInt diff = (eInt)((eU32)cell.sequence-(eU32)pos);
+
+        if (diff == 0)
+        {
+            // Other events may not use the reserved
+            // cells. The depth can be too large, if
+            // the audio thread is just freeing cells,
+            // but never too small.
+            if (!reserved && (eU32)pos-(eU32)m_dequeuePos >= CAPACITY-RESERVED)
+            {
+                eAtomicInc(m_dropped);
+                return eFALSE;
+            }
+
+            // The cell is free, try to claim it.
+            const eInt prevPos = eAtomicCompareExchange(m_enqueuePos, (eInt)((eU32)pos+1), pos);
+
+            if (prevPos == pos)
+            {
+                cell.event = ev;
+                cell.event.timeStamp = eTimer::getTickCount();
+
+                // Publishes the event to the audio
+                // thread (acts as memory barrier).
+                eAtomicInc(cell.sequence);
+                eAtomicInc(m_pushed);
+                return eTRUE;
+            }
+
+            pos = prevPos;
+        }
+        else if (diff < 0)
+        {
+            // The cell still holds an event of the
+            // previous round, so the queue is full.
+            if (silencing)
+            {
+                _setLost(ev);
+                eAtomicInc(m_escalated);
+                return eTRUE;
+            }
+
+            eAtomicInc(m_dropped);
+            return eFALSE;
+        }
+        else
+        {
+            // Another producer claimed the cell.
+            pos = m_enqueuePos;
+        }
+    }
+}
+
+// May only be called from the audio thread.
+eBool tfEventQueue::pop(Event &ev)
+{
+    Cell &cell = m_cells[m_dequeuePos&(CAPACITY-1)];
+
+    // The atomic read orders the sequence before
+    // reading the event.
+    if (eAtomicAdd(cell.sequence, 0) != (eInt)((eU32)m_dequeuePos+1))
+    {
+        return _popLost(ev);
+    }
+
+    ev = cell.event;
+
+    const eU32 depth = (eU32)m_enqueuePos-(eU32)m_dequeuePos;
+    const eU64 latency = eTimer::getTickCount()-ev.timeStamp;
+
+    m_maxDepth = eMax(m_maxDepth, depth);
+    m_maxLatency = eMax(m_maxLatency, latency);
+    m_avgLatency = (m_avgLatency == 0.0f ? (eF32)latency : eLerp(m_avgLatency, (eF32)latency, 0.05f));
+
+    // Frees the cell for the next round. The
+    // position is advanced atomically, as
+    // producers read it to get the depth.
+    eAtomicAdd(cell.sequence, CAPACITY-1);
+    eAtomicInc(m_dequeuePos);
+    return eTRUE;
+}
+
+tfEventQueue::Stats tfEventQueue::getStats() const
+{
+    const eF32 ticksToMs = 1000.0f/(eF32)eTimer::getFrequency();
+
+    Stats stats;
+
+    stats.pushed = m_pushed;
+    stats.dropped = m_dropped;
+    stats.escalated = m_escalated;
+    stats.maxDepth = m_maxDepth;
+    stats.avgLatencyMs = m_avgLatency*ticksToMs;
+    stats.maxLatencyMs = (eF32)m_maxLatency*ticksToMs;
+
+    return stats;
+}
+
+// Events which silence notes may use the reserved
+// cells. Notes are switched off by a velocity of 0.
+eBool tfEventQueue::_isSilencing(const Event &ev)
+{
+    switch (ev.type)
+    {
+    case EVENT_NOTE:
+        return (ev.velocity == 0);
+
+    case EVENT_ALL_NOTES_OFF:
+    case EVENT_PANIC:
+    case EVENT_STOP:
+        return eTRUE;
+    }
+
+    return eFALSE;
+}
+
+eBool tfEventQueue::_isReserved(const Event &ev)
+{
+    return (_isSilencing(ev) || ev.type == EVENT_INSTRUMENT);
+}
+
+void tfEventQueue::_setLost(const Event &ev)
+{
+    eInt flag = LOST_ALL_NOTES_OFF;
+
+    if (ev.type == EVENT_PANIC)
+    {
+        flag = LOST_PANIC;
+    }
+    else if (ev.type == EVENT_STOP)
+    {
+        flag = LOST_STOP;
+    }
+
+    eInt lost = m_lost;
+
+    while (eTRUE)
+    {
+        const eInt prevLost = eAtomicCompareExchange(m_lost, lost|flag, lost);
+
+        if (prevLost == lost)
+        {
+            return;
+        }
+
+        lost = prevLost;
+    }
+}
+
+// Returns the remembered silencing events, once
+// all queued events were drained.
+eBool tfEventQueue::_popLost(Event &ev)
+{
+    eInt lost = m_lost;
+
+    while (lost != 0)
+    {
+        // Panic silences most, followed by stop.
+        eInt flag = LOST_ALL_NOTES_OFF;
+
+        if (lost&LOST_PANIC)
+        {
+            flag = LOST_PANIC;
+        }
+        else if (lost&LOST_STOP)
+        {
+            flag = LOST_STOP;
+        }
+
+        const eInt prevLost = eAtomicCompareExchange(m_lost, lost&~flag, lost);
+
+        if (prevLost == lost)
+        {
+            eMemSet(&ev, 0, sizeof(ev));
+            ev.timeStamp = eTimer::getTickCount();
+
+            if (flag == LOST_PANIC)
+            {
+                ev.type = EVENT_PANIC;
+            }
+            else if (flag == LOST_STOP)
+            {
+                ev.type = EVENT_STOP;
+            }
+            else
+            {
+                ev.type = EVENT_ALL_NOTES_OFF;
+            }
+
+            return eTRUE;
+        }
+
+        lost = prevLost;
+    }
+
+    return eFALSE;
+}
@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *
+ *    ------  /   /  /\   /  /---  -----  /  ----  /   /
+ *       /   /   /  /  \ /  /---   -/-   /   \--  /---/   version 3
+ *      /    \---  /    /  /---    /    /  ----/ /   /.
+ *
+ *       t i n y   m u s i c   s y n t h e s i z e r
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef TF_EVENT_QUEUE_HPP
+#define TF_EVENT_QUEUE_HPP
+
+// Bounded queue passing note, parameter and
+// transport events from any number of threads
+// (GUI, MIDI, VST host) to the audio thread
+// without locks. Producers claim cells with a
+// compare-and-swap and never wait for the audio
+// thread, which drains the queue at the start of
+// each block.
+// The last cells are reserved for events which
+// silence notes or exchange instruments. Other
+// events are dropped and counted, once only the
+// reserved cells are left. If even those are used up, a silencing
+// event is remembered in a flag instead and
+// returned after the queued events, a lost note
+// off becoming an all notes off. So a full queue
+// never leaves notes hanging.
+class tfEventQueue
+{
+public:
+    enum EventType
+    {
+        EVENT_NOTE,
+        EVENT_PARAM,
+        EVENT_INSTRUMENT,
+        EVENT_ALL_NOTES_OFF,
+        EVENT_PANIC,
+        EVENT_PLAY,
+        EVENT_STOP,
+        EVENT_SET_TIME
+    };
+
+    struct Event
+    {
+        eU32                type;
+        eU32                instrument;
+        eU32                index;      // Note, parameter or serial.
+        eU32                velocity;
+        eU32                modSlot;
+        eF32                value;      // Modulation, parameter value or time.
+        eU64                timeStamp;  // Tick count when pushed.
+    };
+
+    // Latencies are the times between pushing and
+    // draining events. The depth is the number of
+    // events which were queued when one was drained.
+    // Escalated are the silencing events which were
+    // kept in a flag, because the queue was full.
+    struct Stats
+    {
+        eU32                pushed;
+        eU32                dropped;
+        eU32                escalated;
+        eU32                maxDepth;
+        eF32                avgLatencyMs;
+        eF32                maxLatencyMs;
+    };
+
+public:
+    tfEventQueue();
+
+    eBool                   push(const Event &ev);
+    eBool                   pop(Event &ev);
+
+    Stats                   getStats() const;
+
+private:
+    static eBool            _isSilencing(const Event &ev);
+    static eBool            _isReserved(const Event &ev);
+    void                    _setLost(const Event &ev);
+    eBool                   _popLost(Event &ev);
+
+private:
+    static const eU32       CAPACITY = 1024;
+    static const eU32       RESERVED = 256;
+
+private:
+    enum LostFlags
+    {
+        LOST_ALL_NOTES_OFF  = 1,
+        LOST_STOP           = 2,
+        LOST_PANIC          = 4
+    };
+
+private:
+    // A cell's sequence equals the position of
+    // the next event to be pushed into it and
+    // is one larger when the event is readable.
+    struct Cell
+    {
+        volatile eInt       sequence;
+        Event               event;
+    };
+
+private:
+    Cell                    m_cells[CAPACITY];
+    volatile eInt           m_enqueuePos;
+    volatile eInt           m_dequeuePos;
+    volatile eInt           m_lost;
+
+    volatile eInt           m_pushed;
+    volatile eInt           m_dropped;
+    volatile eInt           m_escalated;
+    eU32                    m_maxDepth;
+    eF32                    m_avgLatency;
+    eU64                    m_maxLatency;
+};
+
+#endif // TF_EVENT_QUEUE_HPP
@@ -344,4 +344,287 @@ void tfFilter::process(tfFilter::State *state, eSignal **signal, eU32 len)
     }
 }
 
+#ifdef eUSE_SSE
+
+// Voice interleaved filter kernels. One register
+// holds left and right channel of two voices, a
+// kernel runs REGS registers side by side, which
+// hides the latency of the filter recursion. The
+// operations are the same as in process(), so
+// each lane gives bit-identical results.
+template<eU32 R> struct tfMoogLanes
+{
+    static const eU32 REGS = R;
+
+    void load(tfFilter::State **states)
+    {
+        for (eU32 q=0; q<R; q++)
+        {
+            const tfFilter::State &s0 = *states[q*2+0];
+            const tfFilter::State &s1 = *states[q*2+1];
+
+            p[q] = _mm_setr_ps(s0.p, s0.p, s1.p, s1.p);
+            r[q] = _mm_setr_ps(s0.r, s0.r, s1.r, s1.r);
+            k[q] = _mm_setr_ps(s0.k, s0.k, s1.k, s1.k);
+            y1[q] = _mm_setr_ps(s0.y1_l, s0.y1_r, s1.y1_l, s1.y1_r);
+            y2[q] = _mm_setr_ps(s0.y2_l, s0.y2_r, s1.y2_l, s1.y2_r);
+            y3[q] = _mm_setr_ps(s0.y3_l, s0.y3_r, s1.y3_l, s1.y3_r);
+            y4[q] = _mm_setr_ps(s0.y4_l, s0.y4_r, s1.y4_l, s1.y4_r);
+            oldX[q] = _mm_setr_ps(s0.oldx_l, s0.oldx_r, s1.oldx_l, s1.oldx_r);
+            oldY1[q] = _mm_setr_ps(s0.oldy1_l, s0.oldy1_r, s1.oldy1_l, s1.oldy1_r);
+            oldY2[q] = _mm_setr_ps(s0.oldy2_l, s0.oldy2_r, s1.oldy2_l, s1.oldy2_r);
+            oldY3[q] = _mm_setr_ps(s0.oldy3_l, s0.oldy3_r, s1.oldy3_l, s1.oldy3_r);
+            x[q] = oldX[q];
+        }
+
+        const6 = _mm_set1_ps(1.0f/6.0f);
+    }
+
+    eFORCEINLINE __m128 step(eU32 q, __m128 in)
+    {
+        x[q] = _mm_sub_ps(in, _mm_mul_ps(r[q], y4[q]));
+        y1[q] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(oldX[q], p[q]), _mm_mul_ps(x[q], p[q])), _mm_mul_ps(k[q], y1[q]));
+        y2[q] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(oldY1[q], p[q]), _mm_mul_ps(y1[q], p[q])), _mm_mul_ps(k[q], y2[q]));
+        y3[q] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(oldY2[q], p[q]), _mm_mul_ps(y2[q], p[q])), _mm_mul_ps(k[q], y3[q]));
+        y4[q] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(oldY3[q], p[q]), _mm_mul_ps(y3[q], p[q])), _mm_mul_ps(k[q], y4[q]));
+
+        const __m128 out = _mm_sub_ps(y4[q], _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(y4[q], y4[q]), y4[q]), const6));
+
+        oldX[q] = x[q];
+        oldY1[q] = y1[q];
+        oldY2[q] = y2[q];
+        oldY3[q] = y3[q];
+        return out;
+    }
+
+    void store(tfFilter::State **states) const
+    {
+        for (eU32 q=0; q<R; q++)
+        {
+            eF32A ox[4], oy1[4], oy2[4], oy3[4], oy4[4];
+
+            _mm_store_ps(ox, x[q]);
+            _mm_store_ps(oy1, y1[q]);
+            _mm_store_ps(oy2, y2[q]);
+            _mm_store_ps(oy3, y3[q]);
+            _mm_store_ps(oy4, y4[q]);
+
+            for (eU32 v=0; v<2; v++)
+            {
+                tfFilter::State &s = *states[q*2+v];
+
+                s.oldx_l = ox[v*2];
+                s.oldx_r = ox[v*2+1];
+                s.oldy1_l = s.y1_l = oy1[v*2];
+                s.oldy1_r = s.y1_r = oy1[v*2+1];
+                s.oldy2_l = s.y2_l = oy2[v*2];
+                s.oldy2_r = s.y2_r = oy2[v*2+1];
+                s.oldy3_l = s.y3_l = oy3[v*2];
+                s.oldy3_r = s.y3_r = oy3[v*2+1];
+                s.y4_l = oy4[v*2];
+                s.y4_r = oy4[v*2+1];
+            }
+        }
+    }
+
+    __m128 p[R], r[R], k[R];
+    __m128 x[R], y1[R], y2[R], y3[R], y4[R];
+    __m128 oldX[R], oldY1[R], oldY2[R], oldY3[R];
+    __m128 const6;
+};
+
+template<eU32 R> struct tfBiquadLanes
+{
+    static const eU32 REGS = R;
+
+    void load(tfFilter::State **states)
+    {
+        for (eU32 q=0; q<R; q++)
+        {
+            const tfFilter::State &s0 = *states[q*2+0];
+            const tfFilter::State &s1 = *states[q*2+1];
+
+            b0[q] = _mm_setr_ps(s0.b0, s0.b0, s1.b0, s1.b0);
+            b1[q] = _mm_setr_ps(s0.b1, s0.b1, s1.b1, s1.b1);
+            b2[q] = _mm_setr_ps(s0.b2, s0.b2, s1.b2, s1.b2);
+            a1[q] = _mm_setr_ps(s0.a1, s0.a1, s1.a1, s1.a1);
+            a2[q] = _mm_setr_ps(s0.a2, s0.a2, s1.a2, s1.a2);
+            in1[q] = _mm_setr_ps(s0.in1_l, s0.in1_r, s1.in1_l, s1.in1_r);
+            in2[q] = _mm_setr_ps(s0.in2_l, s0.in2_r, s1.in2_l, s1.in2_r);
+            out1[q] = _mm_setr_ps(s0.out1_l, s0.out1_r, s1.out1_l, s1.out1_r);
+            out2[q] = _mm_setr_ps(s0.out2_l, s0.out2_r, s1.out2_l, s1.out2_r);
+        }
+    }
+
+    eFORCEINLINE __m128 step(eU32 q, __m128 in)
+    {
+        const __m128 out = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(b0[q], in),
+                                                                       _mm_mul_ps(b1[q], in1[q])),
+                                                            _mm_mul_ps(b2[q], in2[q])),
+                                                 _mm_mul_ps(a1[q], out1[q])),
+                                      _mm_mul_ps(a2[q], out2[q]));
+
+        in2[q] = in1[q];
+        in1[q] = in;
+        out2[q] = out1[q];
+        out1[q] = out;
+        return out;
+    }
+
+    void store(tfFilter::State **states) const
+    {
+        for (eU32 q=0; q<R; q++)
+        {
+            eF32A i1[4], i2[4], o1[4], o2[4];
+
+            _mm_store_ps(i1, in1[q]);
+            _mm_store_ps(i2, in2[q]);
+            _mm_store_ps(o1, out1[q]);
+            _mm_store_ps(o2, out2[q]);
+
+            for (eU32 v=0; v<2; v++)
+            {
+                tfFilter::State &s = *states[q*2+v];
+
+                s.in1_l = i1[v*2];
+                s.in1_r = i1[v*2+1];
+                s.in2_l = i2[v*2];
+                s.in2_r = i2[v*2+1];
+                s.out1_l = o1[v*2];
+                s.out1_r = o1[v*2+1];
+                s.out2_l = o2[v*2];
+                s.out2_r = o2[v*2+1];
+            }
+        }
+    }
+
+    __m128 b0[R], b1[R], b2[R], a1[R], a2[R];
+    __m128 in1[R], in2[R], out1[R], out2[R];
+};
+
+// Runs a kernel over the channels ch (left and
+// right of 2*REGS voices). Four samples of four
+// channels are transposed, so that loads and
+// stores stay vectorized.
+template<class K> static void tfRunLanes(K &kernel, tfFilter::State **states, eSignal **ch, eU32 len)
+{
+    const eU32 R = K::REGS;
+
+    kernel.load(states);
+
+    eU32 i = 0;
+
+    for (; i+4<=len; i+=4)
+    {
+        __m128 v[R][4];
+
+        for (eU32 q=0; q<R; q++)
+        {
+            for (eU32 c=0; c<4; c++)
+            {
+                v[q][c] = _mm_loadu_ps(ch[q*4+c]+i);
+            }
+
+            _MM_TRANSPOSE4_PS(v[q][0], v[q][1], v[q][2], v[q][3]);
+        }
+
+        for (eU32 t=0; t<4; t++)
+        {
+            for (eU32 q=0; q<R; q++)
+            {
+                v[q][t] = kernel.step(q, v[q][t]);
+            }
+        }
+
+        for (eU32 q=0; q<R; q++)
+        {
+            _MM_TRANSPOSE4_PS(v[q][0], v[q][1], v[q][2], v[q][3]);
+
+            for (eU32 c=0; c<4; c++)
+            {
+                _mm_storeu_ps(ch[q*4+c]+i, v[q][c]);
+            }
+        }
+    }
 
+    for (; i<len; i++)
+    {
+        eF32A out[R][4];
+
+        for (eU32 q=0; q<R; q++)
+        {
+            const __m128 in = _mm_setr_ps(ch[q*4+0][i], ch[q*4+1][i], ch[q*4+2][i], ch[q*4+3][i]);
+            _mm_store_ps(out[q], kernel.step(q, in));
+        }
+
+        for (eU32 q=0; q<R; q++)
+        {
+            for (eU32 c=0; c<4; c++)
+            {
+                ch[q*4+c][i] = out[q][c];
+            }
+        }
+    }
+
+    kernel.store(states);
+}
+
+template<eU32 R> static void tfProcessLanes(tfFilter::State **states, eSignal **ch, eU32 len)
+{
+    if (states[0]->moog_vcf)
+    {
+        tfMoogLanes<R> kernel;
+        tfRunLanes(kernel, states, ch, len);
+    }
+    else
+    {
+        tfBiquadLanes<R> kernel;
+        tfRunLanes(kernel, states, ch, len);
+    }
+}
+
+#endif
+
+// Filters count voices, whose left and right
+// channels are given in signals. All states have
+// to be updated for the same filter mode. With
+// SSE up to four voices are processed at once,
+// unused lanes repeat the last voice of a group.
+void tfFilter::processVoices(tfFilter::State **states, eSignal **signals, eU32 count, eU32 len)
+{
+#ifdef eUSE_SSE
+    const eU32 VOICE_LANES = 4;
+
+    for (eU32 first=0; first<count; first+=VOICE_LANES)
+    {
+        const eU32 used = eMin(count-first, VOICE_LANES);
+
+        State *laneStates[VOICE_LANES];
+        eSignal *laneSignals[VOICE_LANES*2];
+
+        for (eU32 i=0; i<VOICE_LANES; i++)
+        {
+            const eU32 voice = first+eMin(i, used-1);
+            eASSERT(states[voice]->moog_vcf == states[first]->moog_vcf);
+
+            laneStates[i] = states[voice];
+            laneSignals[i*2+0] = signals[voice*2+0];
+            laneSignals[i*2+1] = signals[voice*2+1];
+        }
+
+        if (used <= 2)
+        {
+            tfProcessLanes<1>(laneStates, laneSignals, len);
+        }
+        else
+        {
+            tfProcessLanes<2>(laneStates, laneSignals, len);
+        }
+    }
+#else
+    for (eU32 i=0; i<count; i++)
+    {
+        process(states[i], &signals[i*2], len);
+    }
+#endif
+}
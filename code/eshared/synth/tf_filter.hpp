@@ -99,6 +99,7 @@ public:
         eU32 sampleRate);
 
     void process(State *state, eSignal **signal, eU32 len);
+    void processVoices(State **states, eSignal **signals, eU32 count, eU32 len);
 };
 
 #endif // TF_FILTER_HPP
\ No newline at end of file
@@ -126,6 +126,27 @@ void eDownsampleMix(eSignal **master, eSignal **in, eU32 length, eU32 oversampli
     }
 }
 
+// Seed the random phases and slops of new voices
+// are derived from. 0 uses the tick count, any
+// other seed makes renderings reproducible, as
+// long as notes are only triggered by one thread.
+static eU32 g_voiceSeed = 0;
+
+void tfRandomize(eU32 seed)
+{
+    g_voiceSeed = seed;
+}
+
+eU32 tfRandomSeed()
+{
+    if (g_voiceSeed == 0)
+    {
+        return eRandomSeed();
+    }
+
+    return eRandom(g_voiceSeed);
+}
+
 #ifdef eDEBUG
 #include <stdio.h>
 void eSignalDebugWrite(eSignal **sig, eF32 volume, eChar *filename)
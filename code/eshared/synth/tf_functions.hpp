@@ -20,6 +20,9 @@ void eSignalToS16(eSignal **sig, eS16 *out, const eF32 gain, eU32 length);
 void eSignalToPeak(eSignal **sig, eF32 *peak_left, eF32 *peak_right, eU32 length);
 void eDownsampleMix(eSignal **master, eSignal **in, eU32 length, eU32 oversamplingCount);
 
+void tfRandomize(eU32 seed);
+eU32 tfRandomSeed();
+
 #ifdef eDEBUG
 void eSignalDebugWrite(eSignal **sig, eF32 volume, eChar *filename);
 #endif
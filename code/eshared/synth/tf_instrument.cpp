@@ -21,7 +21,7 @@ eF32  tfInstrument::m_freqTable[TF_NUMFREQS];
 
 void tfInstrument::State::noteOn(eS32 note, eS32 velocity, eF32 lfoPhase1, eF32 lfoPhase2)
 {
-	eU32 seed = eRandomSeed();
+	eU32 seed = tfRandomSeed();
 
 	currentNote = note;
 	currentVelocity = velocity;
@@ -81,13 +81,15 @@ tfInstrument::tfInstrument()
     m_mixBufferLen = 0;
     m_mixBuffers[0] = eNULL;
     m_mixBuffers[1] = eNULL;
+    m_voiceBuffers = eNULL;
+    m_laneEngine = eTRUE;
     m_lfo1Phase = 0.0f;
     m_lfo2Phase = 0.0f;
-    m_ignoreParamUI = eFALSE;
 
 #ifdef TF_OVERSAMPLING
     m_mixBuffersOverSampling[0] = eNULL;
     m_mixBuffersOverSampling[1] = eNULL;
+    m_laneBuffers = eNULL;
 #endif
 
     _prepareFreqTable();
@@ -95,12 +97,12 @@ tfInstrument::tfInstrument()
 
 tfInstrument::~tfInstrument()
 {
-    eSAFE_DELETE_ARRAY(m_mixBuffers[0]);
-    eSAFE_DELETE_ARRAY(m_mixBuffers[1]);
+    eSAFE_DELETE_ARRAY(m_voiceBuffers);
 
 #ifdef TF_OVERSAMPLING
     eSAFE_DELETE_ARRAY(m_mixBuffersOverSampling[0]);
     eSAFE_DELETE_ARRAY(m_mixBuffersOverSampling[1]);
+    eSAFE_DELETE_ARRAY(m_laneBuffers);
 #endif
 
     for (eU32 i=0; i<TF_EFFECTSLOTS; i++)
@@ -142,24 +144,6 @@ void tfInstrument::setParam(eU32 index, eF32 value)
     m_params[index] = value;
 }
 
-void tfInstrument::setIgnoreParamUI(eBool ignore)
-{
-    m_ignoreParamUI = ignore;
-}
-
-void tfInstrument::setParamUI(eU32 index, eF32 value)
-{
-    eASSERT(index >= 0 && index < TF_PARAM_COUNT);
-    if (!m_ignoreParamUI)
-    {
-        eF32 diff = eAbs(m_params[index] - value);
-        if (diff >= 0.005f) 
-        {
-            m_params[index] = value;
-        }   
-    }
-}
-
 void tfInstrument::setSampleRate(eU32 sampleRate)
 {
     m_sampleRate = sampleRate;
@@ -264,17 +248,273 @@ void tfInstrument::_prepareMixBufferInternal(eSignal **sig, eU32 len, eU32 actua
     eMemSet(*sig, 0, sizeof(eSignal) * len);
 }
 
+// Every voice renders into its own pair of
+// buffers, so that the filters can be run on
+// all voices at once after rendering.
 void tfInstrument::prepareMixBuffers(eU32 len)
 {
-    _prepareMixBufferInternal(&m_mixBuffers[0], len, m_mixBufferLen);
-    _prepareMixBufferInternal(&m_mixBuffers[1], len, m_mixBufferLen);
+    if (len != m_mixBufferLen)
+    {
+        eSAFE_DELETE_ARRAY(m_voiceBuffers);
+        m_voiceBuffers = new eSignal[TF_MAXVOICES*2*len];
+
+#ifdef TF_OVERSAMPLING
+        _prepareMixBufferInternal(&m_mixBuffersOverSampling[0], len*TF_MAX_OVERSAMPLING, m_mixBufferLen*TF_MAX_OVERSAMPLING);
+        _prepareMixBufferInternal(&m_mixBuffersOverSampling[1], len*TF_MAX_OVERSAMPLING, m_mixBufferLen*TF_MAX_OVERSAMPLING);
+
+        eSAFE_DELETE_ARRAY(m_laneBuffers);
+        m_laneBuffers = new eSignal[tfOscillator::VOICE_LANES*2*len*TF_MAX_OVERSAMPLING];
+#endif
+
+        m_mixBufferLen = len;
+    }
+}
+
+// Points the mixing buffers to the buffers of
+// the given voice and clears the oversampling
+// buffers. The voice buffers keep their content.
+void tfInstrument::_selectVoiceBuffers(eU32 voice)
+{
+    eASSERT(voice < TF_MAXVOICES);
+
+    m_mixBuffers[0] = m_voiceBuffers+voice*2*m_mixBufferLen;
+    m_mixBuffers[1] = m_mixBuffers[0]+m_mixBufferLen;
+
+#ifdef TF_OVERSAMPLING
+    eMemSet(m_mixBuffersOverSampling[0], 0, sizeof(eSignal)*m_mixBufferLen*TF_MAX_OVERSAMPLING);
+    eMemSet(m_mixBuffersOverSampling[1], 0, sizeof(eSignal)*m_mixBufferLen*TF_MAX_OVERSAMPLING);
+#endif
+}
+
+// Updates the given filter of all rendered
+// voices and runs it. The lane engine filters
+// several voices per SIMD pass, else they're
+// filtered one after another.
+void tfInstrument::_processFilter(tfFilter::Mode mode, tfFilter::State State::*filterState, const eU32 *voices, eU32 count, eU32 len)
+{
+    tfFilter::State *states[TF_MAXVOICES];
+    eSignal *signals[TF_MAXVOICES*2];
+
+    for (eU32 i=0; i<count; i++)
+    {
+        State &state = m_state[voices[i]];
+
+        states[i] = &(state.*filterState);
+        signals[i*2+0] = m_voiceBuffers+voices[i]*2*len;
+        signals[i*2+1] = signals[i*2+0]+len;
+
+        m_filter.update(states[i], &m_modMatrix, &state.modMatrixState, m_params, mode, m_sampleRate);
+    }
+
+    if (m_laneEngine)
+    {
+        m_filter.processVoices(states, signals, count, len);
+    }
+    else
+    {
+        for (eU32 i=0; i<count; i++)
+        {
+            m_filter.process(states[i], &signals[i*2], len);
+        }
+    }
+}
+
+// Updates the (gliding) frequency of the given
+// voice and returns the oversampling factor its
+// oscillators are run with.
+eU32 tfInstrument::_updateVoiceFreq(State *state)
+{
+    eF32 baseFreq = m_freqTable[state->currentNote & 0x7f];
+    eF32 slop = ePow(m_params[TF_OSC_SLOP], 3);
+    baseFreq += state->currentSlop * slop * 8.0f;
+    
+    //  calculate amount of oversampling
+#ifdef TF_OVERSAMPLING
+    eU32 oversamplingCount = 1;
+    eF32 minSamplingRate = baseFreq * 2 * TF_DESIRED_OVERSAMPLING;
+    
+    while (m_sampleRate * oversamplingCount < minSamplingRate
+        && oversamplingCount < TF_MAX_OVERSAMPLING)
+    {
+        oversamplingCount++;
+    }
+
+    baseFreq *= m_scaler / oversamplingCount;
+#else
+    const eU32 oversamplingCount = 1;
+    baseFreq *= m_scaler;
+#endif
+    
+    eF32 glide = m_params[TF_OSC_GLIDE];
+    if (glide > 0.0f && state->currentFreq > 0.0f)
+    {
+        eF32 freqDiff = baseFreq - state->currentFreq;
+        freqDiff /= glide * 10.0f + 1.0f;
+        state->currentFreq += freqDiff;
+    }
+    else
+        state->currentFreq = baseFreq;
+
+    return oversamplingCount;
+}
+
+// Runs the additive synth of a voice into the
+// signals its oscillators have been rendered to.
+eBool tfInstrument::_processAddSynth(State *state, eF32 velocity, eSignal **signals, eU32 oversamplingCount, eU32 len)
+{
+    eASSERT_UNDENORMALIZED();
+
+#ifndef NO_ADDSYNTH
+    m_addSynth.update(m_params, m_sampleRate, eFALSE);
+    eBool has_addsyn = m_addSynth.process(&state->addSynthState, 
+        &m_modMatrix, 
+        &state->modMatrixState, 
+        m_params, 
+        signals, 
+        len*oversamplingCount, 
+        state->currentFreq, 
+        velocity,
+        oversamplingCount);
+#else
+    eBool has_addsyn = eFALSE;
+#endif
+
+    eASSERT_UNDENORMALIZED();
     
+#ifdef eHWSYNTH
+    eSignalDebugWritePeak(signals, "Additive    ");
+#endif	    
+
+    return has_addsyn;
+}
+
+#ifdef TF_OVERSAMPLING
+void tfInstrument::_updateDownsampleFilters(State *state, eU32 oversamplingCount)
+{
+    m_filter.update(&state->downSampleFilterState, eNULL, eNULL, eNULL, tfFilter::FILTER_OVERSAMPLING_LOWPASS, m_sampleRate*oversamplingCount);
+    m_filter.update(&state->downSampleFilterState2, eNULL, eNULL, eNULL, tfFilter::FILTER_OVERSAMPLING_LOWPASS, m_sampleRate*oversamplingCount);
+}
+#endif
+
+// Lane engine counterpart of the voice loop in
+// process(). The oscillators of all voices are
+// prepared in voice order first. Then voices with
+// the same oversampling are grouped and their
+// oscillators and downsampling filters are run in
+// SIMD lanes, each voice in its own lane buffers.
+void tfInstrument::_processVoiceLanes(const eU32 *voices, const eF32 *velocities, const eBool *hasNoise, eU32 count, eU32 len)
+{
+    const eU32 LANES = tfOscillator::VOICE_LANES;
+
+    tfOscillator::Voice oscVoices[TF_MAXVOICES];
+    eU32 oversampling[TF_MAXVOICES];
+    eBool hasOsc[TF_MAXVOICES];
+    eBool done[TF_MAXVOICES];
+
+    for (eU32 i=0; i<count; i++)
+    {
+        State *state = &m_state[voices[i]];
+
+        oversampling[i] = _updateVoiceFreq(state);
+        hasOsc[i] = m_osc.prepare(oscVoices[i], 
+            &state->oscState, 
+            &m_modMatrix, 
+            &state->modMatrixState, 
+            m_params, 
+            len*oversampling[i], 
+            state->currentFreq, 
+            velocities[i], 
+            oversampling[i]);
+        done[i] = eFALSE;
+    }
+
+    for (eU32 i=0; i<count; i++)
+    {
+        if (done[i])
+            continue;
+
+        const eU32 oversamplingCount = oversampling[i];
+        eU32 group[LANES];
+        eSignal *groupSignals[LANES][2];
+        tfOscillator::Voice *laneVoices[LANES];
+        eU32 groupSize = 0;
+        eU32 laneCount = 0;
+
+        for (eU32 j=i; j<count && groupSize<LANES; j++)
+        {
+            if (done[j] || oversampling[j] != oversamplingCount)
+                continue;
+
+            eSignal **signals = groupSignals[groupSize];
+            signals[0] = m_voiceBuffers+voices[j]*2*len;
+            signals[1] = signals[0]+len;
+
 #ifdef TF_OVERSAMPLING
-    _prepareMixBufferInternal(&m_mixBuffersOverSampling[0], len*TF_MAX_OVERSAMPLING, m_mixBufferLen*TF_MAX_OVERSAMPLING);
-    _prepareMixBufferInternal(&m_mixBuffersOverSampling[1], len*TF_MAX_OVERSAMPLING, m_mixBufferLen*TF_MAX_OVERSAMPLING);
+            signals[0] = m_laneBuffers+groupSize*2*len*TF_MAX_OVERSAMPLING;
+            signals[1] = signals[0]+len*TF_MAX_OVERSAMPLING;
+            eMemSet(signals[0], 0, sizeof(eSignal)*len*oversamplingCount);
+            eMemSet(signals[1], 0, sizeof(eSignal)*len*oversamplingCount);
 #endif
 
-    m_mixBufferLen = len;
+            if (hasOsc[j])
+            {
+                oscVoices[j].signals[0] = signals[0];
+                oscVoices[j].signals[1] = signals[1];
+                laneVoices[laneCount++] = &oscVoices[j];
+            }
+
+            group[groupSize++] = j;
+            done[j] = eTRUE;
+        }
+
+        m_osc.processVoices(laneVoices, laneCount, len*oversamplingCount);
+
+        eBool hasAddSynth[LANES];
+
+        for (eU32 g=0; g<groupSize; g++)
+        {
+            const eU32 j = group[g];
+            hasAddSynth[g] = _processAddSynth(&m_state[voices[j]], velocities[j], groupSignals[g], oversamplingCount, len);
+        }
+
+#ifdef TF_OVERSAMPLING
+        // The downsampling filters of a group run at
+        // the same rate, so they're laned, too.
+        tfFilter::State *downStates[LANES];
+        tfFilter::State *downStates2[LANES];
+        eSignal *downSignals[LANES*2];
+
+        for (eU32 g=0; g<groupSize; g++)
+        {
+            State *state = &m_state[voices[group[g]]];
+
+            _updateDownsampleFilters(state, oversamplingCount);
+            downStates[g] = &state->downSampleFilterState;
+            downStates2[g] = &state->downSampleFilterState2;
+            downSignals[g*2+0] = groupSignals[g][0];
+            downSignals[g*2+1] = groupSignals[g][1];
+        }
+
+        m_filter.processVoices(downStates, downSignals, groupSize, len*oversamplingCount);
+        m_filter.processVoices(downStates2, downSignals, groupSize, len*oversamplingCount);
+#endif
+
+        for (eU32 g=0; g<groupSize; g++)
+        {
+            const eU32 j = group[g];
+
+#ifdef TF_OVERSAMPLING
+            eSignal *voiceSignals[2];
+            voiceSignals[0] = m_voiceBuffers+voices[j]*2*len;
+            voiceSignals[1] = voiceSignals[0]+len;
+            eDownsampleMix(voiceSignals, groupSignals[g], len, oversamplingCount);
+#endif
+
+            m_state[voices[j]].playing = hasNoise[j] || hasOsc[j] || hasAddSynth[g];
+        }
+
+        eASSERT_UNDENORMALIZED();
+    }
 }
 
 void tfInstrument::mix(eSignal **signals, eF32 volume)
@@ -282,10 +522,20 @@ void tfInstrument::mix(eSignal **signals, eF32 volume)
     eSignalMix(signals, m_mixBuffers, m_mixBufferLen, volume);
 }
 
+void tfInstrument::setLaneEngine(eBool enable)
+{
+    m_laneEngine = enable;
+}
+
+eBool tfInstrument::getLaneEngine() const
+{
+    return m_laneEngine;
+}
+
 void tfInstrument::updateAddSynth()
 {
 #ifndef NO_ADDSYNTH
-    m_addSynth.update(m_params, m_sampleRate);
+    m_addSynth.update(m_params, m_sampleRate, eTRUE);
 #endif
 }
 
@@ -293,6 +543,20 @@ eF32 tfInstrument::process(eSignal **signals, eU32 len)
 {
     eSetSSEFlushToZeroMode();
 
+    // clear the mixing buffers
+    prepareMixBuffers(len);
+
+    eU32 voices[TF_MAXVOICES];
+    eF32 velocities[TF_MAXVOICES];
+    eBool hasNoise[TF_MAXVOICES];
+    tfNoise::State *noiseStates[TF_MAXVOICES];
+    eSignal *noiseSignals[TF_MAXVOICES*2];
+    eU32 voiceCount = 0;
+    eU32 noiseCount = 0;
+
+    // The noise of all voices is generated first,
+    // so that its filters can run on all of them
+    // at once.
     for(eU32 k=0;k<TF_MAXVOICES;k++)
     {
         State *state = &m_state[k];
@@ -310,8 +574,9 @@ eF32 tfInstrument::process(eSignal **signals, eU32 len)
 
             eASSERT_UNDENORMALIZED();
             
-            // clear the mixing buffers
-            prepareMixBuffers(len);
+            m_mixBuffers[0] = m_voiceBuffers+k*2*len;
+            m_mixBuffers[1] = m_mixBuffers[0]+len;
+            eMemSet(m_mixBuffers[0], 0, sizeof(eSignal)*2*len);
 		
             eF32 velocity = (eF32)state->currentVelocity / 128.0f;
 
@@ -327,205 +592,141 @@ eF32 tfInstrument::process(eSignal **signals, eU32 len)
                 m_mixBuffers, 
                 len,
                 velocity);
-                
+
+            if (has_noise)
+            {
+                noiseStates[noiseCount] = &state->noiseState;
+                noiseSignals[noiseCount*2+0] = m_mixBuffers[0];
+                noiseSignals[noiseCount*2+1] = m_mixBuffers[1];
+                noiseCount++;
+            }
+
+            voices[voiceCount] = k;
+            velocities[voiceCount] = velocity;
+            hasNoise[voiceCount] = has_noise;
+            voiceCount++;
+        }
+    }
+
+    m_noise.processFilters(noiseStates, noiseSignals, noiseCount, len, m_laneEngine);
+
 #ifdef eHWSYNTH
-	    eSignalDebugWritePeak(m_mixBuffers, "Noise       ");
+	eSignalDebugWritePeak(m_mixBuffers, "Noise       ");
 #endif	    
 
+    eASSERT_UNDENORMALIZED();
 
-            eASSERT_UNDENORMALIZED();
+    if (m_laneEngine)
+    {
+        _processVoiceLanes(voices, velocities, hasNoise, voiceCount, len);
+    }
+    else
+    {
+        for(eU32 i=0;i<voiceCount;i++)
+        {
+            const eU32 k = voices[i];
+            State *state = &m_state[k];
+
+            _selectVoiceBuffers(k);
 
             //    Run Oscillator
-            eF32 baseFreq = m_freqTable[state->currentNote & 0x7f];
-            eF32 slop = ePow(m_params[TF_OSC_SLOP], 3);
-            baseFreq += state->currentSlop * slop * 8.0f;
-            
-            //  calculate amount of oversampling
-#ifdef TF_OVERSAMPLING
-            eU32 oversamplingCount = 1;
-            eF32 minSamplingRate = baseFreq * 2 * TF_DESIRED_OVERSAMPLING;
-            
-            while (m_sampleRate * oversamplingCount < minSamplingRate
-                && oversamplingCount < TF_MAX_OVERSAMPLING)
-            {
-                oversamplingCount++;
-            }
+            const eU32 oversamplingCount = _updateVoiceFreq(state);
 
-            baseFreq *= m_scaler / oversamplingCount;
+#ifdef TF_OVERSAMPLING
+            eSignal **oscSignals = m_mixBuffersOverSampling;
 #else
-            baseFreq *= m_scaler;
+            eSignal **oscSignals = m_mixBuffers;
 #endif
-            
-            eF32 glide = m_params[TF_OSC_GLIDE];
-            if (glide > 0.0f && state->currentFreq > 0.0f)
-            {
-                eF32 freqDiff = baseFreq - state->currentFreq;
-                freqDiff /= glide * 10.0f + 1.0f;
-                state->currentFreq += freqDiff;
-            }
-            else
-                state->currentFreq = baseFreq;
-            
-#ifdef TF_OVERSAMPLING
-			eBool has_osc = m_osc.process(&state->oscState, 
+
+            eBool has_osc = m_osc.process(&state->oscState, 
                 &m_modMatrix, 
                 &state->modMatrixState, 
                 m_params, 
-                m_mixBuffersOverSampling, 
+                oscSignals, 
                 len*oversamplingCount, 
                 state->currentFreq, 
-                velocity,
+                velocities[i],
                 oversamplingCount);
-#else
-            eBool has_osc = m_osc.process(&state->oscState, 
-                &m_modMatrix, 
-                &state->modMatrixState, 
-                m_params, 
-                m_mixBuffers, 
-                len, 
-                state->currentFreq, 
-                velocity,
-                1);
-#endif
 
 #ifdef eHWSYNTH
-	    eSignalDebugWritePeak(m_mixBuffers, "Oscillators ");
+	        eSignalDebugWritePeak(m_mixBuffers, "Oscillators ");
 #endif	    
 
-            eASSERT_UNDENORMALIZED();
+            const eBool has_addsyn = _processAddSynth(state, velocities[i], oscSignals, oversamplingCount, len);
 
-#ifndef NO_ADDSYNTH
-            //    Run additive synth
 #ifdef TF_OVERSAMPLING
-			m_addSynth.update(m_params, m_sampleRate);
-            eBool has_addsyn = m_addSynth.process(&state->addSynthState, 
-                &m_modMatrix, 
-                &state->modMatrixState, 
-                m_params, 
-                m_mixBuffersOverSampling, 
-                len*oversamplingCount, 
-                state->currentFreq, 
-                velocity,
-                oversamplingCount);
-#else
-            m_addSynth.update(m_params, m_sampleRate);
-            eBool has_addsyn = m_addSynth.process(&state->addSynthState, 
-                &m_modMatrix, 
-                &state->modMatrixState, 
-                m_params, 
-                m_mixBuffers, 
-                len, 
-                state->currentFreq, 
-                velocity,
-                1);
-#endif
+            _updateDownsampleFilters(state, oversamplingCount);
+            m_filter.process(&state->downSampleFilterState, oscSignals, len*oversamplingCount);
+            m_filter.process(&state->downSampleFilterState2, oscSignals, len*oversamplingCount);
+            eDownsampleMix(m_mixBuffers, oscSignals, len, oversamplingCount);
 #endif
-            eASSERT_UNDENORMALIZED();
-            
-#ifdef eHWSYNTH
-	    eSignalDebugWritePeak(m_mixBuffers, "Additive    ");
-#endif	    
 
+            state->playing = hasNoise[i] || has_osc || has_addsyn;
 
-#ifdef TF_OVERSAMPLING
-			m_filter.update(&state->downSampleFilterState, eNULL, eNULL, eNULL, tfFilter::FILTER_OVERSAMPLING_LOWPASS, m_sampleRate*oversamplingCount);
-			m_filter.update(&state->downSampleFilterState2, eNULL, eNULL, eNULL, tfFilter::FILTER_OVERSAMPLING_LOWPASS, m_sampleRate*oversamplingCount);
-			m_filter.process(&state->downSampleFilterState, m_mixBuffersOverSampling, m_mixBufferLen*oversamplingCount);
-			m_filter.process(&state->downSampleFilterState2, m_mixBuffersOverSampling, m_mixBufferLen*oversamplingCount);
-			eDownsampleMix(m_mixBuffers, m_mixBuffersOverSampling, m_mixBufferLen, oversamplingCount);
-#endif
+            eASSERT_UNDENORMALIZED();
+        }
+    }
 
-#ifndef NO_ADDSYNTH
-            state->playing = has_noise || has_osc || has_addsyn;
-#else
-            state->playing = has_noise || has_osc;
-#endif
+    //    Run Filters
+    if (m_params[TF_LP_FILTER_ON] > 0.5f)
+    {
+        _processFilter(tfFilter::FILTER_LOWPASS, &State::filterStateLP, voices, voiceCount, len);
 
-            //    Run Filters
-            if (m_params[TF_LP_FILTER_ON] > 0.5f)
-            {
-                m_filter.update(&state->filterStateLP, 
-                    &m_modMatrix, 
-                    &state->modMatrixState, 
-                    m_params, 
-                    tfFilter::FILTER_LOWPASS, 
-                    m_sampleRate);
-
-                m_filter.process(&state->filterStateLP, m_mixBuffers, len);
-                
 #ifdef eHWSYNTH
-		eSignalDebugWritePeak(m_mixBuffers, "LP Filter   ");
+	eSignalDebugWritePeak(m_mixBuffers, "LP Filter   ");
 #endif	    
-            }
-
-            eASSERT_UNDENORMALIZED();
+    }
 
-            if (m_params[TF_HP_FILTER_ON] > 0.5f)
-            {
-                m_filter.update(&state->filterStateHP, 
-                    &m_modMatrix, 
-                    &state->modMatrixState, 
-                    m_params, 
-                    tfFilter::FILTER_HIGHPASS, 
-                    m_sampleRate);
+    eASSERT_UNDENORMALIZED();
 
-                m_filter.process(&state->filterStateHP, m_mixBuffers, len);
+    if (m_params[TF_HP_FILTER_ON] > 0.5f)
+    {
+        _processFilter(tfFilter::FILTER_HIGHPASS, &State::filterStateHP, voices, voiceCount, len);
 
 #ifdef eHWSYNTH
-		eSignalDebugWritePeak(m_mixBuffers, "HP Filter   ");
+	eSignalDebugWritePeak(m_mixBuffers, "HP Filter   ");
 #endif	    
-            }
+    }
 
-            eASSERT_UNDENORMALIZED();
+    eASSERT_UNDENORMALIZED();
 
 #ifndef NO_BANDPASS_FILTER
-            if (m_params[TF_BP_FILTER_ON] > 0.5f)
-            {
-                m_filter.update(&state->filterStateBP, 
-                    &m_modMatrix, 
-                    &state->modMatrixState, 
-                    m_params, 
-                    tfFilter::FILTER_BANDPASS, 
-                    m_sampleRate);
-
-                m_filter.process(&state->filterStateBP, m_mixBuffers, len);
-                
+    if (m_params[TF_BP_FILTER_ON] > 0.5f)
+    {
+        _processFilter(tfFilter::FILTER_BANDPASS, &State::filterStateBP, voices, voiceCount, len);
+
 #ifdef eHWSYNTH
-		eSignalDebugWritePeak(m_mixBuffers, "BP Filter   ");
+	eSignalDebugWritePeak(m_mixBuffers, "BP Filter   ");
 #endif	    
-            }
+    }
 #endif
-            eASSERT_UNDENORMALIZED();
+    eASSERT_UNDENORMALIZED();
 
 #ifndef NO_NOTCH_FILTER
-            if (m_params[TF_NT_FILTER_ON] > 0.5f)
-            {
-                m_filter.update(&state->filterStateNT, 
-                    &m_modMatrix, 
-                    &state->modMatrixState, 
-                    m_params, 
-                    tfFilter::FILTER_NOTCH, 
-                    m_sampleRate);
-
-                m_filter.process(&state->filterStateNT, m_mixBuffers, len);
-                
+    if (m_params[TF_NT_FILTER_ON] > 0.5f)
+    {
+        _processFilter(tfFilter::FILTER_NOTCH, &State::filterStateNT, voices, voiceCount, len);
+
 #ifdef eHWSYNTH
-		eSignalDebugWritePeak(m_mixBuffers, "NT Filter   ");
+	eSignalDebugWritePeak(m_mixBuffers, "NT Filter   ");
 #endif	    
-            }
+    }
 #endif
-            eASSERT_UNDENORMALIZED();
+    eASSERT_UNDENORMALIZED();
+
+    //  Mix to final signal in voice order.
+    for (eU32 i=0; i<voiceCount; i++)
+    {
+        m_mixBuffers[0] = m_voiceBuffers+voices[i]*2*len;
+        m_mixBuffers[1] = m_mixBuffers[0]+len;
+        mix(signals, m_params[TF_GAIN_AMOUNT]);
+    }
 
-            //  Mix to final signal.
-            mix(signals, m_params[TF_GAIN_AMOUNT]);
-            
 #ifdef eHWSYNTH
-		eSignalDebugWritePeak(signals, "Mixed       ");
+    eSignalDebugWritePeak(signals, "Mixed       ");
 #endif	    
-				
-            eASSERT_UNDENORMALIZED();
-        }    
-    }
+
+    eASSERT_UNDENORMALIZED();
 
     //    Run effects
     for(eU32 i=0;i<TF_EFFECTSLOTS;i++)
@@ -566,4 +767,68 @@ tfOscillator * tfInstrument::getOscillator()
 eF32 * tfInstrument::getParams()
 {
     return m_params;
-}
\ No newline at end of file
+}
+
+// Renders blockCount blocks of voiceCount held
+// notes with four unisono oscillators through all
+// compiled in filters and returns the number of
+// rendered voice blocks per millisecond, to
+// compare both engines.
+eF32 tfInstrument::benchmark(eBool laneEngine, eU32 voiceCount, eU32 blockCount)
+{
+    eASSERT(voiceCount > 0 && voiceCount <= TF_MAXVOICES);
+    eASSERT(blockCount > 0);
+
+    tfInstrument *instr = new tfInstrument;
+    eF32 *params = instr->getParams();
+
+    for (eU32 i=0; i<TF_EFFECTSLOTS; i++)
+    {
+        params[TF_EFFECT_1+i] = 0.0f;
+    }
+
+    params[TF_OSC_VOLUME] = 0.5f;
+    params[TF_OSC_UNISONO] = 0.3f;
+    params[TF_OSC_POLYPHONY] = 1.0f;
+    params[TF_ADSR1_SUSTAIN] = 1.0f;
+    params[TF_LP_FILTER_ON] = 1.0f;
+    params[TF_LP_FILTER_CUTOFF] = 0.5f;
+    params[TF_LP_FILTER_RESONANCE] = 0.3f;
+    params[TF_HP_FILTER_ON] = 1.0f;
+    params[TF_HP_FILTER_CUTOFF] = 0.1f;
+    params[TF_BP_FILTER_ON] = 1.0f;
+    params[TF_BP_FILTER_CUTOFF] = 0.4f;
+    params[TF_NT_FILTER_ON] = 1.0f;
+    params[TF_NT_FILTER_CUTOFF] = 0.6f;
+    params[TF_GAIN_AMOUNT] = 0.5f;
+
+    instr->setLaneEngine(laneEngine);
+
+    for (eU32 i=0; i<voiceCount; i++)
+    {
+        instr->noteOn(48+i*3, 100, 0, 0.0f);
+    }
+
+    eSignal *signals[2] =
+    {
+        new eSignal[TF_BLOCKSIZE],
+        new eSignal[TF_BLOCKSIZE]
+    };
+
+    const eU64 startTicks = eTimer::getTickCount();
+
+    for (eU32 i=0; i<blockCount; i++)
+    {
+        eMemSet(signals[0], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+        eMemSet(signals[1], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+        instr->process(signals, TF_BLOCKSIZE);
+    }
+
+    const eU64 ticks = eMax(eTimer::getTickCount()-startTicks, (eU64)1);
+
+    eSAFE_DELETE_ARRAY(signals[0]);
+    eSAFE_DELETE_ARRAY(signals[1]);
+    eSAFE_DELETE(instr);
+
+    return (eF32)((eF64)voiceCount*blockCount*eTimer::getFrequency()/(1000.0*ticks));
+}
@@ -66,8 +66,6 @@ public:
 
     eF32    getParam(eU32 index) const;
     void    setParam(eU32 index, eF32 value);
-    void    setParamUI(eU32 index, eF32 value);
-    void    setIgnoreParamUI(eBool value);
     void    updateAddSynth();
     eF32    process(eSignal **signals, eU32 len);
     void    setSampleRate(eU32 sampleRate);
@@ -81,6 +79,10 @@ public:
     eU32    getNewestVoice();
     void    prepareMixBuffers(eU32 len);
     void    mix(eSignal **signals, eF32 volume);
+    void    setLaneEngine(eBool enable);
+    eBool   getLaneEngine() const;
+
+    static eF32 benchmark(eBool laneEngine, eU32 voiceCount, eU32 blockCount);
 
     tfOscillator * getOscillator();
     eF32 *         getParams();
@@ -90,10 +92,18 @@ private:
     static void _prepareFreqTable();
     static void _prepareMixBufferInternal(eSignal **sig, eU32 len, eU32 actual_len);
 
+    void        _selectVoiceBuffers(eU32 voice);
+    eU32        _updateVoiceFreq(State *state);
+    eBool       _processAddSynth(State *state, eF32 velocity, eSignal **signals, eU32 oversamplingCount, eU32 len);
+#ifdef TF_OVERSAMPLING
+    void        _updateDownsampleFilters(State *state, eU32 oversamplingCount);
+#endif
+    void        _processVoiceLanes(const eU32 *voices, const eF32 *velocities, const eBool *hasNoise, eU32 count, eU32 len);
+    void        _processFilter(tfFilter::Mode mode, tfFilter::State State::*filterState, const eU32 *voices, eU32 count, eU32 len);
+
     eF32            m_params[TF_PARAM_COUNT];
     eU32            m_sampleRate;
     eF32            m_scaler;
-    eBool           m_ignoreParamUI;
 
     eF32            m_lfo1Phase;
     eF32            m_lfo2Phase;
@@ -111,10 +121,13 @@ private:
     State           m_state[TF_MAXVOICES];
 
     eSignal *       m_mixBuffers[2];
+    eSignal *       m_voiceBuffers;
 #ifdef TF_OVERSAMPLING
     eSignal *       m_mixBuffersOverSampling[2];
+    eSignal *       m_laneBuffers;
 #endif
     eU32            m_mixBufferLen;
+    eBool           m_laneEngine;
 
 public:
     static eBool    m_freqTableReady;
@@ -32,7 +32,7 @@ eF32 tfNoise::m_noiseTable[];
 
 void tfNoise::State::reset()
 {
-	eU32 seed = eRandomSeed();
+	eU32 seed = tfRandomSeed();
 	offset1 = eRandom(0, TF_NOISETABLESIZE/2, seed);
 	offset2 = eRandom(0, TF_NOISETABLESIZE/2, seed);
 
@@ -64,6 +64,8 @@ void tfNoise::update(tfNoise::State *state, eF32 *params, eU32 sampleRate)
     }
 }
 
+// Adds the noise to the signal. The noise filters
+// are run separately by processFilters().
 eBool tfNoise::process(State *state, 
     tfModMatrix *modMatrix, 
     tfModMatrix::State *modMatrixState, 
@@ -95,18 +97,51 @@ eBool tfNoise::process(State *state,
                 state->offset2 = 0;
         }
 
-        if (state->filterOn)
-        {
-            m_filter.process(&state->filterStateLP, signal, len);
-            m_filter.process(&state->filterStateHP, signal, len);
-        }
-
         return eTRUE;
     }
 
     return eFALSE;
 }
 
+// Runs the noise filters of count voices, whose
+// left and right channels are given in signals.
+// The signals must only contain the noise. With
+// lanes, the filters of several voices are run per
+// SIMD pass, else one voice after another.
+void tfNoise::processFilters(State **states, eSignal **signals, eU32 count, eU32 len, eBool lanes)
+{
+    tfFilter::State *statesLP[TF_MAXVOICES];
+    tfFilter::State *statesHP[TF_MAXVOICES];
+    eSignal *filterSignals[TF_MAXVOICES*2];
+    eU32 filterCount = 0;
+
+    for (eU32 i=0; i<count; i++)
+    {
+        if (states[i]->filterOn)
+        {
+            statesLP[filterCount] = &states[i]->filterStateLP;
+            statesHP[filterCount] = &states[i]->filterStateHP;
+            filterSignals[filterCount*2+0] = signals[i*2+0];
+            filterSignals[filterCount*2+1] = signals[i*2+1];
+            filterCount++;
+        }
+    }
+
+    if (lanes)
+    {
+        m_filter.processVoices(statesLP, filterSignals, filterCount, len);
+        m_filter.processVoices(statesHP, filterSignals, filterCount, len);
+    }
+    else
+    {
+        for (eU32 i=0; i<filterCount; i++)
+        {
+            m_filter.process(statesLP[i], &filterSignals[i*2], len);
+            m_filter.process(statesHP[i], &filterSignals[i*2], len);
+        }
+    }
+}
+
 void tfNoise::generateNoiseTable()
 {
     if (m_noiseReady)
@@ -42,6 +42,7 @@ public:
         eSignal **signal, 
         eU32 len,
         eF32 velocity);
+    void processFilters(State **states, eSignal **signals, eU32 count, eU32 len, eBool lanes);
 
 private:
 
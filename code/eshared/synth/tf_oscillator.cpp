@@ -23,7 +23,7 @@ void tfOscillator::SubOscState::reset(eBool randomizePhase)
 
 	if (randomizePhase)
 	{
-		eU32 seed = eRandomSeed();
+		eU32 seed = tfRandomSeed();
 		phase1 = eRandomF(seed);
 		phase2 = eRandomF(seed);
 	}
@@ -233,6 +233,27 @@ void tfSpline::_solveLinear()
 eBool tfOscillator::process(tfOscillator::State *state, tfModMatrix *modMatrix, 
                            tfModMatrix::State *modMatrixState, eF32 *params, 
                            eSignal **signals, eU32 len, eF32 baseFreq, eF32 velocity, eU32 oversamplingCount)
+{
+    Voice voice;
+
+    if (!prepare(voice, state, modMatrix, modMatrixState, params, len, baseFreq, velocity, oversamplingCount))
+        return eFALSE;
+
+    voice.signals[0] = signals[0];
+    voice.signals[1] = signals[1];
+
+    _processVoice(voice, len);
+    return eTRUE;
+}
+
+// Calculates the frequencies of all sub-oscillators,
+// the volume ramps and the drive of one voice for
+// the next len samples. The signals of the voice
+// are left to the caller. Returns eFALSE if the
+// voice is silent.
+eBool tfOscillator::prepare(Voice &voice, tfOscillator::State *state, tfModMatrix *modMatrix, 
+                            tfModMatrix::State *modMatrixState, eF32 *params, 
+                            eU32 len, eF32 baseFreq, eF32 velocity, eU32 oversamplingCount)
 {
     eF32 vol = params[TF_OSC_VOLUME] * velocity;
 
@@ -289,6 +310,7 @@ eBool tfOscillator::process(tfOscillator::State *state, tfModMatrix *modMatrix,
         // Update the spline.
         // ---------------------------------------------------------------------------------
         m_spline.update(params, modMatrix, modMatrixState);
+        eMemCopy(voice.samples, m_spline.m_samples, sizeof(voice.samples));
 
         // calculate panning, volume and volume step values
         // ---------------------------------------------------------------------------------
@@ -298,15 +320,15 @@ eBool tfOscillator::process(tfOscillator::State *state, tfModMatrix *modMatrix,
 		eF32 volumeL = pan1 * vol;
 		eF32 volumeR = pan2 * vol;
 
-		eF32 vol1_step = (volumeL - state->lastVolume1) / len;
-		eF32 vol1 = state->lastVolume1;
+		voice.vol1Step = (volumeL - state->lastVolume1) / len;
+		voice.vol1 = state->lastVolume1;
 		state->lastVolume1 = volumeL;
 
-		eF32 vol2_step = (volumeR - state->lastVolume2) / len;
-		eF32 vol2 = state->lastVolume2;
+		voice.vol2Step = (volumeR - state->lastVolume2) / len;
+		voice.vol2 = state->lastVolume2;
 		state->lastVolume2 = volumeR;
 
-        // run the oscillators
+        // set the oscillator frequencies
         // ---------------------------------------------------------------------------------
         for (eU32 i=0; i<subosc; i++)
         {
@@ -316,55 +338,75 @@ eBool tfOscillator::process(tfOscillator::State *state, tfModMatrix *modMatrix,
 
                 sostate.freq1 = freq1 + spread * j;
                 sostate.freq2 = freq2 - spread * j;
-                                
-                processSingle(&sostate, signals, 1.0f / (i+1), len);
             }
 
             freq1 *= 0.5f - detune;
             freq2 *= 0.5f + detune;
         }
-        
-        // calculate volume, drive and saturation
-        // ---------------------------------------------------------------------------------
-        eSignal *sig1 = signals[0];
-        eSignal *sig2 = signals[1];
-        eF32x2 vol_step = eSIMDLoad2(vol1_step, vol2_step);
-        eF32x2 drv = eSIMDSet2(drive);
-        eF32x2 const_1 = eSIMDSet2(1.0f);
-        eF32x2 const_n1 = eSIMDSet2(-1.0f);
-        eF32x2 volume = eSIMDLoad2(vol1, vol2);
 
-        eSIMDUndenormalise(vol_step);
+        voice.state = state;
+        voice.subosc = subosc;
+        voice.unisono = unisono;
+        voice.drive = drive;
+        return eTRUE;
+    }
+
+    return eFALSE;
+}
+
+// Runs the oscillators of one prepared voice and
+// applies volume, drive and saturation.
+void tfOscillator::_processVoice(const Voice &voice, eU32 len)
+{
+    State *state = voice.state;
+    eSignal *signals[2] = { voice.signals[0], voice.signals[1] };
 
-        while (len--)
+    // run the oscillators
+    // ---------------------------------------------------------------------------------
+    for (eU32 i=0; i<voice.subosc; i++)
+    {
+        for (eU32 j=0; j<voice.unisono; j++)
         {
-            eF32x2 val = eSIMDLoad2(*sig1, *sig2);
-
-            val = eSIMDMul(
-                    eSIMDMax(
-                        eSIMDMin(
-                            eSIMDMul(val, drv), 
-                            const_1
-                        ), 
-                        const_n1
-                    ),
-                    volume
-                );
-
-            eSIMDStore(val, sig1, sig2);
-            sig1++;
-            sig2++;
-
-            volume = eSIMDAdd(volume, vol_step);
+            processSingle(voice.samples, &state->oscState[j * TF_SUBOSC + i], signals, 1.0f / (i+1), len);
         }
-
-        return eTRUE;
     }
+    
+    // calculate volume, drive and saturation
+    // ---------------------------------------------------------------------------------
+    eSignal *sig1 = signals[0];
+    eSignal *sig2 = signals[1];
+    eF32x2 vol_step = eSIMDLoad2(voice.vol1Step, voice.vol2Step);
+    eF32x2 drv = eSIMDSet2(voice.drive);
+    eF32x2 const_1 = eSIMDSet2(1.0f);
+    eF32x2 const_n1 = eSIMDSet2(-1.0f);
+    eF32x2 volume = eSIMDLoad2(voice.vol1, voice.vol2);
 
-    return eFALSE;
+    eSIMDUndenormalise(vol_step);
+
+    while (len--)
+    {
+        eF32x2 val = eSIMDLoad2(*sig1, *sig2);
+
+        val = eSIMDMul(
+                eSIMDMax(
+                    eSIMDMin(
+                        eSIMDMul(val, drv), 
+                        const_1
+                    ), 
+                    const_n1
+                ),
+                volume
+            );
+
+        eSIMDStore(val, sig1, sig2);
+        sig1++;
+        sig2++;
+
+        volume = eSIMDAdd(volume, vol_step);
+    }
 }
 
-void tfOscillator::processSingle(tfOscillator::SubOscState *state, eSignal **signals, eF32 volume, eU32 len)
+void tfOscillator::processSingle(const eF32 *samples, tfOscillator::SubOscState *state, eSignal **signals, eF32 volume, eU32 len)
 {
     eSignal *sig1 = signals[0];
     eSignal *sig2 = signals[1];
@@ -375,8 +417,8 @@ void tfOscillator::processSingle(tfOscillator::SubOscState *state, eSignal **sig
         eASSERT((state->phase2 >= 0.0f) && (state->phase2 <= 1.0f));
         eU32 spos1 = eFtoL(state->phase1 * (eF32)TF_OSCILLATOR_SAMPLES);
         eU32 spos2 = eFtoL(state->phase2 * (eF32)TF_OSCILLATOR_SAMPLES);
-        eSignal val1 = m_spline.m_samples[spos1];
-        eSignal val2 = m_spline.m_samples[spos2];
+        eSignal val1 = samples[spos1];
+        eSignal val2 = samples[spos2];
 
         *sig1++ += val1 * volume;
         *sig2++ += val2 * volume;
@@ -391,6 +433,283 @@ void tfOscillator::processSingle(tfOscillator::SubOscState *state, eSignal **sig
     }
 }
 
+#ifdef eUSE_SSE
+
+// Lane types of the voice interleaved oscillator
+// kernel, which runs one voice per lane. Table
+// lookups are done per lane, as neither SSE nor
+// AVX can gather.
+struct tfOscLanesSSE
+{
+    typedef __m128 Vec;
+    static const eU32 LANES = 4;
+
+    static eFORCEINLINE Vec set(eF32 v)             { return _mm_set1_ps(v); }
+    static eFORCEINLINE Vec load(const eF32 *v)     { return _mm_loadu_ps(v); }
+    static eFORCEINLINE void store(eF32 *v, Vec a)  { _mm_storeu_ps(v, a); }
+    static eFORCEINLINE Vec add(Vec a, Vec b)       { return _mm_add_ps(a, b); }
+    static eFORCEINLINE Vec mul(Vec a, Vec b)       { return _mm_mul_ps(a, b); }
+
+    static eFORCEINLINE Vec clip(Vec v, Vec one, Vec minusOne)
+    {
+        return _mm_max_ps(_mm_min_ps(v, one), minusOne);
+    }
+
+    // Subtracts one from all phases above one.
+    static eFORCEINLINE Vec wrap(Vec phase, Vec one)
+    {
+        return _mm_sub_ps(phase, _mm_and_ps(_mm_cmpgt_ps(phase, one), one));
+    }
+
+    // Converts like eFtoL(), which rounds on
+    // Windows and truncates elsewhere.
+    static eFORCEINLINE void toIndex(eInt *idx, Vec v)
+    {
+#ifdef _WIN32
+        _mm_storeu_si128((__m128i *)idx, _mm_cvtps_epi32(v));
+#else
+        _mm_storeu_si128((__m128i *)idx, _mm_cvttps_epi32(v));
+#endif
+    }
+
+    static eFORCEINLINE Vec gather(const eF32 * const *tables, const eInt *idx)
+    {
+        return _mm_setr_ps(tables[0][idx[0]], tables[1][idx[1]], tables[2][idx[2]], tables[3][idx[3]]);
+    }
+
+    static eFORCEINLINE Vec column(eSignal * const *ch, eU32 i)
+    {
+        return _mm_setr_ps(ch[0][i], ch[1][i], ch[2][i], ch[3][i]);
+    }
+
+    static eFORCEINLINE void scatter(eSignal * const *ch, eU32 i, Vec v)
+    {
+        eF32A out[4];
+        _mm_store_ps(out, v);
+
+        for (eU32 c=0; c<4; c++)
+        {
+            ch[c][i] = out[c];
+        }
+    }
+};
+
+#ifdef eUSE_AVX
+struct tfOscLanesAVX
+{
+    typedef __m256 Vec;
+    static const eU32 LANES = 8;
+
+    static eFORCEINLINE Vec set(eF32 v)             { return _mm256_set1_ps(v); }
+    static eFORCEINLINE Vec load(const eF32 *v)     { return _mm256_loadu_ps(v); }
+    static eFORCEINLINE void store(eF32 *v, Vec a)  { _mm256_storeu_ps(v, a); }
+    static eFORCEINLINE Vec add(Vec a, Vec b)       { return _mm256_add_ps(a, b); }
+    static eFORCEINLINE Vec mul(Vec a, Vec b)       { return _mm256_mul_ps(a, b); }
+
+    static eFORCEINLINE Vec clip(Vec v, Vec one, Vec minusOne)
+    {
+        return _mm256_max_ps(_mm256_min_ps(v, one), minusOne);
+    }
+
+    static eFORCEINLINE Vec wrap(Vec phase, Vec one)
+    {
+        return _mm256_sub_ps(phase, _mm256_and_ps(_mm256_cmp_ps(phase, one, _CMP_GT_OS), one));
+    }
+
+    static eFORCEINLINE void toIndex(eInt *idx, Vec v)
+    {
+#ifdef _WIN32
+        _mm256_storeu_si256((__m256i *)idx, _mm256_cvtps_epi32(v));
+#else
+        _mm256_storeu_si256((__m256i *)idx, _mm256_cvttps_epi32(v));
+#endif
+    }
+
+    static eFORCEINLINE Vec gather(const eF32 * const *tables, const eInt *idx)
+    {
+        return _mm256_setr_ps(tables[0][idx[0]], tables[1][idx[1]], tables[2][idx[2]], tables[3][idx[3]],
+                              tables[4][idx[4]], tables[5][idx[5]], tables[6][idx[6]], tables[7][idx[7]]);
+    }
+
+    static eFORCEINLINE Vec column(eSignal * const *ch, eU32 i)
+    {
+        return _mm256_setr_ps(ch[0][i], ch[1][i], ch[2][i], ch[3][i],
+                              ch[4][i], ch[5][i], ch[6][i], ch[7][i]);
+    }
+
+    static eFORCEINLINE void scatter(eSignal * const *ch, eU32 i, Vec v)
+    {
+        eF32 out[8];
+        _mm256_storeu_ps(out, v);
+
+        for (eU32 c=0; c<8; c++)
+        {
+            ch[c][i] = out[c];
+        }
+    }
+};
+#endif
+
+// Renders L::LANES prepared voices in chunks of
+// CHUNK samples. Per lane the sub-oscillators are
+// added in the same order and with the same
+// operations as in _processVoice(), so each lane
+// gives bit-identical results.
+template<class L> static void tfRunOscLanes(tfOscillator::Voice **voices, eU32 len)
+{
+    typedef typename L::Vec Vec;
+
+    const eU32 LANES = L::LANES;
+    const eU32 CHUNK = 64;
+    const tfOscillator::Voice &first = *voices[0];
+
+    const eF32 *tables[LANES];
+    eSignal *ch1[LANES];
+    eSignal *ch2[LANES];
+    eF32 drive[LANES], vol1[LANES], vol1Step[LANES], vol2[LANES], vol2Step[LANES];
+
+    for (eU32 v=0; v<LANES; v++)
+    {
+        const tfOscillator::Voice &voice = *voices[v];
+        eASSERT(voice.subosc == first.subosc && voice.unisono == first.unisono);
+
+        tables[v] = voice.samples;
+        ch1[v] = voice.signals[0];
+        ch2[v] = voice.signals[1];
+        drive[v] = voice.drive;
+        vol1[v] = voice.vol1;
+        vol1Step[v] = voice.vol1Step;
+        vol2[v] = voice.vol2;
+        vol2Step[v] = voice.vol2Step;
+    }
+
+    const Vec one = L::set(1.0f);
+    const Vec minusOne = L::set(-1.0f);
+    const Vec scale = L::set((eF32)TF_OSCILLATOR_SAMPLES);
+    const Vec drv = L::load(drive);
+    const Vec volStep1 = L::load(vol1Step);
+    const Vec volStep2 = L::load(vol2Step);
+    Vec volume1 = L::load(vol1);
+    Vec volume2 = L::load(vol2);
+
+    for (eU32 pos=0; pos<len; pos+=CHUNK)
+    {
+        const eU32 count = eMin(len-pos, CHUNK);
+        Vec acc1[CHUNK];
+        Vec acc2[CHUNK];
+
+        for (eU32 n=0; n<count; n++)
+        {
+            acc1[n] = L::column(ch1, pos+n);
+            acc2[n] = L::column(ch2, pos+n);
+        }
+
+        for (eU32 i=0; i<first.subosc; i++)
+        {
+            const Vec volume = L::set(1.0f / (i+1));
+
+            for (eU32 j=0; j<first.unisono; j++)
+            {
+                const eU32 index = j * TF_SUBOSC + i;
+                eF32 p1[LANES], p2[LANES], f1[LANES], f2[LANES];
+
+                for (eU32 v=0; v<LANES; v++)
+                {
+                    const tfOscillator::SubOscState &sostate = voices[v]->state->oscState[index];
+
+                    p1[v] = sostate.phase1;
+                    p2[v] = sostate.phase2;
+                    f1[v] = sostate.freq1;
+                    f2[v] = sostate.freq2;
+                }
+
+                Vec phase1 = L::load(p1);
+                Vec phase2 = L::load(p2);
+                const Vec freq1 = L::load(f1);
+                const Vec freq2 = L::load(f2);
+
+                for (eU32 n=0; n<count; n++)
+                {
+                    eInt spos1[LANES], spos2[LANES];
+                    L::toIndex(spos1, L::mul(phase1, scale));
+                    L::toIndex(spos2, L::mul(phase2, scale));
+
+                    acc1[n] = L::add(acc1[n], L::mul(L::gather(tables, spos1), volume));
+                    acc2[n] = L::add(acc2[n], L::mul(L::gather(tables, spos2), volume));
+
+                    phase1 = L::wrap(L::add(phase1, freq1), one);
+                    phase2 = L::wrap(L::add(phase2, freq2), one);
+                }
+
+                L::store(p1, phase1);
+                L::store(p2, phase2);
+
+                for (eU32 v=0; v<LANES; v++)
+                {
+                    tfOscillator::SubOscState &sostate = voices[v]->state->oscState[index];
+
+                    sostate.phase1 = p1[v];
+                    sostate.phase2 = p2[v];
+                }
+            }
+        }
+
+        for (eU32 n=0; n<count; n++)
+        {
+            L::scatter(ch1, pos+n, L::mul(L::clip(L::mul(acc1[n], drv), one, minusOne), volume1));
+            L::scatter(ch2, pos+n, L::mul(L::clip(L::mul(acc2[n], drv), one, minusOne), volume2));
+
+            volume1 = L::add(volume1, volStep1);
+            volume2 = L::add(volume2, volStep2);
+        }
+    }
+}
+
+#endif
+
+// Renders count prepared voices into their signals.
+// All voices need the same sub-oscillator and
+// unisono counts. With SSE up to VOICE_LANES voices
+// are rendered at once, unused lanes repeat the
+// last voice of a group. A single voice is faster
+// without lanes.
+void tfOscillator::processVoices(Voice **voices, eU32 count, eU32 len)
+{
+#ifdef eUSE_SSE
+    for (eU32 first=0; first<count; first+=VOICE_LANES)
+    {
+        const eU32 used = eMin(count-first, VOICE_LANES);
+        Voice *laneVoices[VOICE_LANES];
+
+        if (used == 1)
+        {
+            _processVoice(*voices[first], len);
+            continue;
+        }
+
+        for (eU32 i=0; i<VOICE_LANES; i++)
+        {
+            laneVoices[i] = voices[first+eMin(i, used-1)];
+        }
+
+#ifdef eUSE_AVX
+        if (used > tfOscLanesSSE::LANES)
+        {
+            tfRunOscLanes<tfOscLanesAVX>(laneVoices, len);
+            continue;
+        }
+#endif
+
+        tfRunOscLanes<tfOscLanesSSE>(laneVoices, len);
+    }
+#else
+    for (eU32 i=0; i<count; i++)
+    {
+        _processVoice(*voices[i], len);
+    }
+#endif
+}
+
 const tfSpline & tfOscillator::getSpline() const
 {
     return m_spline;
@@ -95,16 +95,47 @@ public:
 		SubOscState oscState[(TF_SUBOSC+1) * TF_MAXUNISONO];
 	};
 
+    // Everything one voice needs to render a
+    // block. Filled by prepare(), which also keeps
+    // a copy of the voice's spline samples, as the
+    // spline is shared by all voices.
+    struct Voice
+    {
+        State *     state;
+        eSignal *   signals[2];
+        eU32        subosc;
+        eU32        unisono;
+        eF32        drive;
+        eF32        vol1;
+        eF32        vol1Step;
+        eF32        vol2;
+        eF32        vol2Step;
+        eF32        samples[TF_OSCILLATOR_SAMPLES + 1];
+    };
+
+#ifdef eUSE_AVX
+    static const eU32   VOICE_LANES = 8;
+#else
+    static const eU32   VOICE_LANES = 4;
+#endif
+
 public:
     eBool               process(tfOscillator::State *state, tfModMatrix *modMatrix, 
                                 tfModMatrix::State *modMatrixState, eF32 *params, 
                                 eSignal **signals, eU32 len, eF32 baseFreq, eF32 velocity, eU32 oversamplingCount);
 
-    void                processSingle(tfOscillator::SubOscState *sostate, eSignal **signals, eF32 volume, eU32 len);
+    eBool               prepare(Voice &voice, tfOscillator::State *state, tfModMatrix *modMatrix, 
+                                tfModMatrix::State *modMatrixState, eF32 *params, 
+                                eU32 len, eF32 baseFreq, eF32 velocity, eU32 oversamplingCount);
+    void                processVoices(Voice **voices, eU32 count, eU32 len);
+    void                processSingle(const eF32 *samples, tfOscillator::SubOscState *sostate, eSignal **signals, eF32 volume, eU32 len);
 
     const tfSpline &	getSpline() const;
     tfSpline &			getSpline();
 
+private:
+    void                _processVoice(const Voice &voice, eU32 len);
+
 private:
     tfSpline			m_spline;
 };
@@ -0,0 +1,813 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *
+ *    ------  /   /  /\   /  /---  -----  /  ----  /   /
+ *       /   /   /  /  \ /  /---   -/-   /   \--  /---/   version 3
+ *      /    \---  /    /  /---    /    /  ----/ /   /.
+ *
+ *       t i n y   m u s i c   s y n t h e s i z e r
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ePLAYER
+#include <stdio.h>
+#endif
+
+#include "../system/system.hpp"
+#include "../math/math.hpp"
+#include "tunefish3.hpp"
+
+#ifndef NO_ADDSYNTH
+
+// Complex FFT of count (power of 2) interleaved
+// values. The twiddles hold count/2 complex
+// factors e^(i*2*pi*k/count).
+static void tfComplexFft(eF32 *data, eU32 count, const eF32 *twiddles)
+{
+    for (eU32 i=1, j=0; i<count; i++)
+    {
+        eU32 bit = count>>1;
+
+        for (; j&bit; bit>>=1)
+        {
+            j ^= bit;
+        }
+
+        j ^= bit;
+
+        if (i < j)
+        {
+            eSwap(data[i*2], data[j*2]);
+            eSwap(data[i*2+1], data[j*2+1]);
+        }
+    }
+
+    for (eU32 size=2; size<=count; size<<=1)
+    {
+        const eU32 half = size>>1;
+        const eU32 step = count/size;
+
+        for (eU32 k=0; k<half; k++)
+        {
+            const eF32 wr = twiddles[k*step*2];
+            const eF32 wi = twiddles[k*step*2+1];
+
+            for (eU32 a=k; a<count; a+=size)
+            {
+                eF32 *p1 = data+a*2;
+                eF32 *p2 = p1+half*2;
+
+                const eF32 tr = p2[0]*wr-p2[1]*wi;
+                const eF32 ti = p2[0]*wi+p2[1]*wr;
+
+                p2[0] = p1[0]-tr;
+                p2[1] = p1[1]-ti;
+                p1[0] += tr;
+                p1[1] += ti;
+            }
+        }
+    }
+}
+
+// Calculates the real part of the (not normalized)
+// inverse transform of the count complex values of
+// spectrum. As the result is real, only a complex
+// FFT of half the size is required: the spectrum
+// is folded into a hermitian one, whose even and
+// odd samples are calculated together.
+static void tfRealInverseFft(const eF32 *spectrum, eU32 count, eF32 *samples)
+{
+    eASSERT(eIsPowerOf2(count));
+
+    const eU32 half = count/2;
+
+    // Twiddles for the full size, the half sized
+    // complex FFT uses every second one of them.
+    eArray<eF32> twiddles(count);
+
+    for (eU32 i=0; i<half; i++)
+    {
+        const eF32 arg = eTWOPI*(eF32)i/(eF32)count;
+
+        twiddles[i*2] = eCos(arg);
+        twiddles[i*2+1] = eSin(arg);
+    }
+
+    eArray<eF32> halfTwiddles(half);
+
+    for (eU32 i=0; i<half/2; i++)
+    {
+        halfTwiddles[i*2] = twiddles[i*4];
+        halfTwiddles[i*2+1] = twiddles[i*4+1];
+    }
+
+    // hermitian spectrum h[k] = (x[k]+conj(x[count-k]))/2
+    // for k = 0..count/2
+    eArray<eF32> herm(half*2+2);
+
+    for (eU32 k=0; k<=half; k++)
+    {
+        const eU32 m = (count-k)&(count-1);
+
+        herm[k*2] = (spectrum[k*2]+spectrum[m*2])*0.5f;
+        herm[k*2+1] = (spectrum[k*2+1]-spectrum[m*2+1])*0.5f;
+    }
+
+    // z[k] = (h[k]+conj(h[half-k])) + i*w^k*(h[k]-conj(h[half-k]))
+    // holds even samples in the real part and
+    // odd samples in the imaginary part.
+    eArray<eF32> z(half*2);
+
+    for (eU32 k=0; k<half; k++)
+    {
+        const eF32 *h0 = &herm[k*2];
+        const eF32 *h1 = &herm[(half-k)*2];
+
+        const eF32 er = h0[0]+h1[0];
+        const eF32 ei = h0[1]-h1[1];
+        const eF32 dr = h0[0]-h1[0];
+        const eF32 di = h0[1]+h1[1];
+
+        const eF32 wr = twiddles[k*2];
+        const eF32 wi = twiddles[k*2+1];
+
+        const eF32 odr = dr*wr-di*wi;
+        const eF32 odi = dr*wi+di*wr;
+
+        z[k*2] = er-odi;
+        z[k*2+1] = ei+odr;
+    }
+
+    tfComplexFft(&z[0], half, &halfTwiddles[0]);
+
+    eMemCopy(samples, &z[0], count*sizeof(eF32));
+}
+
+static eF32 tfProfileGauss(eF32 fi, eF32 bwi)
+{
+    eF32 x=fi/bwi;
+    x*=x;
+    //this avoids computing the e^(-x^2) where it's results are very close to zero
+    if (x>14.71280603) return 0.0;
+    return eExp(-x)/bwi;
+}
+
+static eF32 tfProfileSingle(eF32 fi, eF32 bwi)
+{
+    eF32 x=fi/bwi;
+    if (x>0.1f || x < -0.1f) return 0.0f;
+    return 1.0f/bwi;
+}
+
+static eF32 tfProfileDetune(eF32 fi, eF32 bwi)
+{
+    eF32 x=fi/bwi;
+    if (x<-0.5f || (x > -0.4f && x < 0.4f) || x > 0.5f) return 0.0f;
+    return 1.0f/bwi;
+}
+
+static eF32 tfProfileSpread(eF32 fi, eF32 bwi)
+{
+    eF32 x=fi/bwi;
+    if (x>5.0f || x < -5.0f) return 0.0f;
+    return 1.0f/bwi;
+}
+
+tfPadSynthCache::tfPadSynthCache() :
+    m_tables(eNULL),
+    m_requestCount(0),
+    m_useCounter(0),
+    m_pinning(eFALSE),
+    m_thread(eNULL),
+    m_quit(eFALSE)
+{
+#ifndef ePLAYER
+    eStrClear(m_dir);
+#endif
+}
+
+// Doesn't stop the builder: the cache is a static
+// object, so it's destroyed while the module gets
+// unloaded. Joining a thread there deadlocks on
+// the loader lock when the synth runs as plugin,
+// so shutdown() has to be called before. If it
+// wasn't, the tables are left to the process.
+tfPadSynthCache::~tfPadSynthCache()
+{
+    if (!m_thread)
+    {
+        _freeTables(m_tables);
+    }
+}
+
+// Starts the builder thread, if it's not running.
+// Has to be called on the main thread before any
+// table is acquired.
+void tfPadSynthCache::start()
+{
+    if (!m_thread)
+    {
+        m_quit = eFALSE;
+        m_thread = eThreadStart(_threadProc, this, eFALSE);
+    }
+}
+
+// Stops the builder thread and frees all unused
+// tables. The builder is started again by start().
+void tfPadSynthCache::shutdown()
+{
+    if (m_thread)
+    {
+        m_quit = eTRUE;
+        m_requestsAvail.signal();
+        eThreadEnd(m_thread, eTRUE);
+        m_thread = eNULL;
+    }
+
+    m_lock.enter();
+    Table *unused = _removeUnusedTables(0);
+    m_lock.leave();
+
+    _freeTables(unused);
+}
+
+// Returns the table for the given key or null,
+// if it isn't built yet. In the latter case the
+// table is requested from the builder, so the
+// caller has to ask again later. On success the
+// replaced table is released. Unless waiting for
+// the lock is requested, null is returned too if
+// the cache is busy, so the audio thread never
+// blocks. Doesn't allocate or free memory.
+const tfPadSynthCache::Table * tfPadSynthCache::acquire(const Key &key, const Table *replaced, eBool wait)
+{
+    if (wait)
+    {
+        m_lock.enter();
+    }
+    else if (!m_lock.tryEnter())
+    {
+        return eNULL;
+    }
+
+    for (Table *table=m_tables; table; table=table->next)
+    {
+        if (eMemEqual(&table->key, &key, sizeof(Key)))
+        {
+            table->refCount++;
+            table->lastUse = ++m_useCounter;
+
+            if (replaced)
+            {
+                eASSERT(replaced->refCount > 0);
+                ((Table *)replaced)->refCount--;
+            }
+
+            m_lock.leave();
+            return table;
+        }
+    }
+
+    const eBool requested = (_findRequest(key) == -1);
+
+    if (requested)
+    {
+        _addRequest(key);
+    }
+
+    m_lock.leave();
+
+    if (requested)
+    {
+        m_requestsAvail.signal();
+    }
+
+    return eNULL;
+}
+
+// Only drops the reference, unused tables are
+// freed by the builder.
+void tfPadSynthCache::release(const Table *table)
+{
+    if (table)
+    {
+        m_lock.enter();
+        eASSERT(table->refCount > 0);
+        ((Table *)table)->refCount--;
+        m_lock.leave();
+    }
+}
+
+// Waits until all requested tables are built.
+// The calling thread helps building, so loading
+// instruments builds two tables at once.
+void tfPadSynthCache::flush()
+{
+    while (eTRUE)
+    {
+        if (!_buildNext())
+        {
+            m_lock.enter();
+            const eBool done = (m_requestCount == 0);
+            m_lock.leave();
+
+            if (done)
+            {
+                break;
+            }
+
+            eSleep(1);
+        }
+    }
+}
+
+// While pinning is enabled, the cached tables and
+// all tables built are kept referenced. Loading
+// a song enables it, so no table is evicted before
+// the instrument which requested it acquires it.
+void tfPadSynthCache::setPinning(eBool pinning)
+{
+    Table *unused = eNULL;
+
+    m_lock.enter();
+
+    if (pinning != m_pinning)
+    {
+        m_pinning = pinning;
+
+        for (Table *table=m_tables; table; table=table->next)
+        {
+            if (pinning && !table->pinned)
+            {
+                table->refCount++;
+                table->pinned = eTRUE;
+            }
+            else if (!pinning && table->pinned)
+            {
+                eASSERT(table->refCount > 0);
+                table->refCount--;
+                table->pinned = eFALSE;
+            }
+        }
+
+        if (!pinning)
+        {
+            unused = _removeUnusedTables(MAX_UNUSED_TABLES);
+        }
+    }
+
+    m_lock.leave();
+
+    _freeTables(unused);
+}
+
+#ifndef ePLAYER
+// An empty directory disables the disk cache,
+// as well as a directory whose path is too long
+// for the table file names.
+void tfPadSynthCache::setDirectory(const eChar *dir)
+{
+    eASSERT(dir != eNULL);
+
+    m_lock.enter();
+
+    if (eStrLength(dir)+32 <= MAX_PATH_LENGTH)
+    {
+        eStrCopy(m_dir, dir);
+    }
+    else
+    {
+        eStrClear(m_dir);
+    }
+
+    m_lock.leave();
+}
+#endif
+
+tfPadSynthCache & tfPadSynthCache::get()
+{
+    static tfPadSynthCache cache;
+    return cache;
+}
+
+// Builds the newest pending request, so while
+// a parameter is changed live the most recent
+// setting gets audible first. Returns false if
+// there was no request to build.
+eBool tfPadSynthCache::_buildNext()
+{
+    m_lock.enter();
+
+    eInt index = (eInt)m_requestCount-1;
+
+    while (index >= 0 && m_requests[index].building)
+    {
+        index--;
+    }
+
+    if (index < 0)
+    {
+        m_lock.leave();
+        return eFALSE;
+    }
+
+    m_requests[index].building = eTRUE;
+
+    const Key key = m_requests[index].key;
+    m_lock.leave();
+
+    Table *table = new Table;
+    eASSERT(table != eNULL);
+
+    table->key = key;
+    table->samples = new eF32[TABLE_SIZE+1];
+    eASSERT(table->samples != eNULL);
+
+#ifndef ePLAYER
+    if (!_loadTable(*table))
+    {
+        _generate(table->key, table->samples);
+        _storeTable(*table);
+    }
+#else
+    _generate(table->key, table->samples);
+#endif
+
+    m_lock.enter();
+
+    index = _findRequest(table->key);
+    eASSERT(index != -1);
+
+    m_requestCount--;
+
+    for (eU32 i=index; i<m_requestCount; i++)
+    {
+        m_requests[i] = m_requests[i+1];
+    }
+
+    table->refCount = (m_pinning ? 1 : 0);
+    table->pinned = m_pinning;
+    table->lastUse = ++m_useCounter;
+    table->next = m_tables;
+    m_tables = table;
+
+    Table *unused = _removeUnusedTables(MAX_UNUSED_TABLES);
+    m_lock.leave();
+
+    _freeTables(unused);
+    return eTRUE;
+}
+
+eInt tfPadSynthCache::_findRequest(const Key &key) const
+{
+    for (eU32 i=0; i<m_requestCount; i++)
+    {
+        if (eMemEqual(&m_requests[i].key, &key, sizeof(Key)))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// If the queue is full, the oldest request which
+// isn't built yet is dropped. Requests are made
+// again as long as a table is missing, so dropped
+// ones are only outdated parameter settings.
+void tfPadSynthCache::_addRequest(const Key &key)
+{
+    if (m_requestCount == MAX_REQUESTS)
+    {
+        eU32 oldest = 0;
+
+        while (oldest < m_requestCount && m_requests[oldest].building)
+        {
+            oldest++;
+        }
+
+        if (oldest == m_requestCount)
+        {
+            return;
+        }
+
+        m_requestCount--;
+
+        for (eU32 i=oldest; i<m_requestCount; i++)
+        {
+            m_requests[i] = m_requests[i+1];
+        }
+    }
+
+    Request &req = m_requests[m_requestCount++];
+
+    req.key = key;
+    req.building = eFALSE;
+}
+
+// Unlinks the least recently used tables, which
+// aren't used by any instrument anymore, until at
+// most maxUnused of them are left. The unlinked
+// tables are returned, so that they can be freed
+// outside of the lock.
+tfPadSynthCache::Table * tfPadSynthCache::_removeUnusedTables(eU32 maxUnused)
+{
+    Table *removed = eNULL;
+
+    while (eTRUE)
+    {
+        eU32 unusedCount = 0;
+        Table **lru = eNULL;
+
+        for (Table **link=&m_tables; *link; link=&(*link)->next)
+        {
+            const Table *table = *link;
+
+            if (table->refCount == 0)
+            {
+                unusedCount++;
+
+                if (!lru || table->lastUse < (*lru)->lastUse)
+                {
+                    lru = link;
+                }
+            }
+        }
+
+        if (unusedCount <= maxUnused)
+        {
+            break;
+        }
+
+        Table *table = *lru;
+        *lru = table->next;
+        table->next = removed;
+        removed = table;
+    }
+
+    return removed;
+}
+
+void tfPadSynthCache::_freeTables(Table *tables)
+{
+    while (tables)
+    {
+        Table *table = tables;
+        tables = table->next;
+
+        eASSERT(table->refCount == 0);
+        eSAFE_DELETE_ARRAY(table->samples);
+        eSAFE_DELETE(table);
+    }
+}
+
+#ifndef ePLAYER
+// Stored format: magic, version, the key and
+// the table's samples.
+eBool tfPadSynthCache::_loadTable(Table &table) const
+{
+    eChar fileName[MAX_PATH_LENGTH];
+    _getFileName(table.key, fileName);
+
+    if (eStrLength(fileName) == 0)
+    {
+        return eFALSE;
+    }
+
+    FILE *f = fopen(fileName, "rb");
+
+    if (!f)
+    {
+        return eFALSE;
+    }
+
+    eU32 header[2];
+    Key key;
+
+    const eBool ok = (fread(header, sizeof(header), 1, f) == 1 &&
+                      header[0] == FILE_MAGIC &&
+                      header[1] == FILE_VERSION &&
+                      fread(&key, sizeof(key), 1, f) == 1 &&
+                      eMemEqual(&key, &table.key, sizeof(Key)) &&
+                      fread(table.samples, sizeof(eF32), TABLE_SIZE+1, f) == TABLE_SIZE+1);
+
+    fclose(f);
+    return ok;
+}
+
+// The table is written to a temporary file first,
+// so that an interrupted write can never leave a
+// truncated table behind.
+void tfPadSynthCache::_storeTable(const Table &table) const
+{
+    eChar fileName[MAX_PATH_LENGTH];
+    _getFileName(table.key, fileName);
+
+    if (eStrLength(fileName) == 0)
+    {
+        return;
+    }
+
+    eChar tempName[MAX_PATH_LENGTH];
+    eStrCopy(tempName, fileName);
+    eStrAppend(tempName, ".tmp");
+
+    FILE *f = fopen(tempName, "wb");
+
+    if (!f)
+    {
+        return;
+    }
+
+    const eU32 header[2] =
+    {
+        FILE_MAGIC,
+        FILE_VERSION
+    };
+
+    eBool ok = (fwrite(header, sizeof(header), 1, f) == 1 &&
+                fwrite(&table.key, sizeof(Key), 1, f) == 1 &&
+                fwrite(table.samples, sizeof(eF32), TABLE_SIZE+1, f) == TABLE_SIZE+1);
+
+    ok = (fclose(f) == 0 && ok);
+
+    if (!ok || rename(tempName, fileName) != 0)
+    {
+        remove(tempName);
+    }
+}
+
+// Returns an empty file name if the disk cache
+// is disabled.
+void tfPadSynthCache::_getFileName(const Key &key, eChar *fileName) const
+{
+    static const eChar HEX_DIGITS[] = "0123456789abcdef";
+
+    m_lock.enter();
+    eStrCopy(fileName, m_dir);
+    m_lock.leave();
+
+    if (eStrLength(fileName) == 0)
+    {
+        return;
+    }
+
+    eU64 hash = _hashKey(key);
+    eChar name[22];
+
+    for (eInt i=15; i>=0; i--)
+    {
+        name[i] = HEX_DIGITS[hash&15];
+        hash >>= 4;
+    }
+
+    eStrCopy(name+16, ".pad");
+    eStrAppend(fileName, name);
+}
+#endif
+
+// Calculates the table using the PADsynth algorithm:
+// the amplitude spectrum of all harmonics is built
+// from the band profile, random phases are added
+// and the spectrum is transformed back. Phases are
+// seeded by the key, so tables are reproducible.
+void tfPadSynthCache::_generate(const Key &key, eF32 *samples)
+{
+    const eU32 N = TF_ADDSYNTHTABLESIZE;
+    const eU32 NH = N/2;
+
+    const eF32 baseFreq = tfInstrument::m_freqTable[29];
+    const eInt maxHarmonics = eFtoL(key.sampleRate/baseFreq);
+    const eInt harmonicCount = 16+eMin(eFtoL(key.harmonics*255), maxHarmonics);
+
+    eArray<eF32> amps(harmonicCount);
+    amps[0] = 0.0f;
+
+    for (eInt i=1; i<harmonicCount; i+=2)
+    {
+        amps[i] = 1.0f/(1.0f+i*(1.0f-key.damp));
+    }
+
+    for (eInt i=2; i<harmonicCount; i+=2)
+    {
+        amps[i] = 2.0f/(1.0f+i*(1.0f-key.damp));
+    }
+
+    // Profiles are zero beyond width*bwi, so each
+    // harmonic only touches few bins. The profile
+    // function still decides for all bins in the
+    // range, the range just leaves out the zeros.
+    eF32 (*profileFunc)(eF32 fi, eF32 bwi);
+    eF32 profileWidth;
+
+    switch (key.profile)
+    {
+    default:
+    case 0: profileFunc = tfProfileSingle; profileWidth = 0.1f; break;
+    case 1: profileFunc = tfProfileDetune; profileWidth = 0.5f; break;
+    case 2: profileFunc = tfProfileSpread; profileWidth = 5.0f; break;
+    case 3: profileFunc = tfProfileGauss;  profileWidth = 3.8358f; break;
+    }
+
+    eArray<eF32> freqAmps(NH);
+    eMemSet(&freqAmps[0], 0, NH*sizeof(eF32));
+
+    const eF32 recsr = 1.0f/key.sampleRate;
+    const eF32 recdsr = recsr/2.0f;
+    const eF32 Nrec = 1.0f/(eF32)N;
+    const eF32 precalcbw = (ePow(2.0f, key.bandwidth*256.0f/1200.0f)-1.0f)*baseFreq;
+    const eF32 bwscale = key.bwScale*19.0f+1.0f;
+
+    for (eInt nh=1; nh<harmonicCount; nh++)
+    {
+        const eF32 bw_Hz = precalcbw*ePow((eF32)nh, bwscale);
+        const eF32 bwi = bw_Hz*recdsr;
+        const eF32 fi = baseFreq*nh*recsr;
+
+        eU32 first = 0;
+        eU32 last = NH;
+
+        if (bwi > 0.0f)
+        {
+            const eF32 range = profileWidth*1.01f*bwi;
+            first = eFtoL(eClamp(0.0f, (fi-range)*N-1.0f, (eF32)NH));
+            last = eFtoL(eClamp(0.0f, (fi+range)*N+2.0f, (eF32)NH));
+        }
+
+        for (eU32 i=first; i<last; i++)
+        {
+            freqAmps[i] += profileFunc((i*Nrec)-fi, bwi)*amps[nh];
+        }
+    }
+
+    // Add random phases.
+    eArray<eF32> spectrum(NH*2);
+    eU32 seed = (eU32)(_hashKey(key)%0x7ffffffe)+1;
+
+    for (eU32 i=0; i<NH; i++)
+    {
+        const eF32 phase = eRandomF(0.0f, eTWOPI, seed);
+
+        spectrum[i*2] = freqAmps[i]*eCos(phase);
+        spectrum[i*2+1] = freqAmps[i]*eSin(phase);
+    }
+
+    tfRealInverseFft(&spectrum[0], NH, samples);
+
+    // Normalize.
+    eF32 max = 0.0f;
+
+    for (eU32 i=0; i<NH; i++)
+    {
+        max = eMax(max, eAbs(samples[i]));
+    }
+
+    const eF32 scale = 1.0f/(eMax(max, 1e-5f)*1.4142f);
+
+    for (eU32 i=0; i<NH; i++)
+    {
+        samples[i] *= scale;
+    }
+
+    samples[NH] = samples[0];
+}
+
+// 64-bit FNV-1a hash of the key.
+eU64 tfPadSynthCache::_hashKey(const Key &key)
+{
+    const eU8 *bytes = (const eU8 *)&key;
+    eU64 hash = 14695981039346656037ULL;
+
+    for (eU32 i=0; i<sizeof(Key); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+void tfPadSynthCache::_threadProc(ePtr arg)
+{
+    tfPadSynthCache *cache = (tfPadSynthCache *)arg;
+    eASSERT(cache != eNULL);
+
+    while (eTRUE)
+    {
+        cache->m_requestsAvail.wait();
+
+        if (cache->m_quit)
+        {
+            break;
+        }
+
+        while (!cache->m_quit && cache->_buildNext())
+        {
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,127 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *   This file is part of
+ *
+ *    ------  /   /  /\   /  /---  -----  /  ----  /   /
+ *       /   /   /  /  \ /  /---   -/-   /   \--  /---/   version 3
+ *      /    \---  /    /  /---    /    /  ----/ /   /.
+ *
+ *       t i n y   m u s i c   s y n t h e s i z e r
+ *
+ *   Copyright  2003-2010 Brain Control, all rights reserved.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TF_PAD_SYNTH_HPP
+#define TF_PAD_SYNTH_HPP
+
+#ifndef NO_ADDSYNTH
+
+// Builds and caches the PADsynth wavetables of
+// the additive synthesizer. Tables are built by
+// a background thread, so the audio thread never
+// allocates memory or runs the FFT. Instruments
+// with the same settings share one table. Unused
+// tables are kept in memory for a while and, if
+// a directory is set, stored on disk. Memory is
+// never allocated or freed inside the lock. The
+// builder has to be stopped by shutdown() before
+// the application (or plugin) is unloaded.
+class tfPadSynthCache
+{
+public:
+    struct Key
+    {
+        eF32                bandwidth;
+        eF32                damp;
+        eF32                harmonics;
+        eF32                bwScale;
+        eU32                profile;
+        eU32                sampleRate;
+    };
+
+    struct Table
+    {
+        Key                 key;
+        eF32 *              samples; // TABLE_SIZE+1 samples, last one wraps.
+        eU32                refCount;
+        eU32                lastUse;
+        eBool               pinned;
+        Table *             next;
+    };
+
+public:
+    tfPadSynthCache();
+    ~tfPadSynthCache();
+
+    void                    start();
+    void                    shutdown();
+
+    const Table *           acquire(const Key &key, const Table *replaced, eBool wait);
+    void                    release(const Table *table);
+    void                    flush();
+    void                    setPinning(eBool pinning);
+
+#ifndef ePLAYER
+    void                    setDirectory(const eChar *dir);
+#endif
+
+public:
+    static tfPadSynthCache &get();
+
+public:
+    static const eU32       TABLE_SIZE = TF_ADDSYNTHTABLESIZE/2;
+
+private:
+    struct Request
+    {
+        Key                 key;
+        eBool               building;
+    };
+
+private:
+    eBool                   _buildNext();
+    eInt                    _findRequest(const Key &key) const;
+    void                    _addRequest(const Key &key);
+    Table *                 _removeUnusedTables(eU32 maxUnused);
+
+#ifndef ePLAYER
+    eBool                   _loadTable(Table &table) const;
+    void                    _storeTable(const Table &table) const;
+    void                    _getFileName(const Key &key, eChar *fileName) const;
+#endif
+
+    static void             _freeTables(Table *tables);
+    static void             _generate(const Key &key, eF32 *samples);
+    static eU64             _hashKey(const Key &key);
+    static void             _threadProc(ePtr arg);
+
+private:
+    static const eU32       MAX_REQUESTS = TF_MAX_INPUTS*2;
+    static const eU32       MAX_UNUSED_TABLES = 16;
+
+#ifndef ePLAYER
+    static const eU32       FILE_MAGIC = 0x64615066;
+    static const eU32       FILE_VERSION = 1;
+    static const eU32       MAX_PATH_LENGTH = 260;
+#endif
+
+private:
+    Table *                 m_tables;
+    Request                 m_requests[MAX_REQUESTS];
+    eU32                    m_requestCount;
+    eU32                    m_useCounter;
+    eBool                   m_pinning;
+    eCriticalSection        m_lock;
+    eSemaphore              m_requestsAvail;
+    ePtr                    m_thread;
+    volatile eBool          m_quit;
+
+#ifndef ePLAYER
+    eChar                   m_dir[MAX_PATH_LENGTH];
+#endif
+};
+
+#endif
+
+#endif // TF_PAD_SYNTH_HPP
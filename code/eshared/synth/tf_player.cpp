@@ -14,10 +14,17 @@
 
 #ifndef eHWSYNTH
 
-#include "../eshared.hpp"
+#include "../system/system.hpp"
+#include "../math/math.hpp"
+#include "tunefish3.hpp"
+
 #include <stdio.h>
 
-tfPlayer::tfPlayer(tfISoundOut *soundOut) :
+// Without real-time the player neither starts its
+// audio thread nor throttles on the sound output.
+// Instead the caller renders blocks as fast as
+// possible using renderOffline().
+tfPlayer::tfPlayer(tfISoundOut *soundOut, eBool realTime) :
     m_row(0),
     m_playing(eFALSE),
     m_joinRequest(eFALSE),
@@ -27,13 +34,29 @@ tfPlayer::tfPlayer(tfISoundOut *soundOut) :
     m_sampleRate(44100),
     m_time(0),
     m_soundOut(soundOut),
+    m_realTime(realTime),
+    m_segmentBlocks(realTime ? 1 : TF_PLAYER_OFFLINE_BLOCKS),
+    m_renderBlocks(0),
     m_mute(eFALSE),
     m_volume(1.0f),
-    m_masterPeak(0.0f)
+    m_masterPeak(0.0f),
+    m_loopStartRow(0),
+    m_loopEndRow(0),
+    m_workerCount(0),
+    m_workersQuit(eFALSE),
+    m_renderClaim(0),
+    m_renderDone(0),
+    m_renderCount(0),
+    m_segment(0),
+    m_instrPerCore(0.0f),
+    m_instrSerial(0),
+    m_instrSerialDone(0),
+    m_retiredCount(0)
 {
     eASSERT(soundOut != eNULL);
 
     eMemSet(m_instruments, 0, TF_MAX_INPUTS * sizeof(tfInstrument *));
+    eMemSet(m_playInstruments, 0, TF_MAX_INPUTS * sizeof(tfInstrument *));
     eMemSet(m_peakInstrMemory, 0, TF_MAX_INPUTS * TF_PLAYER_PEAK_MEMORY * sizeof(eF32));
     eMemSet(m_masterPeakMemory, 0, TF_PLAYER_PEAK_MEMORY * sizeof(eF32));
     eMemSet(m_peakInstr, 0, TF_MAX_INPUTS * sizeof(eF32));
@@ -41,31 +64,52 @@ tfPlayer::tfPlayer(tfISoundOut *soundOut) :
     eMemSet(m_muted, 0, tfSong::MAX_SEQ_TRACKS * sizeof(eBool));
 	eMemSet(m_instrumentPatternTrack, 0, TF_MAX_INPUTS * sizeof(eU32));
 	eMemSet(m_lastEvents, 0, tfSong::MAX_SEQ_TRACKS * tfSong::MAX_PATTERN_TRACKS * sizeof(tfSong::NoteEvent));
+    eMemSet(m_instrTicks, 0, TF_MAX_INPUTS * sizeof(eU64));
 
     m_outputSignal[0] = new eSignal[TF_BLOCKSIZE];
     m_outputSignal[1] = new eSignal[TF_BLOCKSIZE];
-	m_tempSignal[0] = new eSignal[TF_BLOCKSIZE];
-    m_tempSignal[1] = new eSignal[TF_BLOCKSIZE];
+    m_instrSignals = new eSignal[TF_MAX_INPUTS*m_segmentBlocks*2*TF_BLOCKSIZE];
+    m_instrPeaks = new eF32[TF_MAX_INPUTS*m_segmentBlocks];
     m_outputFinal = new eS16[TF_BLOCKSIZE*2];
 
-    _startThread();
-    m_soundOut->play();
+    eMemSet(m_instrPeaks, 0, TF_MAX_INPUTS*m_segmentBlocks*sizeof(eF32));
+
+    _startWorkers();
+
+    if (m_realTime)
+    {
+        _startThread();
+        m_soundOut->play();
+    }
 }
 
 tfPlayer::~tfPlayer()
 {
-    m_soundOut->stop();
-    _stopThread();
+    if (m_realTime)
+    {
+        m_soundOut->stop();
+        _stopThread();
+    }
+
+    _stopWorkers();
 
+    // Nothing renders anymore, so the retired
+    // instruments can be deleted, too.
     clearInstruments();
+    m_instrSerialDone = m_instrSerial;
+    _deleteRetired();
 
     eSAFE_DELETE_ARRAY(m_outputSignal[0]);
     eSAFE_DELETE_ARRAY(m_outputSignal[1]);
-	eSAFE_DELETE_ARRAY(m_tempSignal[0]);
-    eSAFE_DELETE_ARRAY(m_tempSignal[1]);
+    eSAFE_DELETE_ARRAY(m_instrSignals);
+    eSAFE_DELETE_ARRAY(m_instrPeaks);
     eSAFE_DELETE_ARRAY(m_outputFinal);
 }
 
+// Instruments are added and removed without
+// locking the audio thread out. It picks up the
+// change with the next block. Removed instruments
+// are deleted once it did so.
 void tfPlayer::addInstrument(eU32 index)
 {
     eASSERT(index >= 0 && index < TF_MAX_INPUTS);
@@ -76,13 +120,21 @@ void tfPlayer::addInstrument(eU32 index)
         eASSERT(instr != eNULL);
 		
         m_instruments[index] = instr;
+        _publishInstrument(index);
     }
 }
 
 void tfPlayer::removeInstrument(eU32 index)
 {
     eASSERT(index >= 0 && index < TF_MAX_INPUTS);
-    eSAFE_DELETE(m_instruments[index]);
+
+    tfInstrument *instr = m_instruments[index];
+
+    if (instr)
+    {
+        m_instruments[index] = eNULL;
+        _retireInstrument(instr, _publishInstrument(index));
+    }
 }
 
 tfInstrument * tfPlayer::getInstrument(eU32 index)
@@ -97,6 +149,8 @@ void tfPlayer::loadInstruments(eDataStream &stream)
 {
     clearInstruments();
 
+    // Instruments are published after they were
+    // loaded completely.
     for (eU8 i=0; i<TF_MAX_INPUTS; i++)
     {
         if (stream.readByte())
@@ -130,12 +184,38 @@ void tfPlayer::loadInstruments(eDataStream &stream)
         }
     }
 
+#ifndef NO_ADDSYNTH
+    // Built tables stay pinned until all of them
+    // are acquired, as a song can use more tables
+    // than the cache keeps unused.
+    tfPadSynthCache::get().setPinning(eTRUE);
+#endif
+
     for (eU8 i=0; i<TF_MAX_INPUTS; i++)
     {
         if (m_instruments[i])
             m_instruments[i]->updateAddSynth();
     }
-    
+
+#ifndef NO_ADDSYNTH
+    // Wait for the requested tables, so that
+    // the song starts with all tables ready.
+    tfPadSynthCache::get().flush();
+
+    for (eU8 i=0; i<TF_MAX_INPUTS; i++)
+    {
+        if (m_instruments[i])
+            m_instruments[i]->updateAddSynth();
+    }
+
+    tfPadSynthCache::get().setPinning(eFALSE);
+#endif
+
+    for (eU8 i=0; i<TF_MAX_INPUTS; i++)
+    {
+        if (m_instruments[i])
+            _publishInstrument(i);
+    }
 }
 
 void tfPlayer::storeInstruments(eDataStream &stream) const
@@ -176,27 +256,25 @@ void tfPlayer::storeInstruments(eDataStream &stream) const
 
 void tfPlayer::clearInstruments()
 {
-	m_criticalSection.enter();
-
     for (eU32 i=0; i<TF_MAX_INPUTS; i++)
     {
-        eSAFE_DELETE(m_instruments[i]);
+        removeInstrument(i);
     }
-
-	m_criticalSection.leave();
 }
 
+// Note, parameter and transport changes are
+// queued and applied by the audio thread at the
+// start of the next block, so that callers never
+// wait for the renderer and vice versa.
 void tfPlayer::play(eF32 time)
 {
-    m_playing = eTRUE;
-    setTime(time);
-    m_row = -1;
+    eASSERT(time >= 0.0f);
+    _pushEvent(tfEventQueue::EVENT_PLAY, 0, 0, 0, 0, time);
 }
 
 void tfPlayer::stop()
 {
-    m_playing = eFALSE;
-    m_allNotesOff = eTRUE;
+    _pushEvent(tfEventQueue::EVENT_STOP);
 }
 
 static FILE *s_out;
@@ -216,19 +294,7 @@ void tfPlayer::process()
 
 void tfPlayer::allNotesOff()
 {
-    m_criticalSection.enter();
-
-    for(eU32 i=0; i<TF_MAX_INPUTS; i++)
-    {
-        tfInstrument *tf = m_instruments[i];
-
-        if (tf)
-        {
-            tf->allNotesOff();
-        }
-    }
-
-    m_criticalSection.leave();
+    _pushEvent(tfEventQueue::EVENT_ALL_NOTES_OFF);
 }
 
 void tfPlayer::setVolume(eF32 volume)
@@ -238,19 +304,7 @@ void tfPlayer::setVolume(eF32 volume)
 
 void tfPlayer::panic()
 {
-    m_criticalSection.enter();
-
-    for (eU32 i=0; i<TF_MAX_INPUTS; i++)
-    {
-        tfInstrument *tf = m_instruments[i];
-
-        if (tf)
-        {
-            tf->panic();
-        }
-    }
-
-    m_criticalSection.leave();
+    _pushEvent(tfEventQueue::EVENT_PANIC);
 }
 
 void tfPlayer::mute(eBool on)
@@ -261,20 +315,14 @@ void tfPlayer::mute(eBool on)
 void tfPlayer::noteEvent(eU32 instrument, eU32 note, eU32 velocity, eU32 modslot, eF32 mod)
 {
     eASSERT(instrument >= 0 && instrument < TF_MAX_INPUTS);
+    _pushEvent(tfEventQueue::EVENT_NOTE, instrument, note, velocity, modslot, mod);
+}
 
-    tfInstrument *instr = m_instruments[instrument];
-
-    if (instr)
-    {
-        if (velocity > 0)
-        {
-            instr->noteOn(note, velocity, modslot, mod);
-        }
-        else
-        {
-            instr->noteOff(note);
-        }
-    }
+void tfPlayer::paramEvent(eU32 instrument, eU32 index, eF32 value)
+{
+    eASSERT(instrument >= 0 && instrument < TF_MAX_INPUTS);
+    eASSERT(index < TF_PARAM_COUNT);
+    _pushEvent(tfEventQueue::EVENT_PARAM, instrument, index, 0, 0, value);
 }
 
 void tfPlayer::setSong(tfSong *song)
@@ -295,8 +343,7 @@ void tfPlayer::setSampleRate(eU32 sampleRate)
 void tfPlayer::setTime(eF32 time)
 {
     eASSERT(time >= 0.0f);
-    allNotesOff();
-    m_time = eFtoL(time * m_soundOut->getSampleRate());
+    _pushEvent(tfEventQueue::EVENT_SET_TIME, 0, 0, 0, 0, time);
 }
 
 void tfPlayer::setPosition(eU32 row)
@@ -328,27 +375,226 @@ eU32 tfPlayer::getPosition(eU32 row) const
 eF32 tfPlayer::getPeakInstr(eU32 instr) const
 {
     eASSERT(instr < TF_MAX_INPUTS);
-    m_criticalSection.enter();
-    const eF32 peak = m_peakInstr[instr];
-    m_criticalSection.leave();
-    return peak;
+    return m_peakInstr[instr];
 }
 
 eF32 tfPlayer::getPeakTrack(eU32 track) const
 {
     eASSERT(track < tfSong::MAX_SEQ_TRACKS);
-    m_criticalSection.enter();
-    const eF32 peak = m_peakTrack[track];
-    m_criticalSection.leave();
-    return peak;
+    return m_peakTrack[track];
 }
 
 eF32 tfPlayer::getMasterPeak() const
 {
-    m_criticalSection.enter();
-    const eF32 peak = m_masterPeak;
-    m_criticalSection.leave();
-    return peak;
+    return m_masterPeak;
+}
+
+// Returns how many instruments of the current
+// song one core could render in real-time,
+// measured over the last blocks.
+eF32 tfPlayer::getInstrumentsPerCore() const
+{
+    return m_instrPerCore;
+}
+
+// Number of worker threads rendering together
+// with the audio thread.
+eU32 tfPlayer::getWorkerCount() const
+{
+    return m_workerCount;
+}
+
+// Shows if events are produced faster than the
+// audio thread consumes them.
+tfEventQueue::Stats tfPlayer::getEventStats() const
+{
+    return m_events.getStats();
+}
+
+void tfPlayer::_pushEvent(eU32 type, eU32 instrument, eU32 index, eU32 velocity, eU32 modSlot, eF32 value)
+{
+    tfEventQueue::Event ev;
+
+    ev.type = type;
+    ev.instrument = instrument;
+    ev.index = index;
+    ev.velocity = velocity;
+    ev.modSlot = modSlot;
+    ev.value = value;
+
+    m_events.push(ev);
+}
+
+// Passes the instrument in the given slot to the
+// audio thread and returns the serial of the
+// change. Without audio thread, the calling
+// thread renders, so the change is applied
+// directly.
+eU32 tfPlayer::_publishInstrument(eU32 index)
+{
+    m_instrSerial++;
+
+    if (m_threadHandle == eNULL)
+    {
+        m_playInstruments[index] = m_instruments[index];
+        m_instrSerialDone = m_instrSerial;
+        return m_instrSerial;
+    }
+
+    tfEventQueue::Event ev;
+
+    eMemSet(&ev, 0, sizeof(ev));
+    ev.type = tfEventQueue::EVENT_INSTRUMENT;
+    ev.instrument = index;
+    ev.index = m_instrSerial;
+
+    // Instrument changes may use the reserved
+    // cells, so this only waits if the audio
+    // thread is stuck.
+    while (!m_events.push(ev))
+    {
+        eSleep(1);
+    }
+
+    return m_instrSerial;
+}
+
+// The instrument is deleted after the audio thread
+// applied the change with the given serial.
+void tfPlayer::_retireInstrument(tfInstrument *instr, eU32 serial)
+{
+    _deleteRetired();
+
+    while (m_retiredCount == TF_MAX_INPUTS*2)
+    {
+        eSleep(1);
+        _deleteRetired();
+    }
+
+    m_retired[m_retiredCount].instr = instr;
+    m_retired[m_retiredCount].serial = serial;
+    m_retiredCount++;
+
+    _deleteRetired();
+}
+
+void tfPlayer::_deleteRetired()
+{
+    const eU32 serialDone = (eU32)m_instrSerialDone;
+
+    for (eInt i=(eInt)m_retiredCount-1; i>=0; i--)
+    {
+        if ((eInt)(serialDone-m_retired[i].serial) >= 0)
+        {
+            eSAFE_DELETE(m_retired[i].instr);
+            m_retired[i] = m_retired[--m_retiredCount];
+        }
+    }
+}
+
+// Applies all queued events. Called by the audio
+// thread only, which renders the instruments in
+// m_playInstruments. They're only exchanged here.
+void tfPlayer::_processEvents()
+{
+    tfEventQueue::Event ev;
+
+    while (m_events.pop(ev))
+    {
+        switch (ev.type)
+        {
+        case tfEventQueue::EVENT_NOTE:
+        {
+            tfInstrument *instr = m_playInstruments[ev.instrument];
+
+            if (instr)
+            {
+                if (ev.velocity > 0)
+                {
+                    instr->noteOn(ev.index, ev.velocity, ev.modSlot, ev.value);
+                }
+                else
+                {
+                    instr->noteOff(ev.index);
+                }
+            }
+
+            break;
+        }
+
+        case tfEventQueue::EVENT_PARAM:
+        {
+            tfInstrument *instr = m_playInstruments[ev.instrument];
+
+            if (instr)
+            {
+                instr->setParam(ev.index, ev.value);
+            }
+
+            break;
+        }
+
+        case tfEventQueue::EVENT_INSTRUMENT:
+            m_playInstruments[ev.instrument] = m_instruments[ev.instrument];
+            m_instrSerialDone = ev.index;
+            break;
+
+        case tfEventQueue::EVENT_ALL_NOTES_OFF:
+            _allNotesOff();
+            break;
+
+        case tfEventQueue::EVENT_PANIC:
+            _panic();
+            break;
+
+        case tfEventQueue::EVENT_PLAY:
+            m_playing = eTRUE;
+            _setTime(ev.value);
+            m_row = -1;
+            break;
+
+        case tfEventQueue::EVENT_STOP:
+            m_playing = eFALSE;
+            _allNotesOff();
+            break;
+
+        case tfEventQueue::EVENT_SET_TIME:
+            _setTime(ev.value);
+            break;
+        }
+    }
+}
+
+void tfPlayer::_allNotesOff()
+{
+    for (eU32 i=0; i<TF_MAX_INPUTS; i++)
+    {
+        tfInstrument *tf = m_playInstruments[i];
+
+        if (tf)
+        {
+            tf->allNotesOff();
+        }
+    }
+}
+
+void tfPlayer::_panic()
+{
+    for (eU32 i=0; i<TF_MAX_INPUTS; i++)
+    {
+        tfInstrument *tf = m_playInstruments[i];
+
+        if (tf)
+        {
+            tf->panic();
+        }
+    }
+}
+
+void tfPlayer::_setTime(eF32 time)
+{
+    _allNotesOff();
+    m_time = eFtoL(time * m_soundOut->getSampleRate());
 }
 
 void tfPlayer::_processRow()
@@ -372,7 +618,7 @@ void tfPlayer::_processRow()
 
 						if (prevev->noteOct)
 						{
-							tfInstrument *prev_instr = m_instruments[prevev->instrument];
+							tfInstrument *prev_instr = m_playInstruments[prevev->instrument];
 
 							if (prev_instr)
 							{
@@ -406,7 +652,7 @@ void tfPlayer::_processRow()
 
                 if (ev.noteOct && ev.instrument >= 0)
                 {
-                    tfInstrument *instr = m_instruments[ev.instrument];
+                    tfInstrument *instr = m_playInstruments[ev.instrument];
 
                     if (instr)
                     {
@@ -414,7 +660,7 @@ void tfPlayer::_processRow()
 
                         if (prevev->noteOct)
                         {
-                            tfInstrument *prev_instr = m_instruments[prevev->instrument];
+                            tfInstrument *prev_instr = m_playInstruments[prevev->instrument];
 
                             if (prev_instr)
                             {
@@ -439,7 +685,7 @@ void tfPlayer::_processRow()
 
                     if (prevev->noteOct)
 					{
-						tfInstrument *prev_instr = m_instruments[prevev->instrument];
+						tfInstrument *prev_instr = m_playInstruments[prevev->instrument];
 
 						if (prev_instr)
 						{
@@ -453,6 +699,11 @@ void tfPlayer::_processRow()
     }
 }
 
+// Renders blocks until the sound output is filled.
+// Each block is an own segment, so that events
+// are processed with the lowest possible latency.
+// Nothing is locked, instruments are exchanged
+// through the event queue.
 void tfPlayer::_processAudio()
 {
     if (m_soundOut == eNULL)
@@ -462,125 +713,340 @@ void tfPlayer::_processAudio()
 
     while(!m_soundOut->isFilled())
     {
-        if (m_playing && m_song)
+        _processEvents();
+        _processRows();
+        _renderInstruments(1);
+        _updateLoad();
+        _mixBlock(0);
+        _outputBlock();
+    }
+}
+
+// Renders the given number of blocks into the
+// sound output as fast as possible and returns
+// the number of rendered blocks. Instruments are
+// rendered in parallel for all blocks up to the
+// next row change, as neither rows nor queued
+// events can reach them in between. The output
+// is mixed in instrument order afterwards, so
+// it's identical to the one of real-time
+// playback, regardless of how many workers are
+// running.
+eU32 tfPlayer::renderOffline(eU32 blockCount)
+{
+    eASSERT(!m_realTime);
+    eASSERT(m_soundOut != eNULL);
+
+    eU32 rendered = 0;
+
+    while (rendered < blockCount)
+    {
+        _processEvents();
+        _processRows();
+
+        const eU32 count = _getSegmentBlocks(eMin(blockCount-rendered, m_segmentBlocks));
+
+        _renderInstruments(count);
+        _updateLoad();
+
+        for (eU32 i=0; i<count; i++)
         {
-            eF32 ftime = getTime();
-            eU32 newRow = m_song->timeToRow(ftime) % m_song->getLengthInRows();
+            _mixBlock(i);
+            _outputBlock();
+        }
 
-            if (newRow != m_row)
-            {
-                m_row = newRow;
+        rendered += count;
+    }
 
-				if (m_loopStartRow != m_loopEndRow)
-				{
-					if (m_row >= (eInt)m_loopEndRow)
-					{
-						const eF32 startTime = m_song->rowToTime(m_loopStartRow);
-						const eF32 endTime = m_song->rowToTime(m_loopEndRow);
+    return rendered;
+}
 
-						m_row = m_loopStartRow;
- 						ftime -= endTime - startTime;
+// Advances the song position to the current time
+// and triggers the events of a new row. Called
+// with the critical section entered.
+void tfPlayer::_processRows()
+{
+    if (m_playing && m_song)
+    {
+        eF32 ftime = getTime();
+        eU32 newRow = m_song->timeToRow(ftime) % m_song->getLengthInRows();
 
-						if (ftime < 0.0f)
-							ftime = 0.0f;
+        if (newRow != m_row)
+        {
+            m_row = newRow;
 
-                        m_time = eFtoL(ftime * m_soundOut->getSampleRate());
-					}
-				}
+            if (m_loopStartRow != m_loopEndRow)
+            {
+                if (m_row >= (eInt)m_loopEndRow)
+                {
+                    const eF32 startTime = m_song->rowToTime(m_loopStartRow);
+                    const eF32 endTime = m_song->rowToTime(m_loopEndRow);
 
-                m_criticalSection.enter();
-                _processRow();
-                m_criticalSection.leave();
+                    m_row = m_loopStartRow;
+                    ftime -= endTime - startTime;
+
+                    if (ftime < 0.0f)
+                        ftime = 0.0f;
+
+                    m_time = eFtoL(ftime * m_soundOut->getSampleRate());
+                }
             }
+
+            _processRow();
         }
+    }
+}
 
-        if (m_allNotesOff)
+// Returns how many blocks, starting with the
+// current one, are rendered before the row
+// changes. _processRows() compares the rows
+// exactly like this before each block.
+eU32 tfPlayer::_getSegmentBlocks(eU32 maxBlocks) const
+{
+    if (!m_playing || !m_song)
+    {
+        return maxBlocks;
+    }
+
+    const eU32 sampleRate = m_soundOut->getSampleRate();
+    eU32 count = 1;
+
+    while (count < maxBlocks)
+    {
+        const eF32 ftime = (eF32)(m_time+count*TF_BLOCKSIZE)/sampleRate;
+
+        if (m_song->timeToRow(ftime)%m_song->getLengthInRows() != (eU32)m_row)
         {
-            allNotesOff();
-            m_allNotesOff = eFALSE;
+            break;
         }
 
-        eMemSet(m_outputSignal[0], 0, sizeof(eSignal)*TF_BLOCKSIZE);
-        eMemSet(m_outputSignal[1], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+        count++;
+    }
+
+    return count;
+}
 
-        m_criticalSection.enter();
+// Updates the peaks and mixes the instruments of
+// the given block of the segment. Mixing in
+// instrument order keeps the output independent
+// of the threading.
+void tfPlayer::_mixBlock(eU32 block)
+{
+    eASSERT(block < m_renderBlocks);
 
+    eMemSet(m_outputSignal[0], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+    eMemSet(m_outputSignal[1], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+
+    for(eU32 j=TF_PLAYER_PEAK_MEMORY-1; j>0; j--)
+    {
+        m_masterPeakMemory[j] = m_masterPeakMemory[j - 1];
+    }
+    m_masterPeakMemory[0] = 0.0f;
+
+    for (eU32 i=0; i<tfSong::MAX_SEQ_TRACKS; i++)
+    {
+        m_peakTrack[i] = 0.0f;
+    }
+
+    for (eU32 i=0; i<TF_MAX_INPUTS; i++)
+    {
+        tfInstrument *instr = m_playInstruments[i];
+        eU32 track = m_instrumentPatternTrack[i];
+        eF32 peak = 0.0f;
+
+        const eU32 peak_mem_offset = i * TF_PLAYER_PEAK_MEMORY;
         for(eU32 j=TF_PLAYER_PEAK_MEMORY-1; j>0; j--)
         {
-            m_masterPeakMemory[j] = m_masterPeakMemory[j - 1];
+            m_peakInstrMemory[peak_mem_offset + j] = m_peakInstrMemory[peak_mem_offset + j - 1];
         }
-        m_masterPeakMemory[0] = 0.0f;
+        m_peakInstrMemory[peak_mem_offset] = 0.0f;
 
-	    for (eU32 i=0; i<tfSong::MAX_SEQ_TRACKS; i++)
+        if (instr)
         {
-		    m_peakTrack[i] = 0.0f;
+            const eU32 offset = i*m_segmentBlocks+block;
+
+            eSignal *signals[2] =
+            {
+                &m_instrSignals[(offset*2+0)*TF_BLOCKSIZE],
+                &m_instrSignals[(offset*2+1)*TF_BLOCKSIZE]
+            };
+
+            peak = m_instrPeaks[offset];
+            eSignalMix(m_outputSignal, signals, TF_BLOCKSIZE, 1.0f);
         }
 
-        for (eU32 i=0; i<TF_MAX_INPUTS; i++)
+        if (peak > m_masterPeakMemory[0])
+            m_masterPeakMemory[0] = peak;
+
+        m_peakInstrMemory[peak_mem_offset] = peak;
+        m_peakTrack[track] += peak;
+
+        for(eU32 j=0; j<TF_PLAYER_PEAK_MEMORY; j++)
         {
-            tfInstrument *instr = m_instruments[i];
-		    eU32 track = m_instrumentPatternTrack[i];
-		    eF32 peak = 0.0f;
+            m_peakInstr[i] += m_peakInstrMemory[peak_mem_offset + j];
+        }
 
-            const eU32 peak_mem_offset = i * TF_PLAYER_PEAK_MEMORY;
-            for(eU32 j=TF_PLAYER_PEAK_MEMORY-1; j>0; j--)
-            {
-                m_peakInstrMemory[peak_mem_offset + j] = m_peakInstrMemory[peak_mem_offset + j - 1];
-            }
-            m_peakInstrMemory[peak_mem_offset] = 0.0f;
-            
-            if (instr)
-            {
-				eMemSet(m_tempSignal[0], 0, sizeof(eSignal)*TF_BLOCKSIZE);
-				eMemSet(m_tempSignal[1], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+        m_peakInstr[i] /= TF_PLAYER_PEAK_MEMORY;
+    }
 
-                peak = instr->process(m_tempSignal, TF_BLOCKSIZE);
+    m_masterPeak = 0.0f;
+    for(eU32 j=0; j<TF_PLAYER_PEAK_MEMORY; j++)
+    {
+        m_masterPeak += m_masterPeakMemory[j];
+    }
 
-				eSignalMix(m_outputSignal, m_tempSignal, TF_BLOCKSIZE, 1.0f);
-            }
+    m_masterPeak /= TF_PLAYER_PEAK_MEMORY;
+}
+
+// Converts the mixed block and passes it to
+// the sound output.
+void tfPlayer::_outputBlock()
+{
+    if (m_mute)
+    {
+        eMemSet(m_outputFinal, 0, TF_BLOCKSIZE*2*sizeof(eS16));
+    }
+    else
+    {
+        eSignalToS16(m_outputSignal, m_outputFinal, 5000.0f*m_volume, TF_BLOCKSIZE);
+    }
 
-            if (peak > m_masterPeakMemory[0])
-                m_masterPeakMemory[0] = peak;
+    m_soundOut->fill((const eU8 *)m_outputFinal, TF_BLOCKSIZE*2*sizeof(eS16));
 
-            m_peakInstrMemory[peak_mem_offset] = peak;
-		    m_peakTrack[track] += peak;
+    //fwrite(m_outputFinal, TF_BLOCKSIZE*2*sizeof(eS16), 1, s_out);
 
-            for(eU32 j=0; j<TF_PLAYER_PEAK_MEMORY; j++)
-            {
-                m_peakInstr[i] += m_peakInstrMemory[peak_mem_offset + j];
-            }
+    if (m_playing && m_song)
+    {
+        m_time += TF_BLOCKSIZE;
+    }
+}
 
-            m_peakInstr[i] /= TF_PLAYER_PEAK_MEMORY;
-        }
+// Renders all instruments of the current segment
+// into their own buffers. The audio thread takes
+// part in rendering, so the workers only help when
+// there's more than one instrument. Once no more
+// instruments can be claimed, the audio thread
+// only waits for instruments which workers are
+// still rendering. Nothing is allocated or locked
+// here.
+void tfPlayer::_renderInstruments(eU32 blockCount)
+{
+    eASSERT(blockCount > 0 && blockCount <= m_segmentBlocks);
 
-        m_masterPeak = 0.0f;
-        for(eU32 j=0; j<TF_PLAYER_PEAK_MEMORY; j++)
+    m_renderBlocks = blockCount;
+    m_renderCount = 0;
+
+    for (eU32 i=0; i<TF_MAX_INPUTS; i++)
+    {
+        if (m_playInstruments[i])
         {
-            m_masterPeak += m_masterPeakMemory[j];
+            m_renderList[m_renderCount++] = i;
         }
+    }
+
+    if (m_renderCount == 0)
+    {
+        return;
+    }
+
+    // Workers can't claim anything in between, as
+    // all instruments of the last segment were
+    // claimed. Publishing the new claim word acts
+    // as memory barrier for the render list.
+    m_segment++;
+    m_renderDone = 0;
 
-        m_masterPeak /= TF_PLAYER_PEAK_MEMORY;
+    const eInt claim = (eInt)(((m_segment&0xffff)<<16)|(m_renderCount<<8));
+    eAtomicCompareExchange(m_renderClaim, claim, m_renderClaim);
 
-        m_criticalSection.leave();
+    const eU32 wakeCount = eMin(m_workerCount, m_renderCount-1);
 
-        if (m_mute)
+    if (wakeCount > 0)
+    {
+        m_workAvail.signal(wakeCount);
+    }
+
+    if (!_renderQueued())
+    {
+        m_renderFinished.wait();
+    }
+}
+
+// Claims and renders instruments of the current
+// segment, until all are claimed. Returns if the
+// caller finished the last instrument. Workers
+// waking up late find no instrument or take part
+// in a newer segment.
+eBool tfPlayer::_renderQueued()
+{
+    eBool finishedLast = eFALSE;
+
+    while (eTRUE)
+    {
+        const eInt claim = m_renderClaim;
+        const eU32 count = ((eU32)claim>>8)&0xff;
+        const eU32 next = (eU32)claim&0xff;
+
+        if (next >= count)
         {
-            eMemSet(m_outputFinal, 0, TF_BLOCKSIZE*2*sizeof(eS16));
+            break;
         }
-        else
+
+        if (eAtomicCompareExchange(m_renderClaim, claim+1, claim) != claim)
         {
-            eSignalToS16(m_outputSignal, m_outputFinal, 5000.0f*m_volume, TF_BLOCKSIZE);
+            continue;
         }
 
-        m_soundOut->fill((const eU8 *)m_outputFinal, TF_BLOCKSIZE*2*sizeof(eS16));
+        const eU32 index = m_renderList[next];
+        const eU64 startTicks = eTimer::getTickCount();
+
+        for (eU32 i=0; i<m_renderBlocks; i++)
+        {
+            const eU32 offset = index*m_segmentBlocks+i;
 
-		//fwrite(m_outputFinal, TF_BLOCKSIZE*2*sizeof(eS16), 1, s_out);
+            eSignal *signals[2] =
+            {
+                &m_instrSignals[(offset*2+0)*TF_BLOCKSIZE],
+                &m_instrSignals[(offset*2+1)*TF_BLOCKSIZE]
+            };
+
+            eMemSet(signals[0], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+            eMemSet(signals[1], 0, sizeof(eSignal)*TF_BLOCKSIZE);
+
+            m_instrPeaks[offset] = m_playInstruments[index]->process(signals, TF_BLOCKSIZE);
+        }
 
-        if (m_playing && m_song)
+        m_instrTicks[index] = eTimer::getTickCount()-startTicks;
+
+        if ((eU32)eAtomicInc(m_renderDone) == count)
         {
-            m_time += TF_BLOCKSIZE;
+            finishedLast = eTRUE;
         }
     }
+
+    return finishedLast;
+}
+
+// Relates the time spent rendering instruments
+// to the duration of the segment.
+void tfPlayer::_updateLoad()
+{
+    eU64 ticks = 0;
+
+    for (eU32 i=0; i<m_renderCount; i++)
+    {
+        ticks += m_instrTicks[m_renderList[i]];
+    }
+
+    if (ticks == 0)
+    {
+        return;
+    }
+
+    const eF32 blockTicks = (eF32)eTimer::getFrequency()*TF_BLOCKSIZE*m_renderBlocks/m_soundOut->getSampleRate();
+    const eF32 perCore = blockTicks*m_renderCount/(eF32)ticks;
+
+    m_instrPerCore = (m_instrPerCore == 0.0f ? perCore : eLerp(m_instrPerCore, perCore, 0.05f));
 }
 
 void tfPlayer::_startThread()
@@ -598,13 +1064,40 @@ void tfPlayer::_startThread()
 
 void tfPlayer::_stopThread()
 {
-    m_allNotesOff = eTRUE;
     m_joinRequest = eTRUE;
 
     eThreadEnd(m_threadHandle, eTRUE);
     m_threadHandle = eNULL;
 }
 
+// Workers run with the same priority as the
+// audio thread. The calling thread renders too,
+// so one CPU less than available is used.
+void tfPlayer::_startWorkers()
+{
+    m_workersQuit = eFALSE;
+    m_workerCount = eMin(eGetCpuCount()-1, TF_MAX_INPUTS-1);
+
+    for (eU32 i=0; i<m_workerCount; i++)
+    {
+        m_workers[i] = eThreadStart(_workerProc, this, eTRUE);
+        eASSERT(m_workers[i] != eNULL);
+    }
+}
+
+void tfPlayer::_stopWorkers()
+{
+    m_workersQuit = eTRUE;
+    m_workAvail.signal(m_workerCount);
+
+    for (eU32 i=0; i<m_workerCount; i++)
+    {
+        eThreadEnd(m_workers[i], eTRUE);
+    }
+
+    m_workerCount = 0;
+}
+
 void tfPlayer::_threadProc(ePtr arg)
 {
     tfPlayer *player = (tfPlayer *)arg;
@@ -613,9 +1106,27 @@ void tfPlayer::_threadProc(ePtr arg)
     player->process();
 }
 
-eCriticalSection * tfPlayer::getCriticalSection()
+void tfPlayer::_workerProc(ePtr arg)
 {
-    return &m_criticalSection;
+    tfPlayer *player = (tfPlayer *)arg;
+    eASSERT(player != eNULL);
+
+    while (eTRUE)
+    {
+        player->m_workAvail.wait();
+
+        if (player->m_workersQuit)
+        {
+            break;
+        }
+
+        // The audio thread waits for the last
+        // instrument, if a worker finished it.
+        if (player->_renderQueued())
+        {
+            player->m_renderFinished.signal();
+        }
+    }
 }
 
 #endif
\ No newline at end of file
@@ -18,7 +18,7 @@
 class tfPlayer
 {
 public:
-    tfPlayer(tfISoundOut *soundOut);
+    tfPlayer(tfISoundOut *soundOut, eBool realTime=eTRUE);
     ~tfPlayer();
 
     void                addInstrument(eU32 index);
@@ -33,6 +33,7 @@ public:
     void                play(eF32 time);
     void                stop();
     void                process();
+    eU32                renderOffline(eU32 blockCount);
     void                allNotesOff();
     void                panic();
     void                setVolume(eF32 volume);
@@ -40,6 +41,7 @@ public:
 	void				setLoop(eU32 startRow, eU32 endRow);
 
     void                noteEvent(eU32 instrument, eU32 note, eU32 velocity, eU32 modslot, eF32 mod);
+    void                paramEvent(eU32 instrument, eU32 index, eF32 value);
 
     void                setSong(tfSong *song);
     void                setSampleRate(eU32 sampleRate);
@@ -54,18 +56,46 @@ public:
     eF32                getPeakInstr(eU32 instr) const;
 	eF32                getPeakTrack(eU32 track) const;
     eF32                getMasterPeak() const;
-
-    eCriticalSection *  getCriticalSection();
+    eF32                getInstrumentsPerCore() const;
+    eU32                getWorkerCount() const;
+    tfEventQueue::Stats getEventStats() const;
 
 private:
+    void                _pushEvent(eU32 type, eU32 instrument=0, eU32 index=0, eU32 velocity=0, eU32 modSlot=0, eF32 value=0.0f);
+    eU32                _publishInstrument(eU32 index);
+    void                _retireInstrument(tfInstrument *instr, eU32 serial);
+    void                _deleteRetired();
+    void                _processEvents();
+    void                _allNotesOff();
+    void                _panic();
+    void                _setTime(eF32 time);
+
     void                _processRow();
+    void                _processRows();
     void                _processAudio();
+    void                _mixBlock(eU32 block);
+    void                _outputBlock();
+    eU32                _getSegmentBlocks(eU32 maxBlocks) const;
+
+    void                _renderInstruments(eU32 blockCount);
+    eBool               _renderQueued();
+    void                _updateLoad();
 
     void                _startThread();
     void                _stopThread();
+    void                _startWorkers();
+    void                _stopWorkers();
 
 private:
     static void         _threadProc(ePtr arg);
+    static void         _workerProc(ePtr arg);
+
+private:
+    struct RetiredInstrument
+    {
+        tfInstrument *  instr;
+        eU32            serial;
+    };
 
 private:
     tfSong *            m_song;
@@ -82,21 +112,59 @@ private:
     eF32                m_masterPeakMemory[TF_PLAYER_PEAK_MEMORY];
     eF32                m_masterPeak;
     eSignal *           m_outputSignal[2];
-	eSignal *           m_tempSignal[2];
+    eSignal *           m_instrSignals;
+    eF32 *              m_instrPeaks;
+    eU64                m_instrTicks[TF_MAX_INPUTS];
     eS16 *              m_outputFinal;
     eU32                m_signalCount;
 
+    eBool               m_realTime;
+    eU32                m_segmentBlocks;
+    eU32                m_renderBlocks;
     eBool               m_mute;
     eF32                m_volume;
     eS32                m_row;
     eU32                m_time;
     eBool               m_playing;
     eBool               m_joinRequest;
-    eBool               m_allNotesOff;
-    eCriticalSection    m_criticalSection;
+    tfEventQueue        m_events;
     ePtr                m_threadHandle;
 	eU32				m_loopStartRow;
 	eU32				m_loopEndRow;
+
+    // Instruments of the current segment are claimed
+    // by the audio thread and the workers through
+    // m_renderClaim. It holds the segment number,
+    // the instrument count and the next instrument
+    // to render (16, 8 and 8 bits), so workers can't
+    // claim instruments of a finished segment.
+    // m_renderDone counts the rendered instruments.
+    // In real-time mode a segment is one block,
+    // offline it spans all blocks up to the next
+    // row change (at most m_segmentBlocks).
+    ePtr                m_workers[TF_MAX_INPUTS];
+    eU32                m_workerCount;
+    eSemaphore          m_workAvail;
+    eSemaphore          m_renderFinished;
+    volatile eBool      m_workersQuit;
+    volatile eInt       m_renderClaim;
+    volatile eInt       m_renderDone;
+    eU32                m_renderList[TF_MAX_INPUTS];
+    eU32                m_renderCount;
+    eU32                m_segment;
+    eF32                m_instrPerCore;
+
+    // m_instruments belongs to the thread adding
+    // and removing instruments, the audio thread
+    // renders m_playInstruments. Changes are passed
+    // as events, numbered by m_instrSerial. Removed
+    // instruments are deleted after the audio thread
+    // applied the change (m_instrSerialDone).
+    tfInstrument *      m_playInstruments[TF_MAX_INPUTS];
+    eU32                m_instrSerial;
+    volatile eInt       m_instrSerialDone;
+    RetiredInstrument   m_retired[TF_MAX_INPUTS*2];
+    eU32                m_retiredCount;
 };
 
 #endif // TF_PLAYER_HPP
\ No newline at end of file
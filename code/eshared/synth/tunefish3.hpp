@@ -63,6 +63,7 @@ const eU32  TF_MAX_MODULATIONS      = 4;
 const eU32  TF_MAX_OVERSAMPLING     = 8;
 const eU32  TF_DESIRED_OVERSAMPLING = 32;
 const eU32  TF_PLAYER_PEAK_MEMORY   = 6;
+const eU32  TF_PLAYER_OFFLINE_BLOCKS = 32;
 
 static const eF32 TF_OCTAVES[] =
 {
@@ -585,15 +586,21 @@ static const eF32 TF_DEFAULTPROG[] =
 #include "tf_modmatrix.hpp"
 #include "tf_filter.hpp"
 #include "tf_oscillator.hpp"
+#include "tf_padsynth.hpp"
 #include "tf_addsynth.hpp"
 #include "tf_noise.hpp"
 #include "tf_ieffect.hpp"
 #include "tf_instrument.hpp"
 #include "tf_song.hpp"
 #include "tf_isoundout.hpp"
+#include "tf_eventqueue.hpp"
 #include "tf_player.hpp"
 
+#ifdef _WIN32
 #include "directx/tf_soundoutdx8.hpp"
+#else
+#include "null/tf_soundoutnull.hpp"
+#endif
 
 #ifdef _WIN32
 #include <xmmintrin.h>
@@ -141,7 +141,13 @@ public:
 
     eFORCEINLINE T & push()
     {
-		eArrayReserve((ePtrArray *)this, this->size() + 1);
+        // Grow like append() does. Reserving just one
+        // more element reallocates on every push.
+        if (this->m_size >= this->m_capacity)
+        {
+            eArrayReserve((ePtrArray *)this, (this->m_capacity > 0 ? this->m_capacity*2 : 32));
+        }
+
 		this->m_size++;
 		return this->lastElement();
     }
@@ -22,6 +22,18 @@ struct eFloatColor
     eF32    a;
 };
 
+// Color with 16 bits per channel, used for high
+// precision bitmaps. Channels are stored in the
+// same order as the ones of eColor. 65535 maps
+// to 255 in eColor.
+struct eColor16
+{
+    eU16    blue;
+    eU16    green;
+    eU16    red;
+    eU16    alpha;
+};
+
 // Four channel floating point color. Channel
 // components aren't clamped while doing arithmetic
 // operations (+, -, *) on it.
@@ -154,6 +166,18 @@ public:
         return (eF32)m_channels[index]/255.0f;
     }
 
+    // Returns the color as four floats in
+    // range [0, 1] (r, g, b, a).
+    eFloatColor toFloatColor() const
+    {
+        const eFloatColor fc =
+        {
+            redF(), greenF(), blueF(), alphaF()
+        };
+
+        return fc;
+    }
+
     eF32 redF() const
     {
         return (eF32)m_red/255.0f;
@@ -192,7 +216,7 @@ public:
 
     eColor operator + (const eColor &c) const
     {
-        static eColor res;
+        eColor res;
 
         res.m_red   = eMin((eInt)(m_red+c.m_red), 255);
         res.m_green = eMin((eInt)(m_green+c.m_green), 255);
@@ -204,7 +228,7 @@ public:
 
     eColor operator - (const eColor &c) const
     {
-        static eColor res;
+        eColor res;
 
         res.m_red   = eMax(0, (eInt)(m_red-c.m_red));
         res.m_green = eMax(0, (eInt)(m_green-c.m_green));
@@ -216,7 +240,7 @@ public:
 
     eColor operator * (const eColor &c) const
     {
-        static eColor res;
+        eColor res;
 
         res.m_red   = (m_red*c.m_red)/255;
         res.m_green = (m_green*c.m_green)/255;
@@ -230,7 +254,7 @@ public:
     {
         eASSERT(s >= 0.0f);
 
-        static eColor res;
+        eColor res;
 
         res.m_red   = eMin(eFtoL((eF32)m_red*s), 255);
         res.m_green = eMin(eFtoL((eF32)m_green*s), 255);
@@ -354,18 +378,6 @@ public:
         return m_channels[index];
     }
 
-    operator const eF32 * () const
-    {
-        static eF32 flt[4];
-
-        flt[0] = redF();
-        flt[1] = greenF();
-        flt[2] = blueF();
-        flt[3] = alphaF();
-
-        return flt;
-    }
-
 public:
     // Bigger, non inlinable functions.
     void toHsv(eInt &h, eInt &s, eInt &v);
@@ -38,8 +38,8 @@ eProfiler::Zone::Zone(const eChar *name) :
     m_zoneIndex = m_zoneCount;
     m_zonesByIndex[m_zoneCount++] = this;
 
-    eRandomize(eHashStr(name));
-    m_color.fromHsv(eRandom(0, 359), eRandom(128, 255), eRandom(128, 255));
+    eU32 seed = eMax<eU32>(eHashStr(name)+1, 1);
+    m_color.fromHsv(eRandom(0, 359, seed), eRandom(128, 255, seed), eRandom(128, 255, seed));
 }
 
 void eProfiler::Zone::enter(Zone *lastZone)
@@ -128,9 +128,19 @@ eU32                eProfiler::m_zoneCount = 0;
 eU64                eProfiler::m_frameStartTime = 0;
 eU64                eProfiler::m_frameDuration = 0;
 eProfiler::SortMode eProfiler::m_sortMode = eProfiler::SORT_SELFTIME;
+eU32                eProfiler::m_threadId = 0;
+volatile eInt       eProfiler::m_counters[eProfiler::COUNTER_COUNT];
 
+// Zones are only profiled on the thread which
+// calls beginFrame(), because the zone stack
+// can't be shared with worker threads.
 void eProfiler::enterZone(Zone &zone)
 {
+    if (m_threadId && eThreadGetCurrentId() != m_threadId)
+    {
+        return;
+    }
+
     Zone *lastZone = m_zoneStack[m_stackIndex];
     eASSERT(lastZone != eNULL);
 
@@ -140,6 +150,11 @@ void eProfiler::enterZone(Zone &zone)
 
 void eProfiler::leaveZone()
 {
+    if (m_threadId && eThreadGetCurrentId() != m_threadId)
+    {
+        return;
+    }
+
     Zone *zone = m_zoneStack[m_stackIndex--];
     eASSERT(zone != eNULL);
     Zone *nextZone = m_zoneStack[m_stackIndex];
@@ -158,6 +173,7 @@ void eProfiler::beginFrame()
 
     g_profGlobal.enter(eNULL);
     m_frameStartTime = eTimer::getTickCount();
+    m_threadId = eThreadGetCurrentId();
 #endif
 }
 
@@ -205,6 +221,33 @@ eProfiler::SortMode eProfiler::getSortMode()
     return m_sortMode;
 }
 
+// Counters can be incremented from any thread.
+void eProfiler::incrementCounter(Counter counter)
+{
+    eASSERT(counter < COUNTER_COUNT);
+    eAtomicInc(m_counters[counter]);
+}
+
+void eProfiler::addToCounter(Counter counter, eInt value)
+{
+    eASSERT(counter < COUNTER_COUNT);
+    eAtomicAdd(m_counters[counter], value);
+}
+
+void eProfiler::resetCounters()
+{
+    for (eU32 i=0; i<COUNTER_COUNT; i++)
+    {
+        m_counters[i] = 0;
+    }
+}
+
+eU32 eProfiler::getCounter(Counter counter)
+{
+    eASSERT(counter < COUNTER_COUNT);
+    return (eU32)m_counters[counter];
+}
+
 eU32 eProfiler::getZoneCount()
 {
     return m_zoneCount;
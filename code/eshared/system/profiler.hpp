@@ -26,11 +26,15 @@
                                                 eProfiler::Scope scope(zone);
 
     #define ePROFILER_ZONE(name)                ePROFILER_NAMED_ZONE(eTOKENPASTE(zone_, eTOKENPASTE(__LINE__, __COUNTER__)), name)
+    #define ePROFILER_COUNT(counter)            eProfiler::incrementCounter(counter)
+    #define ePROFILER_ADD(counter, value)       eProfiler::addToCounter(counter, value)
 #else
     #define ePROFILER_DEFINE(zone, name)
     #define ePROFILER_SCOPE(zone)
     #define ePROFILER_NAMED_ZONE(zone, name)
     #define ePROFILER_ZONE(name)
+    #define ePROFILER_COUNT(counter)
+    #define ePROFILER_ADD(counter, value)
 #endif
 
 #if defined(eUSE_PROFILER) && defined(eEDITOR)
@@ -50,6 +54,21 @@ public:
         SORT_CALLCOUNT
     };
 
+    // Counters for events which aren't measured in
+    // time. In contrast to the zones they aren't
+    // reset each frame, but accumulate until they
+    // are reset explicitly.
+    enum Counter
+    {
+        COUNTER_OPCACHE_HITS,
+        COUNTER_OPCACHE_MISSES,
+        COUNTER_VCACHE_TRIANGLES,       // Of loaded static meshes, also decrease.
+        COUNTER_VCACHE_MISSES_RAW,
+        COUNTER_VCACHE_MISSES_OPT,
+        COUNTER_PSYS_SNAPSHOT_BYTES,    // Currently used, also decreases.
+        COUNTER_COUNT
+    };
+
 public:
     // Represents a profiling zone. For convenience,
     // use the ePROFILER_DEFINE macro to declare a new
@@ -115,6 +134,11 @@ public:
 
     static void         setSortMode(SortMode mode);
 
+    static void         incrementCounter(Counter counter);
+    static void         addToCounter(Counter counter, eInt value);
+    static void         resetCounters();
+    static eU32         getCounter(Counter counter);
+
     static SortMode     getSortMode();
     static eU32         getZoneCount();
     static const Zone & getZone(eU32 index);
@@ -133,6 +157,8 @@ private:
     static eU64         m_frameStartTime;
     static eU64         m_frameDuration;
     static SortMode     m_sortMode;
+    static eU32         m_threadId;
+    static volatile eInt m_counters[COUNTER_COUNT];
 };
 
 #endif
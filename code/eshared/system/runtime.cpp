@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 #endif
 
 #include "types.hpp"
@@ -255,11 +256,10 @@ eBool eVerifyInstructionSets()
 void eSetSSEFlushToZeroMode()
 {
 #ifdef eUSE_SSE
-    eU32 mxcsr;
-    __asm STMXCSR mxcsr;
+    eU32 mxcsr = _mm_getcsr();
     eSetBit<eU32>(mxcsr, 15, eTRUE); // flush to zero bit 15
     // eSetBit<eU32>(mxcsr, 6, eTRUE); // denormals are zero bit 6
-    __asm LDMXCSR mxcsr;
+    _mm_setcsr(mxcsr);
 #endif
 }
 
@@ -712,7 +712,11 @@ void eRandomize(eU32 seed)
 
 eU32 eRandomSeed()
 {
+#ifdef _WIN32
 	return GetTickCount();
+#else
+	return (eU32)time(eNULL);
+#endif
 }
 
 // Park-Miller random number generation (so called
@@ -410,7 +410,7 @@ eINLINE eBool isAligned(eConstPtr data, eU32 alignment)
     // Check that the alignment is a power-of-two.
     eASSERT((alignment & (alignment-1)) == 0); 
 
-    return (((eU32)data & (alignment-1)) == 0);
+    return (((size_t)data & (alignment-1)) == 0);
 }
 
 // Casts a floating point value to a 32-bit
@@ -456,7 +456,7 @@ eINLINE eU32 eHashStr(const eChar *str)
 
 template<class T> eU32 eHashPtr(const T * const &ptr)
 {
-    return eHashInt((eInt)ptr);
+    return eHashInt((eInt)(size_t)ptr);
 }
 
 // Faster float to long conversion that c-lib's
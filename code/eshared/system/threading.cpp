@@ -16,6 +16,9 @@
 #include <windows.h>
 #else
 #include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <time.h>
 #endif
 
 #include "system.hpp"
@@ -34,6 +37,18 @@ void eSleep(eU32 ms)
 #endif
 }
 
+eU32 eGetCpuCount()
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (eU32)si.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0 ? (eU32)count : 1);
+#endif
+}
+
 ePtr eThreadStart(void (* func)(ePtr arg), ePtr arg, eBool critical)
 {
 #ifdef _WIN32
@@ -72,6 +87,86 @@ void eThreadEnd(ePtr handle, eBool wait)
 #endif
 }
 
+eU32 eThreadGetCurrentId()
+{
+#ifdef _WIN32
+    return (eU32)GetCurrentThreadId();
+#else
+    return (eU32)(size_t)pthread_self();
+#endif
+}
+
+// All atomic functions return the new value.
+eInt eAtomicInc(volatile eInt &value)
+{
+#ifdef _WIN32
+    return (eInt)InterlockedIncrement((volatile LONG *)&value);
+#else
+    return __sync_add_and_fetch(&value, 1);
+#endif
+}
+
+eInt eAtomicDec(volatile eInt &value)
+{
+#ifdef _WIN32
+    return (eInt)InterlockedDecrement((volatile LONG *)&value);
+#else
+    return __sync_sub_and_fetch(&value, 1);
+#endif
+}
+
+eInt eAtomicAdd(volatile eInt &value, eInt add)
+{
+#ifdef _WIN32
+    return (eInt)InterlockedExchangeAdd((volatile LONG *)&value, add)+add;
+#else
+    return __sync_add_and_fetch(&value, add);
+#endif
+}
+
+// Sets value to exchange if it equals comparand.
+// Returns the previous value in any case.
+eInt eAtomicCompareExchange(volatile eInt &value, eInt exchange, eInt comparand)
+{
+#ifdef _WIN32
+    return (eInt)InterlockedCompareExchange((volatile LONG *)&value, exchange, comparand);
+#else
+    return __sync_val_compare_and_swap(&value, comparand, exchange);
+#endif
+}
+
+// Threads don't inherit the FPU and SSE control
+// words of other threads (e.g. Direct3D switches
+// the FPU to single precision), so they have to
+// be copied to get bit-identical results.
+void eFpuStateStore(eU32 state[2])
+{
+    state[0] = 0;
+    state[1] = 0;
+
+#if defined(_WIN32) && !defined(_WIN64)
+    eU16 fpuCw;
+    __asm fnstcw word ptr [fpuCw]
+    state[0] = fpuCw;
+#endif
+
+#ifdef eUSE_SSE
+    state[1] = _mm_getcsr();
+#endif
+}
+
+void eFpuStateLoad(const eU32 state[2])
+{
+#if defined(_WIN32) && !defined(_WIN64)
+    const eU16 fpuCw = (eU16)state[0];
+    __asm fldcw word ptr [fpuCw]
+#endif
+
+#ifdef eUSE_SSE
+    _mm_setcsr(state[1]);
+#endif
+}
+
 ePtr eCriticalSectionCreate()
 {
 #ifdef _WIN32
@@ -111,6 +206,15 @@ void eCriticalSectionEnter(ePtr handle)
 #endif
 }
 
+eBool eCriticalSectionTryEnter(ePtr handle)
+{
+#ifdef _WIN32
+    return (TryEnterCriticalSection((LPCRITICAL_SECTION)handle) != FALSE);
+#else
+    return (pthread_mutex_trylock((pthread_mutex_t *)handle) == 0);
+#endif
+}
+
 void eCriticalSectionLeave(ePtr handle)
 {
 #ifdef _WIN32
@@ -118,4 +222,234 @@ void eCriticalSectionLeave(ePtr handle)
 #else
     pthread_mutex_unlock((pthread_mutex_t *)handle);
 #endif
+}
+
+ePtr eSemaphoreCreate()
+{
+#ifdef _WIN32
+    HANDLE h = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+    eASSERT(h != NULL);
+    return (ePtr)h;
+#else
+    sem_t *s = new sem_t;
+    sem_init(s, 0, 0);
+    return (ePtr)s;
+#endif
+}
+
+void eSemaphoreDelete(ePtr handle)
+{
+#ifdef _WIN32
+    CloseHandle((HANDLE)handle);
+#else
+    sem_t *s = (sem_t *)handle;
+    eASSERT(s != eNULL);
+    sem_destroy(s);
+    eSAFE_DELETE(s);
+#endif
+}
+
+void eSemaphoreSignal(ePtr handle, eU32 count)
+{
+#ifdef _WIN32
+    ReleaseSemaphore((HANDLE)handle, count, NULL);
+#else
+    while (count--)
+    {
+        sem_post((sem_t *)handle);
+    }
+#endif
+}
+
+void eSemaphoreWait(ePtr handle)
+{
+#ifdef _WIN32
+    WaitForSingleObject((HANDLE)handle, INFINITE);
+#else
+    sem_wait((sem_t *)handle);
+#endif
+}
+
+eU32 eThreadPool::m_globalThreadCount = (eU32)-1;
+
+// The calling thread always takes part in
+// processing jobs while waiting, so a pool
+// with zero threads runs everything serially.
+eThreadPool::eThreadPool(eU32 threadCount) :
+    m_threadCount(eMin(threadCount, MAX_THREADS)),
+    m_nextJob(0),
+    m_quit(eFALSE)
+{
+    for (eU32 i=0; i<m_threadCount; i++)
+    {
+        m_threads[i] = eThreadStart(_threadProc, this, eFALSE);
+    }
+}
+
+eThreadPool::~eThreadPool()
+{
+    m_quit = eTRUE;
+    m_jobsAvail.signal(m_threadCount);
+
+    for (eU32 i=0; i<m_threadCount; i++)
+    {
+        eThreadEnd(m_threads[i], eTRUE);
+    }
+}
+
+void eThreadPool::push(JobFunc func, ePtr arg, eU32 index, volatile eInt *pending)
+{
+    eASSERT(func != eNULL);
+
+    Job job;
+
+    job.func = func;
+    job.arg = arg;
+    job.index = index;
+    job.pending = pending;
+
+    if (pending)
+    {
+        eAtomicInc(*pending);
+    }
+
+    m_lock.enter();
+    m_jobs.append(job);
+    m_lock.leave();
+
+    m_jobsAvail.signal();
+}
+
+// Calls func(arg, i) for i in [0,count) and
+// returns after all calls have finished. The
+// calls run with the FPU state of the caller.
+void eThreadPool::parallelFor(JobFunc func, ePtr arg, eU32 count)
+{
+    if (m_threadCount == 0 || count == 1)
+    {
+        for (eU32 i=0; i<count; i++)
+        {
+            func(arg, i);
+        }
+
+        return;
+    }
+
+    ForJob forJob;
+
+    forJob.func = func;
+    forJob.arg = arg;
+    eFpuStateStore(forJob.fpuState);
+
+    volatile eInt pending = 0;
+
+    for (eU32 i=0; i<count; i++)
+    {
+        push(_forJobProc, &forJob, i, &pending);
+    }
+
+    waitFor(pending);
+}
+
+void eThreadPool::waitFor(volatile eInt &pending)
+{
+    while (pending > 0)
+    {
+        if (!runPendingJob())
+        {
+            eSleep(0);
+        }
+    }
+}
+
+// Takes the next job from the queue and runs
+// it on the calling thread. Returns false if
+// the queue was empty.
+eBool eThreadPool::runPendingJob()
+{
+    m_lock.enter();
+
+    if (m_nextJob == m_jobs.size())
+    {
+        m_lock.leave();
+        return eFALSE;
+    }
+
+    const Job job = m_jobs[m_nextJob++];
+
+    // Reset queue after it ran empty, so it
+    // does not grow endlessly.
+    if (m_nextJob == m_jobs.size())
+    {
+        m_jobs.clear();
+        m_nextJob = 0;
+    }
+
+    m_lock.leave();
+
+    job.func(job.arg, job.index);
+
+    if (job.pending)
+    {
+        eAtomicDec(*job.pending);
+    }
+
+    return eTRUE;
+}
+
+eU32 eThreadPool::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+// Global pool with one thread less than the
+// number of CPUs, because the calling thread
+// helps processing jobs.
+eThreadPool & eThreadPool::get()
+{
+    static eThreadPool pool(m_globalThreadCount != (eU32)-1 ? m_globalThreadCount : eGetCpuCount()-1);
+    return pool;
+}
+
+// Overrides the number of threads of the global
+// pool (e.g. 0 to run all jobs serially). Has to
+// be called before the global pool is used.
+void eThreadPool::setGlobalThreadCount(eU32 threadCount)
+{
+    m_globalThreadCount = threadCount;
+}
+
+// The executing thread's FPU state is restored
+// afterwards, because it might be a thread which
+// is waiting for jobs of its own.
+void eThreadPool::_forJobProc(ePtr arg, eU32 index)
+{
+    const ForJob *forJob = (const ForJob *)arg;
+    eASSERT(forJob != eNULL);
+
+    eU32 oldFpuState[2];
+    eFpuStateStore(oldFpuState);
+    eFpuStateLoad(forJob->fpuState);
+
+    forJob->func(forJob->arg, index);
+
+    eFpuStateLoad(oldFpuState);
+}
+
+void eThreadPool::_threadProc(ePtr arg)
+{
+    eThreadPool *pool = (eThreadPool *)arg;
+    eASSERT(pool != eNULL);
+
+    while (eTRUE)
+    {
+        pool->m_jobsAvail.wait();
+
+        if (pool->m_quit)
+        {
+            break;
+        }
+
+        pool->runPendingJob();
+    }
 }
\ No newline at end of file
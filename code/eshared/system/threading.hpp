@@ -15,15 +15,31 @@
 #define THREADING_HPP
 
 void    eSleep(eU32 ms);
+eU32    eGetCpuCount();
 
 ePtr    eThreadStart(void (*func)(ePtr arg), ePtr arg, eBool critical);
 void    eThreadEnd(ePtr handle, eBool wait);
+eU32    eThreadGetCurrentId();
+
+eInt    eAtomicInc(volatile eInt &value);
+eInt    eAtomicDec(volatile eInt &value);
+eInt    eAtomicAdd(volatile eInt &value, eInt add);
+eInt    eAtomicCompareExchange(volatile eInt &value, eInt exchange, eInt comparand);
+
+void    eFpuStateStore(eU32 state[2]);
+void    eFpuStateLoad(const eU32 state[2]);
 
 ePtr    eCriticalSectionCreate();
 void    eCriticalSectionDelete(ePtr handle);
 void    eCriticalSectionEnter(ePtr handle);
+eBool   eCriticalSectionTryEnter(ePtr handle);
 void    eCriticalSectionLeave(ePtr handle);
 
+ePtr    eSemaphoreCreate();
+void    eSemaphoreDelete(ePtr handle);
+void    eSemaphoreSignal(ePtr handle, eU32 count);
+void    eSemaphoreWait(ePtr handle);
+
 class eCriticalSection
 {
 public:
@@ -42,6 +58,13 @@ public:
         eCriticalSectionEnter(m_handle);
     }
 
+    // Returns false instead of waiting, if another
+    // thread is inside the critical section.
+    eBool tryEnter() const
+    {
+        return eCriticalSectionTryEnter(m_handle);
+    }
+
     void leave() const
     {
         eCriticalSectionLeave(m_handle);
@@ -51,4 +74,96 @@ private:
     ePtr m_handle;
 };
 
+class eSemaphore
+{
+public:
+    eSemaphore() :
+        m_handle(eSemaphoreCreate())
+    {
+    }
+
+    ~eSemaphore()
+    {
+        eSemaphoreDelete(m_handle);
+    }
+
+    void signal(eU32 count=1) const
+    {
+        eSemaphoreSignal(m_handle, count);
+    }
+
+    void wait() const
+    {
+        eSemaphoreWait(m_handle);
+    }
+
+private:
+    ePtr m_handle;
+};
+
+// Pool of worker threads processing jobs from
+// one shared FIFO queue. Jobs can be attached to
+// a pending counter, which is decremented when
+// the job has finished, so that callers are able
+// to wait for a group of jobs. Threads waiting
+// for jobs help processing the queue instead of
+// blocking, so waiting from inside a job is safe.
+class eThreadPool
+{
+public:
+    typedef void (*JobFunc)(ePtr arg, eU32 index);
+
+public:
+    eThreadPool(eU32 threadCount);
+    ~eThreadPool();
+
+    void                    push(JobFunc func, ePtr arg, eU32 index, volatile eInt *pending=eNULL);
+    void                    parallelFor(JobFunc func, ePtr arg, eU32 count);
+    void                    waitFor(volatile eInt &pending);
+    eBool                   runPendingJob();
+
+    eU32                    getThreadCount() const;
+
+public:
+    static eThreadPool &    get();
+    static void             setGlobalThreadCount(eU32 threadCount);
+
+private:
+    struct Job
+    {
+        JobFunc             func;
+        ePtr                arg;
+        eU32                index;
+        volatile eInt *     pending;
+    };
+
+    typedef eArray<Job> JobArray;
+
+    struct ForJob
+    {
+        JobFunc             func;
+        ePtr                arg;
+        eU32                fpuState[2];
+    };
+
+private:
+    static void             _threadProc(ePtr arg);
+    static void             _forJobProc(ePtr arg, eU32 index);
+
+private:
+    static const eU32       MAX_THREADS = 32;
+
+private:
+    static eU32             m_globalThreadCount;
+
+private:
+    ePtr                    m_threads[MAX_THREADS];
+    eU32                    m_threadCount;
+    JobArray                m_jobs;
+    eU32                    m_nextJob;
+    eCriticalSection        m_lock;
+    eSemaphore              m_jobsAvail;
+    volatile eBool          m_quit;
+};
+
 #endif // THREADING_HPP
\ No newline at end of file
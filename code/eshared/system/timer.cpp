@@ -14,6 +14,8 @@
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <time.h>
 #endif
 
 #include "system.hpp"
@@ -32,6 +34,8 @@ void eTimer::restart()
 {
 #ifdef _WIN32
     QueryPerformanceCounter((LARGE_INTEGER *)&m_startTime);
+#else
+    m_startTime = getTickCount();
 #endif
 }
 
@@ -43,12 +47,15 @@ eU32 eTimer::getElapsedMs() const
     QueryPerformanceCounter((LARGE_INTEGER *)&current);
     return eFtoL((eF32)((eF64)(current-m_startTime-m_correction)/(eF64)m_freq*1000.0));
 #else
-    return 0;
+    return eFtoL((eF32)((eF64)(getTickCount()-m_startTime)/(eF64)m_freq*1000.0));
 #endif
 }
 
+// The static functions can be used without ever
+// constructing a timer, so they initialize it.
 eU32 eTimer::getTimeMs()
 {
+    _initialize();
     return eFtoL((eF32)((eF64)getTickCount()/(eF64)m_freq*1000.0));
 }
 
@@ -60,12 +67,17 @@ eU64 eTimer::getTickCount()
     QueryPerformanceCounter((LARGE_INTEGER *)&current);
     return current-m_correction;
 #else
-    return 0;
+    // Ticks are nanoseconds of the monotonic clock.
+    timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (eU64)ts.tv_sec*1000000000+ts.tv_nsec;
 #endif
 }
 
 eU64 eTimer::getFrequency()
 {
+    _initialize();
     return m_freq;
 }
 
@@ -89,5 +101,8 @@ void eTimer::_initialize()
 
     m_correction = stop-start;
     m_inited = eTRUE;
+#else
+    m_freq = 1000000000;
+    m_inited = eTRUE;
 #endif
 }
\ No newline at end of file
@@ -22,12 +22,16 @@
 #include <arm_neon.h>
 #endif
 
-#ifdef _WIN32
+#if defined(_WIN32) || defined(eUSE_SSE)
 #include <xmmintrin.h>
 #include <emmintrin.h>
 #include <smmintrin.h>
 #endif
 
+#ifdef eUSE_AVX
+#include <immintrin.h>
+#endif
+
 // Token paste macros for concatenating strings
 // for pre-processor usage.
 #define eTOKENPASTE_DEF(x, y)   x##y
@@ -48,7 +52,7 @@
 #define eFORCEINLINE        inline
 #define eINLINE             inline
 #define eNORETURN           
-#define eALIGN16            
+#define eALIGN16            __attribute__((aligned(16)))
 #define eNAKED              
 #define eCALLBACK           
 #endif
@@ -89,15 +93,19 @@ typedef __m128	     		eF32x4;
 #else
 typedef struct eF32x2
 {
+	eF32x2()
+	{
+	}
+
 	eF32x2(eF32 v1, eF32 v2)
 	{
 		v[0] = v1;
 		v[1] = v2;
 	}
 
-	eF32x2(eF32 v)
+	eF32x2(eF32 val)
 	{
-		v[0] = v[1] = v;
+		v[0] = v[1] = val;
 	}
 
 	eF32 v[2];
@@ -105,15 +113,21 @@ typedef struct eF32x2
 
 typedef struct eF32x4
 {
+	eF32x4()
+	{
+	}
+
 	eF32x4(eF32 v1, eF32 v2, eF32 v3, eF32 v4)
 	{
 		v[0] = v1;
 		v[1] = v2;
+		v[2] = v3;
+		v[3] = v4;
 	}
 
-	eF32x4(eF32 v)
+	eF32x4(eF32 val)
 	{
-		v[0] = v[1] = v[2] = v[3] = v;
+		v[0] = v[1] = v[2] = v[3] = val;
 	}
 
 	eF32 v[4];
@@ -13,6 +13,7 @@
 
 #include <QtGui/QApplication>
 #include <QtCore/QFile>
+#include <QtCore/QDir>
 
 #include "gui/mainwnd.hpp"
 #include "../configinfo.hpp"
@@ -41,6 +42,23 @@ static void initApplication()
 	{
 		qApp->setStyleSheet(QString(cssFile.readAll()));
 	}
+
+    // Results of expensive operators are cached
+    // on disk across editor sessions.
+    const QString opCacheDir = QApplication::applicationDirPath()+"/opcache/";
+
+    if (QDir().mkpath(opCacheDir))
+    {
+        eOpResultCache::setDirectory(QDir::toNativeSeparators(opCacheDir).toAscii().constData());
+    }
+
+    // Same for the synthesizer's PADsynth tables.
+    const QString padCacheDir = QApplication::applicationDirPath()+"/padcache/";
+
+    if (QDir().mkpath(padCacheDir))
+    {
+        tfPadSynthCache::get().setDirectory(QDir::toNativeSeparators(padCacheDir).toAscii().constData());
+    }
 }
 
 // Qt application's entry point.
@@ -60,5 +78,7 @@ eInt main(eInt argc, eChar **argv)
     app.setActiveWindow(&mainWnd);
     mainWnd.show();
 
-    return app.exec();
+    const eInt result = app.exec();
+    tfPadSynthCache::get().shutdown();
+    return result;
 }
\ No newline at end of file
@@ -43,6 +43,7 @@ eMainWnd::eMainWnd()
 
     m_instrTable->initRows();
     m_synthCurInstr = 0;
+    m_synthIgnoreParamUI = eFALSE;
     _synthSetActiveInstrument(0);
     _synthInstrumentsLoadAll();
     _synthInitInstrumentDropdown();
@@ -204,6 +205,7 @@ void eMainWnd::_makeConnections()
     connect(m_fileMakeAct, SIGNAL(triggered()), this, SLOT(_onFileMake()));
     connect(m_fileExitAct, SIGNAL(triggered()), this, SLOT(close()));
     connect(m_fullScreenAct, SIGNAL(triggered()), this, SLOT(_onToggleAppFullscreen()));
+    connect(m_actHighPrecisionBitmaps, SIGNAL(toggled(bool)), this, SLOT(_onHighPrecisionBitmaps(bool)));
 
     connect(m_pageTree, SIGNAL(onPageAdded(eID &)), this, SLOT(_onPageAdded(eID &)));
     connect(m_pageTree, SIGNAL(onPageRemoved(eID)), this, SLOT(_onPageRemoved(eID)));
@@ -293,6 +295,7 @@ void eMainWnd::_makeConnections()
 	m_oscPresets->setMenu(presetMenu);
 
 	connect(m_instrSelection, SIGNAL(currentIndexChanged(int)), this, SLOT(_onSynthInstrumentChanged(int)));
+    connect(m_oscView, SIGNAL(onParameterChanged(eU32, eF32)), this, SLOT(_onSynthSplineChanged(eU32, eF32)));
 	//connect(m_instrRestore, SIGNAL(clicked(bool)), this, SLOT(_progRestore(bool)));
 	//connect(m_instrSave, SIGNAL(clicked(bool)), this, SLOT(_progSave(bool)));
 	//connect(m_manageInstruments, SIGNAL(clicked(bool)), this, SLOT(_manage(bool)));
@@ -565,6 +568,25 @@ void eMainWnd::_updateStatusBar()
     buffer += " Vertices, ";
     buffer += eIntToStr(m_renderView->getLastCalcMs());
     buffer += " ms/Processing";
+
+    // Latency of note and transport events until
+    // the audio thread processed them. Dropped
+    // events mean that the queue overflowed.
+    const tfEventQueue::Stats eventStats = eDemo::getSynth().getEventStats();
+
+    if (eventStats.pushed > 0)
+    {
+        buffer += ", Synth events: ";
+        buffer += QString::number(eventStats.avgLatencyMs, 'f', 1);
+        buffer += "/";
+        buffer += QString::number(eventStats.maxLatencyMs, 'f', 1);
+        buffer += " ms latency, ";
+        buffer += eIntToStr(eventStats.maxDepth);
+        buffer += " max. queued, ";
+        buffer += eIntToStr(eventStats.dropped);
+        buffer += " dropped";
+    }
+
     _setStatusText(SBPANE_STATISTICS, buffer);
 
     // Update last pane with project information.
@@ -572,6 +594,34 @@ void eMainWnd::_updateStatusBar()
     buffer += eIntToStr(eDemoData::getPageCount());
     buffer += ", Operators: ";
     buffer += eIntToStr(eDemoData::getTotalOpCount());
+    buffer += ", Cached results: ";
+    buffer += eIntToStr(eProfiler::getCounter(eProfiler::COUNTER_OPCACHE_HITS));
+    buffer += "/";
+    buffer += eIntToStr(eProfiler::getCounter(eProfiler::COUNTER_OPCACHE_HITS)+eProfiler::getCounter(eProfiler::COUNTER_OPCACHE_MISSES));
+
+    // Average vertex cache miss ratio of all currently
+    // loaded static meshes before and after optimizing
+    // them.
+    const eU32 vcacheTris = eProfiler::getCounter(eProfiler::COUNTER_VCACHE_TRIANGLES);
+
+    if (vcacheTris > 0)
+    {
+        buffer += ", ACMR: ";
+        buffer += QString::number((eF32)eProfiler::getCounter(eProfiler::COUNTER_VCACHE_MISSES_RAW)/(eF32)vcacheTris, 'f', 2);
+        buffer += " -> ";
+        buffer += QString::number((eF32)eProfiler::getCounter(eProfiler::COUNTER_VCACHE_MISSES_OPT)/(eF32)vcacheTris, 'f', 2);
+    }
+
+    // Memory used by the seek snapshots of all
+    // particle systems.
+    const eU32 psysSnapshotBytes = eProfiler::getCounter(eProfiler::COUNTER_PSYS_SNAPSHOT_BYTES);
+
+    if (psysSnapshotBytes > 0)
+    {
+        buffer += ", Particle snapshots: ";
+        buffer += eIntToStr(psysSnapshotBytes/1024);
+        buffer += " KB";
+    }
 
     _setStatusText(SBPANE_PRJINFOS, buffer);
 
@@ -1358,6 +1408,30 @@ void eMainWnd::_onToggleAppFullscreen()
     }
 }
 
+// Switches high precision bitmaps on or off. All
+// bitmap operators have to be reexecuted then.
+void eMainWnd::_onHighPrecisionBitmaps(bool enabled)
+{
+    eIBitmapOp::setHighPrecision(enabled);
+
+    for (eU32 i=0; i<eDemoData::getPageCount(); i++)
+    {
+        const eOperatorPage *page = eDemoData::getPageByIndex(i);
+        eASSERT(page != eNULL);
+
+        for (eU32 j=0; j<page->getOperatorCount(); j++)
+        {
+            eIOperator *op = page->getOperatorByIndex(j);
+            eASSERT(op != eNULL);
+
+            if (op->getCategory() == "Bitmap")
+            {
+                op->setChanged();
+            }
+        }
+    }
+}
+
 // Toggles viewport (render frame) fullscreen state,
 // by hiding/showing all other widgets on main window
 // except the render frame (of course) and the statusbar.
@@ -1889,7 +1963,11 @@ void eMainWnd::_synthSetActiveInstrument(eU32 index)
     m_synthAreaContents->setEnabled(m_activeInstr != eNULL);
 	m_oscView->setSynth(m_activeInstr);
 
-    _synthInitParameters();
+    if (m_activeInstr)
+    {
+        _synthInitParameters(m_activeInstr->getParams());
+    }
+
     _synthUpdateOscView();
 }
 
@@ -1898,17 +1976,16 @@ tfInstrument * eMainWnd::_synthGetActiveInstrument()
     return m_activeInstr;
 }
 
-void eMainWnd::_synthInitParameters()
+// The parameters are passed in, as the ones of
+// the instrument are only updated once the
+// audio thread processed the queued changes.
+void eMainWnd::_synthInitParameters(const eF32 *params)
 {
-    if (!m_activeInstr)
-        return;
-
     for(eU32 i=0;i<TF_PARAM_COUNT;i++)
     {
         //if (i == TF_FORMANT_WET) __asm int 3;
 
-        eF32 value = m_activeInstr->getParam(i);
-        _synthSetParameter(i, value);
+        _synthSetParameter(i, params[i]);
     }
 }
 
@@ -1939,8 +2016,7 @@ void eMainWnd::_synthSetParameter(eU32 index, eF32 value)
 {
 	eU32 knob = eRound(value*99);
 
-    if (m_activeInstr)
-        m_activeInstr->setIgnoreParamUI(eTRUE);
+    m_synthIgnoreParamUI = eTRUE;
 
 	switch(index)
 	{
@@ -2177,70 +2253,87 @@ void eMainWnd::_synthSetParameter(eU32 index, eF32 value)
 	case TF_EQ_HIGH:                    m_eqHigh->setValue(knob); break; 
 	}
 
-    if (m_activeInstr)
-        m_activeInstr->setIgnoreParamUI(eFALSE);
+    m_synthIgnoreParamUI = eFALSE;
+}
+
+// Changes made in the UI are queued in the
+// player, because the audio thread might be
+// rendering the instrument. Changing a knob's
+// value when initializing the parameters
+// doesn't lead to a change.
+void eMainWnd::_synthSetParamUI(eU32 index, eF32 value)
+{
+    eASSERT(index < TF_PARAM_COUNT);
+
+    if (m_activeInstr && !m_synthIgnoreParamUI)
+    {
+        if (eAbs(m_activeInstr->getParam(index)-value) >= 0.005f)
+        {
+            eDemo::getSynth().paramEvent(m_synthCurrentInstrument, index, value);
+        }
+    }
 }
 
 void eMainWnd::_onSynthClicked(bool checked)
 {
 	QObject *obj = sender();
 
-	if (obj == m_oscUni1)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(0, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni2)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(1, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni3)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(2, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni4)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(3, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni5)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(4, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni6)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(5, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni7)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(6, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni8)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(7, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni9)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(8, 0, TF_MAXUNISONO-1)); return; }
-	if (obj == m_oscUni10)			{ m_activeInstr->setParamUI(TF_OSC_UNISONO, _synthFromIndex(9, 0, TF_MAXUNISONO-1)); return; }
-
-	if (obj == m_oscOctm4)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(8, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOctm3)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(7, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOctm2)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(6, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOctm1)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(5, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOct0)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(4, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOct1)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(3, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOct2)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(2, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOct3)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(1, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_oscOct4)			{ m_activeInstr->setParamUI(TF_OSC_OCTAVE, _synthFromIndex(0, 0, TF_MAXOCTAVES-1)); return; }
-
-	if (obj == m_oscSub0)           { m_activeInstr->setParamUI(TF_OSC_SUBOSC, _synthFromIndex(0, 0, TF_MAXSUBOSC)); return; }
-	if (obj == m_oscSub1)           { m_activeInstr->setParamUI(TF_OSC_SUBOSC, _synthFromIndex(1, 0, TF_MAXSUBOSC)); return; }
-
-	if (obj == m_addOctm4)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(8, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOctm3)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(7, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOctm2)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(6, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOctm1)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(5, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOct0)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(4, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOct1)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(3, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOct2)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(2, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOct3)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(1, 0, TF_MAXOCTAVES-1)); return; }
-	if (obj == m_addOct4)			{ m_activeInstr->setParamUI(TF_ADD_OCTAVE, _synthFromIndex(0, 0, TF_MAXOCTAVES-1)); return; }
-
-	if (obj == m_addSingle)         { m_activeInstr->setParamUI(TF_ADD_PROFILE, _synthFromIndex(0, 0, TF_ADDSYNTHPROFILES-1)); return; }
-	if (obj == m_addDetuned)        { m_activeInstr->setParamUI(TF_ADD_PROFILE, _synthFromIndex(1, 0, TF_ADDSYNTHPROFILES-1)); return; }
-	if (obj == m_addGauss)          { m_activeInstr->setParamUI(TF_ADD_PROFILE, _synthFromIndex(3, 0, TF_ADDSYNTHPROFILES-1)); return; }
-	if (obj == m_addSpread)         { m_activeInstr->setParamUI(TF_ADD_PROFILE, _synthFromIndex(2, 0, TF_ADDSYNTHPROFILES-1)); return; }
-
-	if (obj == m_lfo1ShapeSine)     { m_activeInstr->setParamUI(TF_LFO1_SHAPE, _synthFromIndex(0, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo1ShapeSawUp)    { m_activeInstr->setParamUI(TF_LFO1_SHAPE, _synthFromIndex(1, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo1ShapeSawDown)  { m_activeInstr->setParamUI(TF_LFO1_SHAPE, _synthFromIndex(2, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo1ShapePulse)    { m_activeInstr->setParamUI(TF_LFO1_SHAPE, _synthFromIndex(3, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo1ShapeNoise)    { m_activeInstr->setParamUI(TF_LFO1_SHAPE, _synthFromIndex(4, 0, TF_LFOSHAPECOUNT)); return; }
-
-	if (obj == m_lfo2ShapeSine)     { m_activeInstr->setParamUI(TF_LFO2_SHAPE, _synthFromIndex(0, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo2ShapeSawUp)    { m_activeInstr->setParamUI(TF_LFO2_SHAPE, _synthFromIndex(1, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo2ShapeSawDown)  { m_activeInstr->setParamUI(TF_LFO2_SHAPE, _synthFromIndex(2, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo2ShapePulse)    { m_activeInstr->setParamUI(TF_LFO2_SHAPE, _synthFromIndex(3, 0, TF_LFOSHAPECOUNT)); return; }
-	if (obj == m_lfo2ShapeNoise)    { m_activeInstr->setParamUI(TF_LFO2_SHAPE, _synthFromIndex(4, 0, TF_LFOSHAPECOUNT)); return; }
-
-	if (obj == m_formantA)          { m_activeInstr->setParamUI(TF_FORMANT_MODE, _synthFromIndex(0, 0, 4)); return; }
-	if (obj == m_formantE)          { m_activeInstr->setParamUI(TF_FORMANT_MODE, _synthFromIndex(1, 0, 4)); return; }
-	if (obj == m_formantI)          { m_activeInstr->setParamUI(TF_FORMANT_MODE, _synthFromIndex(2, 0, 4)); return; }
-	if (obj == m_formantO)          { m_activeInstr->setParamUI(TF_FORMANT_MODE, _synthFromIndex(3, 0, 4)); return; }
-	if (obj == m_formantU)          { m_activeInstr->setParamUI(TF_FORMANT_MODE, _synthFromIndex(4, 0, 4)); return; }
+	if (obj == m_oscUni1)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(0, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni2)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(1, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni3)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(2, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni4)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(3, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni5)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(4, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni6)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(5, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni7)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(6, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni8)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(7, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni9)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(8, 0, TF_MAXUNISONO-1)); return; }
+	if (obj == m_oscUni10)			{ _synthSetParamUI(TF_OSC_UNISONO, _synthFromIndex(9, 0, TF_MAXUNISONO-1)); return; }
+
+	if (obj == m_oscOctm4)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(8, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOctm3)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(7, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOctm2)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(6, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOctm1)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(5, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOct0)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(4, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOct1)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(3, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOct2)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(2, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOct3)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(1, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_oscOct4)			{ _synthSetParamUI(TF_OSC_OCTAVE, _synthFromIndex(0, 0, TF_MAXOCTAVES-1)); return; }
+
+	if (obj == m_oscSub0)           { _synthSetParamUI(TF_OSC_SUBOSC, _synthFromIndex(0, 0, TF_MAXSUBOSC)); return; }
+	if (obj == m_oscSub1)           { _synthSetParamUI(TF_OSC_SUBOSC, _synthFromIndex(1, 0, TF_MAXSUBOSC)); return; }
+
+	if (obj == m_addOctm4)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(8, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOctm3)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(7, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOctm2)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(6, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOctm1)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(5, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOct0)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(4, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOct1)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(3, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOct2)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(2, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOct3)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(1, 0, TF_MAXOCTAVES-1)); return; }
+	if (obj == m_addOct4)			{ _synthSetParamUI(TF_ADD_OCTAVE, _synthFromIndex(0, 0, TF_MAXOCTAVES-1)); return; }
+
+	if (obj == m_addSingle)         { _synthSetParamUI(TF_ADD_PROFILE, _synthFromIndex(0, 0, TF_ADDSYNTHPROFILES-1)); return; }
+	if (obj == m_addDetuned)        { _synthSetParamUI(TF_ADD_PROFILE, _synthFromIndex(1, 0, TF_ADDSYNTHPROFILES-1)); return; }
+	if (obj == m_addGauss)          { _synthSetParamUI(TF_ADD_PROFILE, _synthFromIndex(3, 0, TF_ADDSYNTHPROFILES-1)); return; }
+	if (obj == m_addSpread)         { _synthSetParamUI(TF_ADD_PROFILE, _synthFromIndex(2, 0, TF_ADDSYNTHPROFILES-1)); return; }
+
+	if (obj == m_lfo1ShapeSine)     { _synthSetParamUI(TF_LFO1_SHAPE, _synthFromIndex(0, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo1ShapeSawUp)    { _synthSetParamUI(TF_LFO1_SHAPE, _synthFromIndex(1, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo1ShapeSawDown)  { _synthSetParamUI(TF_LFO1_SHAPE, _synthFromIndex(2, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo1ShapePulse)    { _synthSetParamUI(TF_LFO1_SHAPE, _synthFromIndex(3, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo1ShapeNoise)    { _synthSetParamUI(TF_LFO1_SHAPE, _synthFromIndex(4, 0, TF_LFOSHAPECOUNT)); return; }
+
+	if (obj == m_lfo2ShapeSine)     { _synthSetParamUI(TF_LFO2_SHAPE, _synthFromIndex(0, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo2ShapeSawUp)    { _synthSetParamUI(TF_LFO2_SHAPE, _synthFromIndex(1, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo2ShapeSawDown)  { _synthSetParamUI(TF_LFO2_SHAPE, _synthFromIndex(2, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo2ShapePulse)    { _synthSetParamUI(TF_LFO2_SHAPE, _synthFromIndex(3, 0, TF_LFOSHAPECOUNT)); return; }
+	if (obj == m_lfo2ShapeNoise)    { _synthSetParamUI(TF_LFO2_SHAPE, _synthFromIndex(4, 0, TF_LFOSHAPECOUNT)); return; }
+
+	if (obj == m_formantA)          { _synthSetParamUI(TF_FORMANT_MODE, _synthFromIndex(0, 0, 4)); return; }
+	if (obj == m_formantE)          { _synthSetParamUI(TF_FORMANT_MODE, _synthFromIndex(1, 0, 4)); return; }
+	if (obj == m_formantI)          { _synthSetParamUI(TF_FORMANT_MODE, _synthFromIndex(2, 0, 4)); return; }
+	if (obj == m_formantO)          { _synthSetParamUI(TF_FORMANT_MODE, _synthFromIndex(3, 0, 4)); return; }
+	if (obj == m_formantU)          { _synthSetParamUI(TF_FORMANT_MODE, _synthFromIndex(4, 0, 4)); return; }
 }
 
 void eMainWnd::_onSynthChanged(double value)
@@ -2253,16 +2346,16 @@ void eMainWnd::_onSynthChanged(double value)
     const QObject *obj = sender();
     eASSERT(obj != eNULL);
 
-    if (obj == m_mm1Mod)            { m_activeInstr->setParamUI(TF_MM1_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm2Mod)            { m_activeInstr->setParamUI(TF_MM2_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm3Mod)            { m_activeInstr->setParamUI(TF_MM3_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm4Mod)            { m_activeInstr->setParamUI(TF_MM4_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm5Mod)            { m_activeInstr->setParamUI(TF_MM5_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm6Mod)            { m_activeInstr->setParamUI(TF_MM6_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm7Mod)            { m_activeInstr->setParamUI(TF_MM7_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm8Mod)            { m_activeInstr->setParamUI(TF_MM8_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm9Mod)            { m_activeInstr->setParamUI(TF_MM9_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
-    if (obj == m_mm10Mod)           { m_activeInstr->setParamUI(TF_MM10_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm1Mod)            { _synthSetParamUI(TF_MM1_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm2Mod)            { _synthSetParamUI(TF_MM2_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm3Mod)            { _synthSetParamUI(TF_MM3_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm4Mod)            { _synthSetParamUI(TF_MM4_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm5Mod)            { _synthSetParamUI(TF_MM5_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm6Mod)            { _synthSetParamUI(TF_MM6_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm7Mod)            { _synthSetParamUI(TF_MM7_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm8Mod)            { _synthSetParamUI(TF_MM8_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm9Mod)            { _synthSetParamUI(TF_MM9_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
+    if (obj == m_mm10Mod)           { _synthSetParamUI(TF_MM10_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
 }
 
 void eMainWnd::_onSynthChanged(int value)
@@ -2277,122 +2370,122 @@ void eMainWnd::_onSynthChanged(int value)
 
     const eF32 knob = (eF32)value/99;
 
-	if (obj == m_gainAmount)        { m_activeInstr->setParamUI(TF_GAIN_AMOUNT, knob); return; }
-	if (obj == m_oscPoints)         { m_activeInstr->setParamUI(TF_OSC_POINTCOUNT, _synthFromIndex(value, 0, TF_OSCILLATOR_POINTS-3)); _synthUpdateOscView(); return; }
-	if (obj == m_oscVolume)         { m_activeInstr->setParamUI(TF_OSC_VOLUME, knob); return; }
-	if (obj == m_oscFreq)           { m_activeInstr->setParamUI(TF_OSC_FREQ, knob); return; }
-	if (obj == m_oscPanning)        { m_activeInstr->setParamUI(TF_OSC_PAN, knob); return; }
-	if (obj == m_oscDetune)         { m_activeInstr->setParamUI(TF_OSC_DETUNE, knob); return; }
-	if (obj == m_oscPolyphony)      { m_activeInstr->setParamUI(TF_OSC_POLYPHONY, _synthFromIndex(value, 0, TF_MAXVOICES-1)); return; }
-	if (obj == m_oscSpread)         { m_activeInstr->setParamUI(TF_OSC_SPREAD, knob); return; }
-	if (obj == m_oscGlide)          { m_activeInstr->setParamUI(TF_OSC_GLIDE, knob); return; }
-	if (obj == m_oscDrive)          { m_activeInstr->setParamUI(TF_OSC_DRIVE, knob); _synthUpdateOscView(); return; }
-	if (obj == m_oscSlop)           { m_activeInstr->setParamUI(TF_OSC_SLOP, knob); return; }
-
-	if (obj == m_addVolume)         { m_activeInstr->setParamUI(TF_ADD_VOLUME, knob); return; }
-	if (obj == m_addBandwidth)      { m_activeInstr->setParamUI(TF_ADD_BANDWIDTH, knob); return; }
-	if (obj == m_addDamp)           { m_activeInstr->setParamUI(TF_ADD_DAMP, knob); return; }
-	if (obj == m_addHarmonics)      { m_activeInstr->setParamUI(TF_ADD_HARMONICS, knob); return; }
-	if (obj == m_addScale)          { m_activeInstr->setParamUI(TF_ADD_SCALE, knob); return; }
-	if (obj == m_addDrive)          { m_activeInstr->setParamUI(TF_ADD_DRIVE, knob); return; }
-
-	if (obj == m_noiseAmount)       { m_activeInstr->setParamUI(TF_NOISE_AMOUNT, knob); return; }
-	if (obj == m_noiseFreq)         { m_activeInstr->setParamUI(TF_NOISE_FREQ, knob); return; }
-	if (obj == m_noiseBW)           { m_activeInstr->setParamUI(TF_NOISE_BW, knob); return; }
-
-	if (obj == m_lpFreq)            { m_activeInstr->setParamUI(TF_LP_FILTER_CUTOFF, knob); return; }
-	if (obj == m_lpRes)             { m_activeInstr->setParamUI(TF_LP_FILTER_RESONANCE, knob); return; }
-	if (obj == m_lpOn)              { m_activeInstr->setParamUI(TF_LP_FILTER_ON, value ? 1.0f : 0.0f); return; }
-
-	if (obj == m_hpFreq)            { m_activeInstr->setParamUI(TF_HP_FILTER_CUTOFF, knob); return; }
-	if (obj == m_hpRes)             { m_activeInstr->setParamUI(TF_HP_FILTER_RESONANCE, knob); return; }
-	if (obj == m_hpOn)              { m_activeInstr->setParamUI(TF_HP_FILTER_ON, value ? 1.0f : 0.0f); return; }
-
-	if (obj == m_bpFreq)            { m_activeInstr->setParamUI(TF_BP_FILTER_CUTOFF, knob); return; }
-	if (obj == m_bpQ)               { m_activeInstr->setParamUI(TF_BP_FILTER_Q, knob); return; }
-	if (obj == m_bpOn)              { m_activeInstr->setParamUI(TF_BP_FILTER_ON, value ? 1.0f : 0.0f); return; }
-
-	if (obj == m_ntFreq)            { m_activeInstr->setParamUI(TF_NT_FILTER_CUTOFF, knob); return; }
-	if (obj == m_ntQ)               { m_activeInstr->setParamUI(TF_NT_FILTER_Q, knob); return; }
-	if (obj == m_ntOn)              { m_activeInstr->setParamUI(TF_NT_FILTER_ON, value ? 1.0f : 0.0f); return; }
-
-	if (obj == m_adsr1A)            { m_activeInstr->setParamUI(TF_ADSR1_ATTACK, knob); return; }
-	if (obj == m_adsr1D)            { m_activeInstr->setParamUI(TF_ADSR1_DECAY, knob); return; }
-	if (obj == m_adsr1S)            { m_activeInstr->setParamUI(TF_ADSR1_SUSTAIN, knob); return; }
-	if (obj == m_adsr1R)            { m_activeInstr->setParamUI(TF_ADSR1_RELEASE, knob); return; }
-	if (obj == m_adsr1Slope)        { m_activeInstr->setParamUI(TF_ADSR1_SLOPE, knob); return; }
-
-	if (obj == m_adsr2A)            { m_activeInstr->setParamUI(TF_ADSR2_ATTACK, knob); return; }
-	if (obj == m_adsr2D)            { m_activeInstr->setParamUI(TF_ADSR2_DECAY, knob); return; }
-	if (obj == m_adsr2S)            { m_activeInstr->setParamUI(TF_ADSR2_SUSTAIN, knob); return; }
-	if (obj == m_adsr2R)            { m_activeInstr->setParamUI(TF_ADSR2_RELEASE, knob); return; }
-	if (obj == m_adsr2Slope)        { m_activeInstr->setParamUI(TF_ADSR2_SLOPE, knob); return; }
-
-	if (obj == m_lfo1Rate)          { m_activeInstr->setParamUI(TF_LFO1_RATE, knob); return; }
-	if (obj == m_lfo1Depth)         { m_activeInstr->setParamUI(TF_LFO1_DEPTH, knob); return; }
-	if (obj == m_lfo1Sync)          { m_activeInstr->setParamUI(TF_LFO1_SYNC, value ? 1.0f : 0.0f); return; }
-
-	if (obj == m_lfo2Rate)          { m_activeInstr->setParamUI(TF_LFO2_RATE, knob); return; }
-	if (obj == m_lfo2Depth)         { m_activeInstr->setParamUI(TF_LFO2_DEPTH, knob); return; }
-	if (obj == m_lfo2Sync)          { m_activeInstr->setParamUI(TF_LFO2_SYNC, value ? 1.0f : 0.0f); return; }
-
-	if (obj == m_mm1Src)            { m_activeInstr->setParamUI(TF_MM1_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm1Dest)           { m_activeInstr->setParamUI(TF_MM1_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm2Src)            { m_activeInstr->setParamUI(TF_MM2_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm2Dest)           { m_activeInstr->setParamUI(TF_MM2_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm3Src)            { m_activeInstr->setParamUI(TF_MM3_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm3Dest)           { m_activeInstr->setParamUI(TF_MM3_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm4Src)            { m_activeInstr->setParamUI(TF_MM4_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm4Dest)           { m_activeInstr->setParamUI(TF_MM4_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm5Src)            { m_activeInstr->setParamUI(TF_MM5_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm5Dest)           { m_activeInstr->setParamUI(TF_MM5_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm6Src)            { m_activeInstr->setParamUI(TF_MM6_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm6Dest)           { m_activeInstr->setParamUI(TF_MM6_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm7Src)            { m_activeInstr->setParamUI(TF_MM7_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm7Dest)           { m_activeInstr->setParamUI(TF_MM7_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm8Src)            { m_activeInstr->setParamUI(TF_MM8_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm8Dest)           { m_activeInstr->setParamUI(TF_MM8_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm9Src)            { m_activeInstr->setParamUI(TF_MM9_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm9Dest)           { m_activeInstr->setParamUI(TF_MM9_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-	if (obj == m_mm10Src)           { m_activeInstr->setParamUI(TF_MM10_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
-	if (obj == m_mm10Dest)          { m_activeInstr->setParamUI(TF_MM10_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
-
-	if (obj == m_effect1)           { m_activeInstr->setParamUI(TF_EFFECT_1, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect2)           { m_activeInstr->setParamUI(TF_EFFECT_2, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect3)           { m_activeInstr->setParamUI(TF_EFFECT_3, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect4)           { m_activeInstr->setParamUI(TF_EFFECT_4, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect5)           { m_activeInstr->setParamUI(TF_EFFECT_5, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect6)           { m_activeInstr->setParamUI(TF_EFFECT_6, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect7)           { m_activeInstr->setParamUI(TF_EFFECT_7, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect8)           { m_activeInstr->setParamUI(TF_EFFECT_8, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect9)           { m_activeInstr->setParamUI(TF_EFFECT_9, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-	if (obj == m_effect10)          { m_activeInstr->setParamUI(TF_EFFECT_10, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
-
-	if (obj == m_distAmount)        { m_activeInstr->setParamUI(TF_DISTORT_AMOUNT, knob); return; }
-
-	if (obj == m_chorusFreq)        { m_activeInstr->setParamUI(TF_CHORUS_RATE, knob); return; }
-	if (obj == m_chorusDepth)       { m_activeInstr->setParamUI(TF_CHORUS_DEPTH, knob); return; }
-	if (obj == m_chorusGain)        { m_activeInstr->setParamUI(TF_CHORUS_GAIN, knob); return; }
-
-	if (obj == m_delayLeft)         { m_activeInstr->setParamUI(TF_DELAY_LEFT, knob); return; }
-	if (obj == m_delayRight)        { m_activeInstr->setParamUI(TF_DELAY_RIGHT, knob); return; }
-	if (obj == m_delayDecay)        { m_activeInstr->setParamUI(TF_DELAY_DECAY, knob); return; }
-
-	if (obj == m_revRoomsize)       { m_activeInstr->setParamUI(TF_REVERB_ROOMSIZE, knob); return; }
-	if (obj == m_revDamp)           { m_activeInstr->setParamUI(TF_REVERB_DAMP, knob); return; }
-	if (obj == m_revWet)            { m_activeInstr->setParamUI(TF_REVERB_WET, knob); return; }
-	if (obj == m_revWidth)          { m_activeInstr->setParamUI(TF_REVERB_WIDTH, knob); return; }
-
-	if (obj == m_flangLfo)          { m_activeInstr->setParamUI(TF_FLANGER_LFO, knob); return; }
-	if (obj == m_flangFreq)         { m_activeInstr->setParamUI(TF_FLANGER_FREQUENCY, knob); return; }
-	if (obj == m_flangAmp)          { m_activeInstr->setParamUI(TF_FLANGER_AMPLITUDE, knob); return; }
-	if (obj == m_flangWet)          { m_activeInstr->setParamUI(TF_FLANGER_WET, knob); return; }
-
-	if (obj == m_formantWet)        { m_activeInstr->setParamUI(TF_FORMANT_WET, knob); return; }
-
-	if (obj == m_eqLow)             { m_activeInstr->setParamUI(TF_EQ_LOW, knob); return; }
-	if (obj == m_eqMid)             { m_activeInstr->setParamUI(TF_EQ_MID, knob); return; }
-	if (obj == m_eqHigh)            { m_activeInstr->setParamUI(TF_EQ_HIGH, knob); return; }
+	if (obj == m_gainAmount)        { _synthSetParamUI(TF_GAIN_AMOUNT, knob); return; }
+	if (obj == m_oscPoints)         { _synthSetParamUI(TF_OSC_POINTCOUNT, _synthFromIndex(value, 0, TF_OSCILLATOR_POINTS-3)); _synthUpdateOscView(); return; }
+	if (obj == m_oscVolume)         { _synthSetParamUI(TF_OSC_VOLUME, knob); return; }
+	if (obj == m_oscFreq)           { _synthSetParamUI(TF_OSC_FREQ, knob); return; }
+	if (obj == m_oscPanning)        { _synthSetParamUI(TF_OSC_PAN, knob); return; }
+	if (obj == m_oscDetune)         { _synthSetParamUI(TF_OSC_DETUNE, knob); return; }
+	if (obj == m_oscPolyphony)      { _synthSetParamUI(TF_OSC_POLYPHONY, _synthFromIndex(value, 0, TF_MAXVOICES-1)); return; }
+	if (obj == m_oscSpread)         { _synthSetParamUI(TF_OSC_SPREAD, knob); return; }
+	if (obj == m_oscGlide)          { _synthSetParamUI(TF_OSC_GLIDE, knob); return; }
+	if (obj == m_oscDrive)          { _synthSetParamUI(TF_OSC_DRIVE, knob); _synthUpdateOscView(); return; }
+	if (obj == m_oscSlop)           { _synthSetParamUI(TF_OSC_SLOP, knob); return; }
+
+	if (obj == m_addVolume)         { _synthSetParamUI(TF_ADD_VOLUME, knob); return; }
+	if (obj == m_addBandwidth)      { _synthSetParamUI(TF_ADD_BANDWIDTH, knob); return; }
+	if (obj == m_addDamp)           { _synthSetParamUI(TF_ADD_DAMP, knob); return; }
+	if (obj == m_addHarmonics)      { _synthSetParamUI(TF_ADD_HARMONICS, knob); return; }
+	if (obj == m_addScale)          { _synthSetParamUI(TF_ADD_SCALE, knob); return; }
+	if (obj == m_addDrive)          { _synthSetParamUI(TF_ADD_DRIVE, knob); return; }
+
+	if (obj == m_noiseAmount)       { _synthSetParamUI(TF_NOISE_AMOUNT, knob); return; }
+	if (obj == m_noiseFreq)         { _synthSetParamUI(TF_NOISE_FREQ, knob); return; }
+	if (obj == m_noiseBW)           { _synthSetParamUI(TF_NOISE_BW, knob); return; }
+
+	if (obj == m_lpFreq)            { _synthSetParamUI(TF_LP_FILTER_CUTOFF, knob); return; }
+	if (obj == m_lpRes)             { _synthSetParamUI(TF_LP_FILTER_RESONANCE, knob); return; }
+	if (obj == m_lpOn)              { _synthSetParamUI(TF_LP_FILTER_ON, value ? 1.0f : 0.0f); return; }
+
+	if (obj == m_hpFreq)            { _synthSetParamUI(TF_HP_FILTER_CUTOFF, knob); return; }
+	if (obj == m_hpRes)             { _synthSetParamUI(TF_HP_FILTER_RESONANCE, knob); return; }
+	if (obj == m_hpOn)              { _synthSetParamUI(TF_HP_FILTER_ON, value ? 1.0f : 0.0f); return; }
+
+	if (obj == m_bpFreq)            { _synthSetParamUI(TF_BP_FILTER_CUTOFF, knob); return; }
+	if (obj == m_bpQ)               { _synthSetParamUI(TF_BP_FILTER_Q, knob); return; }
+	if (obj == m_bpOn)              { _synthSetParamUI(TF_BP_FILTER_ON, value ? 1.0f : 0.0f); return; }
+
+	if (obj == m_ntFreq)            { _synthSetParamUI(TF_NT_FILTER_CUTOFF, knob); return; }
+	if (obj == m_ntQ)               { _synthSetParamUI(TF_NT_FILTER_Q, knob); return; }
+	if (obj == m_ntOn)              { _synthSetParamUI(TF_NT_FILTER_ON, value ? 1.0f : 0.0f); return; }
+
+	if (obj == m_adsr1A)            { _synthSetParamUI(TF_ADSR1_ATTACK, knob); return; }
+	if (obj == m_adsr1D)            { _synthSetParamUI(TF_ADSR1_DECAY, knob); return; }
+	if (obj == m_adsr1S)            { _synthSetParamUI(TF_ADSR1_SUSTAIN, knob); return; }
+	if (obj == m_adsr1R)            { _synthSetParamUI(TF_ADSR1_RELEASE, knob); return; }
+	if (obj == m_adsr1Slope)        { _synthSetParamUI(TF_ADSR1_SLOPE, knob); return; }
+
+	if (obj == m_adsr2A)            { _synthSetParamUI(TF_ADSR2_ATTACK, knob); return; }
+	if (obj == m_adsr2D)            { _synthSetParamUI(TF_ADSR2_DECAY, knob); return; }
+	if (obj == m_adsr2S)            { _synthSetParamUI(TF_ADSR2_SUSTAIN, knob); return; }
+	if (obj == m_adsr2R)            { _synthSetParamUI(TF_ADSR2_RELEASE, knob); return; }
+	if (obj == m_adsr2Slope)        { _synthSetParamUI(TF_ADSR2_SLOPE, knob); return; }
+
+	if (obj == m_lfo1Rate)          { _synthSetParamUI(TF_LFO1_RATE, knob); return; }
+	if (obj == m_lfo1Depth)         { _synthSetParamUI(TF_LFO1_DEPTH, knob); return; }
+	if (obj == m_lfo1Sync)          { _synthSetParamUI(TF_LFO1_SYNC, value ? 1.0f : 0.0f); return; }
+
+	if (obj == m_lfo2Rate)          { _synthSetParamUI(TF_LFO2_RATE, knob); return; }
+	if (obj == m_lfo2Depth)         { _synthSetParamUI(TF_LFO2_DEPTH, knob); return; }
+	if (obj == m_lfo2Sync)          { _synthSetParamUI(TF_LFO2_SYNC, value ? 1.0f : 0.0f); return; }
+
+	if (obj == m_mm1Src)            { _synthSetParamUI(TF_MM1_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm1Dest)           { _synthSetParamUI(TF_MM1_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm2Src)            { _synthSetParamUI(TF_MM2_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm2Dest)           { _synthSetParamUI(TF_MM2_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm3Src)            { _synthSetParamUI(TF_MM3_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm3Dest)           { _synthSetParamUI(TF_MM3_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm4Src)            { _synthSetParamUI(TF_MM4_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm4Dest)           { _synthSetParamUI(TF_MM4_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm5Src)            { _synthSetParamUI(TF_MM5_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm5Dest)           { _synthSetParamUI(TF_MM5_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm6Src)            { _synthSetParamUI(TF_MM6_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm6Dest)           { _synthSetParamUI(TF_MM6_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm7Src)            { _synthSetParamUI(TF_MM7_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm7Dest)           { _synthSetParamUI(TF_MM7_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm8Src)            { _synthSetParamUI(TF_MM8_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm8Dest)           { _synthSetParamUI(TF_MM8_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm9Src)            { _synthSetParamUI(TF_MM9_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm9Dest)           { _synthSetParamUI(TF_MM9_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+	if (obj == m_mm10Src)           { _synthSetParamUI(TF_MM10_SOURCE, _synthFromIndex(value, 0, tfModMatrix::INPUT_COUNT-1)); return; }
+	if (obj == m_mm10Dest)          { _synthSetParamUI(TF_MM10_TARGET, _synthFromIndex(value, 0, tfModMatrix::OUTPUT_COUNT-1)); return; }
+
+	if (obj == m_effect1)           { _synthSetParamUI(TF_EFFECT_1, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect2)           { _synthSetParamUI(TF_EFFECT_2, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect3)           { _synthSetParamUI(TF_EFFECT_3, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect4)           { _synthSetParamUI(TF_EFFECT_4, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect5)           { _synthSetParamUI(TF_EFFECT_5, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect6)           { _synthSetParamUI(TF_EFFECT_6, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect7)           { _synthSetParamUI(TF_EFFECT_7, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect8)           { _synthSetParamUI(TF_EFFECT_8, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect9)           { _synthSetParamUI(TF_EFFECT_9, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+	if (obj == m_effect10)          { _synthSetParamUI(TF_EFFECT_10, _synthFromIndex(value, 0, tfIEffect::FX_COUNT-1)); return; }
+
+	if (obj == m_distAmount)        { _synthSetParamUI(TF_DISTORT_AMOUNT, knob); return; }
+
+	if (obj == m_chorusFreq)        { _synthSetParamUI(TF_CHORUS_RATE, knob); return; }
+	if (obj == m_chorusDepth)       { _synthSetParamUI(TF_CHORUS_DEPTH, knob); return; }
+	if (obj == m_chorusGain)        { _synthSetParamUI(TF_CHORUS_GAIN, knob); return; }
+
+	if (obj == m_delayLeft)         { _synthSetParamUI(TF_DELAY_LEFT, knob); return; }
+	if (obj == m_delayRight)        { _synthSetParamUI(TF_DELAY_RIGHT, knob); return; }
+	if (obj == m_delayDecay)        { _synthSetParamUI(TF_DELAY_DECAY, knob); return; }
+
+	if (obj == m_revRoomsize)       { _synthSetParamUI(TF_REVERB_ROOMSIZE, knob); return; }
+	if (obj == m_revDamp)           { _synthSetParamUI(TF_REVERB_DAMP, knob); return; }
+	if (obj == m_revWet)            { _synthSetParamUI(TF_REVERB_WET, knob); return; }
+	if (obj == m_revWidth)          { _synthSetParamUI(TF_REVERB_WIDTH, knob); return; }
+
+	if (obj == m_flangLfo)          { _synthSetParamUI(TF_FLANGER_LFO, knob); return; }
+	if (obj == m_flangFreq)         { _synthSetParamUI(TF_FLANGER_FREQUENCY, knob); return; }
+	if (obj == m_flangAmp)          { _synthSetParamUI(TF_FLANGER_AMPLITUDE, knob); return; }
+	if (obj == m_flangWet)          { _synthSetParamUI(TF_FLANGER_WET, knob); return; }
+
+	if (obj == m_formantWet)        { _synthSetParamUI(TF_FORMANT_WET, knob); return; }
+
+	if (obj == m_eqLow)             { _synthSetParamUI(TF_EQ_LOW, knob); return; }
+	if (obj == m_eqMid)             { _synthSetParamUI(TF_EQ_MID, knob); return; }
+	if (obj == m_eqHigh)            { _synthSetParamUI(TF_EQ_HIGH, knob); return; }
 }
 
 void eMainWnd::updateAfterPreset()
@@ -2407,7 +2500,7 @@ void eMainWnd::setPresetValue(eU32 index, eF32 value)
 		return;
 	}
 
-	m_activeInstr->setParam(index, value);
+	eDemo::getSynth().paramEvent(m_synthCurrentInstrument, index, value);
 	_synthSetParameter(index, value);
 }
 
@@ -2549,14 +2642,19 @@ void eMainWnd::_onSynthInstrumentChanged(int value)
 
     for (eInt i=0; i<TF_PARAM_COUNT; i++)
     {
-        m_activeInstr->setParamUI(i, ap.params[i]);
+        _synthSetParamUI(i, ap.params[i]);
     }
 
     _synthUpdateInstrumentName();
-    _synthInitParameters();
+    _synthInitParameters(ap.params);
     _synthUpdateOscView();
 }
 
+void eMainWnd::_onSynthSplineChanged(eU32 index, eF32 value)
+{
+    _synthSetParamUI(index, value);
+}
+
 void eMainWnd::_onSynthInstrNameChanged(const QString &name)
 {
     eStrCopy(m_synthInstrs[m_synthCurInstr].name, name.toAscii().constData());
@@ -2625,7 +2723,7 @@ eBool eMainWnd::_synthInstrumentLoad(eU32 index)
 
                 for (eInt i=0; i<TF_PARAM_COUNT; i++)
                 {
-                    m_activeInstr->setParamUI(i, ap.params[i]);
+                    _synthSetParamUI(i, ap.params[i]);
                 }
             }
 
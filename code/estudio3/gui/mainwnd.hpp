@@ -72,7 +72,8 @@ private:
     eU32                        _synthToIndex(eF32 value, eU32 min, eU32 max);
     eF32                        _synthFromIndex(eU32 value, eU32 min, eU32 max);
     void                        _synthSetParameter(eU32 index, eF32 value);
-    void                        _synthInitParameters();
+    void                        _synthSetParamUI(eU32 index, eF32 value);
+    void                        _synthInitParameters(const eF32 *params);
     void                        _synthUpdateOscView();
     void                        _synthSetActiveInstrument(eU32 index);
     tfInstrument *              _synthGetActiveInstrument();
@@ -111,6 +112,7 @@ private Q_SLOTS:
     void                        _onSwitchToPageView();
 
     void                        _onToggleAppFullscreen();
+    void                        _onHighPrecisionBitmaps(bool enabled);
     void                        _onToggleViewportFullscreen();
 
     void                        _onDemoSeqScaleChanged(int value);
@@ -154,6 +156,7 @@ private Q_SLOTS:
     void                        _onSynthChanged(double value);
     void                        _onSynthChanged(int value);
     void                        _onSynthInstrumentChanged(int value);
+    void                        _onSynthSplineChanged(eU32 index, eF32 value);
     void                        _onSynthInstrNameChanged(const QString &name);
     void                        _onInstrumentChanged();
     void                        _onRemoveInstrument();
@@ -219,6 +222,7 @@ private:
     tfInstrument::Data          m_synthInstrs[TF_NUM_PRESETS];
     eU32                        m_synthCurInstr;
     eU32                        m_synthCurrentInstrument;
+    eBool                       m_synthIgnoreParamUI;
 
 	QPixmap *					m_pixSine;
 	QPixmap	*					m_pixSawUp;
@@ -892,7 +892,7 @@ void eRenderView::_updateNormalsMesh(const eEditMesh &mesh, eF32 length)
     for (eU32 i=0; i<mesh.getFaceCount(); i++)
     {
         const eVector3 &normal = mesh.getFace(i)->normal;
-        const eVector3 &pos = mesh.getFace(i)->getCenter().position;
+        const eVector3 &pos = mesh.getFace(i)->getCenter();
 
         m_normalsMesh.addLine(pos, pos+normal*length, eColor::RED, eMaterial::getWireframe());
     }
@@ -903,7 +903,7 @@ void eRenderView::_updateNormalsMesh(const eEditMesh &mesh, eF32 length)
         const eEditMesh::Vertex *vtx = mesh.getVertex(i);
         eASSERT(vtx != eNULL);
 
-        m_normalsMesh.addLine(vtx->position, vtx->position+vtx->normal*length, eColor::GREEN, eMaterial::getWireframe());
+        m_normalsMesh.addLine(vtx->getPosition(), vtx->getPosition()+vtx->getNormal()*length, eColor::GREEN, eMaterial::getWireframe());
     }
 
     m_normalsMesh.finishLoading(eMesh::TYPE_DYNAMIC);
@@ -929,7 +929,7 @@ void eRenderView::_updateWireframeMesh(const eEditMesh &mesh, eF32 selVertexSize
 
             do
             {
-                m_wireframeMesh.addVertex(he->origin->position, eColor::ORANGE);
+                m_wireframeMesh.addVertex(he->origin->getPosition(), eColor::ORANGE);
                 he = he->next;
             }
             while (he != face->he);
@@ -950,8 +950,8 @@ void eRenderView::_updateWireframeMesh(const eEditMesh &mesh, eF32 selVertexSize
         const eEditMesh::Edge *edge = mesh.getEdge(i);
         eASSERT(edge != eNULL);
 
-        const eVector3 &pos0 = edge->he0->origin->position;
-        const eVector3 &pos1 = edge->he1->origin->position;
+        const eVector3 &pos0 = edge->he0->origin->getPosition();
+        const eVector3 &pos1 = edge->he1->origin->getPosition();
 
         m_wireframeMesh.addLine(pos0, pos1, colors[edge->selected], eMaterial::getWireframe());
     }
@@ -964,7 +964,7 @@ void eRenderView::_updateWireframeMesh(const eEditMesh &mesh, eF32 selVertexSize
 
         if (vtx->selected)
         {
-            m_wireframeMesh.addPoint(vtx->position, eColor::ORANGE, eMaterial::getWireframe());
+            m_wireframeMesh.addPoint(vtx->getPosition(), eColor::ORANGE, eMaterial::getWireframe());
         }
     }
 
@@ -11,6 +11,9 @@
  *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#include <QtCore/QFile>
+#include <QtGui/QFileDialog>
+#include <QtGui/QMessageBox>
 #include <QtGui/QMenu>
 
 #include "songlist.hpp"
@@ -105,6 +108,45 @@ void eSongList::_onRenameSong()
     }
 }
 
+// Exports the selected song together with the
+// instrument bank in the format of demo scripts.
+// Such files can be rendered offline by tfrender.
+void eSongList::_onExportSong()
+{
+    if (selectedItems().size() != 1)
+    {
+        return;
+    }
+
+    const eID songId = selectedItems().first()->data(Qt::UserRole).toInt();
+    const tfSong *song = eDemoData::getSongById(songId);
+    eASSERT(song != eNULL);
+
+    const QString filePath = QFileDialog::getSaveFileName(this, "", QString(song->getUserName())+".tfs", "Tunefish songs (*.tfs)");
+
+    if (filePath == "")
+    {
+        return;
+    }
+
+    eDataStream stream;
+
+    eDemo::getSynth().storeInstruments(stream);
+    song->store(stream);
+
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        QMessageBox::critical(this, "Error", "Couldn't create song file!");
+        return;
+    }
+
+    const eByteArray &data = stream.getData();
+    file.write((const eChar *)&data[0], data.size());
+    file.close();
+}
+
 void eSongList::_onAddSong()
 {
     tfSong *song = eDemoData::newSong();
@@ -144,6 +186,13 @@ void eSongList::_createActions()
     connect(act, SIGNAL(triggered()), this, SLOT(_onRenameSong()));
     addAction(act);
 
+    act = new QAction("Export", this);
+    eASSERT(act != eNULL);
+    act->setShortcut(QKeySequence("e"));
+    act->setShortcutContext(Qt::WidgetShortcut);
+    connect(act, SIGNAL(triggered()), this, SLOT(_onExportSong()));
+    addAction(act);
+
     act = new QAction(this);
     eASSERT(act != eNULL);
     act->setSeparator(true);
@@ -39,6 +39,7 @@ private Q_SLOTS:
     void            _onSortByName();
     void            _onRemoveSong();
     void            _onRenameSong();
+    void            _onExportSong();
     void            _onAddSong();
 
 private:
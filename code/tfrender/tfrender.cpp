@@ -0,0 +1,129 @@
+#include "tfrender.hpp"
+
+const eU32 SAMPLE_RATE = 44100;
+const eU32 RENDER_BLOCKS = 256;
+
+static void printUsage()
+{
+	printf("usage: tfrender <song file> [wave file] [-seed <n>] [-loops <n>]\n\n");
+	printf("Renders a song file exported from the editor (instrument\n");
+	printf("bank followed by the song) as fast as possible. Prints the\n");
+	printf("hash of the output and the speed relative to real-time.\n");
+	printf("A seed of 0 randomizes voices like real-time playback does.\n");
+}
+
+static eBool loadFile(const eChar *fileName, eByteArray &data)
+{
+	FILE *f = fopen(fileName, "rb");
+
+	if (f == eNULL)
+	{
+		return eFALSE;
+	}
+
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	if (size <= 0)
+	{
+		fclose(f);
+		return eFALSE;
+	}
+
+	data.resize(size);
+	const eBool res = (fread(&data[0], 1, size, f) == (size_t)size);
+	fclose(f);
+	return res;
+}
+
+int main(int argc, char **argv)
+{
+	const eChar *songFile = eNULL;
+	const eChar *waveFile = eNULL;
+	eU32 seed = 1;
+	eU32 loops = 1;
+
+	for (eInt i=1; i<argc; i++)
+	{
+		if (eStrCompare(argv[i], "-seed") == 0 && i+1 < argc)
+			seed = atoi(argv[++i]);
+		else if (eStrCompare(argv[i], "-loops") == 0 && i+1 < argc)
+			loops = eMax(atoi(argv[++i]), 1);
+		else if (songFile == eNULL)
+			songFile = argv[i];
+		else if (waveFile == eNULL)
+			waveFile = argv[i];
+		else
+		{
+			printUsage();
+			return -1;
+		}
+	}
+
+	if (songFile == eNULL)
+	{
+		printUsage();
+		return -1;
+	}
+
+	eByteArray data;
+
+	if (!loadFile(songFile, data))
+	{
+		fprintf(stderr, "Could not read song file '%s'\n", songFile);
+		return -1;
+	}
+
+	tfWaveOut waveOut(SAMPLE_RATE);
+
+	if (waveFile && !waveOut.open(waveFile))
+	{
+		fprintf(stderr, "Could not create wave file '%s'\n", waveFile);
+		return -1;
+	}
+
+	// Voices are seeded while rows are processed,
+	// which happens on the calling thread only.
+	tfRandomize(seed);
+
+	tfPlayer *player = new tfPlayer(&waveOut, eFALSE);
+	eASSERT(player != eNULL);
+
+	eDataStream stream(&data[0], data.size());
+	player->loadInstruments(stream);
+
+	tfSong song;
+	song.load(stream);
+
+	const eF32 songTime = song.rowToTime(song.getLengthInRows());
+	const eU32 blockCount = (eU32)eCeil(songTime*SAMPLE_RATE/TF_BLOCKSIZE)*loops;
+
+	printf("Rendering %.2f seconds with %u workers\n", songTime*loops, player->getWorkerCount());
+
+	player->setSong(&song);
+	player->play(0.0f);
+
+	const eU64 startTicks = eTimer::getTickCount();
+
+	for (eU32 i=0; i<blockCount; i+=RENDER_BLOCKS)
+	{
+		player->renderOffline(eMin(blockCount-i, RENDER_BLOCKS));
+	}
+
+	const eF64 seconds = (eF64)(eTimer::getTickCount()-startTicks)/(eF64)eTimer::getFrequency();
+	const eF64 audioSeconds = (eF64)waveOut.getSampleCount()/SAMPLE_RATE;
+
+	printf("Rendered %.2f seconds in %.2f seconds (%.1fx real-time)\n", audioSeconds, seconds, audioSeconds/eMax(seconds, 0.000001));
+	printf("Instruments per core: %.1f\n", player->getInstrumentsPerCore());
+	printf("Hash: %08x%08x\n", (eU32)(waveOut.getHash()>>32), (eU32)waveOut.getHash());
+
+	eSAFE_DELETE(player);
+	waveOut.close();
+
+#ifndef NO_ADDSYNTH
+	tfPadSynthCache::get().shutdown();
+#endif
+
+	return 0;
+}
@@ -0,0 +1,13 @@
+#ifndef TFRENDER_HPP
+#define TFRENDER_HPP
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../eshared/system/system.hpp"
+#include "../eshared/math/math.hpp"
+#include "../eshared/synth/tunefish3.hpp"
+
+#include "waveout.hpp"
+
+#endif
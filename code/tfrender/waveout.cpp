@@ -0,0 +1,143 @@
+#include "tfrender.hpp"
+
+const eU32 CHANNELS = 2;
+const eU32 BITS = 16;
+
+// FNV-1a, which doesn't depend on the block size
+// the samples are filled with.
+const eU64 HASH_BASIS = 0xcbf29ce484222325ULL;
+const eU64 HASH_PRIME = 0x100000001b3ULL;
+
+tfWaveOut::tfWaveOut(eU32 sampleRate) :
+	m_file(eNULL),
+	m_sampleRate(sampleRate),
+	m_dataSize(0),
+	m_hash(HASH_BASIS)
+{
+}
+
+tfWaveOut::~tfWaveOut()
+{
+	close();
+}
+
+eBool tfWaveOut::open(const eChar *fileName)
+{
+	eASSERT(fileName != eNULL);
+
+	close();
+
+	m_file = fopen(fileName, "wb");
+
+	if (m_file == eNULL)
+	{
+		return eFALSE;
+	}
+
+	// The header is written again with the
+	// final sizes when the file is closed.
+	_writeHeader();
+	return eTRUE;
+}
+
+void tfWaveOut::close()
+{
+	if (m_file)
+	{
+		fseek(m_file, 0, SEEK_SET);
+		_writeHeader();
+		fclose(m_file);
+		m_file = eNULL;
+	}
+}
+
+eBool tfWaveOut::initialize(eU32 latency, eU32 sampleRate)
+{
+	m_sampleRate = sampleRate;
+	return eTRUE;
+}
+
+void tfWaveOut::shutdown()
+{
+	close();
+}
+
+void tfWaveOut::play()
+{
+}
+
+void tfWaveOut::stop()
+{
+}
+
+void tfWaveOut::clear()
+{
+}
+
+void tfWaveOut::fill(const eU8 *data, eU32 count)
+{
+	eASSERT(data != eNULL);
+
+	for (eU32 i=0; i<count; i++)
+	{
+		m_hash = (m_hash^data[i])*HASH_PRIME;
+	}
+
+	if (m_file)
+	{
+		fwrite(data, 1, count, m_file);
+	}
+
+	m_dataSize += count;
+}
+
+eBool tfWaveOut::isFilled() const
+{
+	return eFALSE;
+}
+
+eU32 tfWaveOut::getSampleRate() const
+{
+	return m_sampleRate;
+}
+
+eU32 tfWaveOut::getSampleCount() const
+{
+	return m_dataSize/(CHANNELS*BITS/8);
+}
+
+eU64 tfWaveOut::getHash() const
+{
+	return m_hash;
+}
+
+void tfWaveOut::_writeHeader()
+{
+	const eU32 blockAlign = CHANNELS*BITS/8;
+
+	fwrite("RIFF", 1, 4, m_file);
+	_writeDword(36+m_dataSize);
+	fwrite("WAVEfmt ", 1, 8, m_file);
+	_writeDword(16);
+	_writeWord(1);
+	_writeWord(CHANNELS);
+	_writeDword(m_sampleRate);
+	_writeDword(m_sampleRate*blockAlign);
+	_writeWord(blockAlign);
+	_writeWord(BITS);
+	fwrite("data", 1, 4, m_file);
+	_writeDword(m_dataSize);
+}
+
+// Wave files are little endian on every platform.
+void tfWaveOut::_writeDword(eU32 dword)
+{
+	_writeWord(dword&0xffff);
+	_writeWord(dword>>16);
+}
+
+void tfWaveOut::_writeWord(eU16 word)
+{
+	const eU8 bytes[2] = { (eU8)(word&0xff), (eU8)(word>>8) };
+	fwrite(bytes, 1, 2, m_file);
+}
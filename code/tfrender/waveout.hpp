@@ -0,0 +1,42 @@
+#ifndef TF_WAVEOUT_HPP
+#define TF_WAVEOUT_HPP
+
+// Sound output which never throttles the player.
+// All filled samples are hashed and optionally
+// written to a 16 bit stereo wave file.
+class tfWaveOut : public tfISoundOut
+{
+public:
+	tfWaveOut(eU32 sampleRate);
+	virtual ~tfWaveOut();
+
+	eBool			open(const eChar *fileName);
+	void			close();
+
+	virtual eBool	initialize(eU32 latency, eU32 sampleRate);
+	virtual void	shutdown();
+
+	virtual void	play();
+	virtual void	stop();
+	virtual void	clear();
+	virtual void	fill(const eU8 *data, eU32 count);
+
+	virtual eBool	isFilled() const;
+	virtual eU32	getSampleRate() const;
+
+	eU32			getSampleCount() const;
+	eU64			getHash() const;
+
+private:
+	void			_writeHeader();
+	void			_writeDword(eU32 dword);
+	void			_writeWord(eU16 word);
+
+private:
+	FILE *			m_file;
+	eU32			m_sampleRate;
+	eU32			m_dataSize;
+	eU64			m_hash;
+};
+
+#endif
@@ -38,9 +38,12 @@ void tf3SynthProgram::loadDefault(int i)
 // tf3Synth
 //-----------------------------------------------------------------------------------------
 
+static volatile eInt instanceCount = 0;
+
 //-----------------------------------------------------------------------------------------
 tf3Synth::tf3Synth (audioMasterCallback audioMaster, void* hInstance)
-	: AudioEffectX (audioMaster, kNumPrograms, TF_PARAM_COUNT)
+	: AudioEffectX (audioMaster, kNumPrograms, TF_PARAM_COUNT),
+	reloadProgram (0)
 {
 	// Initialize module path
 	eChar mpath[512];
@@ -56,6 +59,7 @@ tf3Synth::tf3Synth (audioMasterCallback audioMaster, void* hInstance)
 	modulePath = QString(mpath);
 
 	// Initialize tunefish
+	eAtomicInc(instanceCount);
 	tf = new tfInstrument();
 
 	// initialize programs
@@ -92,6 +96,14 @@ tf3Synth::~tf3Synth ()
 {
 	eSAFE_DELETE(editor);
 	eSAFE_DELETE(tf);
+
+#ifndef NO_ADDSYNTH
+	// The table builder can't be stopped when the
+	// plugin gets unloaded, so it's stopped with
+	// the last instance.
+	if (eAtomicDec(instanceCount) == 0)
+		tfPadSynthCache::get().shutdown();
+#endif
 }
 
 //-----------------------------------------------------------------------------------------
@@ -104,32 +116,48 @@ void tf3Synth::setProgram (long program)
 	if (program < 0 || program >= kNumPrograms)
 		return;
 
-	// write program from tunefish to program list before switching
-	tf3SynthProgram *ap = &programs[curProgram];
-	for(int i=0;i<TF_PARAM_COUNT;i++)
-		ap->params[i] = tf->getParam(i);
-
-	// switch program
+	// switch program, the audio thread loads it
+	// into tunefish
 	curProgram = program;
-	
-	// load new program to into tunefish
-	ap = &programs[curProgram];	
-	for(int i=0;i<TF_PARAM_COUNT;i++)
-		tf->setParam(i, ap->params[i]);
+	reloadProgram = 1;
 }
 
-void tf3Synth::writeProgramToPresets()
+void tf3Synth::loadProgramFromPresets()
 {
-    tf3SynthProgram *ap = &programs[curProgram];
-    for(int i=0;i<TF_PARAM_COUNT;i++)
-        ap->params[i] = tf->getParam(i);
+    reloadProgram = 1;
 }
 
-void tf3Synth::loadProgramFromPresets()
+// Parameter changes are queued, as the host and
+// the editor call from other threads than the
+// audio thread. If the queue is full, the whole
+// program is reloaded instead.
+void tf3Synth::queueParameter (long index, float value)
+{
+    tfEventQueue::Event ev;
+
+    eMemSet(&ev, 0, sizeof(ev));
+    ev.type = tfEventQueue::EVENT_PARAM;
+    ev.index = index;
+    ev.value = value;
+
+    if (!paramEvents.push(ev))
+        reloadProgram = 1;
+}
+
+// Called by the audio thread before rendering.
+void tf3Synth::applyParameters ()
 {
-    tf3SynthProgram *ap = &programs[curProgram];	
-    for(int i=0;i<TF_PARAM_COUNT;i++)
-        tf->setParam(i, ap->params[i]);
+    tfEventQueue::Event ev;
+
+    while (paramEvents.pop(ev))
+        tf->setParam(ev.index, ev.value);
+
+    if (eAtomicCompareExchange(reloadProgram, 0, 1) == 1)
+    {
+        const tf3SynthProgram *ap = &programs[curProgram];
+        for(int i=0;i<TF_PARAM_COUNT;i++)
+            tf->setParam(i, ap->params[i]);
+    }
 }
 
 //-----------------------------------------------------------------------------------------
@@ -158,7 +186,7 @@ void tf3Synth::getParameterDisplay (long index, char *text)
 {
     LOG("getParameterDisplay()\n");
 	text[0] = 0;
-	float2string (tf->getParam(index), text);
+	float2string (programs[curProgram].params[index], text);
 }
 
 //-----------------------------------------------------------------------------------------
@@ -176,8 +204,8 @@ void tf3Synth::setParameter (long index, float value)
 {
     LOG("setParameter()\n");
 	tf3SynthProgram *ap = &programs[curProgram];
-	tf->setParam(index, value);
     ap->params[index] = value;
+	queueParameter(index, value);
 }
 
 //-----------------------------------------------------------------------------------------
@@ -186,7 +214,7 @@ float tf3Synth::getParameter (long index)
     char str[1024];
     sprintf(str, "getParameter(%i)\n", index);
     LOG(str);
-	return tf->getParam(index);
+	return programs[curProgram].params[index];
 }
 
 //-----------------------------------------------------------------------------------------
@@ -407,12 +435,7 @@ bool tf3Synth::loadProgramAll()
 			return false;
 
         if (i == curProgram)
-        {
-            // load new program to into tunefish
-            tf3SynthProgram *ap = &programs[curProgram];	
-            for(int i=0;i<TF_PARAM_COUNT;i++)
-                tf->setParam(i, ap->params[i]);
-        }
+            reloadProgram = 1;
 	}
 
 	return true;
@@ -503,22 +526,15 @@ bool tf3Synth::saveProgram(long index)
 
 bool tf3Synth::copyProgram()
 {
-    tf3SynthProgram *ap = &copiedProgram;
-	for(int i=0;i<TF_PARAM_COUNT;i++)
-		ap->params[i] = tf->getParam(i);
-
-    eStrCopy(ap->name, programs[curProgram].name);
+    eMemCopy(&copiedProgram, &programs[curProgram], sizeof(tf3SynthProgram));
 
     return true;
 }
 
 bool tf3Synth::pasteProgram()
 {
-    tf3SynthProgram *ap = &copiedProgram;
-	for(int i=0;i<TF_PARAM_COUNT;i++)    
-        tf->setParam(i, ap->params[i]);
-
-    eStrCopy(programs[curProgram].name, ap->name);
+    eMemCopy(&programs[curProgram], &copiedProgram, sizeof(tf3SynthProgram));
+    reloadProgram = 1;
 
     return true;
 }
@@ -565,6 +581,7 @@ void tf3Synth::process (eF32 **inputs, eF32 **outputs, long sampleFrames)
 	// processReplacing () is optional, and in place (out = h). even though
 	// processReplacing () is optional, it is very highly recommended to support it
 
+	applyParameters();
 	tf->process(outputs, sampleFrames);
 }
 
@@ -106,7 +106,6 @@ public:
     void getProgramData(long index, tf3SynthProgram *data);
     void setProgramData(long index, tf3SynthProgram *data);
 
-    void writeProgramToPresets();
     void loadProgramFromPresets();
 
     tfInstrument * getTunefish();
@@ -116,12 +115,20 @@ private:
 	void noteOn (long note, long velocity, long delta);
 	void noteOff ();
 	void fillProgram (long channel, long prg, MidiProgramName* mpn);
+	void queueParameter (long index, float value);
+	void applyParameters ();
 
 	tf3SynthProgram programs[kNumPrograms];
     tf3SynthProgram copiedProgram;
 
 	tfInstrument * tf;
 
+	// The programs hold the current parameters.
+	// Changes are passed to the instrument by the
+	// audio thread, see applyParameters().
+	tfEventQueue paramEvents;
+	volatile eInt reloadProgram;
+
 	long channelPrograms[16];
 	QString modulePath;
 };
@@ -35,6 +35,7 @@ tf3Window::tf3Window(AudioEffect *fx, HWND handle) : QWinWidget(handle, NULL)
     setupUi(this);
     initParameters();
 	m_oscView->setSynth(m_synth->getTunefish());
+	connect(m_oscView, SIGNAL(onParameterChanged(eU32, eF32)), this, SLOT(onSplineChanged(eU32, eF32)));
     updateOscView();
 
     _updateInstrSelection(false);
@@ -526,6 +527,11 @@ void tf3Window::onChanged(double value)
     if (obj == m_mm10Mod)           { effect->setParameter(TF_MM10_MOD, (value / TF_MM_MODRANGE) + 0.5f); return; }
 }
 
+void tf3Window::onSplineChanged(eU32 index, eF32 value)
+{
+    effect->setParameter(index, value);
+}
+
 void tf3Window::onClicked(bool checked)
 {
 	QObject *obj = sender();
@@ -875,14 +881,12 @@ void tf3Window::progRestore(bool checked)
 
 void tf3Window::progSave(bool checked)
 {
-    m_synth->writeProgramToPresets();
     if (!m_synth->saveProgram())
         QMessageBox::critical(this, "TF3", "Program could not be saved!");
 }
 
 void tf3Window::manage(bool checked)
 {
-    m_synth->writeProgramToPresets();
     Manage dlg(m_synth);
     dlg.exec();
     _updateInstrSelection(true);
@@ -40,6 +40,7 @@ private:
 private Q_SLOTS:
     void    onChanged(int value);
     void    onChanged(double value);
+    void    onSplineChanged(eU32 index, eF32 value);
 	void	onClicked(bool checked);
     void    progChanged(int value);
     void    progRestore(bool checked);
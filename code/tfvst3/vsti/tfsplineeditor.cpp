@@ -140,8 +140,8 @@ void tfSplineEditor::mouseMoveEvent(QMouseEvent *me)
 		eF32 value = 1.0f - ((eClamp<eF32>(-1.0f, ((eF32)me->y() - (eF32)viewHeight / 2) / ((eF32)viewHeight / 4), 1.0f) + 1.0f) / 2.0f);
 		eF32 offset = eClamp<eF32>(0.0f, (eF32)(me->x()-m_pointOffset) / (eF32)(viewWidth-m_pointOffset), 1.0f);
 
-		m_tf->setParamUI(TF_OSC_POINT1_VALUE + (3 * m_dragPoint), value);
-		m_tf->setParamUI(TF_OSC_POINT1_OFFSET + (3 * m_dragPoint), offset);
+		Q_EMIT onParameterChanged(TF_OSC_POINT1_VALUE + (3 * m_dragPoint), value);
+		Q_EMIT onParameterChanged(TF_OSC_POINT1_OFFSET + (3 * m_dragPoint), offset);
 
 		update();
 	}
@@ -195,11 +195,11 @@ void tfSplineEditor::mousePressEvent(QMouseEvent *me)
 			{
 				eF32 intrp = m_tf->getParam(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)));
 				if (intrp < 0.33f) 
-					m_tf->setParamUI(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)), 0.5f);
+					Q_EMIT onParameterChanged(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)), 0.5f);
 				else if (intrp < 0.66f) 
-					m_tf->setParamUI(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)), 1.0f);
+					Q_EMIT onParameterChanged(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)), 1.0f);
 				else 
-					m_tf->setParamUI(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)), 0.0f);
+					Q_EMIT onParameterChanged(TF_OSC_POINT1_INTERPOLATION + (3 * (i-1)), 0.0f);
 
 				update();
 				return;
@@ -208,11 +208,11 @@ void tfSplineEditor::mousePressEvent(QMouseEvent *me)
 
 		eF32 intrp = m_tf->getParam(TF_OSC_FINAL_INTERPOLATION);
 		if (intrp < 0.33f) 
-			m_tf->setParamUI(TF_OSC_FINAL_INTERPOLATION, 0.5f);
+			Q_EMIT onParameterChanged(TF_OSC_FINAL_INTERPOLATION, 0.5f);
 		else if (intrp < 0.66f) 
-			m_tf->setParamUI(TF_OSC_FINAL_INTERPOLATION, 1.0f);
+			Q_EMIT onParameterChanged(TF_OSC_FINAL_INTERPOLATION, 1.0f);
 		else 
-			m_tf->setParamUI(TF_OSC_FINAL_INTERPOLATION, 0.0f);
+			Q_EMIT onParameterChanged(TF_OSC_FINAL_INTERPOLATION, 0.0f);
 
 		update();
 	}
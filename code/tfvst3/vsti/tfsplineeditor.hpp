@@ -32,6 +32,12 @@ public:
 
 	void            setSynth(tfInstrument *tf);
 
+Q_SIGNALS:
+    // Edits aren't written to the instrument, as
+    // the audio thread might be rendering it. The
+    // owner queues them instead.
+    void            onParameterChanged(eU32 index, eF32 value);
+
 protected:
 	virtual void	paintEvent(QPaintEvent * pe);
 